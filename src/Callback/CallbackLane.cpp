@@ -0,0 +1,278 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <algorithm>
+#include <chrono>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./CallbackLane.h"
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+CallbackLane::CallbackLane(size_t us_ThreadCount) : b_Barrier(false),
+                                                     b_Run(true)
+{
+    for (size_t i = 0; i < LANE_COUNT; ++i)
+    {
+        for (size_t j = 0; j < us_BucketCount; ++j)
+        {
+            p_Latency[i][j].store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    if (us_ThreadCount == 0)
+    {
+        us_ThreadCount = 1;
+    }
+    
+    try
+    {
+        // Never grows while running, at most one key per thread
+        v_Running.reserve(us_ThreadCount);
+        v_Thread.reserve(us_ThreadCount);
+        
+        for (size_t i = 0; i < us_ThreadCount; ++i)
+        {
+            v_Thread.emplace_back(Work, this);
+        }
+    }
+    catch (std::exception& e)
+    {
+        c_Mutex.lock();
+        b_Run = false;
+        c_Mutex.unlock();
+        c_Condition.notify_all();
+        
+        for (auto& Thread : v_Thread)
+        {
+            Thread.join();
+        }
+        
+        throw Exception("Failed to start callback lane thread: " + std::string(e.what()));
+    }
+}
+
+CallbackLane::~CallbackLane() noexcept
+{
+    c_Mutex.lock();
+    b_Run = false;
+    c_Mutex.unlock();
+    c_Condition.notify_all();
+    
+    for (auto& Thread : v_Thread)
+    {
+        Thread.join();
+    }
+}
+
+//*************************************************************************************
+// Submit
+//*************************************************************************************
+
+void CallbackLane::Submit(MRH_Uint32 u32_Key, Task c_Task) noexcept
+{
+    Queued c_Queued = { std::move(c_Task), GetTimeNS(), u32_Key, false };
+    Queue(c_Queued);
+}
+
+void CallbackLane::SubmitBarrier(Task c_Task) noexcept
+{
+    Queued c_Queued = { std::move(c_Task), GetTimeNS(), 0, true };
+    Queue(c_Queued);
+}
+
+//*************************************************************************************
+// Lane
+//*************************************************************************************
+
+void CallbackLane::Queue(Queued& c_Queued) noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        dq_Queued.push_back(std::move(c_Queued));
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to queue callback: " +
+                                                             std::string(e.what()),
+                                       "CallbackLane.cpp", __LINE__);
+        
+        // Late is better than never
+        Perform(c_Queued.c_Task);
+        AddLatency(IO, c_Queued.u64_QueuedNS);
+        return;
+    }
+    
+    c_Condition.notify_one();
+}
+
+void CallbackLane::Work(CallbackLane* p_Instance) noexcept
+{
+    std::unique_lock<std::mutex> c_Lock(p_Instance->c_Mutex);
+    auto It = p_Instance->dq_Queued.end();
+    
+    while (true)
+    {
+        p_Instance->c_Condition.wait(c_Lock, [p_Instance, &It]
+        {
+            It = p_Instance->FindRunnable();
+            return It != p_Instance->dq_Queued.end() || (p_Instance->b_Run == false && p_Instance->dq_Queued.size() == 0);
+        });
+        
+        // Queue is drained before stopping
+        if (It == p_Instance->dq_Queued.end())
+        {
+            return;
+        }
+        
+        Queued c_Queued = std::move(*It);
+        p_Instance->dq_Queued.erase(It);
+        
+        if (c_Queued.b_Barrier == true)
+        {
+            p_Instance->b_Barrier = true;
+        }
+        else
+        {
+            p_Instance->v_Running.push_back(c_Queued.u32_Key);
+        }
+        
+        c_Lock.unlock();
+        
+        Perform(c_Queued.c_Task);
+        p_Instance->AddLatency(IO, c_Queued.u64_QueuedNS);
+        
+        c_Lock.lock();
+        
+        if (c_Queued.b_Barrier == true)
+        {
+            p_Instance->b_Barrier = false;
+        }
+        else
+        {
+            auto Running = std::find(p_Instance->v_Running.begin(), p_Instance->v_Running.end(), c_Queued.u32_Key);
+            
+            *Running = p_Instance->v_Running.back();
+            p_Instance->v_Running.pop_back();
+        }
+        
+        // Tasks waiting for this one may run now
+        p_Instance->c_Condition.notify_all();
+    }
+}
+
+std::deque<CallbackLane::Queued>::iterator CallbackLane::FindRunnable() noexcept
+{
+    // Nothing runs next to a barrier
+    if (b_Barrier == true)
+    {
+        return dq_Queued.end();
+    }
+    
+    v_Blocked.clear();
+    
+    for (auto It = dq_Queued.begin(); It != dq_Queued.end(); ++It)
+    {
+        if (It->b_Barrier == true)
+        {
+            // Waits for all earlier tasks, later tasks wait for it
+            if (It == dq_Queued.begin() && v_Running.size() == 0)
+            {
+                return It;
+            }
+            
+            break;
+        }
+        else if (std::find(v_Blocked.begin(), v_Blocked.end(), It->u32_Key) != v_Blocked.end())
+        {
+            continue;
+        }
+        else if (std::find(v_Running.begin(), v_Running.end(), It->u32_Key) == v_Running.end())
+        {
+            return It;
+        }
+        
+        // Later tasks of the same key keep their order
+        try
+        {
+            v_Blocked.push_back(It->u32_Key);
+        }
+        catch (...)
+        {
+            // Searched again once a running task finished
+            break;
+        }
+    }
+    
+    return dq_Queued.end();
+}
+
+void CallbackLane::Perform(Task& c_Task) noexcept
+{
+    try
+    {
+        c_Task();
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "CallbackLane.cpp", __LINE__);
+    }
+}
+
+//*************************************************************************************
+// Latency
+//*************************************************************************************
+
+MRH_Uint64 CallbackLane::GetTimeNS() noexcept
+{
+    return static_cast<MRH_Uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void CallbackLane::AddLatency(Lane e_Lane, MRH_Uint64 u64_StartNS) noexcept
+{
+    MRH_Uint64 u64_US = (GetTimeNS() - u64_StartNS) / 1000;
+    size_t us_Bucket = 0;
+    
+    // Highest set bit, the last bucket takes everything above
+    if (u64_US > 1)
+    {
+        us_Bucket = static_cast<size_t>(63 - __builtin_clzll(u64_US));
+        
+        if (us_Bucket >= us_BucketCount)
+        {
+            us_Bucket = us_BucketCount - 1;
+        }
+    }
+    
+    p_Latency[e_Lane][us_Bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CallbackLane::GetLatency(Lane e_Lane, MRH_Uint64* p_Bucket) const noexcept
+{
+    for (size_t i = 0; i < us_BucketCount; ++i)
+    {
+        p_Bucket[i] = p_Latency[e_Lane][i].load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,220 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CallbackLane_h
+#define CallbackLane_h
+
+// C / C++
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <deque>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "../Exception.h"
+
+// Pre-defined
+#ifndef MRH_USER_CALLBACK_IO_THREAD_COUNT
+    #define MRH_USER_CALLBACK_IO_THREAD_COUNT 2
+#endif
+
+
+class CallbackLane
+{
+public:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        FAST = 0, // Memory only, inline on the callback thread
+        IO = 1, // Filesystem, in order per key on the lane threads
+        
+        LANE_MAX = IO,
+        
+        LANE_COUNT = LANE_MAX + 1
+        
+    }Lane;
+    
+    typedef std::function<void()> Task;
+    
+    // Bucket i counts [2^i, 2^(i + 1)) microseconds
+    static constexpr size_t us_BucketCount = 24;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param us_ThreadCount The number of IO lane threads.
+     */
+    
+    CallbackLane(size_t us_ThreadCount);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_CallbackLane CallbackLane class source.
+     */
+    
+    CallbackLane(CallbackLane const& c_CallbackLane) = delete;
+    
+    /**
+     *  Default destructor. Waits for all submitted tasks to complete.
+     */
+    
+    ~CallbackLane() noexcept;
+    
+    //*************************************************************************************
+    // Submit
+    //*************************************************************************************
+    
+    /**
+     *  Submit a task to the IO lane. Tasks with the same key are performed 
+     *  one after the other in submit order, tasks with different keys in 
+     *  parallel. The task is performed inline if it could not be queued. 
+     *  This function is thread safe.
+     *
+     *  \param u32_Key The ordering key, the event group id.
+     *  \param c_Task The task to perform.
+     */
+    
+    void Submit(MRH_Uint32 u32_Key, Task c_Task) noexcept;
+    
+    /**
+     *  Submit a barrier task to the IO lane. The task is performed alone, 
+     *  after all tasks submitted before it and before all tasks submitted 
+     *  after it. The task is performed inline if it could not be queued. 
+     *  This function is thread safe.
+     *
+     *  \param c_Task The task to perform.
+     */
+    
+    void SubmitBarrier(Task c_Task) noexcept;
+    
+    //*************************************************************************************
+    // Latency
+    //*************************************************************************************
+    
+    /**
+     *  Get the current time for latency measurement.
+     *
+     *  \return The monotonic time in nanoseconds.
+     */
+    
+    static MRH_Uint64 GetTimeNS() noexcept;
+    
+    /**
+     *  Add a handled callback to the latency histogram of a lane. This 
+     *  function is thread safe.
+     *
+     *  \param e_Lane The lane which handled the callback.
+     *  \param u64_StartNS The time the callback was recieved.
+     */
+    
+    void AddLatency(Lane e_Lane, MRH_Uint64 u64_StartNS) noexcept;
+    
+    /**
+     *  Get the latency histogram of a lane. This function is thread safe.
+     *
+     *  \param e_Lane The lane to get.
+     *  \param p_Bucket The bucket counts to write, us_BucketCount entries.
+     */
+    
+    void GetLatency(Lane e_Lane, MRH_Uint64* p_Bucket) const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Queued_t
+    {
+        Task c_Task;
+        MRH_Uint64 u64_QueuedNS;
+        MRH_Uint32 u32_Key;
+        bool b_Barrier;
+        
+    }Queued;
+    
+    //*************************************************************************************
+    // Lane
+    //*************************************************************************************
+    
+    /**
+     *  Queue a task.
+     *
+     *  \param c_Queued The task to queue.
+     */
+    
+    void Queue(Queued& c_Queued) noexcept;
+    
+    /**
+     *  Perform queued tasks.
+     *
+     *  \param p_Instance The lane instance to work for.
+     */
+    
+    static void Work(CallbackLane* p_Instance) noexcept;
+    
+    /**
+     *  Find the first queued task which may be performed now. The mutex 
+     *  has to be locked.
+     *
+     *  \return The queued task or the queue end if none may run.
+     */
+    
+    std::deque<Queued>::iterator FindRunnable() noexcept;
+    
+    /**
+     *  Perform a single task.
+     *
+     *  \param c_Task The task to perform.
+     */
+    
+    static void Perform(Task& c_Task) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    std::mutex c_Mutex;
+    std::condition_variable c_Condition;
+    std::deque<Queued> dq_Queued;
+    std::vector<MRH_Uint32> v_Running; // Keys of running tasks
+    std::vector<MRH_Uint32> v_Blocked; // Keys skipped while searching
+    bool b_Barrier; // Barrier task running
+    bool b_Run;
+    std::vector<std::thread> v_Thread;
+    
+    std::atomic<MRH_Uint64> p_Latency[LANE_COUNT][us_BucketCount];
+    
+protected:
+    
+};
+
+#endif /* CallbackLane_h */
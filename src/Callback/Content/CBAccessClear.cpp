@@ -21,13 +21,16 @@
 
 // Project
 #include "./CBAccessClear.h"
+#include "../ResponseEvent.h"
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-CBAccessClear::CBAccessClear(std::shared_ptr<Content>& p_Content) noexcept : p_Content(p_Content)
+CBAccessClear::CBAccessClear(std::shared_ptr<Content>& p_Content,
+                             std::shared_ptr<CallbackLane>& p_Lane) noexcept : p_Content(p_Content),
+                                                                               p_Lane(p_Lane)
 {}
 
 CBAccessClear::~CBAccessClear() noexcept
@@ -39,44 +42,57 @@ CBAccessClear::~CBAccessClear() noexcept
 
 void CBAccessClear::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
 {
-    MRH_EvD_U_AccessClear_S c_Data;
-    c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
+    // Unlinking touches the filesystem and has to follow a previous reset
+    std::shared_ptr<Content> p_Clear(p_Content);
     
+    p_Lane->Submit(u32_GroupID, [p_Clear, u32_GroupID]()
+    {
+        ClearAccess(p_Clear, u32_GroupID);
+    });
+}
+
+//*************************************************************************************
+// Clear
+//*************************************************************************************
+
+void CBAccessClear::ClearAccess(std::shared_ptr<Content> const& p_Content, MRH_Uint32 u32_GroupID) noexcept
+{
     // Reset happened? Needed for package info
     if (p_Content->GetReset() == true)
     {
         try
         {
-            p_Content->ClearAccess();
-            c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+            // Response is sent once all links are removed
+            p_Content->ClearAccess([u32_GroupID](bool b_Result)
+            {
+                SendResponse(b_Result, u32_GroupID);
+            });
+            
+            return;
         }
         catch (Exception& e)
         {
             MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
                                            "CBAccessClear.cpp", __LINE__);
         }
+        catch (std::exception& e)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                           "CBAccessClear.cpp", __LINE__);
+        }
     }
     
+    SendResponse(false, u32_GroupID);
+}
+
+//*************************************************************************************
+// Response
+//*************************************************************************************
+
+void CBAccessClear::SendResponse(bool b_Result, MRH_Uint32 u32_GroupID) noexcept
+{
+    MRH_EvD_U_AccessClear_S c_Data;
+    c_Data.u8_Result = (b_Result == true ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
     
-    MRH_Event* p_Result = MRH_EVD_CreateSetEvent(MRH_EVENT_USER_ACCESS_CLEAR_S, &c_Data);
-    
-    if (p_Result == NULL)
-    {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to create response event!",
-                                       "CBAccessClear.cpp", __LINE__);
-        return;
-    }
-    
-    p_Result->u32_GroupID = u32_GroupID;
-    
-    try
-    {
-        MRH_EventStorage::Singleton().Add(p_Result);
-    }
-    catch (MRH_PSBException& e)
-    {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
-                                       "CBAccessClear.cpp", __LINE__);
-        MRH_EVD_DestroyEvent(p_Result);
-    }
+    ResponseEvent::Send(MRH_EVENT_USER_ACCESS_CLEAR_S, c_Data, u32_GroupID);
 }
@@ -25,6 +25,7 @@
 
 // Project
 #include "../../Content/Content.h"
+#include "../CallbackLane.h"
 
 
 class CBAccessClear : public MRH_Callback
@@ -39,9 +40,11 @@ public:
      *  Default constructor.
      *
      *  \param p_Content The content information to clear on callback.
+     *  \param p_Lane The callback lanes to clear on.
      */
     
-    CBAccessClear(std::shared_ptr<Content>& p_Content) noexcept;
+    CBAccessClear(std::shared_ptr<Content>& p_Content,
+                  std::shared_ptr<CallbackLane>& p_Lane) noexcept;
     
     /**
      *  Default destructor.
@@ -64,11 +67,38 @@ public:
     
 private:
     
+    //*************************************************************************************
+    // Clear
+    //*************************************************************************************
+    
+    /**
+     *  Clear all content access and respond once done.
+     *
+     *  \param p_Content The content information to clear.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void ClearAccess(std::shared_ptr<Content> const& p_Content, MRH_Uint32 u32_GroupID) noexcept;
+    
+    //*************************************************************************************
+    // Response
+    //*************************************************************************************
+    
+    /**
+     *  Send a clear access response.
+     *
+     *  \param b_Result If the clear succeeded.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void SendResponse(bool b_Result, MRH_Uint32 u32_GroupID) noexcept;
+    
     //*************************************************************************************
     // Data
     //*************************************************************************************
     
     std::shared_ptr<Content> p_Content;
+    std::shared_ptr<CallbackLane> p_Lane;
     
 protected:
 
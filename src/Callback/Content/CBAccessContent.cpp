@@ -21,73 +21,118 @@
 
 // Project
 #include "./CBAccessContent.h"
+#include "../ResponseEvent.h"
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-CBAccessContent::CBAccessContent(std::shared_ptr<Content>& p_Content) noexcept : p_Content(p_Content)
-{}
+CBAccessContent::CBAccessContent(std::shared_ptr<Content>& p_Content, Configuration const& c_Configuration, std::shared_ptr<CallbackLane>& p_Lane) : p_Content(p_Content),
+                                                                                                                                                      p_Lane(p_Lane)
+{
+    auto const& v_ContentType = c_Configuration.GetContentTypes();
+    size_t us_Size = 1;
+    
+    // Keep the table at most half full
+    while (us_Size < v_ContentType.size() * 2)
+    {
+        us_Size <<= 1;
+    }
+    
+    v_Dispatch.resize(us_Size, { MRH_EVENT_UNK, MRH_EVENT_UNK, 0 });
+    
+    for (size_t i = 0; i < v_ContentType.size(); ++i)
+    {
+        MRH_Uint32 u32_RequestEvent = v_ContentType[i].u32_RequestEvent;
+        
+        // Custom command only
+        if (u32_RequestEvent == MRH_EVENT_UNK)
+        {
+            continue;
+        }
+        
+        size_t us_Index = GetDispatchIndex(u32_RequestEvent);
+        
+        while (v_Dispatch[us_Index].u32_RequestEvent != MRH_EVENT_UNK)
+        {
+            if (v_Dispatch[us_Index].u32_RequestEvent == u32_RequestEvent)
+            {
+                throw Exception("Content access event " +
+                                std::to_string(u32_RequestEvent) +
+                                " used by multiple content types!");
+            }
+            
+            us_Index = (us_Index + 1) & (v_Dispatch.size() - 1);
+        }
+        
+        v_Dispatch[us_Index] = { u32_RequestEvent, v_ContentType[i].u32_ResponseEvent, static_cast<MRH_Uint32>(i) };
+    }
+}
 
 CBAccessContent::~CBAccessContent() noexcept
 {}
 
+//*************************************************************************************
+// Dispatch
+//*************************************************************************************
+
+size_t CBAccessContent::GetDispatchIndex(MRH_Uint32 u32_RequestEvent) const noexcept
+{
+    // Fibonacci hashing, event ids are mostly sequential
+    return (static_cast<MRH_Uint64>(u32_RequestEvent) * 11400714819323198485ULL) & (v_Dispatch.size() - 1);
+}
+
 //*************************************************************************************
 // Callback
 //*************************************************************************************
 
 void CBAccessContent::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
 {
-    MRH_Uint32 u32_ResponseType = MRH_EVENT_UNK;
+    size_t us_Index = GetDispatchIndex(p_Event->u32_Type);
     
-    MRH_EvD_Base_Result_t c_Data;
-    c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
-    
-    try
+    while (v_Dispatch[us_Index].u32_RequestEvent != p_Event->u32_Type)
     {
-        switch (p_Event->u32_Type)
+        if (v_Dispatch[us_Index].u32_RequestEvent == MRH_EVENT_UNK)
         {
-            case MRH_EVENT_USER_ACCESS_DOCUMENTS_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_DOCUMENTS_S;
-                p_Content->AllowAccess(Content::DOCUMENTS);
-                break;
-            case MRH_EVENT_USER_ACCESS_PICTURES_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_PICTURES_S;
-                p_Content->AllowAccess(Content::PICTURES);
-                break;
-            case MRH_EVENT_USER_ACCESS_MUSIC_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_MUSIC_S;
-                p_Content->AllowAccess(Content::MUSIC);
-                break;
-            case MRH_EVENT_USER_ACCESS_VIDEOS_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_VIDEOS_S;
-                p_Content->AllowAccess(Content::VIDEOS);
-                break;
-            case MRH_EVENT_USER_ACCESS_DOWNLOADS_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_DOWNLOADS_S;
-                p_Content->AllowAccess(Content::DOWNLOADS);
-                break;
-            case MRH_EVENT_USER_ACCESS_CLIPBOARD_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_CLIPBOARD_S;
-                p_Content->AllowAccess(Content::CLIPBOARD);
-                break;
-            case MRH_EVENT_USER_ACCESS_INFO_PERSON_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_INFO_PERSON_S;
-                p_Content->AllowAccess(Content::INFO_PERSON);
-                break;
-            case MRH_EVENT_USER_ACCESS_INFO_RESIDENCE_U:
-                u32_ResponseType = MRH_EVENT_USER_ACCESS_INFO_RESIDENCE_S;
-                p_Content->AllowAccess(Content::INFO_RESIDENCE);
-                break;
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Wrong content access type event " +
+                                                                 std::to_string(p_Event->u32_Type) +
+                                                                 " to create access for!",
+                                           "CBAccessContent.cpp", __LINE__);
             
-            default:
-                throw Exception("Wrong content access type event " +
-                                std::to_string(p_Event->u32_Type) +
-                                " to create access for!");
+            SendResponse(MRH_EVENT_UNK, false, u32_GroupID);
+            return;
         }
         
-        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+        us_Index = (us_Index + 1) & (v_Dispatch.size() - 1);
+    }
+    
+    // Access waits for a previous reset, keep the callback thread free
+    std::shared_ptr<Content> p_Access(p_Content);
+    MRH_Uint32 u32_Type = v_Dispatch[us_Index].u32_Type;
+    MRH_Uint32 u32_ResponseType = v_Dispatch[us_Index].u32_ResponseEvent;
+    
+    p_Lane->Submit(u32_GroupID, [p_Access, u32_Type, u32_ResponseType, u32_GroupID]()
+    {
+        AllowAccess(p_Access, u32_Type, u32_ResponseType, u32_GroupID);
+    });
+}
+
+//*************************************************************************************
+// Access
+//*************************************************************************************
+
+void CBAccessContent::AllowAccess(std::shared_ptr<Content> const& p_Content, MRH_Uint32 u32_Type, MRH_Uint32 u32_ResponseType, MRH_Uint32 u32_GroupID) noexcept
+{
+    try
+    {
+        // Response is sent once the link was created
+        p_Content->AllowAccess(u32_Type, [u32_ResponseType, u32_GroupID](bool b_Result)
+        {
+            SendResponse(u32_ResponseType, b_Result, u32_GroupID);
+        });
+        
+        return;
     }
     catch (MRH_PSBException& e)
     {
@@ -105,26 +150,18 @@ void CBAccessContent::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID)
                                        "CBAccessContent.cpp", __LINE__);
     }
     
-    // Access handled, send response
-    MRH_Event* p_Result = MRH_EVD_CreateSetEvent(u32_ResponseType, &c_Data);
-    
-    if (p_Result == NULL)
-    {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to create response event!",
-                                       "CBAccessContent.cpp", __LINE__);
-        return;
-    }
-    
-    p_Result->u32_GroupID = u32_GroupID;
+    SendResponse(u32_ResponseType, false, u32_GroupID);
+}
+
+//*************************************************************************************
+// Response
+//*************************************************************************************
+
+void CBAccessContent::SendResponse(MRH_Uint32 u32_ResponseType, bool b_Result, MRH_Uint32 u32_GroupID) noexcept
+{
+    MRH_EvD_Base_Result_t c_Data;
+    c_Data.u8_Result = (b_Result == true ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
     
-    try
-    {
-        MRH_EventStorage::Singleton().Add(p_Result);
-    }
-    catch (MRH_PSBException& e)
-    {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
-                                       "CBAccessContent.cpp", __LINE__);
-        MRH_EVD_DestroyEvent(p_Result);
-    }
+    // Access handled, send response
+    ResponseEvent::Send(u32_ResponseType, c_Data, u32_GroupID);
 }
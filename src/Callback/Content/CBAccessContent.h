@@ -19,12 +19,15 @@
 
 // C / C++
 #include <memory>
+#include <vector>
 
 // External
 #include <libmrhpsb/MRH_Callback.h>
 
 // Project
 #include "../../Content/Content.h"
+#include "../../Configuration.h"
+#include "../CallbackLane.h"
 
 
 class CBAccessContent : public MRH_Callback
@@ -39,9 +42,11 @@ public:
      *  Default constructor.
      *
      *  \param p_Content The content information to create on callback.
+     *  \param c_Configuration The configuration containing the content types.
+     *  \param p_Lane The callback lanes to create access on.
      */
     
-    CBAccessContent(std::shared_ptr<Content>& p_Content) noexcept;
+    CBAccessContent(std::shared_ptr<Content>& p_Content, Configuration const& c_Configuration, std::shared_ptr<CallbackLane>& p_Lane);
     
     /**
      *  Default destructor.
@@ -64,11 +69,70 @@ public:
     
 private:
     
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Dispatch_t
+    {
+        MRH_Uint32 u32_RequestEvent; // MRH_EVENT_UNK if unused
+        MRH_Uint32 u32_ResponseEvent;
+        MRH_Uint32 u32_Type;
+        
+    }Dispatch;
+    
+    //*************************************************************************************
+    // Dispatch
+    //*************************************************************************************
+    
+    /**
+     *  Get the table index for a request event.
+     *
+     *  \param u32_RequestEvent The request event type.
+     *
+     *  \return The first table index to check.
+     */
+    
+    size_t GetDispatchIndex(MRH_Uint32 u32_RequestEvent) const noexcept;
+    
+    //*************************************************************************************
+    // Access
+    //*************************************************************************************
+    
+    /**
+     *  Create content access and respond once done.
+     *
+     *  \param p_Content The content information to create access with.
+     *  \param u32_Type The content type to allow access for.
+     *  \param u32_ResponseType The response event type.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void AllowAccess(std::shared_ptr<Content> const& p_Content, MRH_Uint32 u32_Type, MRH_Uint32 u32_ResponseType, MRH_Uint32 u32_GroupID) noexcept;
+    
+    //*************************************************************************************
+    // Response
+    //*************************************************************************************
+    
+    /**
+     *  Send a content access response.
+     *
+     *  \param u32_ResponseType The response event type.
+     *  \param b_Result If the access succeeded.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void SendResponse(MRH_Uint32 u32_ResponseType, bool b_Result, MRH_Uint32 u32_GroupID) noexcept;
+    
     //*************************************************************************************
     // Data
     //*************************************************************************************
     
     std::shared_ptr<Content> p_Content;
+    std::shared_ptr<CallbackLane> p_Lane;
+    
+    // Open addressed, power of two size
+    std::vector<Dispatch> v_Dispatch;
     
 protected:
 
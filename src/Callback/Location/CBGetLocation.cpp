@@ -15,34 +15,113 @@
  */
 
 // C / C++
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <vector>
+#include <algorithm>
 
 // External
 #include <libmrhpsb/MRH_PSBLogger.h>
-#include <libmrhls.h>
 
 // Project
 #include "./CBGetLocation.h"
+#include "../ResponseEvent.h"
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-CBGetLocation::CBGetLocation(Configuration const& c_Configuration) : b_Update(true),
-                                                                     b_LocationRecieved(false),
-                                                                     f64_Latitude(0.f),
-                                                                     f64_Longtitude(0.f),
-                                                                     f64_Elevation(0.f),
-                                                                     f64_Facing(0.f)
+CBGetLocation::CBGetLocation(Configuration const& c_Configuration,
+                             std::shared_ptr<LocationSnapshot>& p_Snapshot,
+                             std::shared_ptr<LocationSubscription>& p_Subscription,
+                             std::shared_ptr<LocationHistory>& p_History,
+                             std::shared_ptr<LocationStore>& p_Store,
+                             std::shared_ptr<LocationSources>& p_Sources,
+                             std::shared_ptr<LocationGeofence>& p_Geofence,
+                             std::shared_ptr<LocationVisits>& p_Visits,
+                             std::shared_ptr<CallbackLane>& p_Lane) : b_Update(true),
+                                                                             i_ShutdownFD(-1),
+                                                                             i_TimerFD(-1),
+                                                                             i_EpollFD(-1),
+                                                                             c_LastFix(c_Configuration.GetLocationLastFixFilePath()),
+                                                                             c_Filter(c_Configuration.GetLocationFilterAccuracy(),
+                                                                                      c_Configuration.GetLocationFilterAcceleration(),
+                                                                                      c_Configuration.GetLocationFilterMaxSpeed()),
+                                                                             p_Snapshot(p_Snapshot),
+                                                                             p_Subscription(p_Subscription),
+                                                                             p_History(p_History),
+                                                                             p_Store(p_Store),
+                                                                             p_Sources(p_Sources),
+                                                                             p_Geofence(p_Geofence),
+                                                                             p_Visits(p_Visits),
+                                                                             p_Lane(p_Lane)
 {
+    // Answer with the last known fix until the server sends a new one
+    LocationSnapshot::Fix c_Fix;
+    
+    if (c_LastFix.Load(c_Fix) == true)
+    {
+        p_Snapshot->Store(c_Fix);
+        
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Restored last location, " +
+                                                            std::to_string(LocationSnapshot::GetAgeMS(c_Fix) / 1000) +
+                                                            " seconds old.",
+                                       "CBGetLocation.cpp", __LINE__);
+    }
+    
+    // Create wait descriptors, the stream thread sleeps on these
+    if ((i_ShutdownFD = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0 ||
+        (i_TimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)) < 0 ||
+        (i_EpollFD = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        int i_Error = errno;
+        CloseDescriptors();
+        
+        throw Exception("Failed to create location wait descriptors: " +
+                        std::string(std::strerror(i_Error)) +
+                        " (" +
+                        std::to_string(i_Error) +
+                        ")!");
+    }
+    
+    struct epoll_event c_Event;
+    std::memset(&c_Event, 0, sizeof(c_Event));
+    c_Event.events = EPOLLIN;
+    
+    c_Event.data.fd = i_ShutdownFD;
+    int i_Result = epoll_ctl(i_EpollFD, EPOLL_CTL_ADD, i_ShutdownFD, &c_Event);
+    
+    if (i_Result == 0)
+    {
+        c_Event.data.fd = i_TimerFD;
+        i_Result = epoll_ctl(i_EpollFD, EPOLL_CTL_ADD, i_TimerFD, &c_Event);
+    }
+    
+    if (i_Result < 0)
+    {
+        int i_Error = errno;
+        CloseDescriptors();
+        
+        throw Exception("Failed to add location wait descriptors: " +
+                        std::string(std::strerror(i_Error)) +
+                        " (" +
+                        std::to_string(i_Error) +
+                        ")!");
+    }
+    
     try
     {
-        c_Thread = std::thread(UpdateStream, 
-                               this, 
-                               c_Configuration.GetServerSocketPath());
+        c_Thread = std::thread(UpdateStream, this);
     }
     catch (std::exception& e)
     {
+        CloseDescriptors();
         throw Exception(e.what());
     }
 }
@@ -50,90 +129,134 @@ CBGetLocation::CBGetLocation(Configuration const& c_Configuration) : b_Update(tr
 CBGetLocation::~CBGetLocation() noexcept
 {
     b_Update = false;
+    
+    // Wake a waiting stream thread
+    MRH_Uint64 u64_Wake = 1;
+    
+    if (write(i_ShutdownFD, &u64_Wake, sizeof(u64_Wake)) < 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to wake location stream thread: " +
+                                                             std::string(std::strerror(errno)) +
+                                                             " (" +
+                                                             std::to_string(errno) +
+                                                             ")!",
+                                       "CBGetLocation.cpp", __LINE__);
+    }
+    
     c_Thread.join();
+    CloseDescriptors();
 }
 
 //*************************************************************************************
-// Callback
+// Descriptors
 //*************************************************************************************
 
-void CBGetLocation::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+void CBGetLocation::CloseDescriptors() noexcept
 {
-    // Grab location data and availability
-    MRH_EvD_U_GetLocation_S c_Data;
-    
-    c_Mutex.lock();
-    
-    if (b_LocationRecieved == true)
+    if (i_EpollFD >= 0)
     {
-        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+        close(i_EpollFD);
+        i_EpollFD = -1;
     }
-    else
+    
+    if (i_TimerFD >= 0)
     {
-        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+        close(i_TimerFD);
+        i_TimerFD = -1;
     }
     
-    c_Data.f64_Latitude = f64_Latitude;
-    c_Data.f64_Longtitude = f64_Longtitude;
-    c_Data.f64_Elevation = f64_Elevation;
-    c_Data.f64_Facing = f64_Facing;
-    
-    c_Mutex.unlock();
-    
-    // Got location data, now create event
-    MRH_Event* p_Result = MRH_EVD_CreateSetEvent(MRH_EVENT_USER_GET_LOCATION_S, &c_Data);
-    
-    if (p_Result == NULL)
+    if (i_ShutdownFD >= 0)
     {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to create response event!",
-                                       "CBGetLocation.cpp", __LINE__);
-        return;
+        close(i_ShutdownFD);
+        i_ShutdownFD = -1;
     }
+}
+
+//*************************************************************************************
+// Callback
+//*************************************************************************************
+
+void CBGetLocation::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    // Grab location data and availability, moved to now if moving
+    MRH_Uint64 u64_StartNS = CallbackLane::GetTimeNS();
+    MRH_EvD_U_GetLocation_S c_Data;
+    LocationSnapshot::Fix c_Fix = LocationFilter::Extrapolate(p_Snapshot->Load(), 
+                                                              LocationSnapshot::GetTimeMS());
     
-    p_Result->u32_GroupID = u32_GroupID;
-    
-    // Add created event
-    try
+    if (c_Fix.b_Recieved == true)
     {
-        MRH_EventStorage::Singleton().Add(p_Result);
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
     }
-    catch (MRH_PSBException& e)
+    else
     {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
-                                       "CBGetLocation.cpp", __LINE__);
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
     }
+    
+    c_Data.f64_Latitude = c_Fix.f64_Latitude;
+    c_Data.f64_Longtitude = c_Fix.f64_Longtitude;
+    c_Data.f64_Elevation = c_Fix.f64_Elevation;
+    c_Data.f64_Facing = c_Fix.f64_Facing;
+    
+    // Got location data, now send event
+    ResponseEvent::Send(MRH_EVENT_USER_GET_LOCATION_S, c_Data, u32_GroupID);
+    p_Lane->AddLatency(CallbackLane::FAST, u64_StartNS);
 }
 
 //*************************************************************************************
 // Stream
 //*************************************************************************************
 
-void CBGetLocation::UpdateStream(CBGetLocation* p_Instance, std::string s_FilePath) noexcept
+void CBGetLocation::UpdateStream(CBGetLocation* p_Instance) noexcept
 {
     MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
-    int i_Result;
+    LocationSources& c_Sources = *(p_Instance->p_Sources);
+    size_t us_Count = c_Sources.GetCount();
+    size_t us_Open = 0;
     
-    // Build stream first
-    c_Logger.Log(MRH_PSBLogger::INFO, "Opening local stream: " + s_FilePath,
-                 "CBGetLocation.cpp", __LINE__);
+    // Build streams first, all served by this thread
+    std::vector<Stream> v_Stream;
     
-    MRH_LocalStream* p_Stream = MRH_LS_Open(s_FilePath.c_str(), 0);
+    try
+    {
+        v_Stream.resize(us_Count, { NULL, MRH_USER_LOCATION_RECONNECT_MIN_MS, 0 });
+    }
+    catch (std::exception& e)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, e.what(),
+                     "CBGetLocation.cpp", __LINE__);
+        return;
+    }
     
-    if (p_Stream == NULL)
+    for (size_t i = 0; i < us_Count; ++i)
     {
-        c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
+        c_Logger.Log(MRH_PSBLogger::INFO, "Opening local stream: " + c_Sources.GetSocketPath(i),
                      "CBGetLocation.cpp", __LINE__);
+        
+        if ((v_Stream[i].p_Stream = MRH_LS_Open(c_Sources.GetSocketPath(i).c_str(), 0)) == NULL)
+        {
+            c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
+                         "CBGetLocation.cpp", __LINE__);
+        }
+        else
+        {
+            ++us_Open;
+        }
+    }
+    
+    if (us_Open == 0)
+    {
         return;
     }
     
     // Now start reading
-    MRH_Uint8 p_Buffer[MRH_STREAM_MESSAGE_TOTAL_SIZE] = { '\0' };
-    MRH_Uint32 u32_Size;
-    
     MRH_LS_M_Location_Data c_Location;
-    MRH_LS_M_Version_Data c_Version;
-    
-    c_Version.u32_Version = MRH_STREAM_MESSAGE_VERSION;
+    MRH_Uint64 u64_TimeMS;
+    MRH_Uint64 u64_WaitMS;
+    size_t us_Connected;
+    bool b_Subscribed;
+    bool b_Recieved;
+    int i_Result;
     
     while (p_Instance->b_Update == true)
     {
@@ -141,79 +264,302 @@ void CBGetLocation::UpdateStream(CBGetLocation* p_Instance, std::string s_FilePa
          *  Connect
          */
         
-        if (MRH_LS_GetConnected(p_Stream) < 0)
+        u64_TimeMS = LocationSources::GetTimeMS();
+        u64_WaitMS = MRH_USER_LOCATION_RECONNECT_MAX_MS;
+        us_Connected = 0;
+        
+        for (size_t i = 0; i < us_Count; ++i)
         {
-            // Attempt to connect
-            if (MRH_LS_Connect(p_Stream) < 0)
-            {
-                // Wait before retry if connection error
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                continue;
-            }
+            Stream& c_Stream = v_Stream[i];
             
-            // Connected, add version info
-            if (MRH_LS_MessageToBuffer(p_Buffer, &u32_Size, MRH_LS_M_VERSION, &c_Version) < 0)
+            if (c_Stream.p_Stream == NULL)
             {
-                c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
-                             "CBGetLocation.cpp", __LINE__);
+                continue;
             }
-            else
+            else if (MRH_LS_GetConnected(c_Stream.p_Stream) < 0)
             {
-                // Continue until fully written
-                while ((i_Result = MRH_LS_Write(p_Stream, p_Buffer, u32_Size)) != 0)
+                c_Sources.SetConnected(i, false);
+                
+                // Not yet time to retry
+                if (u64_TimeMS < c_Stream.u64_ReconnectTimeMS)
+                {
+                    u64_WaitMS = std::min(u64_WaitMS, c_Stream.u64_ReconnectTimeMS - u64_TimeMS);
+                    continue;
+                }
+                
+                // Retry later if connection error, delay doubled each failure
+                if (MRH_LS_Connect(c_Stream.p_Stream) < 0)
                 {
-                    if (i_Result < 0)
+                    c_Stream.u64_ReconnectTimeMS = u64_TimeMS + c_Stream.u32_ReconnectMS;
+                    u64_WaitMS = std::min(u64_WaitMS, static_cast<MRH_Uint64>(c_Stream.u32_ReconnectMS));
+                    
+                    if (c_Stream.u32_ReconnectMS < MRH_USER_LOCATION_RECONNECT_MAX_MS / 2)
                     {
-                        c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
-                                     "CBGetLocation.cpp", __LINE__);
-                        break;
+                        c_Stream.u32_ReconnectMS *= 2;
                     }
+                    else
+                    {
+                        c_Stream.u32_ReconnectMS = MRH_USER_LOCATION_RECONNECT_MAX_MS;
+                    }
+                    
+                    continue;
                 }
+                
+                c_Stream.u32_ReconnectMS = MRH_USER_LOCATION_RECONNECT_MIN_MS;
+                c_Sources.SetConnected(i, true);
+                
+                SendVersion(c_Stream.p_Stream);
             }
+            
+            ++us_Connected;
         }
         
         /**
          *  Read
          */
         
-        // Read data until a full message was read
-        if ((i_Result = MRH_LS_Read(p_Stream, 100, p_Buffer, &u32_Size)) != 0)
+        // A single source may block on its read, multiple sources are 
+        // polled without waiting since their descriptors are not exposed
+        // @NOTE: Without subscribers nobody waits for a fix, all sources 
+        //        are then read without waiting and polled rarely
+        b_Subscribed = p_Instance->p_Subscription->GetSubscribed() || p_Instance->p_Geofence->GetSubscribed();
+        b_Recieved = false;
+        
+        for (size_t i = 0; i < us_Count; ++i)
         {
-            if (i_Result < 0)
+            Stream& c_Stream = v_Stream[i];
+            
+            if (c_Stream.p_Stream == NULL || MRH_LS_GetConnected(c_Stream.p_Stream) < 0)
             {
-                c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
-                             "CBGetLocation.cpp", __LINE__);
-                MRH_LS_Disconnect(p_Stream);
+                continue;
             }
             
-            // > 0 handled, not finished
+            i_Result = ReadStream(c_Stream.p_Stream, 
+                                  us_Connected == 1 && b_Subscribed == true ? MRH_USER_LOCATION_READ_TIMEOUT_MS : 0, 
+                                  c_Location);
+            
+            if (i_Result < 0)
+            {
+                MRH_LS_Disconnect(c_Stream.p_Stream);
+                
+                c_Sources.AddError(i);
+                c_Sources.SetConnected(i, false);
+            }
+            else if (i_Result > 0)
+            {
+                b_Recieved = true;
+                
+                // Ignored while a preferred source is fresh
+                if (c_Sources.AddFix(i) == true)
+                {
+                    Publish(p_Instance, c_Location);
+                }
+            }
+        }
+        
+        if (b_Recieved == true)
+        {
+            continue;
+        }
+        
+        // Send merged updates which became due
+        p_Instance->p_Subscription->Flush();
+        
+        /**
+         *  Wait
+         */
+        
+        if (b_Subscribed == false)
+        {
+            u64_WaitMS = std::min(u64_WaitMS, static_cast<MRH_Uint64>(MRH_USER_LOCATION_IDLE_POLL_MS));
+        }
+        else if (us_Connected > 1)
+        {
+            u64_WaitMS = std::min(u64_WaitMS, static_cast<MRH_Uint64>(MRH_USER_LOCATION_POLL_MS));
+        }
+        else if (us_Connected == 1)
+        {
+            // Already waited on the read
             continue;
         }
         
+        if (Wait(p_Instance, static_cast<MRH_Uint32>(u64_WaitMS)) == false)
+        {
+            break;
+        }
+    }
+    
+    // Termination, close streams
+    for (auto& It : v_Stream)
+    {
+        if (It.p_Stream != NULL)
+        {
+            MRH_LS_Close(It.p_Stream);
+        }
+    }
+}
+
+void CBGetLocation::SendVersion(MRH_LocalStream* p_Stream) noexcept
+{
+    MRH_Uint8 p_Buffer[MRH_STREAM_MESSAGE_TOTAL_SIZE] = { '\0' };
+    MRH_Uint32 u32_Size;
+    MRH_LS_M_Version_Data c_Version;
+    int i_Result;
+    
+    c_Version.u32_Version = MRH_STREAM_MESSAGE_VERSION;
+    
+    if (MRH_LS_MessageToBuffer(p_Buffer, &u32_Size, MRH_LS_M_VERSION, &c_Version) < 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
+                                       "CBGetLocation.cpp", __LINE__);
+        return;
+    }
+    
+    // Continue until fully written
+    while ((i_Result = MRH_LS_Write(p_Stream, p_Buffer, u32_Size)) != 0)
+    {
+        if (i_Result < 0)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
+                                           "CBGetLocation.cpp", __LINE__);
+            return;
+        }
+    }
+}
+
+int CBGetLocation::ReadStream(MRH_LocalStream* p_Stream, MRH_Uint32 u32_TimeoutMS, MRH_LS_M_Location_Data& c_Newest) noexcept
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    MRH_Uint8 p_Buffer[MRH_STREAM_MESSAGE_TOTAL_SIZE] = { '\0' };
+    MRH_Uint32 u32_Size;
+    MRH_LS_M_Location_Data c_Location;
+    bool b_Recieved = false;
+    int i_Result;
+    
+    // Wait for the first message, then drain all queued messages 
+    // without waiting and keep only the newest location
+    while ((i_Result = MRH_LS_Read(p_Stream, u32_TimeoutMS, p_Buffer, &u32_Size)) == 0)
+    {
+        u32_TimeoutMS = 0;
+        
         // Check message and get message data
         if (MRH_LS_GetBufferMessage(p_Buffer) != MRH_LS_M_LOCATION)
         {
             c_Logger.Log(MRH_PSBLogger::ERROR, "Recieved invalid local stream message!",
                          "CBGetLocation.cpp", __LINE__);
-            continue;
         }
         else if (MRH_LS_BufferToMessage(&c_Location, p_Buffer, u32_Size) < 0)
         {
             c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
                          "CBGetLocation.cpp", __LINE__);
-            continue;
         }
-        
-        // Got data, update location
-        std::lock_guard<std::mutex> c_Guard(p_Instance->c_Mutex);
-        
-        p_Instance->b_LocationRecieved = true;
-        p_Instance->f64_Latitude = c_Location.f64_Latitude;
-        p_Instance->f64_Longtitude = c_Location.f64_Longtitude;
-        p_Instance->f64_Elevation = c_Location.f64_Elevation;
-        p_Instance->f64_Facing = c_Location.f64_Facing;
+        else
+        {
+            c_Newest = c_Location;
+            b_Recieved = true;
+        }
+    }
+    
+    // > 0 handled, not finished
+    if (i_Result < 0)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, MRH_ERR_GetLocalStreamErrorString(),
+                     "CBGetLocation.cpp", __LINE__);
+        return -1;
+    }
+    
+    return b_Recieved == true ? 1 : 0;
+}
+
+void CBGetLocation::Publish(CBGetLocation* p_Instance, MRH_LS_M_Location_Data const& c_Location) noexcept
+{
+    LocationSnapshot::Fix c_Fix;
+    
+    c_Fix.b_Recieved = true;
+    c_Fix.f64_Latitude = c_Location.f64_Latitude;
+    c_Fix.f64_Longtitude = c_Location.f64_Longtitude;
+    c_Fix.f64_Elevation = c_Location.f64_Elevation;
+    c_Fix.f64_Facing = c_Location.f64_Facing;
+    c_Fix.f64_Speed = 0.f;
+    c_Fix.f64_Course = 0.f;
+    c_Fix.u64_TimeMS = LocationSnapshot::GetTimeMS();
+    
+    // Smooth and derive motion once here instead of in every package
+    if (p_Instance->c_Filter.Process(c_Fix) == false)
+    {
+        return;
+    }
+    
+    p_Instance->p_Snapshot->Store(c_Fix);
+    p_Instance->p_History->Add(c_Fix);
+    p_Instance->p_Subscription->Publish(c_Fix);
+    p_Instance->p_Geofence->Update(c_Fix);
+    p_Instance->p_Visits->Update(c_Fix);
+    
+    // Persist after publishing, readers never wait for this
+    p_Instance->c_LastFix.Store(c_Fix);
+    p_Instance->p_Store->Add(c_Fix);
+}
+
+bool CBGetLocation::Wait(CBGetLocation* p_Instance, MRH_Uint32 u32_DelayMS) noexcept
+{
+    // A zero timer would never expire
+    if (u32_DelayMS == 0)
+    {
+        return p_Instance->b_Update;
+    }
+    
+    struct itimerspec c_Timer;
+    std::memset(&c_Timer, 0, sizeof(c_Timer));
+    c_Timer.it_value.tv_sec = u32_DelayMS / 1000;
+    c_Timer.it_value.tv_nsec = (u32_DelayMS % 1000) * 1000000;
+    
+    if (timerfd_settime(p_Instance->i_TimerFD, 0, &c_Timer, NULL) < 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to set location wait timer: " +
+                                                             std::string(std::strerror(errno)) +
+                                                             " (" +
+                                                             std::to_string(errno) +
+                                                             ")!",
+                                       "CBGetLocation.cpp", __LINE__);
+        std::this_thread::sleep_for(std::chrono::milliseconds(u32_DelayMS));
+        return p_Instance->b_Update;
+    }
+    
+    // Sleep until the timer expires or shutdown is signaled
+    struct epoll_event c_Event;
+    MRH_Uint64 u64_Expired;
+    int i_Result;
+    
+    while ((i_Result = epoll_wait(p_Instance->i_EpollFD, &c_Event, 1, -1)) < 0 && errno == EINTR)
+    {}
+    
+    if (i_Result < 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to wait for location sources: " +
+                                                             std::string(std::strerror(errno)) +
+                                                             " (" +
+                                                             std::to_string(errno) +
+                                                             ")!",
+                                       "CBGetLocation.cpp", __LINE__);
+        std::this_thread::sleep_for(std::chrono::milliseconds(u32_DelayMS));
+        return p_Instance->b_Update;
+    }
+    else if (c_Event.data.fd == p_Instance->i_ShutdownFD)
+    {
+        return false;
+    }
+    
+    // Consume the expiration, the timer is one-shot
+    if (read(p_Instance->i_TimerFD, &u64_Expired, sizeof(u64_Expired)) < 0 && errno != EAGAIN)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to read location wait timer: " +
+                                                             std::string(std::strerror(errno)) +
+                                                             " (" +
+                                                             std::to_string(errno) +
+                                                             ")!",
+                                       "CBGetLocation.cpp", __LINE__);
     }
     
-    // Termination, close stream
-    MRH_LS_Close(p_Stream);
+    return p_Instance->b_Update;
 }
@@ -19,14 +19,42 @@
 
 // C / C++
 #include <thread>
-#include <mutex>
 #include <atomic>
+#include <memory>
 
 // External
 #include <libmrhpsb/MRH_Callback.h>
+#include <libmrhls.h>
 
 // Project
+#include "../../Location/LocationSnapshot.h"
+#include "../../Location/LocationSubscription.h"
+#include "../../Location/LocationHistory.h"
+#include "../../Location/LocationStore.h"
+#include "../../Location/LocationLastFix.h"
+#include "../../Location/LocationSources.h"
+#include "../../Location/LocationFilter.h"
+#include "../../Location/LocationGeofence.h"
+#include "../../Location/LocationVisits.h"
 #include "../../Configuration.h"
+#include "../CallbackLane.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_READ_TIMEOUT_MS
+    #define MRH_USER_LOCATION_READ_TIMEOUT_MS 100
+#endif
+#ifndef MRH_USER_LOCATION_POLL_MS
+    #define MRH_USER_LOCATION_POLL_MS 20
+#endif
+#ifndef MRH_USER_LOCATION_IDLE_POLL_MS
+    #define MRH_USER_LOCATION_IDLE_POLL_MS 1000
+#endif
+#ifndef MRH_USER_LOCATION_RECONNECT_MIN_MS
+    #define MRH_USER_LOCATION_RECONNECT_MIN_MS 250
+#endif
+#ifndef MRH_USER_LOCATION_RECONNECT_MAX_MS
+    #define MRH_USER_LOCATION_RECONNECT_MAX_MS 16000
+#endif
 
 
 class CBGetLocation : public MRH_Callback
@@ -41,9 +69,25 @@ public:
      *  Default constructor.
      *
      *  \param c_Configuration The configuration to construct with.
+     *  \param p_Snapshot The location snapshot to publish fixes to.
+     *  \param p_Subscription The location subscriptions to update.
+     *  \param p_History The location history to add fixes to.
+     *  \param p_Store The location store to append fixes to.
+     *  \param p_Sources The location sources to read from.
+     *  \param p_Geofence The geofences to test fixes against.
+     *  \param p_Visits The location visits to add fixes to.
+     *  \param p_Lane The callback lanes to add latency to.
      */
     
-    CBGetLocation(Configuration const& c_Configuration);
+    CBGetLocation(Configuration const& c_Configuration,
+                  std::shared_ptr<LocationSnapshot>& p_Snapshot,
+                  std::shared_ptr<LocationSubscription>& p_Subscription,
+                  std::shared_ptr<LocationHistory>& p_History,
+                  std::shared_ptr<LocationStore>& p_Store,
+                  std::shared_ptr<LocationSources>& p_Sources,
+                  std::shared_ptr<LocationGeofence>& p_Geofence,
+                  std::shared_ptr<LocationVisits>& p_Visits,
+                  std::shared_ptr<CallbackLane>& p_Lane);
     
     /**
      *  Default destructor.
@@ -66,32 +110,103 @@ public:
     
 private:
     
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Stream_t
+    {
+        MRH_LocalStream* p_Stream;
+        
+        MRH_Uint32 u32_ReconnectMS; // Doubled each failed attempt
+        MRH_Uint64 u64_ReconnectTimeMS; // Next attempt, source steady time
+        
+    }Stream;
+    
     //*************************************************************************************
     // Stream
     //*************************************************************************************
     
     /**
-     *  Update the location local stream.
+     *  Update all location local streams.
      *  
      *  \param p_Instance The callback instance to update with.
-     *  \param s_FilePath The full path to the stream socket file.
      */
     
-    static void UpdateStream(CBGetLocation* p_Instance, std::string s_FilePath) noexcept;
+    static void UpdateStream(CBGetLocation* p_Instance) noexcept;
+    
+    /**
+     *  Send the stream version to a connected stream.
+     *  
+     *  \param p_Stream The stream to send to.
+     */
+    
+    static void SendVersion(MRH_LocalStream* p_Stream) noexcept;
+    
+    /**
+     *  Read all queued messages from a connected stream.
+     *  
+     *  \param p_Stream The stream to read from.
+     *  \param u32_TimeoutMS The time to wait for the first message in milliseconds.
+     *  \param c_Newest The newest recieved location.
+     *  
+     *  \return 1 if a location was recieved, 0 if none, -1 if the stream failed.
+     */
+    
+    static int ReadStream(MRH_LocalStream* p_Stream, MRH_Uint32 u32_TimeoutMS, MRH_LS_M_Location_Data& c_Newest) noexcept;
+    
+    /**
+     *  Filter and publish a selected location fix.
+     *  
+     *  \param p_Instance The callback instance to publish with.
+     *  \param c_Location The location to publish.
+     */
+    
+    static void Publish(CBGetLocation* p_Instance, MRH_LS_M_Location_Data const& c_Location) noexcept;
+    
+    /**
+     *  Wait for a timeout or shutdown.
+     *  
+     *  \param p_Instance The callback instance to wait with.
+     *  \param u32_DelayMS The time to wait in milliseconds.
+     *  
+     *  \return true if the wait finished, false if the callback is shutting down.
+     */
+    
+    static bool Wait(CBGetLocation* p_Instance, MRH_Uint32 u32_DelayMS) noexcept;
+    
+    //*************************************************************************************
+    // Descriptors
+    //*************************************************************************************
+    
+    /**
+     *  Close all wait descriptors.
+     */
+    
+    void CloseDescriptors() noexcept;
     
     //*************************************************************************************
     // Data
     //*************************************************************************************
     
     std::thread c_Thread;
-    std::mutex c_Mutex;
     std::atomic<bool> b_Update;
     
-    bool b_LocationRecieved;
-    MRH_Sfloat64 f64_Latitude;
-    MRH_Sfloat64 f64_Longtitude;
-    MRH_Sfloat64 f64_Elevation;
-    MRH_Sfloat64 f64_Facing;
+    int i_ShutdownFD; // eventfd
+    int i_TimerFD;
+    int i_EpollFD;
+    
+    LocationLastFix c_LastFix;
+    LocationFilter c_Filter;
+    
+    std::shared_ptr<LocationSnapshot> p_Snapshot;
+    std::shared_ptr<LocationSubscription> p_Subscription;
+    std::shared_ptr<LocationHistory> p_History;
+    std::shared_ptr<LocationStore> p_Store;
+    std::shared_ptr<LocationSources> p_Sources;
+    std::shared_ptr<LocationGeofence> p_Geofence;
+    std::shared_ptr<LocationVisits> p_Visits;
+    std::shared_ptr<CallbackLane> p_Lane;
     
 protected:
 
@@ -0,0 +1,62 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./ResponseEvent.h"
+
+
+//*************************************************************************************
+// Send
+//*************************************************************************************
+
+void ResponseEvent::Send(MRH_Uint32 u32_Type, const void* p_Data, MRH_Uint32 u32_DataSize, MRH_Uint32 u32_GroupID) noexcept
+{
+    Add(MRH_EVD_CreateEvent(u32_Type, p_Data, u32_DataSize), u32_GroupID);
+}
+
+//*************************************************************************************
+// Add
+//*************************************************************************************
+
+void ResponseEvent::Add(MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    if (p_Event == NULL)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to create response event!",
+                                       "ResponseEvent.cpp", __LINE__);
+        return;
+    }
+    
+    p_Event->u32_GroupID = u32_GroupID;
+    
+    // The event storage owns the event from here on and destroys it once sent,
+    // so events can not be pooled by the service
+    try
+    {
+        MRH_EventStorage::Singleton().Add(p_Event);
+    }
+    catch (MRH_PSBException& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "ResponseEvent.cpp", __LINE__);
+        MRH_EVD_DestroyEvent(p_Event);
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef ResponseEvent_h
+#define ResponseEvent_h
+
+// C / C++
+#include <type_traits>
+
+// External
+#include <libmrhpsb/MRH_Callback.h>
+
+// Project
+
+
+class ResponseEvent
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. Disabled for this class.
+     */
+    
+    ResponseEvent() = delete;
+    
+    //*************************************************************************************
+    // Send
+    //*************************************************************************************
+    
+    /**
+     *  Send a response event with predefined event data.
+     *
+     *  \param u32_Type The event type to send.
+     *  \param c_Data The event data matching the event type.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    template<typename T>
+    static void Send(MRH_Uint32 u32_Type, T const& c_Data, MRH_Uint32 u32_GroupID) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Event data has to be trivially copyable!");
+        
+        Add(MRH_EVD_CreateSetEvent(u32_Type, &c_Data), u32_GroupID);
+    }
+    
+    /**
+     *  Send a response event with raw event data.
+     *
+     *  \param u32_Type The event type to send.
+     *  \param p_Data The event data.
+     *  \param u32_DataSize The event data size in bytes.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void Send(MRH_Uint32 u32_Type, const void* p_Data, MRH_Uint32 u32_DataSize, MRH_Uint32 u32_GroupID) noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Add
+    //*************************************************************************************
+    
+    /**
+     *  Add a created event to the event storage. The event is destroyed if
+     *  it could not be added.
+     *
+     *  \param p_Event The created event, NULL if creation failed.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void Add(MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+protected:
+    
+};
+
+#endif /* ResponseEvent_h */
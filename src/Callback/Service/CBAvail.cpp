@@ -21,6 +21,7 @@
 
 // Project
 #include "./CBAvail.h"
+#include "../ResponseEvent.h"
 
 
 //*************************************************************************************
@@ -52,25 +53,5 @@ void CBAvail::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcep
         c_Data.u8_Available = MRH_EVD_BASE_RESULT_FAILED;
     }
     
-    MRH_Event* p_Result = MRH_EVD_CreateSetEvent(MRH_EVENT_USER_AVAIL_S, &c_Data);
-    
-    if (p_Result == NULL)
-    {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to create response event!",
-                                       "CBAvail.cpp", __LINE__);
-        return;
-    }
-    
-    p_Result->u32_GroupID = u32_GroupID;
-    
-    try
-    {
-        MRH_EventStorage::Singleton().Add(p_Result);
-    }
-    catch (MRH_PSBException& e)
-    {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
-                                       "CBAvail.cpp", __LINE__);
-        MRH_EVD_DestroyEvent(p_Result);
-    }
+    ResponseEvent::Send(MRH_EVENT_USER_AVAIL_S, c_Data, u32_GroupID);
 }
@@ -14,20 +14,43 @@
  *  limitations under the License.
  */
 
+
 // C / C++
+#include <cstring>
+#include <algorithm>
 
 // External
 #include <libmrhpsb/MRH_PSBLogger.h>
 
 // Project
 #include "./CBCustomCommand.h"
+#include "./CustomCommand.h"
+#include "../ResponseEvent.h"
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-CBCustomCommand::CBCustomCommand() noexcept
+CBCustomCommand::CBCustomCommand(std::shared_ptr<Content>& p_Content,
+                                 std::shared_ptr<LocationSnapshot>& p_Snapshot,
+                                 std::shared_ptr<LocationSubscription>& p_Subscription,
+                                 std::shared_ptr<LocationHistory>& p_History,
+                                 std::shared_ptr<LocationStore>& p_Store,
+                                 std::shared_ptr<LocationSources>& p_Sources,
+                                 std::shared_ptr<LocationGeofence>& p_Geofence,
+                                 std::shared_ptr<LocationGeocode>& p_Geocode,
+                                 std::shared_ptr<LocationVisits>& p_Visits,
+                                 std::shared_ptr<CallbackLane>& p_Lane) noexcept : p_Content(p_Content),
+                                                                                    p_Snapshot(p_Snapshot),
+                                                                                    p_Subscription(p_Subscription),
+                                                                                    p_History(p_History),
+                                                                                    p_Store(p_Store),
+                                                                                    p_Sources(p_Sources),
+                                                                                    p_Geofence(p_Geofence),
+                                                                                    p_Geocode(p_Geocode),
+                                                                                    p_Visits(p_Visits),
+                                                                                    p_Lane(p_Lane)
 {}
 
 CBCustomCommand::~CBCustomCommand() noexcept
@@ -39,28 +62,572 @@ CBCustomCommand::~CBCustomCommand() noexcept
 
 void CBCustomCommand::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
 {
-    MRH_EvD_Sys_NotImplemented_S c_Data;
-    c_Data.u32_Type = p_Event->u32_Type;
+    MRH_Uint64 u64_StartNS = CallbackLane::GetTimeNS();
+    CustomCommand::Header c_Header;
+    
+    if (p_Event->p_Data == NULL || p_Event->u32_DataSize < sizeof(c_Header))
+    {
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
     
-    MRH_Event* p_Result = MRH_EVD_CreateSetEvent(MRH_EVENT_NOT_IMPLEMENTED_S, &c_Data);
+    std::memcpy(&c_Header, p_Event->p_Data, sizeof(c_Header));
     
-    if (p_Result == NULL)
+    switch (c_Header.u32_Command)
     {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to create response event!",
+        case CustomCommand::ACCESS_CONTENT:
+            // Latency is added by the IO lane
+            AccessContent(p_Event, u32_GroupID);
+            return;
+        case CustomCommand::SUBSCRIBE_LOCATION:
+            SubscribeLocation(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::UNSUBSCRIBE_LOCATION:
+            UnsubscribeLocation(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION_HISTORY:
+            GetLocationHistory(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION_STORE:
+            GetLocationStore(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION:
+            GetLocation(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION_SOURCES:
+            GetLocationSources(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::ADD_GEOFENCE:
+            AddGeofence(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::REMOVE_GEOFENCE:
+            RemoveGeofence(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::SUBSCRIBE_GEOFENCE:
+            SubscribeGeofence(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::UNSUBSCRIBE_GEOFENCE:
+            UnsubscribeGeofence(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION_PLACE:
+            GetLocationPlace(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION_VISITS:
+            GetLocationVisits(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_LOCATION_VISIT_PLACES:
+            GetLocationVisitPlaces(p_Event, u32_GroupID);
+            break;
+        case CustomCommand::GET_CALLBACK_LATENCY:
+            GetCallbackLatency(p_Event, u32_GroupID);
+            break;
+            
+        default:
+            SendNotImplemented(p_Event, u32_GroupID);
+            break;
+    }
+    
+    p_Lane->AddLatency(CallbackLane::FAST, u64_StartNS);
+}
+
+//*************************************************************************************
+// Commands
+//*************************************************************************************
+
+void CBCustomCommand::AccessContent(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::AccessContent_U c_Request;
+    CustomCommand::AccessContent_S c_Data;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid access content command size!",
                                        "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
         return;
     }
     
-    p_Result->u32_GroupID = u32_GroupID;
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    c_Data.c_Header.u32_Command = CustomCommand::ACCESS_CONTENT;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
+    c_Data.u32_TypeMask = c_Request.u32_TypeMask;
+    c_Data.u32_FailedMask = c_Request.u32_TypeMask;
+    
+    // Access waits for a previous reset, keep the callback thread free
+    std::shared_ptr<Content> p_Access(p_Content);
+    
+    p_Lane->Submit(u32_GroupID, [p_Access, c_Data, u32_GroupID]()
+    {
+        try
+        {
+            // Response is sent once all links were created
+            p_Access->AllowAccessMask(c_Data.u32_TypeMask, [c_Data, u32_GroupID](MRH_Uint32 u32_FailedMask) mutable
+            {
+                c_Data.u32_FailedMask = u32_FailedMask;
+                c_Data.u8_Result = (u32_FailedMask == 0 ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
+            
+                SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+            });
+        
+            return;
+        }
+        catch (Exception& e)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                           "CBCustomCommand.cpp", __LINE__);
+        }
+        catch (std::exception& e)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                           "CBCustomCommand.cpp", __LINE__);
+        }
+    
+        SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+    });
+}
+
+void CBCustomCommand::SubscribeLocation(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::SubscribeLocation_U c_Request;
+    CustomCommand::SubscribeLocation_S c_Data;
     
-    try
+    if (p_Event->u32_DataSize < sizeof(c_Request))
     {
-        MRH_EventStorage::Singleton().Add(p_Result);
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid subscribe location command size!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    c_Data.c_Header.u32_Command = CustomCommand::SUBSCRIBE_LOCATION;
+    
+    if (p_Subscription->Subscribe(u32_GroupID,
+                                  c_Request.u32_IntervalMS,
+                                  c_Request.f64_Distance,
+                                  c_Request.f64_Heading) == true)
+    {
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    }
+    else
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "No location subscription available!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
     }
-    catch (MRH_PSBException& e)
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::UnsubscribeLocation(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::SubscribeLocation_S c_Data;
+    
+    c_Data.c_Header.u32_Command = CustomCommand::UNSUBSCRIBE_LOCATION;
+    c_Data.u8_Result = (p_Subscription->Unsubscribe(u32_GroupID) == true ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::GetLocationHistory(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::GetLocationHistory_U c_Request;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
     {
-        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid get location history command size!",
                                        "CBCustomCommand.cpp", __LINE__);
-        MRH_EVD_DestroyEvent(p_Result);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
     }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    LocationSnapshot::Fix p_Fix[MRH_USER_LOCATION_HISTORY_RESPONSE_MAX];
+    MRH_Uint32 u32_Count = p_History->Get(c_Request.u64_StartMS,
+                                          c_Request.u64_EndMS,
+                                          p_Fix,
+                                          std::min(c_Request.u32_Count, static_cast<MRH_Uint32>(MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)));
+    
+    SendLocationFixes(CustomCommand::GET_LOCATION_HISTORY, p_Fix, u32_Count, u32_GroupID);
+}
+
+void CBCustomCommand::GetLocationStore(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::GetLocationHistory_U c_Request;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid get location store command size!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    LocationSnapshot::Fix p_Fix[MRH_USER_LOCATION_HISTORY_RESPONSE_MAX];
+    MRH_Uint32 u32_Count = p_Store->Get(c_Request.u64_StartMS,
+                                        c_Request.u64_EndMS,
+                                        p_Fix,
+                                        std::min(c_Request.u32_Count, static_cast<MRH_Uint32>(MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)));
+    
+    SendLocationFixes(CustomCommand::GET_LOCATION_STORE, p_Fix, u32_Count, u32_GroupID);
+}
+
+void CBCustomCommand::GetLocation(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::GetLocation_S c_Data;
+    LocationSnapshot::Fix c_Fix = p_Snapshot->Load();
+    
+    c_Data.c_Header.u32_Command = CustomCommand::GET_LOCATION;
+    c_Data.u8_Result = (c_Fix.b_Recieved == true ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
+    c_Data.u8_Stale = (LocationSnapshot::GetStale(c_Fix) == true ? 1 : 0);
+    c_Data.u64_TimeMS = c_Fix.u64_TimeMS;
+    c_Data.u64_AgeMS = LocationSnapshot::GetAgeMS(c_Fix);
+    c_Data.f64_Latitude = c_Fix.f64_Latitude;
+    c_Data.f64_Longtitude = c_Fix.f64_Longtitude;
+    c_Data.f64_Elevation = c_Fix.f64_Elevation;
+    c_Data.f64_Facing = c_Fix.f64_Facing;
+    c_Data.f64_Speed = c_Fix.f64_Speed;
+    c_Data.f64_Course = c_Fix.f64_Course;
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::GetLocationSources(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    // Sources are appended after the response header
+    CustomCommand::GetLocationSources_S c_Data;
+    MRH_Uint8 p_Buffer[sizeof(c_Data) + (sizeof(CustomCommand::LocationSourceStats) * MRH_USER_LOCATION_SOURCE_MAX)];
+    MRH_Uint8* p_Entry = p_Buffer + sizeof(c_Data);
+    
+    c_Data.c_Header.u32_Command = CustomCommand::GET_LOCATION_SOURCES;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    c_Data.u32_Count = static_cast<MRH_Uint32>(p_Sources->GetCount());
+    
+    for (MRH_Uint32 i = 0; i < c_Data.u32_Count; ++i)
+    {
+        LocationSources::Stats c_Stats = p_Sources->GetStats(i);
+        CustomCommand::LocationSourceStats c_Entry;
+        
+        c_Entry.u32_Priority = c_Stats.u32_Priority;
+        c_Entry.u8_Connected = (c_Stats.b_Connected == true ? 1 : 0);
+        c_Entry.u8_Active = (c_Stats.b_Active == true ? 1 : 0);
+        c_Entry.u8_Fresh = (c_Stats.b_Fresh == true ? 1 : 0);
+        c_Entry.u32_IntervalMS = c_Stats.u32_IntervalMS;
+        c_Entry.u64_AgeMS = c_Stats.u64_AgeMS;
+        c_Entry.u64_Fixes = c_Stats.u64_Fixes;
+        c_Entry.u64_Selected = c_Stats.u64_Selected;
+        c_Entry.u64_Connects = c_Stats.u64_Connects;
+        c_Entry.u64_Errors = c_Stats.u64_Errors;
+        
+        std::memcpy(p_Entry, &c_Entry, sizeof(c_Entry));
+        p_Entry += sizeof(c_Entry);
+    }
+    
+    std::memcpy(p_Buffer, &c_Data, sizeof(c_Data));
+    SendResponse(p_Buffer, static_cast<MRH_Uint32>(p_Entry - p_Buffer), u32_GroupID);
+}
+
+void CBCustomCommand::AddGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::AddGeofence_U c_Request;
+    CustomCommand::Geofence_S c_Data;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid add geofence command size!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    if (c_Request.u32_Count > MRH_USER_LOCATION_GEOFENCE_POINT_MAX ||
+        p_Event->u32_DataSize < sizeof(c_Request) + (c_Request.u32_Count * sizeof(CustomCommand::GeofencePoint)))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid add geofence point count!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    // Points follow the request header
+    MRH_Sfloat64 p_Latitude[MRH_USER_LOCATION_GEOFENCE_POINT_MAX];
+    MRH_Sfloat64 p_Longtitude[MRH_USER_LOCATION_GEOFENCE_POINT_MAX];
+    const MRH_Uint8* p_Entry = static_cast<const MRH_Uint8*>(p_Event->p_Data) + sizeof(c_Request);
+    
+    for (MRH_Uint32 i = 0; i < c_Request.u32_Count; ++i)
+    {
+        CustomCommand::GeofencePoint c_Point;
+        std::memcpy(&c_Point, p_Entry, sizeof(c_Point));
+        p_Entry += sizeof(c_Point);
+        
+        p_Latitude[i] = c_Point.f64_Latitude;
+        p_Longtitude[i] = c_Point.f64_Longtitude;
+    }
+    
+    c_Data.c_Header.u32_Command = CustomCommand::ADD_GEOFENCE;
+    c_Data.u32_RegionID = p_Geofence->Add(u32_GroupID,
+                                          c_Request.f64_Radius,
+                                          p_Latitude,
+                                          p_Longtitude,
+                                          c_Request.u32_Count);
+    
+    if (c_Data.u32_RegionID != 0)
+    {
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    }
+    else
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to add geofence region!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
+    }
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::RemoveGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::RemoveGeofence_U c_Request;
+    CustomCommand::Geofence_S c_Data;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid remove geofence command size!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    c_Data.c_Header.u32_Command = CustomCommand::REMOVE_GEOFENCE;
+    c_Data.u8_Result = (p_Geofence->Remove(u32_GroupID, c_Request.u32_RegionID) == true ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
+    c_Data.u32_RegionID = c_Request.u32_RegionID;
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::SubscribeGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::Geofence_S c_Data;
+    
+    c_Data.c_Header.u32_Command = CustomCommand::SUBSCRIBE_GEOFENCE;
+    c_Data.u32_RegionID = 0;
+    
+    if (p_Geofence->Subscribe(u32_GroupID) == true)
+    {
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    }
+    else
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "No geofence subscription available!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
+    }
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::UnsubscribeGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::Geofence_S c_Data;
+    
+    c_Data.c_Header.u32_Command = CustomCommand::UNSUBSCRIBE_GEOFENCE;
+    c_Data.u8_Result = (p_Geofence->Unsubscribe(u32_GroupID) == true ? MRH_EVD_BASE_RESULT_SUCCESS : MRH_EVD_BASE_RESULT_FAILED);
+    c_Data.u32_RegionID = 0;
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+void CBCustomCommand::GetLocationPlace(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    // Name is appended after the response header
+    CustomCommand::GetLocationPlace_S c_Data;
+    MRH_Uint8 p_Buffer[sizeof(c_Data) + 0xFF];
+    LocationSnapshot::Fix c_Fix = p_Snapshot->Load();
+    LocationGeocode::Place c_Place;
+    
+    std::memset(&c_Data, 0, sizeof(c_Data));
+    c_Data.c_Header.u32_Command = CustomCommand::GET_LOCATION_PLACE;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_FAILED;
+    c_Data.u8_Stale = (LocationSnapshot::GetStale(c_Fix) == true ? 1 : 0);
+    c_Data.u64_TimeMS = c_Fix.u64_TimeMS;
+    
+    if (p_Geocode->Lookup(c_Fix, c_Place) == true)
+    {
+        c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+        c_Data.f64_Latitude = c_Place.f64_Latitude;
+        c_Data.f64_Longtitude = c_Place.f64_Longtitude;
+        c_Data.f64_Distance = c_Place.f64_Distance;
+        c_Data.u32_Population = c_Place.u32_Population;
+        c_Data.p_Country[0] = c_Place.p_Country[0];
+        c_Data.p_Country[1] = c_Place.p_Country[1];
+        c_Data.u8_NameSize = c_Place.u8_NameSize;
+    
+        std::memcpy(p_Buffer + sizeof(c_Data), c_Place.p_Name, c_Place.u8_NameSize);
+    }
+    
+    std::memcpy(p_Buffer, &c_Data, sizeof(c_Data));
+    SendResponse(p_Buffer, static_cast<MRH_Uint32>(sizeof(c_Data) + c_Data.u8_NameSize), u32_GroupID);
+}
+
+void CBCustomCommand::GetLocationVisits(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::GetLocationHistory_U c_Request;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid get location visits command size!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    // Visits are appended after the response header
+    LocationVisits::Visit p_Visit[MRH_USER_LOCATION_HISTORY_RESPONSE_MAX];
+    CustomCommand::GetLocationVisits_S c_Data;
+    MRH_Uint8 p_Buffer[sizeof(c_Data) + (sizeof(CustomCommand::LocationVisit) * MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)];
+    MRH_Uint8* p_Entry = p_Buffer + sizeof(c_Data);
+    
+    c_Data.c_Header.u32_Command = CustomCommand::GET_LOCATION_VISITS;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    c_Data.u32_Count = p_Visits->GetVisits(c_Request.u64_StartMS,
+                                           c_Request.u64_EndMS,
+                                           p_Visit,
+                                           std::min(c_Request.u32_Count, static_cast<MRH_Uint32>(MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)));
+    
+    for (MRH_Uint32 i = 0; i < c_Data.u32_Count; ++i)
+    {
+        CustomCommand::LocationVisit c_Entry;
+        c_Entry.u64_ArrivalMS = p_Visit[i].u64_ArrivalMS;
+        c_Entry.u64_DepartureMS = p_Visit[i].u64_DepartureMS;
+        c_Entry.f64_Latitude = p_Visit[i].f64_Latitude;
+        c_Entry.f64_Longtitude = p_Visit[i].f64_Longtitude;
+        c_Entry.u32_PlaceID = p_Visit[i].u32_PlaceID;
+        
+        std::memcpy(p_Entry, &c_Entry, sizeof(c_Entry));
+        p_Entry += sizeof(c_Entry);
+    }
+    
+    std::memcpy(p_Buffer, &c_Data, sizeof(c_Data));
+    SendResponse(p_Buffer, static_cast<MRH_Uint32>(p_Entry - p_Buffer), u32_GroupID);
+}
+
+void CBCustomCommand::GetLocationVisitPlaces(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::GetLocationVisitPlaces_U c_Request;
+    
+    if (p_Event->u32_DataSize < sizeof(c_Request))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid get location visit places command size!",
+                                       "CBCustomCommand.cpp", __LINE__);
+        SendNotImplemented(p_Event, u32_GroupID);
+        return;
+    }
+    
+    std::memcpy(&c_Request, p_Event->p_Data, sizeof(c_Request));
+    
+    // Places are appended after the response header
+    LocationVisits::Place p_Place[MRH_USER_LOCATION_HISTORY_RESPONSE_MAX];
+    CustomCommand::GetLocationVisitPlaces_S c_Data;
+    MRH_Uint8 p_Buffer[sizeof(c_Data) + (sizeof(CustomCommand::LocationVisitPlace) * MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)];
+    MRH_Uint8* p_Entry = p_Buffer + sizeof(c_Data);
+    
+    c_Data.c_Header.u32_Command = CustomCommand::GET_LOCATION_VISIT_PLACES;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    c_Data.u32_Count = p_Visits->GetPlaces(p_Place,
+                                           std::min(c_Request.u32_Count, static_cast<MRH_Uint32>(MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)));
+    
+    for (MRH_Uint32 i = 0; i < c_Data.u32_Count; ++i)
+    {
+        CustomCommand::LocationVisitPlace c_Entry;
+        c_Entry.u32_PlaceID = p_Place[i].u32_PlaceID;
+        c_Entry.f64_Latitude = p_Place[i].f64_Latitude;
+        c_Entry.f64_Longtitude = p_Place[i].f64_Longtitude;
+        c_Entry.u32_Visits = p_Place[i].u32_Visits;
+        c_Entry.u64_DurationMS = p_Place[i].u64_DurationMS;
+        c_Entry.u64_LastMS = p_Place[i].u64_LastMS;
+        
+        std::memcpy(p_Entry, &c_Entry, sizeof(c_Entry));
+        p_Entry += sizeof(c_Entry);
+    }
+    
+    std::memcpy(p_Buffer, &c_Data, sizeof(c_Data));
+    SendResponse(p_Buffer, static_cast<MRH_Uint32>(p_Entry - p_Buffer), u32_GroupID);
+}
+
+void CBCustomCommand::GetCallbackLatency(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    static_assert(sizeof(CustomCommand::GetCallbackLatency_S::p_FastBucket) == CallbackLane::us_BucketCount * sizeof(MRH_Uint64) &&
+                  sizeof(CustomCommand::GetCallbackLatency_S::p_IOBucket) == CallbackLane::us_BucketCount * sizeof(MRH_Uint64),
+                  "Callback latency bucket count mismatch!");
+    
+    CustomCommand::GetCallbackLatency_S c_Data;
+    MRH_Uint64 p_Bucket[CallbackLane::us_BucketCount];
+    
+    c_Data.c_Header.u32_Command = CustomCommand::GET_CALLBACK_LATENCY;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    
+    // Packed response, copy instead of writing unaligned members
+    p_Lane->GetLatency(CallbackLane::FAST, p_Bucket);
+    std::memcpy(c_Data.p_FastBucket, p_Bucket, sizeof(p_Bucket));
+    
+    p_Lane->GetLatency(CallbackLane::IO, p_Bucket);
+    std::memcpy(c_Data.p_IOBucket, p_Bucket, sizeof(p_Bucket));
+    
+    SendResponse(&c_Data, sizeof(c_Data), u32_GroupID);
+}
+
+//*************************************************************************************
+// Response
+//*************************************************************************************
+
+void CBCustomCommand::SendResponse(const void* p_Data, MRH_Uint32 u32_DataSize, MRH_Uint32 u32_GroupID) noexcept
+{
+    ResponseEvent::Send(MRH_EVENT_USER_CUSTOM_COMMAND_S, p_Data, u32_DataSize, u32_GroupID);
+}
+
+void CBCustomCommand::SendNotImplemented(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept
+{
+    MRH_EvD_Sys_NotImplemented_S c_Data;
+    c_Data.u32_Type = p_Event->u32_Type;
+    
+    ResponseEvent::Send(MRH_EVENT_NOT_IMPLEMENTED_S, c_Data, u32_GroupID);
+}
+
+void CBCustomCommand::SendLocationFixes(MRH_Uint32 u32_Command, const LocationSnapshot::Fix* p_Fix, MRH_Uint32 u32_Count, MRH_Uint32 u32_GroupID) noexcept
+{
+    // Fixes are appended after the response header
+    CustomCommand::GetLocationHistory_S c_Data;
+    MRH_Uint8 p_Buffer[sizeof(c_Data) + (sizeof(CustomCommand::LocationHistoryFix) * MRH_USER_LOCATION_HISTORY_RESPONSE_MAX)];
+    MRH_Uint8* p_Entry = p_Buffer + sizeof(c_Data);
+    
+    c_Data.c_Header.u32_Command = u32_Command;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    c_Data.u32_Count = std::min(u32_Count, static_cast<MRH_Uint32>(MRH_USER_LOCATION_HISTORY_RESPONSE_MAX));
+    
+    for (MRH_Uint32 i = 0; i < c_Data.u32_Count; ++i)
+    {
+        CustomCommand::LocationHistoryFix c_Entry;
+        c_Entry.u64_TimeMS = p_Fix[i].u64_TimeMS;
+        c_Entry.f64_Latitude = p_Fix[i].f64_Latitude;
+        c_Entry.f64_Longtitude = p_Fix[i].f64_Longtitude;
+        c_Entry.f64_Elevation = p_Fix[i].f64_Elevation;
+        c_Entry.f64_Facing = p_Fix[i].f64_Facing;
+        
+        std::memcpy(p_Entry, &c_Entry, sizeof(c_Entry));
+        p_Entry += sizeof(c_Entry);
+    }
+    
+    std::memcpy(p_Buffer, &c_Data, sizeof(c_Data));
+    SendResponse(p_Buffer, static_cast<MRH_Uint32>(p_Entry - p_Buffer), u32_GroupID);
 }
@@ -18,11 +18,26 @@
 #define CBCustomCommand_h
 
 // C / C++
+#include <memory>
 
 // External
 #include <libmrhpsb/MRH_Callback.h>
 
 // Project
+#include "../../Content/Content.h"
+#include "../../Location/LocationSubscription.h"
+#include "../../Location/LocationHistory.h"
+#include "../../Location/LocationStore.h"
+#include "../../Location/LocationSources.h"
+#include "../../Location/LocationGeofence.h"
+#include "../../Location/LocationGeocode.h"
+#include "../../Location/LocationVisits.h"
+#include "../CallbackLane.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_HISTORY_RESPONSE_MAX
+    #define MRH_USER_LOCATION_HISTORY_RESPONSE_MAX 64
+#endif
 
 
 class CBCustomCommand : public MRH_Callback
@@ -35,9 +50,29 @@ public:
     
     /**
      *  Default constructor.
+     *
+     *  \param p_Content The content information to use for content commands.
+     *  \param p_Snapshot The location snapshot to use for location commands.
+     *  \param p_Subscription The location subscriptions to use for location commands.
+     *  \param p_History The location history to use for location commands.
+     *  \param p_Store The location store to use for location commands.
+     *  \param p_Sources The location sources to use for location commands.
+     *  \param p_Geofence The geofences to use for geofence commands.
+     *  \param p_Geocode The place index to use for location commands.
+     *  \param p_Visits The location visits to use for location commands.
+     *  \param p_Lane The callback lanes to use for content commands.
      */
     
-    CBCustomCommand() noexcept;
+    CBCustomCommand(std::shared_ptr<Content>& p_Content,
+                    std::shared_ptr<LocationSnapshot>& p_Snapshot,
+                    std::shared_ptr<LocationSubscription>& p_Subscription,
+                    std::shared_ptr<LocationHistory>& p_History,
+                    std::shared_ptr<LocationStore>& p_Store,
+                    std::shared_ptr<LocationSources>& p_Sources,
+                    std::shared_ptr<LocationGeofence>& p_Geofence,
+                    std::shared_ptr<LocationGeocode>& p_Geocode,
+                    std::shared_ptr<LocationVisits>& p_Visits,
+                    std::shared_ptr<CallbackLane>& p_Lane) noexcept;
     
     /**
      *  Default destructor.
@@ -60,10 +95,194 @@ public:
     
 private:
     
+    //*************************************************************************************
+    // Commands
+    //*************************************************************************************
+    
+    /**
+     *  Allow access to multiple content types.
+     *
+     *  \param p_Event The recieved access content command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void AccessContent(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Subscribe to location updates.
+     *
+     *  \param p_Event The recieved subscribe location command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void SubscribeLocation(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Stop location updates.
+     *
+     *  \param p_Event The recieved unsubscribe location command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void UnsubscribeLocation(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get location fixes from the location history.
+     *
+     *  \param p_Event The recieved get location history command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocationHistory(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get location fixes from the location store.
+     *
+     *  \param p_Event The recieved get location store command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocationStore(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get the current location with its age.
+     *
+     *  \param p_Event The recieved get location command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocation(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get the health of all location sources.
+     *
+     *  \param p_Event The recieved get location sources command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocationSources(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Add a geofence region.
+     *
+     *  \param p_Event The recieved add geofence command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void AddGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Remove a geofence region.
+     *
+     *  \param p_Event The recieved remove geofence command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void RemoveGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Subscribe to configured geofence region events.
+     *
+     *  \param p_Event The recieved subscribe geofence command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void SubscribeGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Stop configured geofence region events.
+     *
+     *  \param p_Event The recieved unsubscribe geofence command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void UnsubscribeGeofence(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get the place closest to the current location.
+     *
+     *  \param p_Event The recieved get location place command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocationPlace(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get the location visits in a time range.
+     *
+     *  \param p_Event The recieved get location visits command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocationVisits(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get the most visited places.
+     *
+     *  \param p_Event The recieved get location visit places command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetLocationVisitPlaces(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Get the callback latency histograms.
+     *
+     *  \param p_Event The recieved get callback latency command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    void GetCallbackLatency(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    //*************************************************************************************
+    // Response
+    //*************************************************************************************
+    
+    /**
+     *  Send a custom command response.
+     *
+     *  \param p_Data The response data.
+     *  \param u32_DataSize The response data size in bytes.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void SendResponse(const void* p_Data, MRH_Uint32 u32_DataSize, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Send a not implemented response.
+     *
+     *  \param p_Event The recieved custom command event.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void SendNotImplemented(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Send a location fix list response.
+     *
+     *  \param u32_Command The command to respond to.
+     *  \param p_Fix The fixes to send.
+     *  \param u32_Count The number of fixes to send.
+     *  \param u32_GroupID The event group id for the user event.
+     */
+    
+    static void SendLocationFixes(MRH_Uint32 u32_Command, const LocationSnapshot::Fix* p_Fix, MRH_Uint32 u32_Count, MRH_Uint32 u32_GroupID) noexcept;
+    
     //*************************************************************************************
     // Data
     //*************************************************************************************
     
+    std::shared_ptr<Content> p_Content;
+    std::shared_ptr<LocationSnapshot> p_Snapshot;
+    std::shared_ptr<LocationSubscription> p_Subscription;
+    std::shared_ptr<LocationHistory> p_History;
+    std::shared_ptr<LocationStore> p_Store;
+    std::shared_ptr<LocationSources> p_Sources;
+    std::shared_ptr<LocationGeofence> p_Geofence;
+    std::shared_ptr<LocationGeocode> p_Geocode;
+    std::shared_ptr<LocationVisits> p_Visits;
+    std::shared_ptr<CallbackLane> p_Lane;
+    
 protected:
 
 };
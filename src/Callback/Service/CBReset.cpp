@@ -27,7 +27,13 @@
 // Constructor / Destructor
 //*************************************************************************************
 
-CBReset::CBReset(std::shared_ptr<Content>& p_Content) noexcept : p_Content(p_Content)
+CBReset::CBReset(std::shared_ptr<Content>& p_Content,
+                 std::shared_ptr<LocationSubscription>& p_Subscription,
+                 std::shared_ptr<LocationGeofence>& p_Geofence,
+                 std::shared_ptr<CallbackLane>& p_Lane) noexcept : p_Content(p_Content),
+                                                                   p_Subscription(p_Subscription),
+                                                                   p_Geofence(p_Geofence),
+                                                                   p_Lane(p_Lane)
 {}
 
 CBReset::~CBReset() noexcept
@@ -49,19 +55,52 @@ void CBReset::Callback(const MRH_Event* p_Event, MRH_Uint32 u32_GroupID) noexcep
         return;
     }
     
+    // Location updates and added regions belong to the previous package,
+    // cleared here so requests of the new package are kept
+    p_Subscription->Clear();
+    p_Geofence->Clear();
+    
+    // Content is reset on the IO lane, later content requests wait for it
+    std::shared_ptr<Content> p_Reset(p_Content);
+    std::string s_PackagePath;
+    
+    try
+    {
+        s_PackagePath = c_Data.p_PackagePath;
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "CBReset.cpp", __LINE__);
+    }
+    
+    p_Lane->SubmitBarrier([p_Reset, s_PackagePath]()
+    {
+        Reset(p_Reset, s_PackagePath);
+    });
+}
+
+//*************************************************************************************
+// Reset
+//*************************************************************************************
+
+void CBReset::Reset(std::shared_ptr<Content> const& p_Content, std::string const& s_PackagePath) noexcept
+{
     // Reset in individual try-catch blocks so both will be performed
     try
     {
         try
         {
-            p_Content->Reset(c_Data.p_PackagePath);
+            p_Content->Reset(s_PackagePath);
         }
         catch (Exception& e)
         {
             MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
                                            "CBSReset.cpp", __LINE__);
             
-            // Invalid path, which will fail but remove links
+            // Invalid path, which will fail and leave no active package
+            // @NOTE: Links of the previous package are kept in its session, 
+            //        they are only removed once the session is reused
             p_Content->Reset("");
         }
     }
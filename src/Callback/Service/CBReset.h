@@ -25,6 +25,9 @@
 
 // Project
 #include "../../Content/Content.h"
+#include "../../Location/LocationSubscription.h"
+#include "../../Location/LocationGeofence.h"
+#include "../CallbackLane.h"
 
 
 class CBReset : public MRH_Callback
@@ -39,9 +42,15 @@ public:
      *  Default constructor.
      *
      *  \param p_Content The content information to reset on callback.
+     *  \param p_Subscription The location subscriptions to clear on callback.
+     *  \param p_Geofence The geofences to clear on callback.
+     *  \param p_Lane The callback lanes to reset on.
      */
     
-    CBReset(std::shared_ptr<Content>& p_Content) noexcept;
+    CBReset(std::shared_ptr<Content>& p_Content,
+            std::shared_ptr<LocationSubscription>& p_Subscription,
+            std::shared_ptr<LocationGeofence>& p_Geofence,
+            std::shared_ptr<CallbackLane>& p_Lane) noexcept;
     
     /**
      *  Default destructor.
@@ -64,11 +73,27 @@ public:
     
 private:
     
+    //*************************************************************************************
+    // Reset
+    //*************************************************************************************
+    
+    /**
+     *  Reset the content for a package.
+     *
+     *  \param p_Content The content information to reset.
+     *  \param s_PackagePath The full path to the package.
+     */
+    
+    static void Reset(std::shared_ptr<Content> const& p_Content, std::string const& s_PackagePath) noexcept;
+    
     //*************************************************************************************
     // Data
     //*************************************************************************************
     
     std::shared_ptr<Content> p_Content;
+    std::shared_ptr<LocationSubscription> p_Subscription;
+    std::shared_ptr<LocationGeofence> p_Geofence;
+    std::shared_ptr<CallbackLane> p_Lane;
     
 protected:
 
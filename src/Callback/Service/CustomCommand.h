@@ -0,0 +1,462 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef CustomCommand_h
+#define CustomCommand_h
+
+// C / C++
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+
+//*************************************************************************************
+// Custom Command
+//*************************************************************************************
+
+/**
+ *  Custom command event data layouts. Every MRH_EVENT_USER_CUSTOM_COMMAND_U 
+ *  and MRH_EVENT_USER_CUSTOM_COMMAND_S event starts with the command id, 
+ *  followed by the command specific data. All values are stored in host 
+ *  byte order without padding.
+ */
+
+namespace CustomCommand
+{
+    typedef enum
+    {
+        ACCESS_CONTENT = 0,
+        SUBSCRIBE_LOCATION = 1,
+        UNSUBSCRIBE_LOCATION = 2,
+        GET_LOCATION_HISTORY = 3,
+        GET_LOCATION_STORE = 4,
+        GET_LOCATION = 5,
+        GET_LOCATION_SOURCES = 6,
+        ADD_GEOFENCE = 7,
+        REMOVE_GEOFENCE = 8,
+        SUBSCRIBE_GEOFENCE = 9,
+        UNSUBSCRIBE_GEOFENCE = 10,
+        GEOFENCE_EVENT = 11, // Response only
+        GET_LOCATION_PLACE = 12,
+        GET_LOCATION_VISITS = 13,
+        GET_LOCATION_VISIT_PLACES = 14,
+        GET_CALLBACK_LATENCY = 15,
+        
+        COMMAND_MAX = GET_CALLBACK_LATENCY,
+        
+        COMMAND_COUNT = COMMAND_MAX + 1
+        
+    }Command;
+    
+#pragma pack(push, 1)
+    
+    /**
+     *  Command header, shared by all requests and responses.
+     */
+    
+    typedef struct Header_t
+    {
+        MRH_Uint32 u32_Command;
+        
+    }Header;
+    
+    /**
+     *  ACCESS_CONTENT request. Each set bit is a Content::Type to link.
+     */
+    
+    typedef struct AccessContent_U_t
+    {
+        Header c_Header;
+        MRH_Uint32 u32_TypeMask;
+        
+    }AccessContent_U;
+    
+    /**
+     *  ACCESS_CONTENT response. On failure no requested type was linked, 
+     *  the failed mask lists the types which could not be linked.
+     */
+    
+    typedef struct AccessContent_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint32 u32_TypeMask;
+        MRH_Uint32 u32_FailedMask;
+        
+    }AccessContent_S;
+    
+    /**
+     *  SUBSCRIBE_LOCATION request. Location updates are sent as 
+     *  MRH_EVENT_USER_GET_LOCATION_S events once the interval passed and 
+     *  the distance (meters) or facing (degrees) changed enough. A change 
+     *  of 0 for both sends every new location.
+     */
+    
+    typedef struct SubscribeLocation_U_t
+    {
+        Header c_Header;
+        MRH_Uint32 u32_IntervalMS;
+        MRH_Sfloat64 f64_Distance;
+        MRH_Sfloat64 f64_Heading;
+        
+    }SubscribeLocation_U;
+    
+    /**
+     *  SUBSCRIBE_LOCATION and UNSUBSCRIBE_LOCATION response.
+     */
+    
+    typedef struct SubscribeLocation_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        
+    }SubscribeLocation_S;
+    
+    /**
+     *  UNSUBSCRIBE_LOCATION request, stops location updates.
+     */
+    
+    typedef struct UnsubscribeLocation_U_t
+    {
+        Header c_Header;
+        
+    }UnsubscribeLocation_U;
+    
+    /**
+     *  GET_LOCATION_HISTORY, GET_LOCATION_STORE and GET_LOCATION_VISITS 
+     *  request. Returns the newest fixes with a time (Unix time in 
+     *  milliseconds) inside [start, end], up to count fixes. Visits are 
+     *  returned if they overlap the range.
+     */
+    
+    typedef struct GetLocationHistory_U_t
+    {
+        Header c_Header;
+        MRH_Uint64 u64_StartMS;
+        MRH_Uint64 u64_EndMS;
+        MRH_Uint32 u32_Count;
+        
+    }GetLocationHistory_U;
+    
+    /**
+     *  A single location history fix.
+     */
+    
+    typedef struct LocationHistoryFix_t
+    {
+        MRH_Uint64 u64_TimeMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Elevation;
+        MRH_Sfloat64 f64_Facing;
+        
+    }LocationHistoryFix;
+    
+    /**
+     *  GET_LOCATION_HISTORY and GET_LOCATION_STORE response, followed by 
+     *  count LocationHistoryFix entries, oldest first.
+     */
+    
+    typedef struct GetLocationHistory_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint32 u32_Count;
+        
+    }GetLocationHistory_S;
+    
+    /**
+     *  GET_LOCATION request, the current location with its age.
+     */
+    
+    typedef struct GetLocation_U_t
+    {
+        Header c_Header;
+        
+    }GetLocation_U;
+    
+    /**
+     *  GET_LOCATION response. The location is stale if it is older than 
+     *  the service stale time, for example if restored after a restart. 
+     *  Speed (meters per second) and course (degrees from north) are 0 
+     *  unless location filtering is enabled.
+     */
+    
+    typedef struct GetLocation_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint8 u8_Stale;
+        MRH_Uint64 u64_TimeMS;
+        MRH_Uint64 u64_AgeMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Elevation;
+        MRH_Sfloat64 f64_Facing;
+        MRH_Sfloat64 f64_Speed;
+        MRH_Sfloat64 f64_Course;
+        
+    }GetLocation_S;
+    
+    /**
+     *  GET_LOCATION_SOURCES request, the health of all location sources.
+     */
+    
+    typedef struct GetLocationSources_U_t
+    {
+        Header c_Header;
+        
+    }GetLocationSources_U;
+    
+    /**
+     *  A single location source. The active source provided the current 
+     *  location, a fresh source is connected and recently sent fixes. 
+     *  The interval is the average time between fixes, the age the time 
+     *  since the last fix, both in milliseconds.
+     */
+    
+    typedef struct LocationSourceStats_t
+    {
+        MRH_Uint32 u32_Priority;
+        MRH_Uint8 u8_Connected;
+        MRH_Uint8 u8_Active;
+        MRH_Uint8 u8_Fresh;
+        MRH_Uint32 u32_IntervalMS;
+        MRH_Uint64 u64_AgeMS;
+        MRH_Uint64 u64_Fixes;
+        MRH_Uint64 u64_Selected;
+        MRH_Uint64 u64_Connects;
+        MRH_Uint64 u64_Errors;
+        
+    }LocationSourceStats;
+    
+    /**
+     *  GET_LOCATION_SOURCES response, followed by count LocationSourceStats 
+     *  entries in configuration order.
+     */
+    
+    typedef struct GetLocationSources_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint32 u32_Count;
+        
+    }GetLocationSources_S;
+    
+    /**
+     *  ADD_GEOFENCE request, followed by count GeofencePoint entries. A 
+     *  radius in meters with a single point adds a circle, a radius of 0 
+     *  with 3 or more points a polygon. Events for the region are sent to 
+     *  the requesting group id.
+     */
+    
+    typedef struct AddGeofence_U_t
+    {
+        Header c_Header;
+        MRH_Sfloat64 f64_Radius;
+        MRH_Uint32 u32_Count;
+        
+    }AddGeofence_U;
+    
+    /**
+     *  A single geofence point.
+     */
+    
+    typedef struct GeofencePoint_t
+    {
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+    }GeofencePoint;
+    
+    /**
+     *  REMOVE_GEOFENCE request, removes a region added by the same group id.
+     */
+    
+    typedef struct RemoveGeofence_U_t
+    {
+        Header c_Header;
+        MRH_Uint32 u32_RegionID;
+        
+    }RemoveGeofence_U;
+    
+    /**
+     *  SUBSCRIBE_GEOFENCE and UNSUBSCRIBE_GEOFENCE request. Subscribed 
+     *  group ids recieve events for all configured regions.
+     */
+    
+    typedef struct SubscribeGeofence_U_t
+    {
+        Header c_Header;
+        
+    }SubscribeGeofence_U;
+    
+    /**
+     *  ADD_GEOFENCE, REMOVE_GEOFENCE, SUBSCRIBE_GEOFENCE and 
+     *  UNSUBSCRIBE_GEOFENCE response. The region id is the added or 
+     *  removed region, 0 otherwise.
+     */
+    
+    typedef struct Geofence_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint32 u32_RegionID;
+        
+    }Geofence_S;
+    
+    /**
+     *  GEOFENCE_EVENT, sent without request once the location entered or 
+     *  left a region.
+     */
+    
+    typedef struct GeofenceEvent_S_t
+    {
+        Header c_Header;
+        MRH_Uint32 u32_RegionID;
+        MRH_Uint8 u8_Entered; // 0 if left
+        MRH_Uint64 u64_TimeMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+    }GeofenceEvent_S;
+    
+    /**
+     *  GET_LOCATION_PLACE request, the place closest to the current 
+     *  location.
+     */
+    
+    typedef struct GetLocationPlace_U_t
+    {
+        Header c_Header;
+        
+    }GetLocationPlace_U;
+    
+    /**
+     *  GET_LOCATION_PLACE response, followed by the UTF-8 place name 
+     *  without terminator. The time is the location time, the stale flag 
+     *  is set like for GET_LOCATION. The position is the place position, 
+     *  the distance in meters from the location. The country is a 
+     *  ISO 3166-1 alpha-2 code.
+     */
+    
+    typedef struct GetLocationPlace_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint8 u8_Stale;
+        MRH_Uint64 u64_TimeMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Distance;
+        MRH_Uint32 u32_Population;
+        char p_Country[2];
+        MRH_Uint8 u8_NameSize;
+        
+    }GetLocationPlace_S;
+    
+    /**
+     *  A single visit. The departure is 0 for the current visit, the 
+     *  place id 0 if the visit has no place.
+     */
+    
+    typedef struct LocationVisit_t
+    {
+        MRH_Uint64 u64_ArrivalMS;
+        MRH_Uint64 u64_DepartureMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Uint32 u32_PlaceID;
+        
+    }LocationVisit;
+    
+    /**
+     *  GET_LOCATION_VISITS response, followed by count LocationVisit 
+     *  entries, oldest first.
+     */
+    
+    typedef struct GetLocationVisits_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint32 u32_Count;
+        
+    }GetLocationVisits_S;
+    
+    /**
+     *  GET_LOCATION_VISIT_PLACES request, the most visited places up to 
+     *  count places.
+     */
+    
+    typedef struct GetLocationVisitPlaces_U_t
+    {
+        Header c_Header;
+        MRH_Uint32 u32_Count;
+        
+    }GetLocationVisitPlaces_U;
+    
+    /**
+     *  A single visited place. The duration is the time spent at all 
+     *  visits, the last time the last departure.
+     */
+    
+    typedef struct LocationVisitPlace_t
+    {
+        MRH_Uint32 u32_PlaceID;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Uint32 u32_Visits;
+        MRH_Uint64 u64_DurationMS;
+        MRH_Uint64 u64_LastMS;
+        
+    }LocationVisitPlace;
+    
+    /**
+     *  GET_LOCATION_VISIT_PLACES response, followed by count 
+     *  LocationVisitPlace entries, most visits first.
+     */
+    
+    typedef struct GetLocationVisitPlaces_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint32 u32_Count;
+        
+    }GetLocationVisitPlaces_S;
+    
+    /**
+     *  GET_CALLBACK_LATENCY response. Each bucket i counts the callbacks 
+     *  handled in [2^i, 2^(i + 1)) microseconds, the first bucket starts 
+     *  at 0 and the last bucket has no upper limit. Fast callbacks are 
+     *  answered in memory, IO callbacks include the wait on the IO lane.
+     */
+    
+    typedef struct GetCallbackLatency_S_t
+    {
+        Header c_Header;
+        MRH_Uint8 u8_Result;
+        MRH_Uint64 p_FastBucket[24];
+        MRH_Uint64 p_IOBucket[24];
+        
+    }GetCallbackLatency_S;
+    
+#pragma pack(pop)
+}
+
+#endif /* CustomCommand_h */
@@ -18,6 +18,7 @@
 #include <cstring>
 
 // External
+#include <MRH_Event.h>
 #include <libmrhbf.h>
 
 // Project
@@ -27,6 +28,12 @@
 #ifndef MRH_USER_CONFIGURATION_PATH
     #define MRH_USER_CONFIGURATION_PATH "/usr/local/etc/mrh/mrhpservice/User.conf"
 #endif
+#ifndef MRH_USER_SERVICE_THREAD_COUNT
+    #define MRH_USER_SERVICE_THREAD_COUNT 1
+#endif
+#ifndef MRH_USER_CONTENT_THREAD_COUNT
+    #define MRH_USER_CONTENT_THREAD_COUNT 1
+#endif
 
 namespace
 {
@@ -37,16 +44,27 @@ namespace
         BLOCK_DESTINATION = 1,
         BLOCK_USER_CONTENT = 2,
         BLOCK_SERVER = 3,
+        BLOCK_USER_SESSION = 4,
+        BLOCK_USER_CONTENT_TYPE = 5,
+        BLOCK_LOCATION_HISTORY = 6,
+        BLOCK_LOCATION_STORE = 7,
+        BLOCK_LOCATION_LAST_FIX = 8,
+        BLOCK_LOCATION_SOURCE = 9,
+        BLOCK_LOCATION_FILTER = 10,
+        BLOCK_LOCATION_GEOFENCE = 11,
+        BLOCK_LOCATION_GEOCODE = 12,
+        BLOCK_LOCATION_VISIT = 13,
+        BLOCK_USER_THREADS = 14,
         
         // Source Key
-        SOURCE_DIR_PATH = 4,
+        SOURCE_DIR_PATH = 15,
         
         // Link Key
-        LINK_CONTENT_DIR_PATH = 5,
-        LINK_PACKAGE_DIR_PATH = 6,
+        LINK_CONTENT_DIR_PATH = 16,
+        LINK_PACKAGE_DIR_PATH = 17,
         
         // User Content Key
-        USER_CONTENT_DOCUMENTS = 7,
+        USER_CONTENT_DOCUMENTS = 18,
         USER_CONTENT_PICTURES,
         USER_CONTENT_MUSIC,
         USER_CONTENT_VIDEOS,
@@ -58,8 +76,57 @@ namespace
         // Server Key
         SERVER_SOCKET_PATH,
         
+        // User Session Key
+        USER_SESSION_RESET_KEEP_ACCESS,
+        
+        // User Threads Key
+        USER_THREADS_CALLBACK_COUNT,
+        USER_THREADS_CONTENT_MIN,
+        USER_THREADS_CONTENT_MAX,
+        
+        // User Content Type Key
+        USER_CONTENT_TYPE_PATH,
+        USER_CONTENT_TYPE_FILE,
+        USER_CONTENT_TYPE_REQUEST_EVENT,
+        USER_CONTENT_TYPE_RESPONSE_EVENT,
+        
+        // Location History Key
+        LOCATION_HISTORY_CAPACITY,
+        
+        // Location Store Key
+        LOCATION_STORE_DIR_PATH,
+        LOCATION_STORE_SEGMENT_SIZE,
+        LOCATION_STORE_SIZE_BUDGET,
+        
+        // Location Last Fix Key
+        LOCATION_LAST_FIX_FILE_PATH,
+        
+        // Location Source Key
+        LOCATION_SOURCE_SOCKET_PATH,
+        LOCATION_SOURCE_PRIORITY,
+        
+        // Location Filter Key
+        LOCATION_FILTER_ACCURACY,
+        LOCATION_FILTER_ACCELERATION,
+        LOCATION_FILTER_MAX_SPEED,
+        
+        // Location Geofence Key
+        LOCATION_GEOFENCE_ID,
+        LOCATION_GEOFENCE_RADIUS,
+        LOCATION_GEOFENCE_POINTS,
+        
+        // Location Geocode Key
+        LOCATION_GEOCODE_DATA_PATH,
+        LOCATION_GEOCODE_INDEX_PATH,
+        
+        // Location Visit Key
+        LOCATION_VISIT_DISTANCE,
+        LOCATION_VISIT_DURATION,
+        LOCATION_VISIT_PLACE_DISTANCE,
+        LOCATION_VISIT_FILE_PATH,
+        
         // Bounds
-        IDENTIFIER_MAX = SERVER_SOCKET_PATH,
+        IDENTIFIER_MAX = LOCATION_VISIT_FILE_PATH,
 
         IDENTIFIER_COUNT = IDENTIFIER_MAX + 1
     };
@@ -71,6 +138,17 @@ namespace
         "UserDestination",
         "UserContent",
         "Server",
+        "UserSession",
+        "UserContentType",
+        "LocationHistory",
+        "LocationStore",
+        "LocationLastFix",
+        "LocationSource",
+        "LocationFilter",
+        "LocationGeofence",
+        "LocationGeocode",
+        "LocationVisit",
+        "UserThreads",
         
         // Source Key
         "SourceDirPath",
@@ -90,7 +168,90 @@ namespace
         "InfoResidenceFile",
         
         // Server Key
-        "SocketPath"
+        "SocketPath",
+        
+        // User Session Key
+        "ResetKeepAccess",
+        
+        // User Threads Key
+        "CallbackCount",
+        "ContentMin",
+        "ContentMax",
+        
+        // User Content Type Key
+        "Path",
+        "File",
+        "RequestEvent",
+        "ResponseEvent",
+        
+        // Location History Key
+        "Capacity",
+        
+        // Location Store Key
+        "DirPath",
+        "SegmentSize",
+        "SizeBudget",
+        
+        // Location Last Fix Key
+        "FilePath",
+        
+        // Location Source Key
+        "SocketPath",
+        "Priority",
+        
+        // Location Filter Key
+        "Accuracy",
+        "Acceleration",
+        "MaxSpeed",
+        
+        // Location Geofence Key
+        "ID",
+        "Radius",
+        "Points",
+        
+        // Location Geocode Key
+        "DataPath",
+        "IndexPath",
+        
+        // Location Visit Key
+        "Distance",
+        "Duration",
+        "PlaceDistance",
+        "FilePath"
+    };
+    
+    // Built-in content types, in content type order
+    struct BuiltInType
+    {
+        Identifier e_Key;
+        const char* p_Path;
+        bool b_File;
+        MRH_Uint32 u32_RequestEvent;
+        MRH_Uint32 u32_ResponseEvent;
+    };
+    
+    constexpr BuiltInType p_BuiltInType[] =
+    {
+        { USER_CONTENT_DOCUMENTS, "Documents", false, MRH_EVENT_USER_ACCESS_DOCUMENTS_U, MRH_EVENT_USER_ACCESS_DOCUMENTS_S },
+        { USER_CONTENT_PICTURES, "Pictures", false, MRH_EVENT_USER_ACCESS_PICTURES_U, MRH_EVENT_USER_ACCESS_PICTURES_S },
+        { USER_CONTENT_MUSIC, "Music", false, MRH_EVENT_USER_ACCESS_MUSIC_U, MRH_EVENT_USER_ACCESS_MUSIC_S },
+        { USER_CONTENT_VIDEOS, "Videos", false, MRH_EVENT_USER_ACCESS_VIDEOS_U, MRH_EVENT_USER_ACCESS_VIDEOS_S },
+        { USER_CONTENT_DOWNLOADS, "Downloads", false, MRH_EVENT_USER_ACCESS_DOWNLOADS_U, MRH_EVENT_USER_ACCESS_DOWNLOADS_S },
+        { USER_CONTENT_CLIPBOARD, "Clipboard.txt", true, MRH_EVENT_USER_ACCESS_CLIPBOARD_U, MRH_EVENT_USER_ACCESS_CLIPBOARD_S },
+        { USER_CONTENT_INFO_PERSON, "UserPerson.conf", true, MRH_EVENT_USER_ACCESS_INFO_PERSON_U, MRH_EVENT_USER_ACCESS_INFO_PERSON_S },
+        { USER_CONTENT_INFO_RESIDENCE, "UserResidence.conf", true, MRH_EVENT_USER_ACCESS_INFO_RESIDENCE_U, MRH_EVENT_USER_ACCESS_INFO_RESIDENCE_S }
+    };
+    
+    constexpr size_t us_BuiltInTypeCount = sizeof(p_BuiltInType) / sizeof(BuiltInType);
+    
+    // Request events handled by other callbacks
+    constexpr MRH_Uint32 p_ReservedEvent[] =
+    {
+        MRH_EVENT_USER_AVAIL_U,
+        MRH_EVENT_PS_RESET_REQUEST_U,
+        MRH_EVENT_USER_CUSTOM_COMMAND_U,
+        MRH_EVENT_USER_ACCESS_CLEAR_U,
+        MRH_EVENT_USER_GET_LOCATION_U
     };
 }
 
@@ -102,16 +263,33 @@ namespace
 Configuration::Configuration() : s_SourceDirPath("/var/mrh/mrhpsuser/"),
                                  s_ContentLinkDirPath("/var/mrh/mrhpsuser/_User/"),
                                  s_PackageLinkDirPath("FSRoot/_User/"),
-                                 s_DocumentsDir("Documents"),
-                                 s_PicturesDir("Pictures"),
-                                 s_MusicDir("Music"),
-                                 s_VideosDir("Videos"),
-                                 s_DownloadsDir("Downloads"),
-                                 s_ClipboardFile("Clipboard.txt"),
-                                 s_InfoPersonFile("UserPerson.conf"),
-                                 s_InfoResidenceFile("UserResidence.conf"),
-                                 s_ServerSocketPath("/tmp/mrh/mrhpsuser_location.sock")
+                                 s_ServerSocketPath("/tmp/mrh/mrhpsuser_location.sock"),
+                                 b_ResetKeepAccess(false),
+                                 u32_CallbackThreadCount(MRH_USER_SERVICE_THREAD_COUNT),
+                                 u32_ContentThreadMin(MRH_USER_CONTENT_THREAD_COUNT),
+                                 u32_ContentThreadMax(MRH_USER_CONTENT_THREAD_COUNT),
+                                 u32_LocationHistoryCapacity(1024),
+                                 s_LocationStoreDirPath("/var/mrh/mrhpsuser/Location/"),
+                                 u32_LocationStoreSegmentSize(1024 * 1024),
+                                 u64_LocationStoreSizeBudget(64 * 1024 * 1024),
+                                 s_LocationLastFixFilePath("/var/mrh/mrhpsuser/LastLocation.bin"),
+                                 f64_LocationFilterAccuracy(0.0),
+                                 f64_LocationFilterAcceleration(2.0),
+                                 f64_LocationFilterMaxSpeed(100.0),
+                                 s_LocationGeocodeIndexPath("/var/mrh/mrhpsuser/Places.bin"),
+                                 f64_LocationVisitDistance(100.0),
+                                 u32_LocationVisitDuration(300),
+                                 f64_LocationVisitPlaceDistance(150.0),
+                                 s_LocationVisitFilePath("/var/mrh/mrhpsuser/Visits.bin")
 {
+    for (size_t i = 0; i < us_BuiltInTypeCount; ++i)
+    {
+        v_ContentType.push_back({ p_BuiltInType[i].p_Path,
+                                  p_BuiltInType[i].b_File,
+                                  p_BuiltInType[i].u32_RequestEvent,
+                                  p_BuiltInType[i].u32_ResponseEvent });
+    }
+    
     try
     {
         MRH_BlockFile c_File(MRH_USER_CONFIGURATION_PATH);
@@ -146,25 +324,134 @@ Configuration::Configuration() : s_SourceDirPath("/var/mrh/mrhpsuser/"),
             }
             else if (Block.GetName().compare(p_Identifier[BLOCK_USER_CONTENT]) == 0)
             {
-                s_DocumentsDir = Block.GetValue(p_Identifier[USER_CONTENT_DOCUMENTS]);
-                s_PicturesDir = Block.GetValue(p_Identifier[USER_CONTENT_PICTURES]);
-                s_MusicDir = Block.GetValue(p_Identifier[USER_CONTENT_MUSIC]);
-                s_VideosDir = Block.GetValue(p_Identifier[USER_CONTENT_VIDEOS]);
-                s_DownloadsDir = Block.GetValue(p_Identifier[USER_CONTENT_DOWNLOADS]);
-                s_ClipboardFile = Block.GetValue(p_Identifier[USER_CONTENT_CLIPBOARD]);
-                s_InfoPersonFile = Block.GetValue(p_Identifier[USER_CONTENT_INFO_PERSON]);
-                s_InfoResidenceFile = Block.GetValue(p_Identifier[USER_CONTENT_INFO_RESIDENCE]);
+                for (size_t i = 0; i < us_BuiltInTypeCount; ++i)
+                {
+                    v_ContentType[i].s_Path = Block.GetValue(p_Identifier[p_BuiltInType[i].e_Key]);
+                }
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_USER_CONTENT_TYPE]) == 0)
+            {
+                // Additional types, one block each
+                v_ContentType.push_back({ Block.GetValue(p_Identifier[USER_CONTENT_TYPE_PATH]),
+                                          Block.GetValue(p_Identifier[USER_CONTENT_TYPE_FILE]).compare("1") == 0,
+                                          static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[USER_CONTENT_TYPE_REQUEST_EVENT]))),
+                                          static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[USER_CONTENT_TYPE_RESPONSE_EVENT]))) });
             }
             else if (Block.GetName().compare(p_Identifier[BLOCK_SERVER]) == 0)
             {
                 s_ServerSocketPath = Block.GetValue(p_Identifier[SERVER_SOCKET_PATH]);
             }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_USER_SESSION]) == 0)
+            {
+                b_ResetKeepAccess = Block.GetValue(p_Identifier[USER_SESSION_RESET_KEEP_ACCESS]).compare("1") == 0;
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_USER_THREADS]) == 0)
+            {
+                u32_CallbackThreadCount = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[USER_THREADS_CALLBACK_COUNT])));
+                u32_ContentThreadMin = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[USER_THREADS_CONTENT_MIN])));
+                u32_ContentThreadMax = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[USER_THREADS_CONTENT_MAX])));
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_HISTORY]) == 0)
+            {
+                u32_LocationHistoryCapacity = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[LOCATION_HISTORY_CAPACITY])));
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_STORE]) == 0)
+            {
+                s_LocationStoreDirPath = Block.GetValue(p_Identifier[LOCATION_STORE_DIR_PATH]);
+                u32_LocationStoreSegmentSize = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[LOCATION_STORE_SEGMENT_SIZE])));
+                u64_LocationStoreSizeBudget = std::stoull(Block.GetValue(p_Identifier[LOCATION_STORE_SIZE_BUDGET]));
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_LAST_FIX]) == 0)
+            {
+                s_LocationLastFixFilePath = Block.GetValue(p_Identifier[LOCATION_LAST_FIX_FILE_PATH]);
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_SOURCE]) == 0)
+            {
+                // Additional sources, one block each
+                v_LocationSource.push_back({ Block.GetValue(p_Identifier[LOCATION_SOURCE_SOCKET_PATH]),
+                                             static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[LOCATION_SOURCE_PRIORITY]))) });
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_FILTER]) == 0)
+            {
+                f64_LocationFilterAccuracy = std::stod(Block.GetValue(p_Identifier[LOCATION_FILTER_ACCURACY]));
+                f64_LocationFilterAcceleration = std::stod(Block.GetValue(p_Identifier[LOCATION_FILTER_ACCELERATION]));
+                f64_LocationFilterMaxSpeed = std::stod(Block.GetValue(p_Identifier[LOCATION_FILTER_MAX_SPEED]));
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_GEOFENCE]) == 0)
+            {
+                // Points are listed as "lat,lon;lat,lon;..."
+                Geofence c_Geofence;
+                std::string s_Points = Block.GetValue(p_Identifier[LOCATION_GEOFENCE_POINTS]);
+                size_t us_Start = 0;
+                
+                c_Geofence.u32_ID = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[LOCATION_GEOFENCE_ID])));
+                c_Geofence.f64_Radius = std::stod(Block.GetValue(p_Identifier[LOCATION_GEOFENCE_RADIUS]));
+                
+                while (us_Start < s_Points.size())
+                {
+                    size_t us_End = s_Points.find(';', us_Start);
+                    
+                    if (us_End == std::string::npos)
+                    {
+                        us_End = s_Points.size();
+                    }
+                    
+                    std::string s_Point = s_Points.substr(us_Start, us_End - us_Start);
+                    size_t us_Split = s_Point.find(',');
+                    
+                    if (us_Split == std::string::npos)
+                    {
+                        throw Exception("Invalid geofence point: " + s_Point);
+                    }
+                    
+                    c_Geofence.v_Latitude.emplace_back(std::stod(s_Point.substr(0, us_Split)));
+                    c_Geofence.v_Longtitude.emplace_back(std::stod(s_Point.substr(us_Split + 1)));
+                    
+                    us_Start = us_End + 1;
+                }
+                
+                v_Geofence.emplace_back(std::move(c_Geofence));
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_GEOCODE]) == 0)
+            {
+                s_LocationGeocodeDataPath = Block.GetValue(p_Identifier[LOCATION_GEOCODE_DATA_PATH]);
+                s_LocationGeocodeIndexPath = Block.GetValue(p_Identifier[LOCATION_GEOCODE_INDEX_PATH]);
+            }
+            else if (Block.GetName().compare(p_Identifier[BLOCK_LOCATION_VISIT]) == 0)
+            {
+                f64_LocationVisitDistance = std::stod(Block.GetValue(p_Identifier[LOCATION_VISIT_DISTANCE]));
+                u32_LocationVisitDuration = static_cast<MRH_Uint32>(std::stoul(Block.GetValue(p_Identifier[LOCATION_VISIT_DURATION])));
+                f64_LocationVisitPlaceDistance = std::stod(Block.GetValue(p_Identifier[LOCATION_VISIT_PLACE_DISTANCE]));
+                s_LocationVisitFilePath = Block.GetValue(p_Identifier[LOCATION_VISIT_FILE_PATH]);
+            }
+        }
+        
+        // Only one callback can be added per event
+        for (auto& ContentType : v_ContentType)
+        {
+            for (auto& Reserved : p_ReservedEvent)
+            {
+                if (ContentType.u32_RequestEvent == Reserved)
+                {
+                    throw Exception("Content type " +
+                                    ContentType.s_Path +
+                                    " request event " +
+                                    std::to_string(Reserved) +
+                                    " is already used by the service!");
+                }
+            }
         }
     }
     catch (std::exception& e)
     {
         throw Exception("Could not read configuration: " + std::string(e.what()));
     }
+    
+    // The server is the only source if none were listed
+    if (v_LocationSource.size() == 0)
+    {
+        v_LocationSource.push_back({ s_ServerSocketPath, 0 });
+    }
 }
 
 Configuration::~Configuration() noexcept
@@ -189,47 +476,107 @@ std::string Configuration::GetPackageLinkDirectoryPath() const noexcept
     return s_PackageLinkDirPath;
 }
 
-std::string Configuration::GetDocumentsDirectory() const noexcept
+std::vector<Configuration::ContentType> const& Configuration::GetContentTypes() const noexcept
+{
+    return v_ContentType;
+}
+
+std::vector<Configuration::LocationSource> const& Configuration::GetLocationSources() const noexcept
+{
+    return v_LocationSource;
+}
+
+bool Configuration::GetResetKeepAccess() const noexcept
+{
+    return b_ResetKeepAccess;
+}
+
+MRH_Uint32 Configuration::GetCallbackThreadCount() const noexcept
+{
+    return u32_CallbackThreadCount;
+}
+
+MRH_Uint32 Configuration::GetContentThreadMin() const noexcept
+{
+    return u32_ContentThreadMin;
+}
+
+MRH_Uint32 Configuration::GetContentThreadMax() const noexcept
+{
+    return u32_ContentThreadMax;
+}
+
+MRH_Uint32 Configuration::GetLocationHistoryCapacity() const noexcept
+{
+    return u32_LocationHistoryCapacity;
+}
+
+std::string Configuration::GetLocationStoreDirectoryPath() const noexcept
+{
+    return s_LocationStoreDirPath;
+}
+
+MRH_Uint32 Configuration::GetLocationStoreSegmentSize() const noexcept
+{
+    return u32_LocationStoreSegmentSize;
+}
+
+MRH_Uint64 Configuration::GetLocationStoreSizeBudget() const noexcept
+{
+    return u64_LocationStoreSizeBudget;
+}
+
+std::string Configuration::GetLocationLastFixFilePath() const noexcept
+{
+    return s_LocationLastFixFilePath;
+}
+
+MRH_Sfloat64 Configuration::GetLocationFilterAccuracy() const noexcept
+{
+    return f64_LocationFilterAccuracy;
+}
+
+MRH_Sfloat64 Configuration::GetLocationFilterAcceleration() const noexcept
 {
-    return s_DocumentsDir;
+    return f64_LocationFilterAcceleration;
 }
 
-std::string Configuration::GetPicturesDirectory() const noexcept
+MRH_Sfloat64 Configuration::GetLocationFilterMaxSpeed() const noexcept
 {
-    return s_PicturesDir;
+    return f64_LocationFilterMaxSpeed;
 }
 
-std::string Configuration::GetMusicDirectory() const noexcept
+std::vector<Configuration::Geofence> const& Configuration::GetGeofences() const noexcept
 {
-    return s_MusicDir;
+    return v_Geofence;
 }
 
-std::string Configuration::GetVideosDirectory() const noexcept
+std::string Configuration::GetLocationGeocodeDataPath() const noexcept
 {
-    return s_VideosDir;
+    return s_LocationGeocodeDataPath;
 }
 
-std::string Configuration::GetDownloadsDirectory() const noexcept
+std::string Configuration::GetLocationGeocodeIndexPath() const noexcept
 {
-    return s_DownloadsDir;
+    return s_LocationGeocodeIndexPath;
 }
 
-std::string Configuration::GetClipboardFile() const noexcept
+MRH_Sfloat64 Configuration::GetLocationVisitDistance() const noexcept
 {
-    return s_ClipboardFile;
+    return f64_LocationVisitDistance;
 }
 
-std::string Configuration::GetInfoPersonFile() const noexcept
+MRH_Uint32 Configuration::GetLocationVisitDuration() const noexcept
 {
-    return s_InfoPersonFile;
+    return u32_LocationVisitDuration;
 }
 
-std::string Configuration::GetInfoResidenceFile() const noexcept
+MRH_Sfloat64 Configuration::GetLocationVisitPlaceDistance() const noexcept
 {
-    return s_InfoResidenceFile;
+    return f64_LocationVisitPlaceDistance;
 }
 
-std::string Configuration::GetServerSocketPath() const noexcept
+std::string Configuration::GetLocationVisitFilePath() const noexcept
 {
-    return s_ServerSocketPath;
+    return s_LocationVisitFilePath;
 }
@@ -18,6 +18,8 @@
 #define Configuration_h
 
 // C / C++
+#include <vector>
+#include <string>
 
 // External
 #include <MRH_Typedefs.h>
@@ -30,6 +32,40 @@ class Configuration
 {
 public:
     
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct ContentType_t
+    {
+        // Relative to the source and link directory
+        std::string s_Path;
+        bool b_File;
+        
+        // MRH_EVENT_UNK if only accessible by custom command
+        MRH_Uint32 u32_RequestEvent;
+        MRH_Uint32 u32_ResponseEvent;
+        
+    }ContentType;
+    
+    typedef struct LocationSource_t
+    {
+        std::string s_SocketPath;
+        MRH_Uint32 u32_Priority; // Lower is preferred
+        
+    }LocationSource;
+    
+    typedef struct Geofence_t
+    {
+        MRH_Uint32 u32_ID;
+        
+        // Circle if a radius is given, polygon otherwise
+        MRH_Sfloat64 f64_Radius;
+        std::vector<MRH_Sfloat64> v_Latitude;
+        std::vector<MRH_Sfloat64> v_Longtitude;
+        
+    }Geofence;
+    
     //*************************************************************************************
     // Constructor
     //*************************************************************************************
@@ -75,76 +111,174 @@ public:
     std::string GetPackageLinkDirectoryPath() const noexcept;
     
     /**
-     *  Get the documents directory name.
+     *  Get all content types. Built-in types are listed first, in the 
+     *  order of the content type enum.
+     *
+     *  \return The content types.
+     */
+    
+    std::vector<ContentType> const& GetContentTypes() const noexcept;
+    
+    /**
+     *  Get all location sources. The server socket is the only source 
+     *  if no location sources were configured.
+     *
+     *  \return The location sources.
+     */
+    
+    std::vector<LocationSource> const& GetLocationSources() const noexcept;
+    
+    /**
+     *  Check if content access is kept when a package is reset again.
+     *
+     *  \return true if access is kept, false if not.
+     */
+    
+    bool GetResetKeepAccess() const noexcept;
+    
+    /**
+     *  Get the number of threads to use for callbacks.
+     *
+     *  \return The callback thread count, 0 for one per core.
+     */
+    
+    MRH_Uint32 GetCallbackThreadCount() const noexcept;
+    
+    /**
+     *  Get the number of content threads kept while idle.
+     *
+     *  \return The minimum content thread count.
+     */
+    
+    MRH_Uint32 GetContentThreadMin() const noexcept;
+    
+    /**
+     *  Get the number of content threads used under load.
+     *
+     *  \return The maximum content thread count.
+     */
+    
+    MRH_Uint32 GetContentThreadMax() const noexcept;
+    
+    /**
+     *  Get the number of location fixes to keep in the history.
+     *
+     *  \return The location history capacity.
+     */
+    
+    MRH_Uint32 GetLocationHistoryCapacity() const noexcept;
+    
+    /**
+     *  Get the location store directory path.
+     *
+     *  \return The location store directory path.
+     */
+    
+    std::string GetLocationStoreDirectoryPath() const noexcept;
+    
+    /**
+     *  Get the size of a single location store segment.
      *
-     *  \return The documents directory name.
+     *  \return The segment size in bytes.
      */
     
-    std::string GetDocumentsDirectory() const noexcept;
+    MRH_Uint32 GetLocationStoreSegmentSize() const noexcept;
     
     /**
-     *  Get the pictures directory name.
+     *  Get the maximum size of all location store segments.
      *
-     *  \return The pictures directory name.
+     *  \return The size budget in bytes, 0 if the store is disabled.
      */
     
-    std::string GetPicturesDirectory() const noexcept;
+    MRH_Uint64 GetLocationStoreSizeBudget() const noexcept;
     
     /**
-     *  Get the music directory name.
+     *  Get the full path to the last location fix file.
      *
-     *  \return The music directory name.
+     *  \return The last location fix file path.
      */
     
-    std::string GetMusicDirectory() const noexcept;
+    std::string GetLocationLastFixFilePath() const noexcept;
     
     /**
-     *  Get the videos directory name.
+     *  Get the expected location error used for filtering.
      *
-     *  \return The videos directory name.
+     *  \return The location error in meters, 0 if filtering is disabled.
      */
     
-    std::string GetVideosDirectory() const noexcept;
+    MRH_Sfloat64 GetLocationFilterAccuracy() const noexcept;
     
     /**
-     *  Get the downloads directory name.
+     *  Get the expected acceleration used for filtering.
      *
-     *  \return The downloads directory name.
+     *  \return The acceleration in meters per second squared.
      */
     
-    std::string GetDownloadsDirectory() const noexcept;
+    MRH_Sfloat64 GetLocationFilterAcceleration() const noexcept;
     
     /**
-     *  Get the clipboard file name.
+     *  Get the fastest plausible speed used for filtering.
      *
-     *  \return The clipboard file name.
+     *  \return The speed in meters per second.
      */
     
-    std::string GetClipboardFile() const noexcept;
+    MRH_Sfloat64 GetLocationFilterMaxSpeed() const noexcept;
     
     /**
-     *  Get the person info file name.
+     *  Get all configured geofence regions.
      *
-     *  \return The person info file name.
+     *  \return The geofence regions.
      */
     
-    std::string GetInfoPersonFile() const noexcept;
+    std::vector<Geofence> const& GetGeofences() const noexcept;
     
     /**
-     *  Get the residence info file name.
+     *  Get the full path to the place data used for reverse geocoding.
      *
-     *  \return The residence info name.
+     *  \return The place data path, empty if the index is used as is.
      */
     
-    std::string GetInfoResidenceFile() const noexcept;
+    std::string GetLocationGeocodeDataPath() const noexcept;
     
     /**
-     *  Get the full server socket path.
+     *  Get the full path to the place index used for reverse geocoding.
      *
-     *  \return The full server socket path.
+     *  \return The place index path.
      */
     
-    std::string GetServerSocketPath() const noexcept;
+    std::string GetLocationGeocodeIndexPath() const noexcept;
+    
+    /**
+     *  Get the distance a stay may spread to count as visit.
+     *
+     *  \return The stay distance in meters.
+     */
+    
+    MRH_Sfloat64 GetLocationVisitDistance() const noexcept;
+    
+    /**
+     *  Get the time a stay needs to count as visit.
+     *
+     *  \return The stay duration in seconds.
+     */
+    
+    MRH_Uint32 GetLocationVisitDuration() const noexcept;
+    
+    /**
+     *  Get the distance between visits of the same place.
+     *
+     *  \return The place distance in meters.
+     */
+    
+    MRH_Sfloat64 GetLocationVisitPlaceDistance() const noexcept;
+    
+    /**
+     *  Get the full path to the visit file.
+     *
+     *  \return The visit file path.
+     */
+    
+    std::string GetLocationVisitFilePath() const noexcept;
     
 private:
     
@@ -160,18 +294,51 @@ private:
     std::string s_PackageLinkDirPath;
     
     // User Content
-    std::string s_DocumentsDir;
-    std::string s_PicturesDir;
-    std::string s_MusicDir;
-    std::string s_VideosDir;
-    std::string s_DownloadsDir;
-    std::string s_ClipboardFile;
-    std::string s_InfoPersonFile;
-    std::string s_InfoResidenceFile;
+    std::vector<ContentType> v_ContentType;
     
     // Server
     std::string s_ServerSocketPath;
     
+    // User Session
+    bool b_ResetKeepAccess;
+    
+    // User Threads
+    MRH_Uint32 u32_CallbackThreadCount;
+    MRH_Uint32 u32_ContentThreadMin;
+    MRH_Uint32 u32_ContentThreadMax;
+    
+    // Location History
+    MRH_Uint32 u32_LocationHistoryCapacity;
+    
+    // Location Store
+    std::string s_LocationStoreDirPath;
+    MRH_Uint32 u32_LocationStoreSegmentSize;
+    MRH_Uint64 u64_LocationStoreSizeBudget;
+    
+    // Location Last Fix
+    std::string s_LocationLastFixFilePath;
+    
+    // Location Source
+    std::vector<LocationSource> v_LocationSource;
+    
+    // Location Filter
+    MRH_Sfloat64 f64_LocationFilterAccuracy;
+    MRH_Sfloat64 f64_LocationFilterAcceleration;
+    MRH_Sfloat64 f64_LocationFilterMaxSpeed;
+    
+    // Location Geofence
+    std::vector<Geofence> v_Geofence;
+    
+    // Location Geocode
+    std::string s_LocationGeocodeDataPath;
+    std::string s_LocationGeocodeIndexPath;
+    
+    // Location Visit
+    MRH_Sfloat64 f64_LocationVisitDistance;
+    MRH_Uint32 u32_LocationVisitDuration;
+    MRH_Sfloat64 f64_LocationVisitPlaceDistance;
+    std::string s_LocationVisitFilePath;
+    
 protected:
 
 };
@@ -16,11 +16,21 @@
 
 // C / C++
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <cstdio>
+#ifdef __linux__
+    #include <sys/syscall.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/openat2.h>)
+        #include <linux/openat2.h>
+    #endif
+#endif
 
 // External
 #include <libmrhpsb/MRH_PSBLogger.h>
@@ -29,6 +39,17 @@
 #include "./Content.h"
 
 // Pre-defined
+#if defined(RESOLVE_BENEATH) && defined(SYS_openat2)
+    #define MRH_USER_USE_OPENAT2 1
+#endif
+
+#ifndef RENAME_NOREPLACE
+    #define RENAME_NOREPLACE (1 << 0)
+#endif
+#ifndef RENAME_EXCHANGE
+    #define RENAME_EXCHANGE (1 << 1)
+#endif
+
 namespace
 {
 #ifdef __APPLE__
@@ -36,6 +57,39 @@ namespace
 #else
     constexpr int i_PackageDirMode = 0600;
 #endif
+    
+    constexpr int i_ContentFileMode = 0666;
+    
+    // Directories are only used as *at() base, no read access needed
+#ifdef O_PATH
+    constexpr int i_DirOpenFlags = O_PATH | O_DIRECTORY | O_CLOEXEC;
+#else
+    constexpr int i_DirOpenFlags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+#endif
+    
+    void CloseDir(int& i_DirFD) noexcept
+    {
+        if (i_DirFD >= 0)
+        {
+            close(i_DirFD);
+            i_DirFD = -1;
+        }
+    }
+    
+    int RenameAt(int i_OldDirFD, const char* p_OldPath, int i_NewDirFD, const char* p_NewPath, unsigned int u32_Flags) noexcept
+    {
+#ifdef SYS_renameat2
+        return static_cast<int>(syscall(SYS_renameat2, i_OldDirFD, p_OldPath, i_NewDirFD, p_NewPath, u32_Flags));
+#else
+        if (u32_Flags != 0)
+        {
+            errno = ENOSYS;
+            return -1;
+        }
+        
+        return renameat(i_OldDirFD, p_OldPath, i_NewDirFD, p_NewPath);
+#endif
+    }
 }
 
 
@@ -44,82 +98,199 @@ namespace
 //*************************************************************************************
 
 Content::Content(Configuration const& c_Configuration) : b_Reset(false),
-                                                         s_UserDirLinkPath("")
+                                                         b_KeepAccess(c_Configuration.GetResetKeepAccess()),
+                                                         u32_Operations(0),
+                                                         i_SourceDirFD(-1),
+                                                         i_ContentLinkDirFD(-1),
+                                                         u32_TypeCount(0),
+                                                         u32_TypeMaskAll(0),
+                                                         p_Active(NULL),
+                                                         u64_ResetCount(0)
 {
     s_ContentLinkDirPath = c_Configuration.GetContentLinkDirectoryPath();
-    s_PackageLinkDirPath = c_Configuration.GetPackageLinkDirectoryPath();
+    
+    if (s_ContentLinkDirPath.length() > 0 && s_ContentLinkDirPath[s_ContentLinkDirPath.length() - 1] != '/')
+    {
+        s_ContentLinkDirPath += "/";
+    }
+    
+    for (auto& Session : v_Session)
+    {
+        Session.i_PackageLinkDirFD = -1;
+        Session.i_LinkDirFD = -1;
+        Session.u32_LinkState = 0;
+        Session.u64_LastUse = 0;
+    }
+    
+    // Split package link into the containing directory and the link name
+    std::string s_PackageLinkPath(c_Configuration.GetPackageLinkDirectoryPath());
+    size_t us_Pos = s_PackageLinkPath.find_last_of('/');
+    
+    if (us_Pos == std::string::npos)
+    {
+        s_PackageLinkDirPath = ".";
+        s_PackageLinkName = s_PackageLinkPath;
+    }
+    else
+    {
+        s_PackageLinkDirPath = s_PackageLinkPath.substr(0, us_Pos);
+        s_PackageLinkName = s_PackageLinkPath.substr(us_Pos + 1);
+    }
     
     std::string s_SourceDirPath(c_Configuration.GetSourceDirectoryPath());
-    std::string s_Documents(c_Configuration.GetDocumentsDirectory());
-    std::string s_Pictures(c_Configuration.GetPicturesDirectory());
-    std::string s_Music(c_Configuration.GetMusicDirectory());
-    std::string s_Videos(c_Configuration.GetVideosDirectory());
-    std::string s_Downloads(c_Configuration.GetDownloadsDirectory());
-    std::string s_Clipboard(c_Configuration.GetClipboardFile());
-    std::string s_InfoPerson(c_Configuration.GetInfoPersonFile());
-    std::string s_InfoResidence(c_Configuration.GetInfoResidenceFile());
+    auto const& v_ContentType = c_Configuration.GetContentTypes();
+    
+    if (v_ContentType.size() > TYPE_LIMIT)
+    {
+        throw Exception("Too many content types (" + std::to_string(v_ContentType.size()) + ")!");
+    }
     
     try
     {
+        p_Executor = std::unique_ptr<FSExecutor>(new FSExecutor(c_Configuration.GetContentThreadMin(),
+                                                                  c_Configuration.GetContentThreadMax()));
+        
         // Make sure the user directory exists
-        CheckDir(s_SourceDirPath);
-        CheckDir(s_ContentLinkDirPath);
+        CheckDir(AT_FDCWD, s_SourceDirPath);
+        CheckDir(AT_FDCWD, s_ContentLinkDirPath);
+        
+        // Keep both open, all following work is relative to them
+        i_SourceDirFD = OpenDir(AT_FDCWD, s_SourceDirPath, false);
+        i_ContentLinkDirFD = OpenDir(AT_FDCWD, s_ContentLinkDirPath, false);
         
         // Make sure stuff exists
-        CheckDir(s_SourceDirPath + s_Documents);
-        CheckDir(s_SourceDirPath + s_Pictures);
-        CheckDir(s_SourceDirPath + s_Music);
-        CheckDir(s_SourceDirPath + s_Videos);
-        CheckDir(s_SourceDirPath + s_Downloads);
-        CheckFile(s_SourceDirPath + s_Clipboard);
-        CheckFile(s_SourceDirPath + s_InfoPerson);
-        CheckFile(s_SourceDirPath + s_InfoResidence);
+        for (auto& ContentType : v_ContentType)
+        {
+            if (ContentType.b_File == true)
+            {
+                CheckFile(i_SourceDirFD, ContentType.s_Path);
+            }
+            else
+            {
+                CheckDir(i_SourceDirFD, ContentType.s_Path);
+            }
+        }
         
         // All OK, create
-        m_SymLink.emplace(DOCUMENTS, new SymLink(s_SourceDirPath + s_Documents, s_ContentLinkDirPath + s_Documents));
-        m_SymLink.emplace(PICTURES, new SymLink(s_SourceDirPath + s_Pictures, s_ContentLinkDirPath + s_Pictures));
-        m_SymLink.emplace(MUSIC, new SymLink(s_SourceDirPath + s_Music, s_ContentLinkDirPath + s_Music));
-        m_SymLink.emplace(VIDEOS, new SymLink(s_SourceDirPath + s_Videos, s_ContentLinkDirPath + s_Videos));
-        m_SymLink.emplace(DOWNLOADS, new SymLink(s_SourceDirPath + s_Downloads, s_ContentLinkDirPath + s_Downloads));
-        m_SymLink.emplace(CLIPBOARD, new SymLink(s_SourceDirPath + s_Clipboard, s_ContentLinkDirPath + s_Clipboard));
-        m_SymLink.emplace(INFO_PERSON, new SymLink(s_SourceDirPath + s_InfoPerson, s_ContentLinkDirPath + s_InfoPerson));
-        m_SymLink.emplace(INFO_RESIDENCE, new SymLink(s_SourceDirPath + s_InfoResidence, s_ContentLinkDirPath + s_InfoResidence));
+        for (size_t i = 0; i < v_ContentType.size(); ++i)
+        {
+            v_SymLink[i].Setup(s_SourceDirPath + v_ContentType[i].s_Path, v_ContentType[i].s_Path);
+            u32_TypeMaskAll |= TypeMask(i);
+        }
+        
+        u32_TypeCount = static_cast<MRH_Uint32>(v_ContentType.size());
+        
+        // Every package session links inside its own directory
+        for (size_t i = 0; i < MRH_USER_CONTENT_SESSION_COUNT; ++i)
+        {
+            std::string s_LinkDirName("Package" + std::to_string(i));
+            
+            CheckDir(i_ContentLinkDirFD, s_LinkDirName);
+            
+            v_Session[i].s_LinkDirPath = s_ContentLinkDirPath + s_LinkDirName + "/";
+            v_Session[i].i_LinkDirFD = OpenDir(i_ContentLinkDirFD, s_LinkDirName, true);
+            
+            // Links left over from a previous run belong to no package
+            for (MRH_Uint32 u32_Type = 0; u32_Type < u32_TypeCount; ++u32_Type)
+            {
+                unlinkat(v_Session[i].i_LinkDirFD, v_SymLink[u32_Type].GetLinkName(), 0);
+            }
+            
+            // Nested links need their parent directories
+            for (auto& ContentType : v_ContentType)
+            {
+                if (ContentType.s_Path.find_last_of('/') != std::string::npos)
+                {
+                    CheckDir(v_Session[i].i_LinkDirFD, ContentType.s_Path.substr(0, ContentType.s_Path.find_last_of('/')));
+                }
+            }
+        }
     }
     catch (Exception& e)
     {
+        for (auto& Session : v_Session)
+        {
+            CloseDir(Session.i_LinkDirFD);
+        }
+        
+        CloseDir(i_SourceDirFD);
+        CloseDir(i_ContentLinkDirFD);
         throw;
     }
     catch (std::exception& e)
     {
+        for (auto& Session : v_Session)
+        {
+            CloseDir(Session.i_LinkDirFD);
+        }
+        
+        CloseDir(i_SourceDirFD);
+        CloseDir(i_ContentLinkDirFD);
         throw Exception(e.what());
     }
 }
 
 Content::~Content() noexcept
 {
-    for (auto& SymLink : m_SymLink)
+    // Finish pending operations, they use the links
+    p_Executor.reset();
+    
+    MRH_Uint64 u64_SkippedAllow = 0;
+    MRH_Uint64 u64_SkippedClear = 0;
+    
+    for (MRH_Uint32 u32_Type = 0; u32_Type < u32_TypeCount; ++u32_Type)
+    {
+        u64_SkippedAllow += v_SymLink[u32_Type].GetSkippedAllow();
+        u64_SkippedClear += v_SymLink[u32_Type].GetSkippedClear();
+    }
+    
+    MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Skipped " +
+                                                        std::to_string(u64_SkippedAllow) +
+                                                        " link and " +
+                                                        std::to_string(u64_SkippedClear) +
+                                                        " unlink operations.",
+                                   "Content.cpp", __LINE__);
+    
+    // Links need the link directory, remove first
+    for (auto& Session : v_Session)
     {
-        delete SymLink.second;
+        for (MRH_Uint32 u32_Type = 0; u32_Type < u32_TypeCount; ++u32_Type)
+        {
+            unlinkat(Session.i_LinkDirFD, v_SymLink[u32_Type].GetLinkName(), 0);
+        }
+        
+        CloseDir(Session.i_PackageLinkDirFD);
+        CloseDir(Session.i_LinkDirFD);
     }
+    
+    CloseDir(i_ContentLinkDirFD);
+    CloseDir(i_SourceDirFD);
 }
 
-Content::SymLink::SymLink(std::string const& s_SourcePath,
-                          std::string const& s_LinkPath) noexcept
-{
-    this->s_SourcePath = s_SourcePath;
-    this->s_LinkPath = s_LinkPath;
-}
+Content::SymLink::SymLink() noexcept : u64_SkippedAllow(0),
+                                       u64_SkippedClear(0)
+{}
 
 Content::SymLink::~SymLink() noexcept
-{
-    ClearAccess();
-}
+{}
 
 //*************************************************************************************
 // Setup
 //*************************************************************************************
 
-void Content::CheckDir(std::string s_DirPath)
+void Content::SymLink::Setup(std::string const& s_SourcePath, std::string const& s_LinkName)
+{
+    // Built once, operations point to these strings
+    if (s_SourcePath.length() >= PATH_MAX || s_LinkName.length() >= PATH_MAX)
+    {
+        throw Exception("Content path too long: " + s_SourcePath);
+    }
+    
+    this->s_SourcePath = s_SourcePath;
+    this->s_LinkName = s_LinkName;
+}
+
+void Content::CheckDir(int i_DirFD, std::string s_DirPath)
 {
     struct stat s_FileStatus;
     std::string s_CurrentDir;
@@ -145,15 +316,15 @@ void Content::CheckDir(std::string s_DirPath)
             b_Continue = false;
         }
         
-        if ((stat(s_CurrentDir.c_str(), &s_FileStatus) == 0 && S_ISDIR(s_FileStatus.st_mode)))
+        if ((fstatat(i_DirFD, s_CurrentDir.c_str(), &s_FileStatus, 0) == 0 && S_ISDIR(s_FileStatus.st_mode)))
         {
             continue;
         }
         
-        if (mkdir(s_CurrentDir.c_str(), i_PackageDirMode) < 0)
+        if (mkdirat(i_DirFD, s_CurrentDir.c_str(), i_PackageDirMode) < 0)
         {
             throw Exception("Failed to create directory " +
-                            s_DirPath +
+                            s_CurrentDir +
                             ": " +
                             std::string(std::strerror(errno)) +
                             " (" +
@@ -164,14 +335,14 @@ void Content::CheckDir(std::string s_DirPath)
     while (b_Continue == true);
 }
 
-void Content::CheckFile(std::string const& s_FilePath)
+void Content::CheckFile(int i_DirFD, std::string const& s_FilePath)
 {
     // Create folders for file
     if (s_FilePath.find_last_of('/') != std::string::npos)
     {
         try
         {
-            CheckDir(s_FilePath.substr(0, s_FilePath.find_last_of('/')));
+            CheckDir(i_DirFD, s_FilePath.substr(0, s_FilePath.find_last_of('/')));
         }
         catch (Exception& e)
         {
@@ -182,26 +353,70 @@ void Content::CheckFile(std::string const& s_FilePath)
     // Create file
     struct stat s_FileStatus;
     
-    if (stat(s_FilePath.c_str(), &s_FileStatus) == 0 && S_ISREG(s_FileStatus.st_mode))
+    if (fstatat(i_DirFD, s_FilePath.c_str(), &s_FileStatus, 0) == 0 && S_ISREG(s_FileStatus.st_mode))
     {
         return;
     }
     
-    std::ofstream s_File(s_FilePath);
+    int i_FD = openat(i_DirFD, s_FilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, i_ContentFileMode);
     
-    if (s_File.is_open() == false)
+    if (i_FD < 0)
     {
         throw Exception("Failed to create file: " + s_FilePath);
     }
     
-    s_File.close();
+    close(i_FD);
+}
+
+int Content::OpenDir(int i_DirFD, std::string const& s_DirPath, bool b_Beneath)
+{
+    int i_Result = -1;
+    
+#ifdef MRH_USER_USE_OPENAT2
+    // Stay inside the given directory, no escaping package links
+    if (b_Beneath == true)
+    {
+        struct open_how c_How;
+        std::memset(&c_How, 0, sizeof(c_How));
+        
+        c_How.flags = i_DirOpenFlags;
+        c_How.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+        
+        i_Result = static_cast<int>(syscall(SYS_openat2, i_DirFD, s_DirPath.c_str(), &c_How, sizeof(c_How)));
+        
+        if (i_Result < 0 && errno != ENOSYS)
+        {
+            throw Exception("Failed to open directory " +
+                            s_DirPath +
+                            ": " +
+                            std::string(std::strerror(errno)) +
+                            " (" +
+                            std::to_string(errno) +
+                            ")!");
+        }
+    }
+#endif
+    
+    // No openat2 available, use default open
+    if (i_Result < 0 && (i_Result = openat(i_DirFD, s_DirPath.c_str(), i_DirOpenFlags)) < 0)
+    {
+        throw Exception("Failed to open directory " +
+                        s_DirPath +
+                        ": " +
+                        std::string(std::strerror(errno)) +
+                        " (" +
+                        std::to_string(errno) +
+                        ")!");
+    }
+    
+    return i_Result;
 }
 
 //*************************************************************************************
 // Reset
 //*************************************************************************************
 
-std::string Content::GetFullPackageLinkPath(std::string s_PackagePath)
+int Content::OpenPackageLinkDir(std::string s_PackagePath, std::string& s_LinkPath)
 {
     // Check and correct new package path
     if (s_PackagePath.length() == 0)
@@ -213,23 +428,32 @@ std::string Content::GetFullPackageLinkPath(std::string s_PackagePath)
         s_PackagePath += "/";
     }
     
-    // @NOTE: Using std::string operations here didn't work while not returning ANY errors.
-    //        This convoluted way of doing the string works though.
-    size_t us_StringLength = s_PackagePath.length() + s_PackageLinkDirPath.length() + 1;
-    char p_CharString[us_StringLength];
+    int i_PackageDirFD = OpenDir(AT_FDCWD, s_PackagePath, false);
+    int i_Result;
+    
+    try
+    {
+        i_Result = OpenDir(i_PackageDirFD, s_PackageLinkDirPath, true);
+    }
+    catch (Exception& e)
+    {
+        close(i_PackageDirFD);
+        throw;
+    }
+    
+    close(i_PackageDirFD);
     
-    std::memset(p_CharString, '\0', us_StringLength);
-    std::strcpy(p_CharString, s_PackagePath.c_str());
-    std::strcat(p_CharString, s_PackageLinkDirPath.c_str());
+    // Only kept for log messages
+    s_LinkPath = s_PackagePath + s_PackageLinkDirPath + "/" + s_PackageLinkName;
     
-    return std::string(p_CharString);
+    return i_Result;
 }
 
-bool Content::IsSymLink(std::string s_FilePath) noexcept
+bool Content::IsSymLink(int i_DirFD, std::string const& s_FileName) noexcept
 {
     struct stat s_Status;
     
-    if (lstat(s_FilePath.c_str(), &s_Status) == 0 && S_ISLNK(s_Status.st_mode))
+    if (fstatat(i_DirFD, s_FileName.c_str(), &s_Status, AT_SYMLINK_NOFOLLOW) == 0 && S_ISLNK(s_Status.st_mode))
     {
         return true;
     }
@@ -237,230 +461,1144 @@ bool Content::IsSymLink(std::string s_FilePath) noexcept
     return false;
 }
 
-void Content::Reset(std::string const& s_PackagePath)
+bool Content::IsSameDir(int i_DirFD, int i_OtherDirFD) noexcept
 {
-    // Lock until end for full reset
-    std::lock_guard<std::mutex> s_Guard(s_ResetMutex);
-    
-    // Set default result
-    b_Reset = false;
+    struct stat s_Status;
+    struct stat s_OtherStatus;
     
-    // Unlink all links inside the user dir
-    try
+    if (i_DirFD < 0 || i_OtherDirFD < 0 || fstat(i_DirFD, &s_Status) < 0 || fstat(i_OtherDirFD, &s_OtherStatus) < 0)
     {
-        for (auto& SymLink : m_SymLink)
-        {
-            SymLink.second->ClearAccess();
-        }
-    }
-    catch (Exception& e)
-    {
-        throw;
+        return false;
     }
     
-    // Remove user link from old package
-    if (s_UserDirLinkPath.size() > 0)
+    return s_Status.st_dev == s_OtherStatus.st_dev && s_Status.st_ino == s_OtherStatus.st_ino;
+}
+
+void Content::InstallPackageLink(int i_DirFD,
+                                 std::string const& s_TargetPath,
+                                 std::string const& s_LinkPath,
+                                 bool b_Replace)
+{
+    // Build the new link next to the old one, then move it in place
+    std::string s_TempName = "." + s_PackageLinkName + ".new";
+    
+    if (symlinkat(s_TargetPath.c_str(), i_DirFD, s_TempName.c_str()) < 0)
     {
-        // Removal of main user dir link
-        if (unlink(s_UserDirLinkPath.c_str()) < 0 && errno != ENOENT)
+        // Left behind by a crash during a previous install
+        if (errno != EEXIST || unlinkat(i_DirFD, s_TempName.c_str(), 0) < 0 ||
+            symlinkat(s_TargetPath.c_str(), i_DirFD, s_TempName.c_str()) < 0)
         {
-            throw Exception("Failed to unlink content directory link (" +
-                            s_UserDirLinkPath +
-                            "): " +
+            throw Exception("Failed to create content directory link from " +
+                            s_TargetPath +
+                            " to " +
+                            s_LinkPath +
+                            ": " +
                             std::string(std::strerror(errno)) +
                             " (" +
                             std::to_string(errno) +
                             ")!");
         }
-        
-        // Reset link path, no longer in use
-        s_UserDirLinkPath = "";
     }
     
-    // Create main user dir link
-    try
-    {
-        s_UserDirLinkPath = GetFullPackageLinkPath(s_PackagePath);
-    }
-    catch (Exception& e)
+    // Our own link is in place, simply replace
+    unsigned int u32_Flags = (b_Replace == true ? 0 : RENAME_NOREPLACE);
+    
+    if (RenameAt(i_DirFD, s_TempName.c_str(), i_DirFD, s_PackageLinkName.c_str(), u32_Flags) == 0)
     {
-        throw Exception(e.what());
+        return;
     }
     
-    if (symlink(s_ContentLinkDirPath.c_str(), s_UserDirLinkPath.c_str()) < 0)
+    int i_Error = errno;
+    
+    if (i_Error == EEXIST)
     {
-        // Already a symlink in place with this name
-        if (errno == EEXIST && IsSymLink(s_UserDirLinkPath) == true)
+        // Something already exists with this name, swap to check it
+        if (RenameAt(i_DirFD, s_TempName.c_str(), i_DirFD, s_PackageLinkName.c_str(), RENAME_EXCHANGE) == 0)
         {
-            // Re-link, maybe something wasn't removed correctly (crash)
-            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, s_ContentLinkDirPath +
-                                                                " directory link to " +
-                                                                s_UserDirLinkPath +
-                                                                " already exists.",
-                                           "Content.cpp", __LINE__);
-            
-            if (unlink(s_UserDirLinkPath.c_str()) < 0 || symlink(s_ContentLinkDirPath.c_str(), s_UserDirLinkPath.c_str()) < 0)
+            if (IsSymLink(i_DirFD, s_TempName) == true)
             {
-                throw Exception("Failed to recreate content directory link from " +
-                                s_ContentLinkDirPath +
-                                " to " +
-                                s_UserDirLinkPath +
-                                ": " +
-                                std::string(std::strerror(errno)) +
-                                " (" +
-                                std::to_string(errno) +
-                                ")!");
+                // Re-linked, maybe something wasn't removed correctly (crash)
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, s_TargetPath +
+                                                                    " directory link to " +
+                                                                    s_LinkPath +
+                                                                    " already exists.",
+                                               "Content.cpp", __LINE__);
+                
+                unlinkat(i_DirFD, s_TempName.c_str(), 0);
+                return;
             }
+            
+            // Not a link, restore
+            RenameAt(i_DirFD, s_TempName.c_str(), i_DirFD, s_PackageLinkName.c_str(), RENAME_EXCHANGE);
+            i_Error = EEXIST;
         }
         else
         {
-            throw Exception("Failed to create content directory link from " +
-                            s_ContentLinkDirPath +
-                            " to " +
-                            s_UserDirLinkPath +
-                            ": " +
-                            std::string(std::strerror(errno)) +
-                            " (" +
-                            std::to_string(errno) +
-                            ")!");
+            i_Error = errno;
         }
     }
     
-    // Reset performed
-    b_Reset = true;
-}
-
-//*************************************************************************************
-// Allow Access
-//*************************************************************************************
-
-void Content::SymLink::AllowAccess()
-{
-    std::lock_guard<std::mutex> s_Guard(c_Mutex);
-    
-    if (symlink(s_SourcePath.c_str(), s_LinkPath.c_str()) < 0)
+    if (i_Error == ENOSYS || i_Error == EINVAL)
     {
-        if (errno == EEXIST)
+        // No renameat2 for this kernel or filesystem, rename still replaces atomically
+        if (IsSymLink(i_DirFD, s_PackageLinkName) == true || faccessat(i_DirFD, s_PackageLinkName.c_str(), F_OK, AT_SYMLINK_NOFOLLOW) < 0)
         {
-            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Requested content access link already exists!",
-                                           "Content.cpp", __LINE__);
-            return;
+            if (renameat(i_DirFD, s_TempName.c_str(), i_DirFD, s_PackageLinkName.c_str()) == 0)
+            {
+                return;
+            }
+            
+            i_Error = errno;
         }
         else
         {
-            throw Exception("Failed to link content " +
-                            s_SourcePath +
-                            ": " +
-                            std::string(std::strerror(errno)) +
-                            " (" +
-                            std::to_string(errno) +
-                            ")!");
+            i_Error = EEXIST;
         }
     }
     
-    MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Created access link " +
-                                                        s_LinkPath +
-                                                        " for source " +
-                                                        s_SourcePath,
-                                   "Content.cpp", __LINE__);
+    unlinkat(i_DirFD, s_TempName.c_str(), 0);
+    
+    throw Exception("Failed to install content directory link from " +
+                    s_TargetPath +
+                    " to " +
+                    s_LinkPath +
+                    ": " +
+                    std::string(std::strerror(i_Error)) +
+                    " (" +
+                    std::to_string(i_Error) +
+                    ")!");
 }
 
-void Content::AllowAccess(Type e_Type)
+void Content::Reset(std::string const& s_PackagePath)
 {
-    if (e_Type > TYPE_MAX)
-    {
-        throw Exception("Cannot access content (Uknown type)!");
-    }
-    else if (b_Reset == false)
+    // Lock until end for full reset, no new access operations
+    std::unique_lock<std::shared_mutex> s_Guard(s_ResetMutex);
+    
+    // Set default result
+    b_Reset = false;
+    p_Active = NULL;
+    
+    // Links submitted for the previous package have to be finished first
+    WaitOperations();
+    
+    // Sessions are keyed by the canonical package path
+    std::string s_Package(s_PackagePath);
+    char* p_RealPath = realpath(s_PackagePath.c_str(), NULL);
+    
+    if (p_RealPath != NULL)
     {
-        throw Exception("Cannot access content (Reset missing)!");
+        s_Package = p_RealPath;
+        free(p_RealPath);
     }
     
-    // Link already existing?
-    auto SymLink = m_SymLink.find(e_Type);
-    
-    if (SymLink == m_SymLink.end())
+    if (s_Package.length() > 0 && s_Package[s_Package.length() - 1] != '/')
     {
-        throw Exception("Request link is missing!");
+        s_Package += "/";
     }
     
+    // Open the new package first, invalid packages lose their session
+    std::string s_LinkPath;
+    int i_LinkDirFD;
+    
     try
     {
-        SymLink->second->AllowAccess();
+        i_LinkDirFD = OpenPackageLinkDir(s_Package, s_LinkPath);
     }
     catch (Exception& e)
     {
+        auto It = m_Session.find(s_Package);
+        
+        if (It != m_Session.end())
+        {
+            CloseSession(*(It->second));
+        }
+        
         throw;
     }
-}
-
-//*************************************************************************************
-// Clear Access
-//*************************************************************************************
-
-void Content::SymLink::ClearAccess()
-{
-    std::lock_guard<std::mutex> s_Guard(c_Mutex);
     
-    if (unlink(s_LinkPath.c_str()) < 0)
+    Session* p_Session;
+    
+    try
     {
-        if (errno == ENOENT)
-        {
-            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Requested content access does not exist!",
-                                           "Content.cpp", __LINE__);
-        }
-        else
-        {
-            throw Exception("Failed to remove content link " +
-                            s_LinkPath +
-                            ": " +
-                            std::string(std::strerror(errno)) +
-                            " (" +
-                            std::to_string(errno) +
-                            ")!");
-        }
+        p_Session = &(GetSession(s_Package));
+    }
+    catch (std::exception& e)
+    {
+        CloseDir(i_LinkDirFD);
+        throw Exception("Failed to create package session: " + std::string(e.what()));
     }
-}
-
-void Content::ClearAccess()
-{
-    bool b_Result = true;
     
-    for (auto& SymLink : m_SymLink)
+    p_Session->u64_LastUse = ++u64_ResetCount;
+    
+    // Package already linked in the same dir, only fix what changed
+    if (IsSameDir(i_LinkDirFD, p_Session->i_PackageLinkDirFD) == true)
     {
+        close(i_LinkDirFD);
+        
         try
         {
-            SymLink.second->ClearAccess();
+            UpdateSession(*p_Session);
         }
         catch (Exception& e)
         {
-            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
-                                           "Content.cpp", __LINE__);
-            b_Result = false;
+            CloseSession(*p_Session);
+            throw;
         }
+        
+        p_Active = p_Session;
+        b_Reset = true;
+        return;
     }
     
-    if (b_Result == false)
+    // Unlink all links of this package and the old package link at once
+    FSExecutor::Batch c_Batch;
+    
+    for (MRH_Uint32 u32_Type = 0; u32_Type < u32_TypeCount; ++u32_Type)
     {
-        throw Exception("Failed to reset all content links!");
+        c_Batch.push_back(v_SymLink[u32_Type].GetClearOperation(p_Session->i_LinkDirFD));
     }
-}
-
-//*************************************************************************************
-// Getters
-//*************************************************************************************
-
-std::string Content::SymLink::GetSourcePath() noexcept
-{
-    return s_SourcePath;
-}
-
-std::string Content::SymLink::GetLinkPath() noexcept
-{
-    return s_LinkPath;
-}
-
-bool Content::GetReset() noexcept
-{
-    return b_Reset;
+    
+    if (p_Session->i_PackageLinkDirFD >= 0)
+    {
+        c_Batch.push_back(FSExecutor::Unlink(p_Session->i_PackageLinkDirFD, s_PackageLinkName.c_str()));
+    }
+    
+    try
+    {
+        p_Executor->Execute(c_Batch);
+    }
+    catch (Exception& e)
+    {
+        CloseDir(i_LinkDirFD);
+        throw;
+    }
+    
+    // Reset is the point where the link state matches the filesystem again
+    MRH_Uint32 u32_State = 0;
+    
+    for (size_t i = 0; i < u32_TypeCount; ++i)
+    {
+        if (c_Batch[i].i_Result != 0 && c_Batch[i].i_Result != ENOENT)
+        {
+            u32_State |= TypeMask(i);
+        }
+    }
+    
+    p_Session->u32_LinkState = u32_State;
+    
+    for (auto& Operation : c_Batch)
+    {
+        if (Operation.i_Result != 0 && Operation.i_Result != ENOENT)
+        {
+            CloseDir(i_LinkDirFD);
+            throw Exception("Failed to remove link " +
+                            (Operation.i_DirFD == p_Session->i_PackageLinkDirFD ? p_Session->s_UserDirLinkPath : std::string(Operation.p_Path)) +
+                            ": " +
+                            std::string(std::strerror(Operation.i_Result)) +
+                            " (" +
+                            std::to_string(Operation.i_Result) +
+                            ")!");
+        }
+    }
+    
+    // Reset link dir, no longer in use
+    CloseDir(p_Session->i_PackageLinkDirFD);
+    p_Session->s_UserDirLinkPath = "";
+    
+    // Create main user dir link, whatever is in place was not linked by this session
+    try
+    {
+        InstallPackageLink(i_LinkDirFD, p_Session->s_LinkDirPath, s_LinkPath, false);
+    }
+    catch (Exception& e)
+    {
+        close(i_LinkDirFD);
+        CloseSession(*p_Session);
+        throw;
+    }
+    
+    p_Session->i_PackageLinkDirFD = i_LinkDirFD;
+    p_Session->s_UserDirLinkPath = s_LinkPath;
+    
+    // Reset performed
+    p_Active = p_Session;
+    b_Reset = true;
+}
+
+//*************************************************************************************
+// Session
+//*************************************************************************************
+
+Content::Session& Content::GetSession(std::string const& s_PackagePath)
+{
+    auto It = m_Session.find(s_PackagePath);
+    
+    if (It != m_Session.end())
+    {
+        return *(It->second);
+    }
+    
+    // Prefer unused sessions, otherwise replace the least recently used
+    Session* p_Session = &(v_Session[0]);
+    
+    for (auto& Session : v_Session)
+    {
+        if (Session.s_PackagePath.length() == 0)
+        {
+            p_Session = &Session;
+            break;
+        }
+        else if (Session.u64_LastUse < p_Session->u64_LastUse)
+        {
+            p_Session = &Session;
+        }
+    }
+    
+    if (p_Session->s_PackagePath.length() > 0)
+    {
+        CloseSession(*p_Session);
+    }
+    
+    m_Session.emplace(s_PackagePath, p_Session);
+    p_Session->s_PackagePath = s_PackagePath;
+    
+    return *p_Session;
+}
+
+void Content::UpdateSession(Session& c_Session)
+{
+    FSExecutor::Batch c_Batch;
+    std::vector<MRH_Uint32> v_Type;
+    MRH_Uint32 u32_State = 0;
+    char p_Target[PATH_MAX];
+    ssize_t ss_Length;
+    
+    // Single pass over existing links, only wrong ones are removed
+    for (size_t i = 0; i < u32_TypeCount; ++i)
+    {
+        // Not a link fails with EINVAL and is removed as well
+        if ((ss_Length = readlinkat(c_Session.i_LinkDirFD, v_SymLink[i].GetLinkName(), p_Target, sizeof(p_Target))) < 0 && errno == ENOENT)
+        {
+            continue;
+        }
+        else if (b_KeepAccess == true && ss_Length >= 0 &&
+                 static_cast<size_t>(ss_Length) == std::strlen(v_SymLink[i].GetSourcePath()) &&
+                 std::memcmp(p_Target, v_SymLink[i].GetSourcePath(), ss_Length) == 0)
+        {
+            // Left by another package or an interrupted reset otherwise
+            u32_State |= TypeMask(i);
+            continue;
+        }
+        
+        c_Batch.push_back(v_SymLink[i].GetClearOperation(c_Session.i_LinkDirFD));
+        v_Type.push_back(TypeMask(i));
+    }
+    
+    if (c_Batch.size() > 0)
+    {
+        p_Executor->Execute(c_Batch);
+        
+        for (size_t i = 0; i < c_Batch.size(); ++i)
+        {
+            if (c_Batch[i].i_Result != 0 && c_Batch[i].i_Result != ENOENT)
+            {
+                u32_State |= v_Type[i];
+            }
+        }
+    }
+    
+    c_Session.u32_LinkState = u32_State;
+    
+    for (auto& Operation : c_Batch)
+    {
+        if (Operation.i_Result != 0 && Operation.i_Result != ENOENT)
+        {
+            throw Exception("Failed to remove link " +
+                            std::string(Operation.p_Path) +
+                            ": " +
+                            std::string(std::strerror(Operation.i_Result)) +
+                            " (" +
+                            std::to_string(Operation.i_Result) +
+                            ")!");
+        }
+    }
+    
+    // Package link still pointing to the session?
+    ss_Length = readlinkat(c_Session.i_PackageLinkDirFD, s_PackageLinkName.c_str(), p_Target, sizeof(p_Target));
+    
+    if (ss_Length < 0 || c_Session.s_LinkDirPath.compare(0, std::string::npos, p_Target, ss_Length) != 0)
+    {
+        InstallPackageLink(c_Session.i_PackageLinkDirFD, c_Session.s_LinkDirPath, c_Session.s_UserDirLinkPath, true);
+    }
+}
+
+void Content::CloseSession(Session& c_Session) noexcept
+{
+    // @NOTE: Called during reset, no access operations are running
+    FSExecutor::Batch c_Batch;
+    
+    for (MRH_Uint32 u32_Type = 0; u32_Type < u32_TypeCount; ++u32_Type)
+    {
+        c_Batch.push_back(v_SymLink[u32_Type].GetClearOperation(c_Session.i_LinkDirFD));
+    }
+    
+    if (c_Session.i_PackageLinkDirFD >= 0)
+    {
+        c_Batch.push_back(FSExecutor::Unlink(c_Session.i_PackageLinkDirFD, s_PackageLinkName.c_str()));
+    }
+    
+    try
+    {
+        p_Executor->Execute(c_Batch);
+        
+        for (auto& Operation : c_Batch)
+        {
+            if (Operation.i_Result != 0 && Operation.i_Result != ENOENT)
+            {
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to remove link " +
+                                                                     (Operation.i_DirFD == c_Session.i_PackageLinkDirFD ? c_Session.s_UserDirLinkPath : std::string(Operation.p_Path)) +
+                                                                     ": " +
+                                                                     std::string(std::strerror(Operation.i_Result)) +
+                                                                     " (" +
+                                                                     std::to_string(Operation.i_Result) +
+                                                                     ")!",
+                                               "Content.cpp", __LINE__);
+            }
+        }
+    }
+    catch (Exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "Content.cpp", __LINE__);
+    }
+    
+    MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Closed content session for package " +
+                                                        c_Session.s_PackagePath,
+                                   "Content.cpp", __LINE__);
+    
+    m_Session.erase(c_Session.s_PackagePath);
+    
+    if (p_Active == &c_Session)
+    {
+        p_Active = NULL;
+    }
+    
+    CloseDir(c_Session.i_PackageLinkDirFD);
+    c_Session.s_PackagePath = "";
+    c_Session.s_UserDirLinkPath = "";
+    c_Session.u32_LinkState = 0;
+    c_Session.u64_LastUse = 0;
+}
+
+//*************************************************************************************
+// Allow Access
+//*************************************************************************************
+
+FSExecutor::Operation Content::SymLink::GetAllowOperation(int i_LinkDirFD) const noexcept
+{
+    return FSExecutor::SymLink(s_SourcePath.c_str(), i_LinkDirFD, s_LinkName.c_str());
+}
+
+void Content::AllowAccess(MRH_Uint32 u32_Type, Completion c_Completion)
+{
+    if (u32_Type >= u32_TypeCount)
+    {
+        throw Exception("Cannot access content (Uknown type)!");
+    }
+    
+    // Shared, only reset needs exclusive access
+    std::shared_lock<std::shared_mutex> s_Guard(s_ResetMutex);
+    
+    if (b_Reset == false || p_Active == NULL)
+    {
+        throw Exception("Cannot access content (Reset missing)!");
+    }
+    
+    Session* p_Session = p_Active;
+    
+    SymLink* p_SymLink = &(v_SymLink[u32_Type]);
+    MRH_Uint32 u32_Mask = TypeMask(u32_Type);
+    
+    // Nothing to do if already linked
+    if ((p_Session->u32_LinkState & u32_Mask) != 0)
+    {
+        p_SymLink->SkipAllow();
+        c_Completion(true);
+        return;
+    }
+    
+    MRH_Uint64 u64_Key = GetPendingKey(u32_Type);
+    bool b_Linked = false;
+    
+    {
+        std::lock_guard<std::mutex> s_PendingGuard(s_PendingMutex);
+        auto It = m_Pending.find(u64_Key);
+        
+        if ((p_Session->u32_LinkState & u32_Mask) != 0)
+        {
+            // Linked while checking, state is set before the operation is removed
+            b_Linked = true;
+        }
+        else if (It != m_Pending.end())
+        {
+            // Already being linked, answered by the running operation
+            It->second.push_back(c_Completion);
+            p_SymLink->SkipAllow();
+            return;
+        }
+        else
+        {
+            m_Pending.emplace(u64_Key, std::vector<Completion>({ c_Completion }));
+        }
+    }
+    
+    if (b_Linked == true)
+    {
+        p_SymLink->SkipAllow();
+        c_Completion(true);
+        return;
+    }
+    
+    try
+    {
+        SubmitLink(p_Session, u32_Type, u64_Key);
+    }
+    catch (std::exception& e)
+    {
+        // The caller gets the exception, requests attached meanwhile fail
+        std::vector<Completion> v_Completion(TakePending(u64_Key));
+        
+        for (size_t i = 1; i < v_Completion.size(); ++i)
+        {
+            v_Completion[i](false);
+        }
+        
+        throw;
+    }
+}
+
+void Content::AllowAccessMask(MRH_Uint32 u32_TypeMask, MaskCompletion c_Completion)
+{
+    if (u32_TypeMask == 0 || (u32_TypeMask & ~u32_TypeMaskAll) != 0)
+    {
+        throw Exception("Cannot access content (Uknown type)!");
+    }
+    
+    std::shared_lock<std::shared_mutex> s_Guard(s_ResetMutex);
+    
+    if (b_Reset == false || p_Active == NULL)
+    {
+        throw Exception("Cannot access content (Reset missing)!");
+    }
+    
+    Session* p_Session = p_Active;
+    
+    // Built before anything is registered, nothing to undo on failure
+    std::shared_ptr<MaskRequest> p_Request(std::make_shared<MaskRequest>());
+    FSExecutor::Batch c_Batch;
+    std::vector<MRH_Uint64> v_Attached;
+    
+    p_Request->p_Session = p_Session;
+    p_Request->c_Completion = c_Completion;
+    p_Request->u64_Key = GetPendingKey(0);
+    p_Request->u32_Owned = 0;
+    p_Request->u32_Created = 0;
+    p_Request->u32_Existed = 0;
+    
+    c_Batch.reserve(u32_TypeCount);
+    v_Attached.reserve(u32_TypeCount);
+    
+    FSExecutor::Completion c_Linked = [this, p_Request](FSExecutor::Batch& c_Batch)
+    {
+        MRH_Uint32 u32_Failed = 0;
+        size_t us_Pos = 0;
+        
+        // Batch holds the owned types in order
+        for (size_t i = 0; i < u32_TypeCount; ++i)
+        {
+            MRH_Uint32 u32_Type = TypeMask(i);
+            
+            if ((p_Request->u32_Owned & u32_Type) == 0)
+            {
+                continue;
+            }
+            
+            FSExecutor::Operation& Operation = c_Batch[us_Pos++];
+            
+            if (Operation.i_Result == 0)
+            {
+                p_Request->u32_Created |= u32_Type;
+            }
+            else if (Operation.i_Result == EEXIST)
+            {
+                p_Request->u32_Existed |= u32_Type;
+            }
+            else
+            {
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to link content " +
+                                                                     std::string(Operation.p_Target) +
+                                                                     ": " +
+                                                                     std::string(std::strerror(Operation.i_Result)) +
+                                                                     " (" +
+                                                                     std::to_string(Operation.i_Result) +
+                                                                     ")!",
+                                               "Content.cpp", __LINE__);
+                u32_Failed |= u32_Type;
+            }
+        }
+        
+        CountMask(p_Request, u32_Failed);
+    };
+    
+    BeginOperation();
+    
+    {
+        std::lock_guard<std::mutex> s_PendingGuard(s_PendingMutex);
+        MRH_Uint32 u32_Remaining = 0;
+        
+        try
+        {
+            for (size_t i = 0; i < u32_TypeCount; ++i)
+            {
+                MRH_Uint32 u32_Type = TypeMask(i);
+                
+                if ((u32_TypeMask & u32_Type) == 0)
+                {
+                    continue;
+                }
+                else if ((p_Session->u32_LinkState & u32_Type) != 0)
+                {
+                    v_SymLink[i].SkipAllow();
+                    continue;
+                }
+                
+                MRH_Uint64 u64_Key = p_Request->u64_Key + i;
+                auto It = m_Pending.find(u64_Key);
+                
+                if (It != m_Pending.end())
+                {
+                    // Already being linked, counted once the running operation finished
+                    It->second.push_back([this, p_Request, u32_Type](bool b_Result)
+                    {
+                        CountMask(p_Request, (b_Result == true ? 0 : u32_Type));
+                    });
+                    
+                    v_Attached.push_back(u64_Key);
+                    v_SymLink[i].SkipAllow();
+                    ++u32_Remaining;
+                }
+                else
+                {
+                    // Nobody waits yet, the request answers every waiter once finished
+                    m_Pending.emplace(u64_Key, std::vector<Completion>());
+                    
+                    c_Batch.push_back(v_SymLink[i].GetAllowOperation(p_Session->i_LinkDirFD));
+                    p_Request->u32_Owned |= u32_Type;
+                }
+            }
+        }
+        catch (std::exception& e)
+        {
+            // Registered under this lock, nobody could attach yet
+            for (size_t i = 0; i < u32_TypeCount; ++i)
+            {
+                if ((p_Request->u32_Owned & TypeMask(i)) != 0)
+                {
+                    m_Pending.erase(p_Request->u64_Key + i);
+                }
+            }
+            
+            for (auto& Attached : v_Attached)
+            {
+                m_Pending.find(Attached)->second.pop_back();
+            }
+            
+            EndOperation();
+            throw;
+        }
+        
+        if (p_Request->u32_Owned != 0)
+        {
+            ++u32_Remaining;
+        }
+        
+        // Set before any waited for operation can count
+        p_Request->u32_Remaining = u32_Remaining;
+    }
+    
+    // All requested types already linked?
+    if (p_Request->u32_Remaining == 0)
+    {
+        EndOperation();
+        c_Completion(0);
+        return;
+    }
+    else if (p_Request->u32_Owned == 0)
+    {
+        return;
+    }
+    
+    try
+    {
+        p_Executor->Submit(std::move(c_Batch), std::move(c_Linked));
+    }
+    catch (std::exception& e)
+    {
+        // Answered by the completion, like a failed link
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "Content.cpp", __LINE__);
+        
+        CountMask(p_Request, p_Request->u32_Owned);
+    }
+}
+
+void Content::SubmitLink(Session* p_Session, MRH_Uint32 u32_Type, MRH_Uint64 u64_Key)
+{
+    SymLink* p_SymLink = &(v_SymLink[u32_Type]);
+    MRH_Uint32 u32_Mask = TypeMask(u32_Type);
+    
+    // Built before the operation is counted, nothing to undo on failure
+    FSExecutor::Batch c_Batch({ p_SymLink->GetAllowOperation(p_Session->i_LinkDirFD) });
+    FSExecutor::Completion c_Linked = [this, p_Session, p_SymLink, u32_Mask, u64_Key](FSExecutor::Batch& c_Batch)
+    {
+        int i_Result = c_Batch[0].i_Result;
+        
+        if (i_Result == 0 || i_Result == EEXIST)
+        {
+            p_Session->u32_LinkState |= u32_Mask;
+        }
+        
+        if (i_Result == 0)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Created access link " +
+                                                                std::string(p_SymLink->GetLinkName()) +
+                                                                " for source " +
+                                                                p_SymLink->GetSourcePath(),
+                                           "Content.cpp", __LINE__);
+        }
+        else if (i_Result == EEXIST)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Requested content access link already exists!",
+                                           "Content.cpp", __LINE__);
+        }
+        else
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to link content " +
+                                                                 std::string(p_SymLink->GetSourcePath()) +
+                                                                 ": " +
+                                                                 std::string(std::strerror(i_Result)) +
+                                                                 " (" +
+                                                                 std::to_string(i_Result) +
+                                                                 ")!",
+                                           "Content.cpp", __LINE__);
+        }
+        
+        // Answer every request which waited for this link
+        AnswerPending(u64_Key, i_Result == 0 || i_Result == EEXIST);
+        EndOperation();
+    };
+    
+    BeginOperation();
+    
+    try
+    {
+        p_Executor->Submit(std::move(c_Batch), std::move(c_Linked));
+    }
+    catch (std::exception& e)
+    {
+        EndOperation();
+        throw;
+    }
+}
+
+void Content::CountMask(std::shared_ptr<MaskRequest> const& p_Request, MRH_Uint32 u32_Failed) noexcept
+{
+    if (u32_Failed != 0)
+    {
+        p_Request->u32_Failed.fetch_or(u32_Failed);
+    }
+    
+    if (p_Request->u32_Remaining.fetch_sub(1) == 1)
+    {
+        FinishMask(p_Request);
+    }
+}
+
+void Content::FinishMask(std::shared_ptr<MaskRequest> const& p_Request) noexcept
+{
+    Session* p_Session = p_Request->p_Session;
+    MRH_Uint32 u32_Failed = p_Request->u32_Failed;
+    MRH_Uint32 u32_Rollback = 0;
+    
+    for (size_t i = 0; i < u32_TypeCount; ++i)
+    {
+        MRH_Uint32 u32_Type = TypeMask(i);
+        MRH_Uint64 u64_Key = p_Request->u64_Key + i;
+        
+        if ((p_Request->u32_Owned & u32_Type) == 0)
+        {
+            continue;
+        }
+        else if ((u32_Failed & u32_Type) != 0)
+        {
+            AnswerPending(u64_Key, false);
+            continue;
+        }
+        else if (u32_Failed != 0 && (p_Request->u32_Created & u32_Type) != 0)
+        {
+            // Created by this request, keep it only if another request waits
+            std::lock_guard<std::mutex> s_PendingGuard(s_PendingMutex);
+            auto It = m_Pending.find(u64_Key);
+            
+            if (It == m_Pending.end() || It->second.size() == 0)
+            {
+                u32_Rollback |= u32_Type;
+                continue;
+            }
+        }
+        
+        // State is set before the operation is removed
+        p_Session->u32_LinkState |= u32_Type;
+        AnswerPending(u64_Key, true);
+    }
+    
+    if (u32_Failed == 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Created access links for content mask " +
+                                                            std::to_string(p_Request->u32_Owned),
+                                       "Content.cpp", __LINE__);
+    }
+    
+    if (u32_Rollback == 0)
+    {
+        p_Request->c_Completion(u32_Failed);
+        EndOperation();
+        return;
+    }
+    
+    // Failed, remove the links nobody else waits for
+    // @NOTE: The pending operations are kept, requests attaching meanwhile 
+    //        wait for the removal instead of linking concurrently
+    try
+    {
+        FSExecutor::Batch c_Batch;
+        
+        for (size_t i = 0; i < u32_TypeCount; ++i)
+        {
+            if ((u32_Rollback & TypeMask(i)) != 0)
+            {
+                c_Batch.push_back(v_SymLink[i].GetClearOperation(p_Session->i_LinkDirFD));
+            }
+        }
+        
+        p_Executor->Submit(std::move(c_Batch), [this, p_Request, u32_Rollback](FSExecutor::Batch& c_Batch)
+        {
+            Session* p_Session = p_Request->p_Session;
+            size_t us_Pos = 0;
+            
+            for (size_t i = 0; i < u32_TypeCount; ++i)
+            {
+                MRH_Uint32 u32_Type = TypeMask(i);
+                MRH_Uint64 u64_Key = p_Request->u64_Key + i;
+                
+                if ((u32_Rollback & u32_Type) == 0)
+                {
+                    continue;
+                }
+                
+                FSExecutor::Operation& Operation = c_Batch[us_Pos++];
+                
+                if (Operation.i_Result != 0 && Operation.i_Result != ENOENT)
+                {
+                    MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to remove content link " +
+                                                                         std::string(Operation.p_Path) +
+                                                                         ": " +
+                                                                         std::string(std::strerror(Operation.i_Result)) +
+                                                                         " (" +
+                                                                         std::to_string(Operation.i_Result) +
+                                                                         ")!",
+                                                   "Content.cpp", __LINE__);
+                    
+                    p_Session->u32_LinkState |= u32_Type;
+                    AnswerPending(u64_Key, true);
+                    continue;
+                }
+                
+                bool b_Waiting = false;
+                
+                {
+                    std::lock_guard<std::mutex> s_PendingGuard(s_PendingMutex);
+                    auto It = m_Pending.find(u64_Key);
+                    
+                    if (It != m_Pending.end() && It->second.size() > 0)
+                    {
+                        b_Waiting = true;
+                    }
+                    else if (It != m_Pending.end())
+                    {
+                        m_Pending.erase(It);
+                    }
+                }
+                
+                // Requests attached during the removal need the link again
+                if (b_Waiting == true)
+                {
+                    try
+                    {
+                        SubmitLink(p_Session, static_cast<MRH_Uint32>(i), u64_Key);
+                    }
+                    catch (std::exception& e)
+                    {
+                        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                                       "Content.cpp", __LINE__);
+                        AnswerPending(u64_Key, false);
+                    }
+                }
+            }
+            
+            p_Request->c_Completion(p_Request->u32_Failed);
+            EndOperation();
+        });
+    }
+    catch (std::exception& e)
+    {
+        // Keep the links, the link state matches the filesystem
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to remove content links: " +
+                                                             std::string(e.what()),
+                                       "Content.cpp", __LINE__);
+        
+        for (size_t i = 0; i < u32_TypeCount; ++i)
+        {
+            if ((u32_Rollback & TypeMask(i)) != 0)
+            {
+                p_Session->u32_LinkState |= TypeMask(i);
+                AnswerPending(p_Request->u64_Key + i, true);
+            }
+        }
+        
+        p_Request->c_Completion(u32_Failed);
+        EndOperation();
+    }
+}
+
+//*************************************************************************************
+// Clear Access
+//*************************************************************************************
+
+FSExecutor::Operation Content::SymLink::GetClearOperation(int i_LinkDirFD) const noexcept
+{
+    return FSExecutor::Unlink(i_LinkDirFD, s_LinkName.c_str());
+}
+
+void Content::ClearAccess(Completion c_Completion)
+{
+    std::shared_lock<std::shared_mutex> s_Guard(s_ResetMutex);
+    
+    // No package, nothing linked
+    if (p_Active == NULL)
+    {
+        c_Completion(true);
+        return;
+    }
+    
+    Session* p_Session = p_Active;
+    FSExecutor::Batch c_Batch;
+    std::vector<MRH_Uint32> v_Type;
+    MRH_Uint32 u32_State = p_Session->u32_LinkState;
+    
+    // Only remove links which exist
+    for (size_t i = 0; i < u32_TypeCount; ++i)
+    {
+        MRH_Uint32 u32_Type = TypeMask(i);
+        
+        if ((u32_State & u32_Type) == 0)
+        {
+            v_SymLink[i].SkipClear();
+            continue;
+        }
+        
+        c_Batch.push_back(v_SymLink[i].GetClearOperation(p_Session->i_LinkDirFD));
+        v_Type.push_back(u32_Type);
+    }
+    
+    if (c_Batch.size() == 0)
+    {
+        c_Completion(true);
+        return;
+    }
+    
+    // Built before the operation is counted, nothing to undo on failure
+    FSExecutor::Completion c_Cleared = [this, p_Session, v_Type, c_Completion](FSExecutor::Batch& c_Batch)
+    {
+        bool b_Result = true;
+        
+        for (size_t i = 0; i < c_Batch.size(); ++i)
+        {
+            FSExecutor::Operation& Operation = c_Batch[i];
+            
+            if (Operation.i_Result == ENOENT)
+            {
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Requested content access does not exist!",
+                                               "Content.cpp", __LINE__);
+            }
+            else if (Operation.i_Result != 0)
+            {
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to remove content link " +
+                                                                     std::string(Operation.p_Path) +
+                                                                     ": " +
+                                                                     std::string(std::strerror(Operation.i_Result)) +
+                                                                     " (" +
+                                                                     std::to_string(Operation.i_Result) +
+                                                                     ")!",
+                                               "Content.cpp", __LINE__);
+                b_Result = false;
+                continue;
+            }
+            
+            p_Session->u32_LinkState &= ~v_Type[i];
+        }
+        
+        if (b_Result == false)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to reset all content links!",
+                                           "Content.cpp", __LINE__);
+        }
+        
+        c_Completion(b_Result);
+        EndOperation();
+    };
+    
+    BeginOperation();
+    
+    try
+    {
+        p_Executor->Submit(std::move(c_Batch), std::move(c_Cleared));
+    }
+    catch (std::exception& e)
+    {
+        EndOperation();
+        throw;
+    }
+}
+
+//*************************************************************************************
+// Operations
+//*************************************************************************************
+
+void Content::BeginOperation() noexcept
+{
+    std::lock_guard<std::mutex> s_Guard(s_OperationMutex);
+    ++u32_Operations;
+}
+
+void Content::EndOperation() noexcept
+{
+    std::lock_guard<std::mutex> s_Guard(s_OperationMutex);
+    
+    if (--u32_Operations == 0)
+    {
+        s_OperationCondition.notify_all();
+    }
+}
+
+void Content::WaitOperations() noexcept
+{
+    std::unique_lock<std::mutex> s_Lock(s_OperationMutex);
+    s_OperationCondition.wait(s_Lock, [this] { return u32_Operations == 0; });
+}
+
+MRH_Uint64 Content::GetPendingKey(MRH_Uint32 u32_Type) const noexcept
+{
+    // Every reset starts a new epoch, operations never outlive a reset
+    return u64_ResetCount * TYPE_LIMIT + u32_Type;
+}
+
+std::vector<Content::Completion> Content::TakePending(MRH_Uint64 u64_Key) noexcept
+{
+    std::lock_guard<std::mutex> s_PendingGuard(s_PendingMutex);
+    std::vector<Completion> v_Completion;
+    auto It = m_Pending.find(u64_Key);
+    
+    if (It != m_Pending.end())
+    {
+        v_Completion.swap(It->second);
+        m_Pending.erase(It);
+    }
+    
+    return v_Completion;
+}
+
+void Content::AnswerPending(MRH_Uint64 u64_Key, bool b_Result) noexcept
+{
+    std::vector<Completion> v_Completion(TakePending(u64_Key));
+    
+    for (auto& Completion : v_Completion)
+    {
+        Completion(b_Result);
+    }
+}
+
+//*************************************************************************************
+// Skipped
+//*************************************************************************************
+
+void Content::SymLink::SkipAllow() noexcept
+{
+    u64_SkippedAllow.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Content::SymLink::SkipClear() noexcept
+{
+    u64_SkippedClear.fetch_add(1, std::memory_order_relaxed);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+const char* Content::SymLink::GetSourcePath() const noexcept
+{
+    return s_SourcePath.c_str();
+}
+
+const char* Content::SymLink::GetLinkName() const noexcept
+{
+    return s_LinkName.c_str();
+}
+
+MRH_Uint64 Content::SymLink::GetSkippedAllow() const noexcept
+{
+    return u64_SkippedAllow.load(std::memory_order_relaxed);
+}
+
+MRH_Uint64 Content::SymLink::GetSkippedClear() const noexcept
+{
+    return u64_SkippedClear.load(std::memory_order_relaxed);
+}
+
+bool Content::GetReset() noexcept
+{
+    return b_Reset;
+}
+
+MRH_Uint32 Content::GetTypeCount() const noexcept
+{
+    return u32_TypeCount;
+}
+
+MRH_Uint32 Content::GetTypeMask() const noexcept
+{
+    return u32_TypeMaskAll;
+}
+
+MRH_Uint64 Content::GetSkippedOperations() noexcept
+{
+    MRH_Uint64 u64_Skipped = 0;
+    
+    for (MRH_Uint32 u32_Type = 0; u32_Type < u32_TypeCount; ++u32_Type)
+    {
+        u64_Skipped += v_SymLink[u32_Type].GetSkippedAllow() + v_SymLink[u32_Type].GetSkippedClear();
+    }
+    
+    return u64_Skipped;
 }
@@ -18,15 +18,35 @@
 #define Content_h
 
 // C / C++
+#include <climits>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 #include <atomic>
+#include <array>
+#include <vector>
 #include <unordered_map>
+#include <string>
+#include <memory>
+#include <functional>
 
 // External
 
 // Project
+#include "./FSExecutor.h"
 #include "../Configuration.h"
 
+// Pre-defined
+#ifndef MRH_USER_CONTENT_SESSION_COUNT
+    #define MRH_USER_CONTENT_SESSION_COUNT 4
+#endif
+#ifndef MRH_USER_CACHE_LINE_SIZE
+    #define MRH_USER_CACHE_LINE_SIZE 64
+#endif
+#ifndef PATH_MAX
+    #define PATH_MAX 4096
+#endif
+
 
 class Content
 {
@@ -36,6 +56,7 @@ public:
     // Types
     //*************************************************************************************
 
+    // Built-in content types, configured types follow
     typedef enum
     {
         DOCUMENTS = 0,
@@ -53,6 +74,28 @@ public:
         
     }Type;
     
+    // One mask bit per type
+    static constexpr MRH_Uint32 TYPE_LIMIT = sizeof(MRH_Uint32) * 8;
+    
+    /**
+     *  Get the mask bit for a content type.
+     *
+     *  \param u32_Type The content type.
+     *
+     *  \return The content type mask bit.
+     */
+    
+    static constexpr MRH_Uint32 TypeMask(MRH_Uint32 u32_Type) noexcept
+    {
+        return static_cast<MRH_Uint32>(1) << u32_Type;
+    }
+    
+    // Called with the operation result once finished
+    typedef std::function<void(bool)> Completion;
+    
+    // Called with the mask of failed content types once finished
+    typedef std::function<void(MRH_Uint32)> MaskCompletion;
+    
     //*************************************************************************************
     // Constructor / Destructor
     //*************************************************************************************
@@ -84,7 +127,12 @@ public:
     //*************************************************************************************
     
     /**
-     *  Reset setup user content. This function is thread safe.
+     *  Reset user content for a package and make it the active package. 
+     *  Links of other packages are kept. Resetting the same package again 
+     *  only repairs changed links. Waits for running access operations 
+     *  and blocks new ones until finished. No package is active if the 
+     *  reset fails, the links of the previous package are kept. This 
+     *  function is thread safe.
      *
      *  \param s_PackagePath The full path to the current application package.
      */
@@ -96,22 +144,42 @@ public:
     //*************************************************************************************
     
     /**
-     *  Allow access to the requested user content. This function is thread safe.
+     *  Allow access to the requested user content for the active package. 
+     *  The link is created asynchronously. Requests for a type which is 
+     *  already being linked wait for the running operation and receive 
+     *  its result. This function is thread safe.
      *
-     *  \param e_Type The content type to allow access for.
+     *  \param u32_Type The content type to allow access for.
+     *  \param c_Completion The completion to call with the result.
      */
     
-    void AllowAccess(Type e_Type);
+    void AllowAccess(MRH_Uint32 u32_Type, Completion c_Completion);
+    
+    /**
+     *  Allow access to multiple user content types at once for the active 
+     *  package. Either all requested types are linked or none, links created 
+     *  by this request are removed on failure unless another request waits 
+     *  for them. The links are created asynchronously. This function is 
+     *  thread safe.
+     *
+     *  \param u32_TypeMask The content types to allow access for, one bit per type.
+     *  \param c_Completion The completion to call with the failed content types.
+     */
+    
+    void AllowAccessMask(MRH_Uint32 u32_TypeMask, MaskCompletion c_Completion);
     
     //*************************************************************************************
     // Clear Access
     //*************************************************************************************
     
     /**
-     *  Clear all user content access. This function is thread safe.
+     *  Clear all user content access for the active package. The links are 
+     *  removed asynchronously. This function is thread safe.
+     *
+     *  \param c_Completion The completion to call with the result.
      */
     
-    void ClearAccess();
+    void ClearAccess(Completion c_Completion);
     
     //*************************************************************************************
     // Getters
@@ -125,13 +193,39 @@ public:
     
     bool GetReset() noexcept;
     
+    /**
+     *  Get the number of content types.
+     *
+     *  \return The number of built-in and configured content types.
+     */
+    
+    MRH_Uint32 GetTypeCount() const noexcept;
+    
+    /**
+     *  Get the mask of all content types.
+     *
+     *  \return The content type mask.
+     */
+    
+    MRH_Uint32 GetTypeMask() const noexcept;
+    
+    /**
+     *  Get the number of link operations skipped because the link was already 
+     *  in the requested state. This function is thread safe.
+     *
+     *  \return The number of skipped link operations.
+     */
+    
+    MRH_Uint64 GetSkippedOperations() noexcept;
+    
 private:
 
     //*************************************************************************************
     // Content Link
     //*************************************************************************************
     
-    class SymLink
+    // Each link on its own cache line, grants for different types share nothing
+    class alignas(MRH_USER_CACHE_LINE_SIZE) SymLink
     {
     public:
         
@@ -141,13 +235,17 @@ private:
         
         /**
          *  Default constructor.
+         */
+        
+        SymLink() noexcept;
+        
+        /**
+         *  Copy constructor. Disabled for this class.
          *
-         *  \param s_SourcePath The full path to the source directory.
-         *  \param s_LinkPath The full path to the new link directory.
+         *  \param s_SymLink SymLink class source.
          */
         
-        SymLink(std::string const& s_SourcePath,
-                std::string const& s_LinkPath) noexcept;
+        SymLink(SymLink const& s_SymLink) = delete;
         
         /**
          *  Default destructor.
@@ -156,44 +254,93 @@ private:
         ~SymLink() noexcept;
         
         //*************************************************************************************
-        // Allow Access
+        // Setup
+        //*************************************************************************************
+        
+        /**
+         *  Set the link paths.
+         *
+         *  \param s_SourcePath The full path to the source directory.
+         *  \param s_LinkName The link name inside a link directory.
+         */
+        
+        void Setup(std::string const& s_SourcePath, std::string const& s_LinkName);
+        
+        //*************************************************************************************
+        // Operation
         //*************************************************************************************
         
         /**
-         *  Allow access to user content. This function is thread safe.
+         *  Get the operation creating the content link.
+         *
+         *  \param i_LinkDirFD The directory file descriptor for the link directory.
+         *
+         *  \return The link operation.
+         */
+        
+        FSExecutor::Operation GetAllowOperation(int i_LinkDirFD) const noexcept;
+        
+        /**
+         *  Get the operation removing the content link.
+         *
+         *  \param i_LinkDirFD The directory file descriptor for the link directory.
+         *
+         *  \return The unlink operation.
          */
         
-        void AllowAccess();
+        FSExecutor::Operation GetClearOperation(int i_LinkDirFD) const noexcept;
         
         //*************************************************************************************
-        // Clear Access
+        // Skipped
         //*************************************************************************************
         
         /**
-         *  Clear user content access. This function is thread safe.
+         *  Count a skipped link operation.
          */
         
-        void ClearAccess();
+        void SkipAllow() noexcept;
+        
+        /**
+         *  Count a skipped unlink operation.
+         */
+        
+        void SkipClear() noexcept;
         
         //*************************************************************************************
         // Getters
         //*************************************************************************************
         
         /**
-         *  Get the content source path. This function is thread safe.
+         *  Get the content source path.
          *
          *  \return The full content source path.
          */
         
-        std::string GetSourcePath() noexcept;
+        const char* GetSourcePath() const noexcept;
+        
+        /**
+         *  Get the content link name.
+         *
+         *  \return The content link name inside a link directory.
+         */
+        
+        const char* GetLinkName() const noexcept;
+        
+        /**
+         *  Get the number of skipped link operations.
+         *
+         *  \return The skipped link operations.
+         */
+        
+        MRH_Uint64 GetSkippedAllow() const noexcept;
         
         /**
-         *  Get the content link path. This function is thread safe.
+         *  Get the number of skipped unlink operations.
          *
-         *  \return The full content link path.
+         *  \return The skipped unlink operations.
          */
         
-        std::string GetLinkPath() noexcept;
+        MRH_Uint64 GetSkippedClear() const noexcept;
         
     private:
         
@@ -201,15 +348,67 @@ private:
         // Data
         //*************************************************************************************
         
-        std::mutex c_Mutex;
+        // Written per request, kept in the first line
+        std::atomic<MRH_Uint64> u64_SkippedAllow;
+        std::atomic<MRH_Uint64> u64_SkippedClear;
         
-        std::string s_SourcePath;
-        std::string s_LinkPath;
+        // Read only after setup, starts on the next line
+        alignas(MRH_USER_CACHE_LINE_SIZE) std::string s_SourcePath;
+        std::string s_LinkName;
         
     protected:
         
     };
     
+    //*************************************************************************************
+    // Package Session
+    //*************************************************************************************
+    
+    typedef struct Session_t
+    {
+        // Empty if the session is unused
+        std::string s_PackagePath;
+        
+        // Package "_User" link, full path only kept for messages
+        std::string s_UserDirLinkPath;
+        int i_PackageLinkDirFD;
+        
+        // Content links for this package
+        std::string s_LinkDirPath;
+        int i_LinkDirFD;
+        
+        // Existing content links, one bit per type, read by every request
+        // and only written on link changes, so it gets a line of its own
+        alignas(MRH_USER_CACHE_LINE_SIZE) std::atomic<MRH_Uint32> u32_LinkState;
+        
+        // Reset counter value of the last use
+        MRH_Uint64 u64_LastUse;
+        
+    }Session;
+    
+    //*************************************************************************************
+    // Mask Request
+    //*************************************************************************************
+    
+    typedef struct MaskRequest_t
+    {
+        Session* p_Session;
+        MaskCompletion c_Completion;
+        
+        // Pending key of the first type, types follow in order
+        MRH_Uint64 u64_Key;
+        
+        // Types linked by this request, results are set before the batch is counted
+        MRH_Uint32 u32_Owned;
+        MRH_Uint32 u32_Created;
+        MRH_Uint32 u32_Existed;
+        
+        // Unanswered types linked by other requests and the own batch
+        std::atomic<MRH_Uint32> u32_Remaining;
+        std::atomic<MRH_Uint32> u32_Failed;
+        
+    }MaskRequest;
+    
     //*************************************************************************************
     // Setup
     //*************************************************************************************
@@ -217,58 +416,246 @@ private:
     /**
      *  Check and create a directory.
      *
-     *  \param s_DirPath The full directory path.
+     *  \param i_DirFD The directory file descriptor the path is relative to.
+     *  \param s_DirPath The directory path.
      */
     
-    void CheckDir(std::string s_DirPath);
+    void CheckDir(int i_DirFD, std::string s_DirPath);
     
     /**
      *  Check and create a file.
      *
-     *  \param s_FilePath The full file path.
+     *  \param i_DirFD The directory file descriptor the path is relative to.
+     *  \param s_FilePath The file path.
+     */
+    
+    void CheckFile(int i_DirFD, std::string const& s_FilePath);
+    
+    /**
+     *  Open a directory file descriptor.
+     *
+     *  \param i_DirFD The directory file descriptor the path is relative to.
+     *  \param s_DirPath The directory path.
+     *  \param b_Beneath If the opened directory has to be beneath the given directory.
+     *
+     *  \return The opened directory file descriptor.
      */
     
-    void CheckFile(std::string const& s_FilePath);
+    int OpenDir(int i_DirFD, std::string const& s_DirPath, bool b_Beneath);
     
     //*************************************************************************************
     // Reset
     //*************************************************************************************
     
     /**
-     *  Get the full "_User" link path.
+     *  Open the directory containing the "_User" link for a package.
      *
      *  \param s_PackagePath The full path to the application package.
+     *  \param s_LinkPath The full "_User" link path for the package.
      *
-     *  \return The full link path.
+     *  \return The opened directory file descriptor.
      */
     
-    std::string GetFullPackageLinkPath(std::string s_PackagePath);
+    int OpenPackageLinkDir(std::string s_PackagePath, std::string& s_LinkPath);
     
     /**
      *  Check if a file is a symbolic link.
      *
-     *  \param s_FilePath The full path to the file.
+     *  \param i_DirFD The directory file descriptor containing the file.
+     *  \param s_FileName The name of the file.
      *
      *  \return true if it is a symbolic link, false if not.
      */
     
-    bool IsSymLink(std::string s_FilePath) noexcept;
+    bool IsSymLink(int i_DirFD, std::string const& s_FileName) noexcept;
+    
+    /**
+     *  Check if two directory file descriptors refer to the same directory.
+     *
+     *  \param i_DirFD The first directory file descriptor.
+     *  \param i_OtherDirFD The second directory file descriptor.
+     *
+     *  \return true if both are the same directory, false if not.
+     */
+    
+    bool IsSameDir(int i_DirFD, int i_OtherDirFD) noexcept;
+    
+    /**
+     *  Atomically install the "_User" link inside a package. The link is 
+     *  created under a temporary name and renamed in place.
+     *
+     *  \param i_DirFD The directory file descriptor to install the link in.
+     *  \param s_TargetPath The content link directory to link to.
+     *  \param s_LinkPath The full "_User" link path, used for messages.
+     *  \param b_Replace If the link in place is known to be a content link.
+     */
+    
+    void InstallPackageLink(int i_DirFD, 
+                            std::string const& s_TargetPath, 
+                            std::string const& s_LinkPath, 
+                            bool b_Replace);
+    
+    //*************************************************************************************
+    // Session
+    //*************************************************************************************
+    
+    /**
+     *  Get the session for a package. Unused or least recently used sessions 
+     *  are taken if the package has none.
+     *
+     *  \param s_PackagePath The full path to the application package.
+     *
+     *  \return The package session.
+     */
+    
+    Session& GetSession(std::string const& s_PackagePath);
+    
+    /**
+     *  Check the links of an already linked session and repair changed ones.
+     *
+     *  \param c_Session The session to update.
+     */
+    
+    void UpdateSession(Session& c_Session);
+    
+    /**
+     *  Remove all content links and the "_User" link of a session and 
+     *  mark it as unused.
+     *
+     *  \param c_Session The session to close.
+     */
+    
+    void CloseSession(Session& c_Session) noexcept;
+    
+    //*************************************************************************************
+    // Allow Access
+    //*************************************************************************************
+    
+    /**
+     *  Submit the link operation for a pending content type. Every completion 
+     *  waiting for the type is answered once the link was created. The 
+     *  pending operation is kept if this fails.
+     *
+     *  \param p_Session The session to link for.
+     *  \param u32_Type The content type to link.
+     *  \param u64_Key The pending operation key.
+     */
+    
+    void SubmitLink(Session* p_Session, MRH_Uint32 u32_Type, MRH_Uint64 u64_Key);
+    
+    /**
+     *  Count a finished part of a mask request.
+     *
+     *  \param p_Request The mask request.
+     *  \param u32_Failed The content types which failed.
+     */
+    
+    void CountMask(std::shared_ptr<MaskRequest> const& p_Request, MRH_Uint32 u32_Failed) noexcept;
+    
+    /**
+     *  Finish a mask request once every part was answered. Links created by 
+     *  the request are removed if any type failed and no other request 
+     *  waits for them.
+     *
+     *  \param p_Request The mask request.
+     */
+    
+    void FinishMask(std::shared_ptr<MaskRequest> const& p_Request) noexcept;
+    
+    //*************************************************************************************
+    // Operations
+    //*************************************************************************************
+    
+    /**
+     *  Count a submitted access operation. The reset lock has to be held shared.
+     */
+    
+    void BeginOperation() noexcept;
+    
+    /**
+     *  Finish a submitted access operation.
+     */
+    
+    void EndOperation() noexcept;
+    
+    /**
+     *  Wait for all submitted access operations to finish. The reset lock has 
+     *  to be held exclusive.
+     */
+    
+    void WaitOperations() noexcept;
+    
+    /**
+     *  Get the pending operation key for a content type in the current 
+     *  reset epoch. The reset lock has to be held.
+     *
+     *  \param u32_Type The content type.
+     *
+     *  \return The pending operation key.
+     */
+    
+    MRH_Uint64 GetPendingKey(MRH_Uint32 u32_Type) const noexcept;
+    
+    /**
+     *  Remove a pending operation and get the completions waiting for it.
+     *
+     *  \param u64_Key The pending operation key.
+     *
+     *  \return The waiting completions, the first one started the operation 
+     *          if it was a single access request.
+     */
+    
+    std::vector<Completion> TakePending(MRH_Uint64 u64_Key) noexcept;
+    
+    /**
+     *  Remove a pending operation and answer all completions waiting for it.
+     *
+     *  \param u64_Key The pending operation key.
+     *  \param b_Result The operation result.
+     */
+    
+    void AnswerPending(MRH_Uint64 u64_Key, bool b_Result) noexcept;
     
     //*************************************************************************************
     // Data
     //*************************************************************************************
     
-    // State
-    std::mutex s_ResetMutex;
+    // State, shared for access and exclusive for reset
+    std::shared_mutex s_ResetMutex;
     std::atomic<bool> b_Reset;
+    bool b_KeepAccess;
+    
+    // Submitted access operations, reset drains these
+    std::mutex s_OperationMutex;
+    std::condition_variable s_OperationCondition;
+    MRH_Uint32 u32_Operations;
+    
+    // Running link operations by type and reset epoch, duplicates wait for the first
+    std::mutex s_PendingMutex;
+    std::unordered_map<MRH_Uint64, std::vector<Completion>> m_Pending;
     
     // Link directory info
-    std::string s_UserDirLinkPath;
     std::string s_PackageLinkDirPath;
+    std::string s_PackageLinkName;
     std::string s_ContentLinkDirPath;
     
-    // Content links
-    std::unordered_map<size_t, SymLink*> m_SymLink;
+    // Opened directories
+    int i_SourceDirFD;
+    int i_ContentLinkDirFD;
+    
+    // Content links, indexed by type, only the first u32_TypeCount are set
+    std::array<SymLink, TYPE_LIMIT> v_SymLink;
+    MRH_Uint32 u32_TypeCount;
+    MRH_Uint32 u32_TypeMaskAll;
+    
+    // Package sessions, the active one receives access requests
+    std::array<Session, MRH_USER_CONTENT_SESSION_COUNT> v_Session;
+    std::unordered_map<std::string, Session*> m_Session;
+    Session* p_Active;
+    MRH_Uint64 u64_ResetCount;
+    
+    // Link operations
+    std::unique_ptr<FSExecutor> p_Executor;
     
 protected:
 
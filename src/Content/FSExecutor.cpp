@@ -0,0 +1,769 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cerrno>
+#include <future>
+#include <chrono>
+#include <sys/mman.h>
+#ifdef __linux__
+    #include <linux/version.h>
+    #include <sys/syscall.h>
+    #if LINUX_VERSION_CODE >= KERNEL_VERSION(5,15,0)
+        #include <linux/io_uring.h>
+    #endif
+#endif
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./FSExecutor.h"
+
+// Pre-defined
+#ifndef MRH_USER_CONTENT_THREAD_IDLE_MS
+    #define MRH_USER_CONTENT_THREAD_IDLE_MS 30000
+#endif
+
+#ifndef MRH_USER_CONTENT_IO_URING
+    #define MRH_USER_CONTENT_IO_URING 1
+#endif
+
+#if MRH_USER_CONTENT_IO_URING != 0 && defined(IORING_FEAT_SINGLE_MMAP) && defined(__NR_io_uring_setup)
+    #define MRH_USER_USE_IO_URING 1
+#endif
+
+namespace
+{
+    // Enough for a full reset batch and concurrent grants
+    constexpr unsigned u32_RingEntries = 64;
+    
+#ifdef MRH_USER_USE_IO_URING
+    constexpr __u8 p_RingOpCode[FSExecutor::OPERATION_COUNT] =
+    {
+        IORING_OP_SYMLINKAT,
+        IORING_OP_UNLINKAT,
+        IORING_OP_MKDIRAT
+    };
+    
+    int RingEnter(int i_RingFD, unsigned u32_Submit, unsigned u32_MinComplete, unsigned u32_Flags) noexcept
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, i_RingFD, u32_Submit, u32_MinComplete, u32_Flags, NULL, 0));
+    }
+#endif
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+FSExecutor::FSExecutor(size_t us_ThreadMin, size_t us_ThreadMax) : i_RingFD(-1),
+                                                                   p_SQRing(MAP_FAILED),
+                                                                   p_CQRing(MAP_FAILED),
+                                                                   p_SQE(MAP_FAILED),
+                                                                   us_SQRingSize(0),
+                                                                   us_CQRingSize(0),
+                                                                   us_SQESize(0),
+                                                                   u32_SQEntries(0),
+                                                                   u32_CQEntries(0),
+                                                                   u32_InFlight(0),
+                                                                   us_ThreadMin(us_ThreadMin),
+                                                                   us_ThreadMax(us_ThreadMax),
+                                                                   us_Waiting(0),
+                                                                   b_Work(true)
+{
+    if (SetupRing() == true)
+    {
+        try
+        {
+            c_RingThread = std::thread(ReapRing, this);
+        }
+        catch (std::exception& e)
+        {
+            DestroyRing();
+            throw Exception("Failed to start io_uring completion thread: " + std::string(e.what()));
+        }
+        
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Using io_uring for content operations.",
+                                       "FSExecutor.cpp", __LINE__);
+        return;
+    }
+    
+    // No ring, use blocking workers instead
+    if (this->us_ThreadMax < this->us_ThreadMin)
+    {
+        this->us_ThreadMax = this->us_ThreadMin;
+    }
+    
+    if (this->us_ThreadMax == 0)
+    {
+        this->us_ThreadMax = 1;
+    }
+    
+    try
+    {
+        std::lock_guard<std::mutex> c_Guard(c_WorkMutex);
+        
+        for (size_t i = 0; i < this->us_ThreadMin; ++i)
+        {
+            AddWorker();
+        }
+    }
+    catch (Exception& e)
+    {
+        c_WorkMutex.lock();
+        b_Work = false;
+        c_WorkMutex.unlock();
+        c_WorkCondition.notify_all();
+        
+        for (auto& Thread : v_WorkThread)
+        {
+            Thread.join();
+        }
+        
+        throw;
+    }
+    
+    MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "io_uring unavailable, using " +
+                                                        std::to_string(this->us_ThreadMin) +
+                                                        " to " +
+                                                        std::to_string(this->us_ThreadMax) +
+                                                        " worker thread(s) for content operations.",
+                                   "FSExecutor.cpp", __LINE__);
+}
+
+FSExecutor::~FSExecutor() noexcept
+{
+    if (i_RingFD >= 0)
+    {
+        // Wait for in-flight operations
+        std::unique_lock<std::mutex> c_Lock(c_RingMutex);
+        c_RingCondition.wait(c_Lock, [this] { return u32_InFlight == 0 && dq_Deferred.size() == 0; });
+        c_Lock.unlock();
+        
+        DestroyRing();
+        return;
+    }
+    
+    c_WorkMutex.lock();
+    b_Work = false;
+    c_WorkMutex.unlock();
+    c_WorkCondition.notify_all();
+    
+    for (auto& Thread : v_WorkThread)
+    {
+        Thread.join();
+    }
+}
+
+FSExecutor::Pending::Pending(Batch& c_Batch, Completion& c_Completion) : c_Batch(std::move(c_Batch)),
+                                                                          c_Completion(std::move(c_Completion)),
+                                                                          us_Remaining(this->c_Batch.size())
+{}
+
+//*************************************************************************************
+// Operation
+//*************************************************************************************
+
+FSExecutor::Operation FSExecutor::SymLink(const char* p_Target, int i_DirFD, const char* p_Path) noexcept
+{
+    return { SYMLINK, i_DirFD, p_Path, p_Target, 0, 0 };
+}
+
+FSExecutor::Operation FSExecutor::Unlink(int i_DirFD, const char* p_Path) noexcept
+{
+    return { UNLINK, i_DirFD, p_Path, NULL, 0, 0 };
+}
+
+FSExecutor::Operation FSExecutor::MkDir(int i_DirFD, const char* p_Path, int i_Mode) noexcept
+{
+    return { MKDIR, i_DirFD, p_Path, NULL, i_Mode, 0 };
+}
+
+//*************************************************************************************
+// Submit
+//*************************************************************************************
+
+void FSExecutor::Submit(Batch c_Batch, Completion c_Completion)
+{
+    Pending* p_Pending;
+    
+    try
+    {
+        p_Pending = new Pending(c_Batch, c_Completion);
+    }
+    catch (std::exception& e)
+    {
+        throw Exception("Failed to submit content operations: " + std::string(e.what()));
+    }
+    
+    // Nothing to do?
+    if (p_Pending->c_Batch.size() == 0)
+    {
+        Finish(p_Pending);
+        return;
+    }
+    
+    if (i_RingFD >= 0)
+    {
+        try
+        {
+            p_Pending->v_Request.reserve(p_Pending->c_Batch.size());
+            
+            for (size_t i = 0; i < p_Pending->c_Batch.size(); ++i)
+            {
+                p_Pending->v_Request.push_back({ p_Pending, i });
+            }
+        }
+        catch (std::exception& e)
+        {
+            delete p_Pending;
+            throw Exception("Failed to submit content operations: " + std::string(e.what()));
+        }
+        
+        SubmitRing(p_Pending, 0);
+        return;
+    }
+    
+    std::unique_lock<std::mutex> c_Lock(c_WorkMutex);
+    dq_Work.push_back(p_Pending);
+    
+    // Every worker busy, add another one if allowed
+    JoinIdleWorkers();
+    
+    if (us_Waiting < dq_Work.size() && v_WorkThread.size() < us_ThreadMax)
+    {
+        try
+        {
+            AddWorker();
+        }
+        catch (Exception& e)
+        {
+            // Queued work waits for a busy worker, if there is one
+            if (v_WorkThread.size() == 0)
+            {
+                dq_Work.pop_back();
+                delete p_Pending;
+                throw;
+            }
+            
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                           "FSExecutor.cpp", __LINE__);
+        }
+    }
+    
+    c_Lock.unlock();
+    c_WorkCondition.notify_one();
+}
+
+void FSExecutor::Execute(Batch& c_Batch)
+{
+    std::promise<void> c_Promise;
+    std::future<void> c_Future = c_Promise.get_future();
+    
+    Submit(std::move(c_Batch), [&c_Batch, &c_Promise](Batch& c_Result)
+    {
+        c_Batch = std::move(c_Result);
+        c_Promise.set_value();
+    });
+    
+    c_Future.wait();
+}
+
+//*************************************************************************************
+// Ring
+//*************************************************************************************
+
+bool FSExecutor::SetupRing() noexcept
+{
+#ifdef MRH_USER_USE_IO_URING
+    struct io_uring_params c_Params;
+    std::memset(&c_Params, 0, sizeof(c_Params));
+    
+    if ((i_RingFD = static_cast<int>(syscall(__NR_io_uring_setup, u32_RingEntries, &c_Params))) < 0)
+    {
+        return false;
+    }
+    
+    // Older kernels lack the *at() operations
+    size_t us_ProbeSize = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    std::vector<MRH_Uint8> v_Probe(us_ProbeSize, 0);
+    struct io_uring_probe* p_Probe = reinterpret_cast<struct io_uring_probe*>(v_Probe.data());
+    
+    if (syscall(__NR_io_uring_register, i_RingFD, IORING_REGISTER_PROBE, p_Probe, 256) < 0)
+    {
+        DestroyRing();
+        return false;
+    }
+    
+    for (size_t i = 0; i < OPERATION_COUNT; ++i)
+    {
+        if (p_Probe->last_op < p_RingOpCode[i] || (p_Probe->ops[p_RingOpCode[i]].flags & IO_URING_OP_SUPPORTED) == 0)
+        {
+            DestroyRing();
+            return false;
+        }
+    }
+    
+    // Map shared rings
+    if ((c_Params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+    {
+        DestroyRing();
+        return false;
+    }
+    
+    us_SQRingSize = c_Params.sq_off.array + c_Params.sq_entries * sizeof(unsigned);
+    us_CQRingSize = c_Params.cq_off.cqes + c_Params.cq_entries * sizeof(struct io_uring_cqe);
+    
+    if (us_CQRingSize > us_SQRingSize)
+    {
+        us_SQRingSize = us_CQRingSize;
+    }
+    
+    us_CQRingSize = 0; // Shared with SQ ring
+    us_SQESize = c_Params.sq_entries * sizeof(struct io_uring_sqe);
+    
+    p_SQRing = mmap(NULL, us_SQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, i_RingFD, IORING_OFF_SQ_RING);
+    p_SQE = mmap(NULL, us_SQESize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, i_RingFD, IORING_OFF_SQES);
+    
+    if (p_SQRing == MAP_FAILED || p_SQE == MAP_FAILED)
+    {
+        DestroyRing();
+        return false;
+    }
+    
+    p_CQRing = p_SQRing;
+    
+    MRH_Uint8* p_SQ = static_cast<MRH_Uint8*>(p_SQRing);
+    MRH_Uint8* p_CQ = static_cast<MRH_Uint8*>(p_CQRing);
+    
+    p_SQHead = reinterpret_cast<unsigned*>(p_SQ + c_Params.sq_off.head);
+    p_SQTail = reinterpret_cast<unsigned*>(p_SQ + c_Params.sq_off.tail);
+    p_SQMask = reinterpret_cast<unsigned*>(p_SQ + c_Params.sq_off.ring_mask);
+    p_SQArray = reinterpret_cast<unsigned*>(p_SQ + c_Params.sq_off.array);
+    u32_SQEntries = c_Params.sq_entries;
+    
+    p_CQHead = reinterpret_cast<unsigned*>(p_CQ + c_Params.cq_off.head);
+    p_CQTail = reinterpret_cast<unsigned*>(p_CQ + c_Params.cq_off.tail);
+    p_CQMask = reinterpret_cast<unsigned*>(p_CQ + c_Params.cq_off.ring_mask);
+    p_CQE = p_CQ + c_Params.cq_off.cqes;
+    u32_CQEntries = c_Params.cq_entries;
+    
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FSExecutor::DestroyRing() noexcept
+{
+#ifdef MRH_USER_USE_IO_URING
+    if (c_RingThread.joinable() == true)
+    {
+        // Wake reaper with a stop request
+        c_RingMutex.lock();
+        
+        unsigned u32_Tail = *p_SQTail;
+        unsigned u32_Index = u32_Tail & *p_SQMask;
+        struct io_uring_sqe* p_Entry = static_cast<struct io_uring_sqe*>(p_SQE) + u32_Index;
+        
+        std::memset(p_Entry, 0, sizeof(struct io_uring_sqe));
+        p_Entry->opcode = IORING_OP_NOP;
+        p_Entry->user_data = 0;
+        p_SQArray[u32_Index] = u32_Index;
+        
+        __atomic_store_n(p_SQTail, u32_Tail + 1, __ATOMIC_RELEASE);
+        RingEnter(i_RingFD, 1, 0, 0);
+        
+        c_RingMutex.unlock();
+        c_RingThread.join();
+    }
+    
+    if (p_SQE != MAP_FAILED)
+    {
+        munmap(p_SQE, us_SQESize);
+        p_SQE = MAP_FAILED;
+    }
+    
+    if (p_SQRing != MAP_FAILED)
+    {
+        munmap(p_SQRing, us_SQRingSize);
+        p_SQRing = MAP_FAILED;
+        p_CQRing = MAP_FAILED;
+    }
+    
+    if (i_RingFD >= 0)
+    {
+        close(i_RingFD);
+        i_RingFD = -1;
+    }
+#endif
+}
+
+void FSExecutor::SubmitRing(Pending* p_Pending, size_t us_Pos) noexcept
+{
+#ifdef MRH_USER_USE_IO_URING
+    // @NOTE: The batch may complete and be freed once the last part is submitted
+    Batch& c_Batch = p_Pending->c_Batch;
+    size_t us_Size = c_Batch.size();
+    bool b_Reaper = (std::this_thread::get_id() == c_RingThread.get_id());
+    
+    while (us_Pos < us_Size)
+    {
+        std::unique_lock<std::mutex> c_Lock(c_RingMutex);
+        
+        // Never queue more than the completion ring can hold
+        if (b_Reaper == false)
+        {
+            c_RingCondition.wait(c_Lock, [this] { return u32_InFlight < u32_CQEntries; });
+        }
+        else if (u32_InFlight >= u32_CQEntries)
+        {
+            // Submitted by a completion, the reaper can't wait for itself and 
+            // continues once space was reaped
+            try
+            {
+                dq_Deferred.push_back({ p_Pending, us_Pos });
+                return;
+            }
+            catch (...)
+            {
+                c_Lock.unlock();
+                Perform(p_Pending, us_Pos);
+                return;
+            }
+        }
+        
+        unsigned u32_Free = u32_CQEntries - u32_InFlight;
+        unsigned u32_Tail = *p_SQTail;
+        unsigned u32_Count = 0;
+        
+        if (u32_Free > u32_SQEntries)
+        {
+            u32_Free = u32_SQEntries;
+        }
+        
+        for (; us_Pos < us_Size && u32_Count < u32_Free; ++us_Pos, ++u32_Count)
+        {
+            Operation& c_Operation = c_Batch[us_Pos];
+            unsigned u32_Index = (u32_Tail + u32_Count) & *p_SQMask;
+            struct io_uring_sqe* p_Entry = static_cast<struct io_uring_sqe*>(p_SQE) + u32_Index;
+            
+            std::memset(p_Entry, 0, sizeof(struct io_uring_sqe));
+            p_Entry->opcode = p_RingOpCode[c_Operation.e_Type];
+            p_Entry->fd = c_Operation.i_DirFD;
+            p_Entry->user_data = reinterpret_cast<__u64>(&(p_Pending->v_Request[us_Pos]));
+            
+            switch (c_Operation.e_Type)
+            {
+                case SYMLINK:
+                    p_Entry->addr = reinterpret_cast<__u64>(c_Operation.p_Target);
+                    p_Entry->off = reinterpret_cast<__u64>(c_Operation.p_Path);
+                    break;
+                case UNLINK:
+                    p_Entry->addr = reinterpret_cast<__u64>(c_Operation.p_Path);
+                    break;
+                case MKDIR:
+                    p_Entry->addr = reinterpret_cast<__u64>(c_Operation.p_Path);
+                    p_Entry->len = static_cast<__u32>(c_Operation.i_Mode);
+                    break;
+                
+                default:
+                    break;
+            }
+            
+            p_SQArray[u32_Index] = u32_Index;
+        }
+        
+        __atomic_store_n(p_SQTail, u32_Tail + u32_Count, __ATOMIC_RELEASE);
+        u32_InFlight += u32_Count;
+        
+        // The kernel consumes all queued entries on enter
+        unsigned u32_Submitted = 0;
+        int i_Result;
+        
+        while (u32_Submitted < u32_Count)
+        {
+            if ((i_Result = RingEnter(i_RingFD, u32_Count - u32_Submitted, 0, 0)) < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                {
+                    continue;
+                }
+                else if (errno == EBUSY && b_Reaper == false)
+                {
+                    // Completion ring full, the reaper frees space without the 
+                    // ring lock, which is kept so nobody queues behind this part
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to submit content operations: " +
+                                                                     std::string(std::strerror(errno)) +
+                                                                     " (" +
+                                                                     std::to_string(errno) +
+                                                                     ")!",
+                                               "FSExecutor.cpp", __LINE__);
+                
+                // Entries not consumed by the kernel are taken back
+                unsigned u32_Unsubmitted = u32_Count - u32_Submitted;
+                
+                __atomic_store_n(p_SQTail, u32_Tail + u32_Submitted, __ATOMIC_RELEASE);
+                u32_InFlight -= u32_Unsubmitted;
+                
+                c_Lock.unlock();
+                c_RingCondition.notify_all();
+                
+                // Perform the rest with blocking syscalls
+                Perform(p_Pending, us_Pos - u32_Unsubmitted);
+                return;
+            }
+            
+            u32_Submitted += static_cast<unsigned>(i_Result);
+        }
+    }
+#else
+    (void)p_Pending;
+    (void)us_Pos;
+#endif
+}
+
+void FSExecutor::ReapRing(FSExecutor* p_Instance) noexcept
+{
+#ifdef MRH_USER_USE_IO_URING
+    std::vector<Pending*> v_Finished;
+    bool b_Stop = false;
+    
+    while (b_Stop == false)
+    {
+        unsigned u32_Head = *(p_Instance->p_CQHead);
+        unsigned u32_Tail = __atomic_load_n(p_Instance->p_CQTail, __ATOMIC_ACQUIRE);
+        
+        if (u32_Head == u32_Tail)
+        {
+            // Wait for at least one completion
+            RingEnter(p_Instance->i_RingFD, 0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+        
+        unsigned u32_Reaped = 0;
+        
+        for (; u32_Head != u32_Tail; ++u32_Head)
+        {
+            struct io_uring_cqe* p_Entry = static_cast<struct io_uring_cqe*>(p_Instance->p_CQE) + (u32_Head & *(p_Instance->p_CQMask));
+            
+            // Stop request
+            if (p_Entry->user_data == 0)
+            {
+                b_Stop = true;
+                continue;
+            }
+            
+            Request* p_Request = reinterpret_cast<Request*>(p_Entry->user_data);
+            Pending* p_Pending = p_Request->p_Pending;
+            
+            p_Pending->c_Batch[p_Request->us_Index].i_Result = (p_Entry->res < 0 ? -(p_Entry->res) : 0);
+            ++u32_Reaped;
+            
+            if (p_Pending->us_Remaining.fetch_sub(1) == 1)
+            {
+                v_Finished.push_back(p_Pending);
+            }
+        }
+        
+        __atomic_store_n(p_Instance->p_CQHead, u32_Head, __ATOMIC_RELEASE);
+        
+        p_Instance->c_RingMutex.lock();
+        p_Instance->u32_InFlight -= u32_Reaped;
+        p_Instance->c_RingMutex.unlock();
+        
+        // Completions run after the ring space was returned
+        for (auto& Finished : v_Finished)
+        {
+            Finish(Finished);
+        }
+        
+        v_Finished.clear();
+        
+        // Continue submissions which waited for the reaped space
+        std::deque<Request> dq_Deferred;
+        
+        p_Instance->c_RingMutex.lock();
+        dq_Deferred.swap(p_Instance->dq_Deferred);
+        p_Instance->c_RingMutex.unlock();
+        
+        for (auto& Deferred : dq_Deferred)
+        {
+            p_Instance->SubmitRing(Deferred.p_Pending, Deferred.us_Index);
+        }
+        
+        p_Instance->c_RingCondition.notify_all();
+    }
+#else
+    (void)p_Instance;
+#endif
+}
+
+//*************************************************************************************
+// Worker
+//*************************************************************************************
+
+void FSExecutor::Work(FSExecutor* p_Instance) noexcept
+{
+    std::unique_lock<std::mutex> c_Lock(p_Instance->c_WorkMutex);
+    
+    while (true)
+    {
+        ++(p_Instance->us_Waiting);
+        bool b_Ready = p_Instance->c_WorkCondition.wait_for(c_Lock,
+                                                            std::chrono::milliseconds(MRH_USER_CONTENT_THREAD_IDLE_MS),
+                                                            [p_Instance] { return p_Instance->dq_Work.size() > 0 || p_Instance->b_Work == false; });
+        --(p_Instance->us_Waiting);
+        
+        if (b_Ready == false)
+        {
+            // Idle for too long, stop if above the minimum
+            if (p_Instance->v_WorkThread.size() - p_Instance->v_IdleThread.size() > p_Instance->us_ThreadMin)
+            {
+                p_Instance->v_IdleThread.push_back(std::this_thread::get_id());
+                return;
+            }
+            
+            continue;
+        }
+        
+        // Queue is drained before stopping
+        if (p_Instance->dq_Work.size() == 0)
+        {
+            return;
+        }
+        
+        Pending* p_Pending = p_Instance->dq_Work.front();
+        p_Instance->dq_Work.pop_front();
+        c_Lock.unlock();
+        
+        for (auto& Operation : p_Pending->c_Batch)
+        {
+            Perform(Operation);
+        }
+        
+        Finish(p_Pending);
+        c_Lock.lock();
+    }
+}
+
+void FSExecutor::AddWorker()
+{
+    try
+    {
+        v_WorkThread.emplace_back(Work, this);
+    }
+    catch (std::exception& e)
+    {
+        throw Exception("Failed to start content worker thread: " + std::string(e.what()));
+    }
+}
+
+void FSExecutor::JoinIdleWorkers() noexcept
+{
+    // Stopped workers only return after releasing the mutex
+    for (auto& Idle : v_IdleThread)
+    {
+        for (auto It = v_WorkThread.begin(); It != v_WorkThread.end(); ++It)
+        {
+            if (It->get_id() == Idle)
+            {
+                It->join();
+                v_WorkThread.erase(It);
+                break;
+            }
+        }
+    }
+    
+    v_IdleThread.clear();
+}
+
+void FSExecutor::Perform(Operation& c_Operation) noexcept
+{
+    int i_Result = -1;
+    
+    switch (c_Operation.e_Type)
+    {
+        case SYMLINK:
+            i_Result = symlinkat(c_Operation.p_Target, c_Operation.i_DirFD, c_Operation.p_Path);
+            break;
+        case UNLINK:
+            i_Result = unlinkat(c_Operation.i_DirFD, c_Operation.p_Path, 0);
+            break;
+        case MKDIR:
+            i_Result = mkdirat(c_Operation.i_DirFD, c_Operation.p_Path, c_Operation.i_Mode);
+            break;
+        
+        default:
+            errno = EINVAL;
+            break;
+    }
+    
+    c_Operation.i_Result = (i_Result < 0 ? errno : 0);
+}
+
+void FSExecutor::Perform(Pending* p_Pending, size_t us_Pos) noexcept
+{
+    Batch& c_Batch = p_Pending->c_Batch;
+    size_t us_Performed = c_Batch.size() - us_Pos;
+    
+    for (; us_Pos < c_Batch.size(); ++us_Pos)
+    {
+        Perform(c_Batch[us_Pos]);
+    }
+    
+    // Never touch the batch after the last part was counted
+    if (p_Pending->us_Remaining.fetch_sub(us_Performed) == us_Performed)
+    {
+        Finish(p_Pending);
+    }
+}
+
+void FSExecutor::Finish(Pending* p_Pending) noexcept
+{
+    try
+    {
+        p_Pending->c_Completion(p_Pending->c_Batch);
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "FSExecutor.cpp", __LINE__);
+    }
+    
+    delete p_Pending;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool FSExecutor::GetRingUsed() const noexcept
+{
+    return i_RingFD >= 0;
+}
@@ -0,0 +1,346 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef FSExecutor_h
+#define FSExecutor_h
+
+// C / C++
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "../Exception.h"
+
+
+class FSExecutor
+{
+public:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        SYMLINK = 0,
+        UNLINK = 1,
+        MKDIR = 2,
+        
+        OPERATION_MAX = MKDIR,
+        
+        OPERATION_COUNT = OPERATION_MAX + 1
+        
+    }OperationType;
+    
+    typedef struct Operation_t
+    {
+        OperationType e_Type;
+        
+        // Paths are not copied and have to outlive the operation
+        int i_DirFD;
+        const char* p_Path; // Relative to i_DirFD
+        const char* p_Target; // SYMLINK only
+        int i_Mode; // MKDIR only
+        
+        int i_Result; // 0 on success, errno on failure
+        
+    }Operation;
+    
+    typedef std::vector<Operation> Batch;
+    typedef std::function<void(Batch&)> Completion;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. Worker threads are only used if io_uring is
+     *  unavailable. Workers are added while all are busy and removed after
+     *  being idle, within the given bounds.
+     *
+     *  \param us_ThreadMin The number of worker threads kept while idle.
+     *  \param us_ThreadMax The number of worker threads used under load.
+     */
+    
+    FSExecutor(size_t us_ThreadMin, size_t us_ThreadMax);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_FSExecutor FSExecutor class source.
+     */
+    
+    FSExecutor(FSExecutor const& c_FSExecutor) = delete;
+    
+    /**
+     *  Default destructor. Waits for all submitted batches to complete.
+     */
+    
+    ~FSExecutor() noexcept;
+    
+    //*************************************************************************************
+    // Operation
+    //*************************************************************************************
+    
+    /**
+     *  Create a symlinkat() operation.
+     *
+     *  \param p_Target The link target.
+     *  \param i_DirFD The directory file descriptor to create the link in.
+     *  \param p_Path The link path relative to the directory.
+     *
+     *  \return The created operation.
+     */
+    
+    static Operation SymLink(const char* p_Target, int i_DirFD, const char* p_Path) noexcept;
+    
+    /**
+     *  Create a unlinkat() operation.
+     *
+     *  \param i_DirFD The directory file descriptor containing the file.
+     *  \param p_Path The file path relative to the directory.
+     *
+     *  \return The created operation.
+     */
+    
+    static Operation Unlink(int i_DirFD, const char* p_Path) noexcept;
+    
+    /**
+     *  Create a mkdirat() operation.
+     *
+     *  \param i_DirFD The directory file descriptor to create the directory in.
+     *  \param p_Path The directory path relative to the directory.
+     *  \param i_Mode The directory mode.
+     *
+     *  \return The created operation.
+     */
+    
+    static Operation MkDir(int i_DirFD, const char* p_Path, int i_Mode) noexcept;
+    
+    //*************************************************************************************
+    // Submit
+    //*************************************************************************************
+    
+    /**
+     *  Submit a batch of operations. The completion is called once all operations 
+     *  finished, on a executor thread. Completions may submit new operations, 
+     *  which never wait for ring space on the completion thread. This function 
+     *  is thread safe.
+     *
+     *  \param c_Batch The operations to perform.
+     *  \param c_Completion The completion to call with the finished batch.
+     */
+    
+    void Submit(Batch c_Batch, Completion c_Completion);
+    
+    /**
+     *  Perform a batch of operations and wait for the result. This function is 
+     *  thread safe.
+     *
+     *  \param c_Batch The operations to perform, results are set on return.
+     */
+    
+    void Execute(Batch& c_Batch);
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Check if io_uring is used to perform operations.
+     *
+     *  \return true if io_uring is used, false if worker threads are used.
+     */
+    
+    bool GetRingUsed() const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    class Pending;
+    
+    typedef struct Request_t
+    {
+        Pending* p_Pending;
+        size_t us_Index;
+        
+    }Request;
+    
+    class Pending
+    {
+    public:
+        
+        /**
+         *  Default constructor.
+         *
+         *  \param c_Batch The operations to perform.
+         *  \param c_Completion The completion to call with the finished batch.
+         */
+        
+        Pending(Batch& c_Batch, Completion& c_Completion);
+        
+        Batch c_Batch;
+        Completion c_Completion;
+        std::vector<Request> v_Request; // io_uring user data
+        std::atomic<size_t> us_Remaining;
+    };
+    
+    //*************************************************************************************
+    // Ring
+    //*************************************************************************************
+    
+    /**
+     *  Setup the io_uring instance.
+     *
+     *  \return true if io_uring can be used, false if not.
+     */
+    
+    bool SetupRing() noexcept;
+    
+    /**
+     *  Destroy the io_uring instance.
+     */
+    
+    void DestroyRing() noexcept;
+    
+    /**
+     *  Submit a pending batch to the io_uring instance.
+     *
+     *  \param p_Pending The batch to submit.
+     *  \param us_Pos The first operation of the batch to submit.
+     */
+    
+    void SubmitRing(Pending* p_Pending, size_t us_Pos) noexcept;
+    
+    /**
+     *  Reap io_uring completions.
+     *
+     *  \param p_Instance The executor instance to reap for.
+     */
+    
+    static void ReapRing(FSExecutor* p_Instance) noexcept;
+    
+    //*************************************************************************************
+    // Worker
+    //*************************************************************************************
+    
+    /**
+     *  Perform queued batches with blocking syscalls.
+     *
+     *  \param p_Instance The executor instance to work for.
+     */
+    
+    static void Work(FSExecutor* p_Instance) noexcept;
+    
+    /**
+     *  Add a worker thread. The work mutex has to be locked.
+     */
+    
+    void AddWorker();
+    
+    /**
+     *  Join all worker threads which stopped after being idle. The work 
+     *  mutex has to be locked.
+     */
+    
+    void JoinIdleWorkers() noexcept;
+    
+    /**
+     *  Perform a single operation with a blocking syscall.
+     *
+     *  \param c_Operation The operation to perform.
+     */
+    
+    static void Perform(Operation& c_Operation) noexcept;
+    
+    /**
+     *  Perform the remaining operations of a batch with blocking syscalls. 
+     *  The batch is finished if these were the last operations.
+     *
+     *  \param p_Pending The batch to perform.
+     *  \param us_Pos The first operation to perform.
+     */
+    
+    static void Perform(Pending* p_Pending, size_t us_Pos) noexcept;
+    
+    /**
+     *  Finish a completed batch.
+     *
+     *  \param p_Pending The completed batch.
+     */
+    
+    static void Finish(Pending* p_Pending) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Ring
+    int i_RingFD;
+    void* p_SQRing;
+    void* p_CQRing;
+    void* p_SQE;
+    size_t us_SQRingSize;
+    size_t us_CQRingSize;
+    size_t us_SQESize;
+    
+    unsigned* p_SQHead;
+    unsigned* p_SQTail;
+    unsigned* p_SQMask;
+    unsigned* p_SQArray;
+    unsigned u32_SQEntries;
+    
+    unsigned* p_CQHead;
+    unsigned* p_CQTail;
+    unsigned* p_CQMask;
+    void* p_CQE;
+    unsigned u32_CQEntries;
+    
+    std::mutex c_RingMutex;
+    std::condition_variable c_RingCondition;
+    unsigned u32_InFlight;
+    std::deque<Request> dq_Deferred; // Submitted by completions, waiting for ring space
+    std::thread c_RingThread;
+    
+    // Worker
+    std::mutex c_WorkMutex;
+    std::condition_variable c_WorkCondition;
+    std::deque<Pending*> dq_Work;
+    std::vector<std::thread> v_WorkThread;
+    std::vector<std::thread::id> v_IdleThread; // Stopped, not yet joined
+    size_t us_ThreadMin;
+    size_t us_ThreadMax;
+    size_t us_Waiting;
+    bool b_Work;
+    
+protected:
+    
+};
+
+#endif /* FSExecutor_h */
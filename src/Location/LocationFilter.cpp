@@ -0,0 +1,275 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./LocationFilter.h"
+
+namespace
+{
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0;
+    constexpr MRH_Sfloat64 f64_Radians = M_PI / 180.0;
+    constexpr MRH_Sfloat64 f64_MetersPerLatitude = f64_EarthRadius * f64_Radians;
+    
+    // Distance from the origin before it is moved, keeps the plane flat
+    constexpr MRH_Sfloat64 f64_RebaseDistance = 10000.0;
+    
+    // Velocity variance of a new track, about 10 m/s
+    constexpr MRH_Sfloat64 f64_VelocityVariance = 100.0;
+    
+    // Chi-squared 99.9% for 2 degrees of freedom
+    constexpr MRH_Sfloat64 f64_Gate = 13.82;
+    
+    // Slower movement has no reliable course
+    constexpr MRH_Sfloat64 f64_CourseMinSpeed = 0.5;
+    
+    // Smallest longtitude scale, within about 60 km of a pole
+    constexpr MRH_Sfloat64 f64_PoleScale = 0.01;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationFilter::LocationFilter(MRH_Sfloat64 f64_Accuracy, MRH_Sfloat64 f64_Acceleration, MRH_Sfloat64 f64_MaxSpeed) noexcept : f64_Variance(f64_Accuracy * f64_Accuracy),
+                                                                                                                              f64_Noise(f64_Acceleration * f64_Acceleration),
+                                                                                                                              f64_MaxSpeed(f64_MaxSpeed),
+                                                                                                                              b_Started(false),
+                                                                                                                              u64_TimeMS(0),
+                                                                                                                              u32_Rejected(0),
+                                                                                                                              f64_OriginLatitude(0.0),
+                                                                                                                              f64_OriginLongtitude(0.0),
+                                                                                                                              f64_MetersPerLongtitude(f64_MetersPerLatitude),
+                                                                                                                              c_East({ 0.0, 0.0, 0.0, 0.0, 0.0 }),
+                                                                                                                              c_North({ 0.0, 0.0, 0.0, 0.0, 0.0 }),
+                                                                                                                              c_Up({ 0.0, 0.0, 0.0, 0.0, 0.0 }),
+                                                                                                                              f64_Course(0.0),
+                                                                                                                              u64_Fixes(0),
+                                                                                                                              u64_Rejected(0),
+                                                                                                                              u64_TimeNS(0)
+{}
+
+LocationFilter::~LocationFilter() noexcept
+{
+    if (u64_Fixes > 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Location filter processed " +
+                                                            std::to_string(u64_Fixes) +
+                                                            " fixes (" +
+                                                            std::to_string(u64_Rejected) +
+                                                            " rejected), " +
+                                                            std::to_string(u64_TimeNS / u64_Fixes) +
+                                                            " ns per fix.",
+                                       "LocationFilter.cpp", __LINE__);
+    }
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+bool LocationFilter::Process(LocationSnapshot::Fix& c_Fix) noexcept
+{
+    if (f64_Variance <= 0.0)
+    {
+        return true;
+    }
+    
+    auto c_Start = std::chrono::steady_clock::now();
+    bool b_Accepted = true;
+    
+    // Start over after a long gap or if time went backwards
+    if (b_Started == false || 
+        c_Fix.u64_TimeMS < u64_TimeMS || 
+        c_Fix.u64_TimeMS - u64_TimeMS > MRH_USER_LOCATION_FILTER_RESET_MS)
+    {
+        Reset(c_Fix);
+    }
+    else
+    {
+        MRH_Sfloat64 f64_Time = (c_Fix.u64_TimeMS - u64_TimeMS) / 1000.0;
+        MRH_Sfloat64 f64_Longtitude = std::remainder(c_Fix.f64_Longtitude - f64_OriginLongtitude, 360.0);
+        MRH_Sfloat64 f64_East = f64_Longtitude * f64_MetersPerLongtitude;
+        MRH_Sfloat64 f64_North = (c_Fix.f64_Latitude - f64_OriginLatitude) * f64_MetersPerLatitude;
+        
+        // Distance from the last estimate, before moving it forward
+        MRH_Sfloat64 f64_Distance = std::hypot(f64_East - c_East.f64_Position, f64_North - c_North.f64_Position);
+        
+        Predict(c_East, f64_Time);
+        Predict(c_North, f64_Time);
+        Predict(c_Up, f64_Time);
+        
+        // Reject fixes too far off the prediction or impossibly fast
+        MRH_Sfloat64 f64_InnovationEast = f64_East - c_East.f64_Position;
+        MRH_Sfloat64 f64_InnovationNorth = f64_North - c_North.f64_Position;
+        MRH_Sfloat64 f64_Score = ((f64_InnovationEast * f64_InnovationEast) / (c_East.f64_P00 + f64_Variance)) + 
+                                 ((f64_InnovationNorth * f64_InnovationNorth) / (c_North.f64_P00 + f64_Variance));
+        
+        if (f64_Score > f64_Gate || 
+            f64_Distance > f64_MaxSpeed * f64_Time + 3.0 * std::sqrt(f64_Variance))
+        {
+            // Trust a moved source once it stays moved
+            if (++u32_Rejected < MRH_USER_LOCATION_FILTER_REJECT_MAX)
+            {
+                b_Accepted = false;
+                ++u64_Rejected;
+            }
+            else
+            {
+                Reset(c_Fix);
+            }
+        }
+        else
+        {
+            u32_Rejected = 0;
+            
+            Correct(c_East, f64_East);
+            Correct(c_North, f64_North);
+            Correct(c_Up, c_Fix.f64_Elevation);
+            
+            if (std::fabs(c_East.f64_Position) > f64_RebaseDistance || 
+                std::fabs(c_North.f64_Position) > f64_RebaseDistance)
+            {
+                Rebase();
+            }
+        }
+        
+        u64_TimeMS = c_Fix.u64_TimeMS;
+    }
+    
+    if (b_Accepted == true)
+    {
+        // Replace with the estimate, facing is kept as recieved
+        MRH_Sfloat64 f64_Speed = std::hypot(c_East.f64_Velocity, c_North.f64_Velocity);
+        
+        if (f64_Speed >= f64_CourseMinSpeed)
+        {
+            f64_Course = std::atan2(c_East.f64_Velocity, c_North.f64_Velocity) / f64_Radians;
+            
+            if (f64_Course < 0.0)
+            {
+                f64_Course += 360.0;
+            }
+        }
+        
+        c_Fix.f64_Latitude = std::max(-90.0, std::min(f64_OriginLatitude + (c_North.f64_Position / f64_MetersPerLatitude), 90.0));
+        c_Fix.f64_Longtitude = std::remainder(f64_OriginLongtitude + (c_East.f64_Position / f64_MetersPerLongtitude), 360.0);
+        c_Fix.f64_Elevation = c_Up.f64_Position;
+        c_Fix.f64_Speed = f64_Speed;
+        c_Fix.f64_Course = f64_Course;
+    }
+    
+    ++u64_Fixes;
+    u64_TimeNS += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start).count();
+    
+    return b_Accepted;
+}
+
+//*************************************************************************************
+// Filter
+//*************************************************************************************
+
+void LocationFilter::Reset(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    f64_OriginLatitude = c_Fix.f64_Latitude;
+    f64_OriginLongtitude = c_Fix.f64_Longtitude;
+    f64_MetersPerLongtitude = f64_MetersPerLatitude * std::max(std::cos(f64_OriginLatitude * f64_Radians), f64_PoleScale);
+    
+    c_East = { 0.0, 0.0, f64_Variance, 0.0, f64_VelocityVariance };
+    c_North = { 0.0, 0.0, f64_Variance, 0.0, f64_VelocityVariance };
+    c_Up = { c_Fix.f64_Elevation, 0.0, f64_Variance, 0.0, f64_VelocityVariance };
+    
+    b_Started = true;
+    u64_TimeMS = c_Fix.u64_TimeMS;
+    u32_Rejected = 0;
+}
+
+void LocationFilter::Rebase() noexcept
+{
+    f64_OriginLatitude = std::max(-90.0, std::min(f64_OriginLatitude + (c_North.f64_Position / f64_MetersPerLatitude), 90.0));
+    f64_OriginLongtitude = std::remainder(f64_OriginLongtitude + (c_East.f64_Position / f64_MetersPerLongtitude), 360.0);
+    f64_MetersPerLongtitude = f64_MetersPerLatitude * std::max(std::cos(f64_OriginLatitude * f64_Radians), f64_PoleScale);
+    
+    c_East.f64_Position = 0.0;
+    c_North.f64_Position = 0.0;
+}
+
+void LocationFilter::Predict(Axis& c_Axis, MRH_Sfloat64 f64_Time) const noexcept
+{
+    // Constant velocity, random acceleration
+    MRH_Sfloat64 f64_Time2 = f64_Time * f64_Time;
+    
+    c_Axis.f64_Position += c_Axis.f64_Velocity * f64_Time;
+    
+    c_Axis.f64_P00 += (f64_Time * ((2.0 * c_Axis.f64_P01) + (f64_Time * c_Axis.f64_P11))) + (f64_Noise * f64_Time2 * f64_Time2 / 4.0);
+    c_Axis.f64_P01 += (f64_Time * c_Axis.f64_P11) + (f64_Noise * f64_Time2 * f64_Time / 2.0);
+    c_Axis.f64_P11 += f64_Noise * f64_Time2;
+}
+
+void LocationFilter::Correct(Axis& c_Axis, MRH_Sfloat64 f64_Position) const noexcept
+{
+    MRH_Sfloat64 f64_Innovation = f64_Position - c_Axis.f64_Position;
+    MRH_Sfloat64 f64_Gain0 = c_Axis.f64_P00 / (c_Axis.f64_P00 + f64_Variance);
+    MRH_Sfloat64 f64_Gain1 = c_Axis.f64_P01 / (c_Axis.f64_P00 + f64_Variance);
+    
+    c_Axis.f64_Position += f64_Gain0 * f64_Innovation;
+    c_Axis.f64_Velocity += f64_Gain1 * f64_Innovation;
+    
+    c_Axis.f64_P11 -= f64_Gain1 * c_Axis.f64_P01;
+    c_Axis.f64_P00 *= (1.0 - f64_Gain0);
+    c_Axis.f64_P01 *= (1.0 - f64_Gain0);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+LocationSnapshot::Fix LocationFilter::Extrapolate(LocationSnapshot::Fix const& c_Fix, MRH_Uint64 u64_TimeMS) noexcept
+{
+    if (c_Fix.b_Recieved == false || c_Fix.f64_Speed <= 0.0 || u64_TimeMS <= c_Fix.u64_TimeMS)
+    {
+        return c_Fix;
+    }
+    
+    // Never guess far ahead
+    MRH_Uint64 u64_AheadMS = u64_TimeMS - c_Fix.u64_TimeMS;
+    
+    if (u64_AheadMS > MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS)
+    {
+        u64_AheadMS = MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS;
+    }
+    
+    MRH_Sfloat64 f64_Distance = c_Fix.f64_Speed * (u64_AheadMS / 1000.0);
+    MRH_Sfloat64 f64_Course = c_Fix.f64_Course * f64_Radians;
+    MRH_Sfloat64 f64_Scale = std::max(std::cos(c_Fix.f64_Latitude * f64_Radians), f64_PoleScale);
+    LocationSnapshot::Fix c_Result = c_Fix;
+    
+    // Stop at the pole instead of passing over it
+    c_Result.f64_Latitude = std::max(-90.0, std::min(c_Fix.f64_Latitude + ((f64_Distance * std::cos(f64_Course)) / f64_MetersPerLatitude), 90.0));
+    c_Result.f64_Longtitude = std::remainder(c_Fix.f64_Longtitude + ((f64_Distance * std::sin(f64_Course)) / (f64_MetersPerLatitude * f64_Scale)), 360.0);
+    c_Result.u64_TimeMS = c_Fix.u64_TimeMS + u64_AheadMS;
+    
+    return c_Result;
+}
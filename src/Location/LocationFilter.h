@@ -0,0 +1,192 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationFilter_h
+#define LocationFilter_h
+
+// C / C++
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_FILTER_RESET_MS
+    #define MRH_USER_LOCATION_FILTER_RESET_MS 30000
+#endif
+#ifndef MRH_USER_LOCATION_FILTER_REJECT_MAX
+    #define MRH_USER_LOCATION_FILTER_REJECT_MAX 5
+#endif
+#ifndef MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS
+    #define MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS 2000
+#endif
+
+
+class LocationFilter
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param f64_Accuracy The expected location error in meters, 0 to disable filtering.
+     *  \param f64_Acceleration The expected acceleration in meters per second squared.
+     *  \param f64_MaxSpeed The fastest plausible speed in meters per second.
+     */
+    
+    LocationFilter(MRH_Sfloat64 f64_Accuracy, MRH_Sfloat64 f64_Acceleration, MRH_Sfloat64 f64_MaxSpeed) noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationFilter LocationFilter class source.
+     */
+    
+    LocationFilter(LocationFilter const& c_LocationFilter) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationFilter() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Filter a recieved location fix. The fix is replaced with the 
+     *  smoothed location, speed and course. Fixes are passed unchanged 
+     *  if filtering is disabled.
+     *
+     *  \param c_Fix The fix to filter.
+     *
+     *  \return true if the fix should be published, false if it was rejected.
+     */
+    
+    bool Process(LocationSnapshot::Fix& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Move a location fix along its course to a given time.
+     *
+     *  \param c_Fix The fix to move.
+     *  \param u64_TimeMS The Unix time in milliseconds to move to.
+     *
+     *  \return The moved fix.
+     */
+    
+    static LocationSnapshot::Fix Extrapolate(LocationSnapshot::Fix const& c_Fix, MRH_Uint64 u64_TimeMS) noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Axis_t
+    {
+        // Meters from the origin
+        MRH_Sfloat64 f64_Position;
+        MRH_Sfloat64 f64_Velocity;
+        
+        // Covariance
+        MRH_Sfloat64 f64_P00;
+        MRH_Sfloat64 f64_P01;
+        MRH_Sfloat64 f64_P11;
+        
+    }Axis;
+    
+    //*************************************************************************************
+    // Filter
+    //*************************************************************************************
+    
+    /**
+     *  Restart filtering at a fix.
+     *
+     *  \param c_Fix The fix to start at.
+     */
+    
+    void Reset(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Move the origin to the current estimate.
+     */
+    
+    void Rebase() noexcept;
+    
+    /**
+     *  Predict an axis forward in time.
+     *
+     *  \param c_Axis The axis to predict.
+     *  \param f64_Time The time to predict in seconds.
+     */
+    
+    void Predict(Axis& c_Axis, MRH_Sfloat64 f64_Time) const noexcept;
+    
+    /**
+     *  Correct an axis with a measurement.
+     *
+     *  \param c_Axis The axis to correct.
+     *  \param f64_Position The measured position in meters.
+     */
+    
+    void Correct(Axis& c_Axis, MRH_Sfloat64 f64_Position) const noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Settings
+    MRH_Sfloat64 f64_Variance; // Measurement
+    MRH_Sfloat64 f64_Noise; // Process, acceleration squared
+    MRH_Sfloat64 f64_MaxSpeed;
+    
+    // State
+    bool b_Started;
+    MRH_Uint64 u64_TimeMS;
+    MRH_Uint32 u32_Rejected; // In a row
+    
+    MRH_Sfloat64 f64_OriginLatitude;
+    MRH_Sfloat64 f64_OriginLongtitude;
+    MRH_Sfloat64 f64_MetersPerLongtitude;
+    
+    Axis c_East;
+    Axis c_North;
+    Axis c_Up;
+    
+    MRH_Sfloat64 f64_Course;
+    
+    // Cost
+    MRH_Uint64 u64_Fixes;
+    MRH_Uint64 u64_Rejected;
+    MRH_Uint64 u64_TimeNS;
+    
+protected:
+    
+};
+
+#endif /* LocationFilter_h */
@@ -0,0 +1,605 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./LocationGeocode.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_IndexMagic = 0x4C474331; // "LGC1"
+    constexpr MRH_Uint32 u32_IndexVersion = 1;
+    
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0; // Meters
+    constexpr MRH_Sfloat64 f64_Radians = M_PI / 180.0;
+    
+    // Ranges this small are searched without splitting
+    constexpr MRH_Uint32 u32_LeafSize = 8;
+    constexpr int i_StackSize = 128;
+    
+    // GeoNames columns, tab separated
+    constexpr int i_ColumnName = 1;
+    constexpr int i_ColumnLatitude = 4;
+    constexpr int i_ColumnLongtitude = 5;
+    constexpr int i_ColumnFeatureClass = 6;
+    constexpr int i_ColumnCountry = 8;
+    constexpr int i_ColumnPopulation = 14;
+    constexpr int i_ColumnCount = 15;
+    
+    inline void ToAxis(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, float* p_Axis) noexcept
+    {
+        MRH_Sfloat64 f64_Lat = f64_Latitude * f64_Radians;
+        MRH_Sfloat64 f64_Lon = f64_Longtitude * f64_Radians;
+        
+        p_Axis[0] = static_cast<float>(std::cos(f64_Lat) * std::cos(f64_Lon));
+        p_Axis[1] = static_cast<float>(std::cos(f64_Lat) * std::sin(f64_Lon));
+        p_Axis[2] = static_cast<float>(std::sin(f64_Lat));
+    }
+    
+    inline float GetDistance(const float* p_A, const float* p_B) noexcept
+    {
+        float f32_X = p_A[0] - p_B[0];
+        float f32_Y = p_A[1] - p_B[1];
+        float f32_Z = p_A[2] - p_B[2];
+        
+        return (f32_X * f32_X) + (f32_Y * f32_Y) + (f32_Z * f32_Z);
+    }
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationGeocode::LocationGeocode(std::string const& s_DataPath, std::string const& s_IndexPath) noexcept : p_Map(MAP_FAILED),
+                                                                                                          us_MapSize(0),
+                                                                                                          u32_Count(0),
+                                                                                                          p_Point(NULL),
+                                                                                                          p_Entry(NULL),
+                                                                                                          p_Name(NULL),
+                                                                                                          u32_NameSize(0),
+                                                                                                          b_Mapped(false),
+                                                                                                          b_Build(true),
+                                                                                                          b_Cached(false),
+                                                                                                          b_CachedFound(false),
+                                                                                                          u64_CachedTimeMS(0),
+                                                                                                          f64_CachedLatitude(0.0),
+                                                                                                          f64_CachedLongtitude(0.0)
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    struct stat c_Stat;
+    
+    std::memset(&c_CachedPlace, 0, sizeof(c_CachedPlace));
+    
+    if (s_DataPath.size() == 0)
+    {
+        if (s_IndexPath.size() > 0 && Map(s_IndexPath, 0, 0) == false)
+        {
+            c_Logger.Log(MRH_PSBLogger::INFO, "No place index found, reverse geocoding disabled.",
+                         "LocationGeocode.cpp", __LINE__);
+        }
+        
+        return;
+    }
+    else if (stat(s_DataPath.c_str(), &c_Stat) != 0)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to read place data " +
+                                           s_DataPath +
+                                           ": " +
+                                           std::string(std::strerror(errno)) +
+                                           " (" +
+                                           std::to_string(errno) +
+                                           ")!",
+                     "LocationGeocode.cpp", __LINE__);
+        
+        // Keep using an existing index
+        Map(s_IndexPath, 0, 0);
+        return;
+    }
+    
+    // Only rebuilt if the place data changed
+    if (Map(s_IndexPath, c_Stat.st_size, c_Stat.st_mtime) == true)
+    {
+        return;
+    }
+    
+    c_Logger.Log(MRH_PSBLogger::INFO, "Building place index in the background.",
+                 "LocationGeocode.cpp", __LINE__);
+    
+    try
+    {
+        c_BuildThread = std::thread(BuildIndex, this, s_DataPath, s_IndexPath, c_Stat.st_size, c_Stat.st_mtime);
+    }
+    catch (std::exception& e)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to start place index build: " + std::string(e.what()),
+                     "LocationGeocode.cpp", __LINE__);
+    }
+}
+
+LocationGeocode::~LocationGeocode() noexcept
+{
+    b_Build = false;
+    
+    if (c_BuildThread.joinable() == true)
+    {
+        c_BuildThread.join();
+    }
+    
+    if (p_Map != MAP_FAILED)
+    {
+        munmap(p_Map, us_MapSize);
+    }
+}
+
+//*************************************************************************************
+// Index
+//*************************************************************************************
+
+bool LocationGeocode::Map(std::string const& s_IndexPath, MRH_Uint64 u64_DataSize, MRH_Sint64 s64_DataTime) noexcept
+{
+    int i_FD = open(s_IndexPath.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat c_Stat;
+    void* p_File = MAP_FAILED;
+    
+    if (i_FD < 0)
+    {
+        return false;
+    }
+    else if (fstat(i_FD, &c_Stat) == 0 && c_Stat.st_size >= static_cast<off_t>(sizeof(Header)))
+    {
+        p_File = mmap(NULL, c_Stat.st_size, PROT_READ, MAP_SHARED, i_FD, 0);
+    }
+    
+    close(i_FD);
+    
+    if (p_File == MAP_FAILED)
+    {
+        return false;
+    }
+    
+    const Header* p_Header = static_cast<const Header*>(p_File);
+    MRH_Uint64 u64_Size = sizeof(Header) +
+                          (static_cast<MRH_Uint64>(p_Header->u32_Count) * (sizeof(Point) + sizeof(Entry))) +
+                          p_Header->u32_NameSize;
+    
+    if (p_Header->u32_Magic != u32_IndexMagic ||
+        p_Header->u32_Version != u32_IndexVersion ||
+        u64_Size != static_cast<MRH_Uint64>(c_Stat.st_size) ||
+        (u64_DataSize != 0 && (p_Header->u64_DataSize != u64_DataSize || p_Header->s64_DataTime != s64_DataTime)))
+    {
+        munmap(p_File, c_Stat.st_size);
+        return false;
+    }
+    
+    p_Map = p_File;
+    us_MapSize = c_Stat.st_size;
+    
+    u32_Count = p_Header->u32_Count;
+    p_Point = reinterpret_cast<const Point*>(static_cast<const MRH_Uint8*>(p_File) + sizeof(Header));
+    p_Entry = reinterpret_cast<const Entry*>(p_Point + u32_Count);
+    p_Name = reinterpret_cast<const char*>(p_Entry + u32_Count);
+    u32_NameSize = p_Header->u32_NameSize;
+    
+    b_Mapped = true;
+    
+    // Only touched pages are read
+    madvise(p_Map, us_MapSize, MADV_RANDOM);
+    
+    MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Loaded " +
+                                                        std::to_string(u32_Count) +
+                                                        " places.",
+                                   "LocationGeocode.cpp", __LINE__);
+    
+    return true;
+}
+
+bool LocationGeocode::Build(std::string const& s_DataPath, std::string const& s_IndexPath, MRH_Uint64 u64_DataSize, MRH_Sint64 s64_DataTime, std::atomic<bool> const& b_Build) noexcept
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    FILE* p_Data = fopen(s_DataPath.c_str(), "r");
+    
+    if (p_Data == NULL)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to open place data " +
+                                           s_DataPath +
+                                           ": " +
+                                           std::string(std::strerror(errno)) +
+                                           " (" +
+                                           std::to_string(errno) +
+                                           ")!",
+                     "LocationGeocode.cpp", __LINE__);
+        return false;
+    }
+    
+    std::vector<Point> v_Point;
+    std::vector<Entry> v_Entry;
+    std::vector<char> v_Name;
+    char* p_Line = NULL;
+    size_t us_LineSize = 0;
+    ssize_t ss_Read;
+    
+    try
+    {
+        while (b_Build == true && (ss_Read = getline(&p_Line, &us_LineSize, p_Data)) > 0)
+        {
+            const char* p_Column[i_ColumnCount + 1];
+            int i_Column = 0;
+            
+            p_Column[i_Column++] = p_Line;
+            
+            for (ssize_t i = 0; i < ss_Read && i_Column <= i_ColumnCount; ++i)
+            {
+                if (p_Line[i] == '\t' || p_Line[i] == '\n')
+                {
+                    p_Line[i] = '\0';
+                    p_Column[i_Column++] = p_Line + i + 1;
+                }
+            }
+            
+            // Populated places only
+            if (i_Column <= i_ColumnCount || p_Column[i_ColumnFeatureClass][0] != 'P')
+            {
+                continue;
+            }
+            
+            char* p_End;
+            MRH_Sfloat64 f64_Latitude = std::strtod(p_Column[i_ColumnLatitude], &p_End);
+            MRH_Sfloat64 f64_Longtitude = std::strtod(p_Column[i_ColumnLongtitude], &p_End);
+            
+            if (std::isfinite(f64_Latitude) == false || std::fabs(f64_Latitude) > 90.0 ||
+                std::isfinite(f64_Longtitude) == false || std::fabs(f64_Longtitude) > 180.0 ||
+                v_Point.size() >= 0xFFFFFFFF)
+            {
+                continue;
+            }
+            
+            // Cut long names without splitting UTF-8 characters
+            size_t us_NameSize = std::strlen(p_Column[i_ColumnName]);
+            
+            if (us_NameSize > 0xFF)
+            {
+                us_NameSize = 0xFF;
+                
+                while (us_NameSize > 0 && (p_Column[i_ColumnName][us_NameSize] & 0xC0) == 0x80)
+                {
+                    --us_NameSize;
+                }
+            }
+            
+            if (v_Name.size() + us_NameSize > 0xFFFFFFFF)
+            {
+                continue;
+            }
+            
+            Point c_Point;
+            Entry c_Entry;
+            
+            ToAxis(f64_Latitude, f64_Longtitude, c_Point.p_Axis);
+            
+            c_Entry.u32_Name = static_cast<MRH_Uint32>(v_Name.size());
+            c_Entry.u32_Population = static_cast<MRH_Uint32>(std::min(std::strtoull(p_Column[i_ColumnPopulation], &p_End, 10), 0xFFFFFFFFULL));
+            c_Entry.p_Country[0] = p_Column[i_ColumnCountry][0];
+            c_Entry.p_Country[1] = (c_Entry.p_Country[0] != '\0' ? p_Column[i_ColumnCountry][1] : '\0');
+            c_Entry.u8_NameSize = static_cast<MRH_Uint8>(us_NameSize);
+            c_Entry.u8_Reserved = 0;
+            
+            v_Point.emplace_back(c_Point);
+            v_Entry.emplace_back(c_Entry);
+            v_Name.insert(v_Name.end(), p_Column[i_ColumnName], p_Column[i_ColumnName] + us_NameSize);
+        }
+    }
+    catch (std::exception& e)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to read place data: " + std::string(e.what()),
+                     "LocationGeocode.cpp", __LINE__);
+        
+        free(p_Line);
+        fclose(p_Data);
+        return false;
+    }
+    
+    free(p_Line);
+    fclose(p_Data);
+    
+    // Stopped, nothing to report
+    if (b_Build == false)
+    {
+        return false;
+    }
+    else if (v_Point.size() == 0)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "No places found in " + s_DataPath + "!",
+                     "LocationGeocode.cpp", __LINE__);
+        return false;
+    }
+    
+    // Sort into an implicit k-d tree, each range is split at its
+    // middle element by the axis for its depth
+    std::vector<MRH_Uint32> v_Order(v_Point.size());
+    std::vector<std::pair<MRH_Uint32, MRH_Uint32>> v_Range;
+    std::vector<int> v_Axis;
+    
+    for (MRH_Uint32 i = 0; i < v_Order.size(); ++i)
+    {
+        v_Order[i] = i;
+    }
+    
+    v_Range.emplace_back(0, static_cast<MRH_Uint32>(v_Order.size()));
+    v_Axis.emplace_back(0);
+    
+    while (v_Range.size() > 0)
+    {
+        MRH_Uint32 u32_Low = v_Range.back().first;
+        MRH_Uint32 u32_High = v_Range.back().second;
+        int i_Axis = v_Axis.back();
+        
+        v_Range.pop_back();
+        v_Axis.pop_back();
+        
+        if (u32_High - u32_Low <= u32_LeafSize)
+        {
+            continue;
+        }
+        
+        MRH_Uint32 u32_Middle = u32_Low + ((u32_High - u32_Low) / 2);
+        
+        std::nth_element(v_Order.begin() + u32_Low,
+                         v_Order.begin() + u32_Middle,
+                         v_Order.begin() + u32_High,
+                         [&v_Point, i_Axis](MRH_Uint32 u32_A, MRH_Uint32 u32_B)
+                         {
+                             return v_Point[u32_A].p_Axis[i_Axis] < v_Point[u32_B].p_Axis[i_Axis];
+                         });
+        
+        v_Range.emplace_back(u32_Low, u32_Middle);
+        v_Axis.emplace_back((i_Axis + 1) % 3);
+        v_Range.emplace_back(u32_Middle + 1, u32_High);
+        v_Axis.emplace_back((i_Axis + 1) % 3);
+    }
+    
+    // Write to a temporary file first, a failed build keeps the old index
+    std::string s_TempPath = s_IndexPath + ".tmp";
+    FILE* p_Index = fopen(s_TempPath.c_str(), "wb");
+    Header c_Header;
+    bool b_Written;
+    
+    if (p_Index == NULL)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to create place index " +
+                                           s_TempPath +
+                                           ": " +
+                                           std::string(std::strerror(errno)) +
+                                           " (" +
+                                           std::to_string(errno) +
+                                           ")!",
+                     "LocationGeocode.cpp", __LINE__);
+        return false;
+    }
+    
+    std::memset(&c_Header, 0, sizeof(c_Header));
+    c_Header.u32_Magic = u32_IndexMagic;
+    c_Header.u32_Version = u32_IndexVersion;
+    c_Header.u32_Count = static_cast<MRH_Uint32>(v_Point.size());
+    c_Header.u32_NameSize = static_cast<MRH_Uint32>(v_Name.size());
+    c_Header.u64_DataSize = u64_DataSize;
+    c_Header.s64_DataTime = s64_DataTime;
+    
+    b_Written = fwrite(&c_Header, sizeof(c_Header), 1, p_Index) == 1;
+    
+    for (size_t i = 0; i < v_Order.size() && b_Written == true; ++i)
+    {
+        b_Written = fwrite(&(v_Point[v_Order[i]]), sizeof(Point), 1, p_Index) == 1;
+    }
+    
+    for (size_t i = 0; i < v_Order.size() && b_Written == true; ++i)
+    {
+        b_Written = fwrite(&(v_Entry[v_Order[i]]), sizeof(Entry), 1, p_Index) == 1;
+    }
+    
+    if (b_Written == true && v_Name.size() > 0)
+    {
+        b_Written = fwrite(v_Name.data(), v_Name.size(), 1, p_Index) == 1;
+    }
+    
+    if (fclose(p_Index) != 0 || b_Written == false || rename(s_TempPath.c_str(), s_IndexPath.c_str()) != 0)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to write place index " +
+                                           s_IndexPath +
+                                           ": " +
+                                           std::string(std::strerror(errno)) +
+                                           " (" +
+                                           std::to_string(errno) +
+                                           ")!",
+                     "LocationGeocode.cpp", __LINE__);
+        
+        unlink(s_TempPath.c_str());
+        return false;
+    }
+    
+    c_Logger.Log(MRH_PSBLogger::INFO, "Built place index with " +
+                                      std::to_string(v_Point.size()) +
+                                      " places in " +
+                                      std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - c_Start).count()) +
+                                      " ms.",
+                 "LocationGeocode.cpp", __LINE__);
+    
+    return true;
+}
+
+void LocationGeocode::BuildIndex(LocationGeocode* p_Instance, std::string s_DataPath, std::string s_IndexPath, MRH_Uint64 u64_DataSize, MRH_Sint64 s64_DataTime) noexcept
+{
+    if (Build(s_DataPath, s_IndexPath, u64_DataSize, s64_DataTime, p_Instance->b_Build) == false || 
+        p_Instance->Map(s_IndexPath, u64_DataSize, s64_DataTime) == false)
+    {
+        if (p_Instance->b_Build == true)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "No place index available, reverse geocoding disabled.",
+                                           "LocationGeocode.cpp", __LINE__);
+        }
+    }
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool LocationGeocode::Lookup(LocationSnapshot::Fix const& c_Fix, Place& c_Place) noexcept
+{
+    if (c_Fix.b_Recieved == false)
+    {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    // Repeated lookups between fixes reuse the result
+    if (b_Cached == false ||
+        u64_CachedTimeMS != c_Fix.u64_TimeMS ||
+        f64_CachedLatitude != c_Fix.f64_Latitude ||
+        f64_CachedLongtitude != c_Fix.f64_Longtitude)
+    {
+        // Results before the index is loaded are not kept
+        bool b_Loaded = b_Mapped;
+        
+        b_CachedFound = Find(c_Fix.f64_Latitude, c_Fix.f64_Longtitude, c_CachedPlace);
+        b_Cached = b_Loaded;
+        u64_CachedTimeMS = c_Fix.u64_TimeMS;
+        f64_CachedLatitude = c_Fix.f64_Latitude;
+        f64_CachedLongtitude = c_Fix.f64_Longtitude;
+    }
+    
+    c_Place = c_CachedPlace;
+    return b_CachedFound;
+}
+
+bool LocationGeocode::Find(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, Place& c_Place) const noexcept
+{
+    if (b_Mapped == false || u32_Count == 0 || std::isfinite(f64_Latitude) == false || std::isfinite(f64_Longtitude) == false)
+    {
+        return false;
+    }
+    
+    typedef struct Range_t
+    {
+        MRH_Uint32 u32_Low;
+        MRH_Uint32 u32_High;
+        int i_Axis;
+        float f32_Bound; // Squared distance to the splitting plane
+        
+    }Range;
+    
+    Range p_Stack[i_StackSize];
+    int i_Stack = 0;
+    float p_Axis[3];
+    float f32_Best = 5.f; // Larger than any chord
+    MRH_Uint32 u32_Best = 0;
+    
+    ToAxis(f64_Latitude, f64_Longtitude, p_Axis);
+    p_Stack[i_Stack++] = { 0, u32_Count, 0, 0.f };
+    
+    while (i_Stack > 0)
+    {
+        Range c_Range = p_Stack[--i_Stack];
+        
+        if (c_Range.f32_Bound >= f32_Best)
+        {
+            continue;
+        }
+        else if (c_Range.u32_High - c_Range.u32_Low <= u32_LeafSize)
+        {
+            for (MRH_Uint32 i = c_Range.u32_Low; i < c_Range.u32_High; ++i)
+            {
+                float f32_Distance = GetDistance(p_Axis, p_Point[i].p_Axis);
+                
+                if (f32_Distance < f32_Best)
+                {
+                    f32_Best = f32_Distance;
+                    u32_Best = i;
+                }
+            }
+            
+            continue;
+        }
+        
+        MRH_Uint32 u32_Middle = c_Range.u32_Low + ((c_Range.u32_High - c_Range.u32_Low) / 2);
+        float f32_Distance = GetDistance(p_Axis, p_Point[u32_Middle].p_Axis);
+        float f32_Plane = p_Axis[c_Range.i_Axis] - p_Point[u32_Middle].p_Axis[c_Range.i_Axis];
+        int i_Axis = (c_Range.i_Axis + 1) % 3;
+        
+        if (f32_Distance < f32_Best)
+        {
+            f32_Best = f32_Distance;
+            u32_Best = u32_Middle;
+        }
+        
+        // Far side first, the near side is searched next
+        Range c_Low = { c_Range.u32_Low, u32_Middle, i_Axis, c_Range.f32_Bound };
+        Range c_High = { u32_Middle + 1, c_Range.u32_High, i_Axis, c_Range.f32_Bound };
+        
+        if (f32_Plane < 0.f)
+        {
+            c_High.f32_Bound = std::max(c_Range.f32_Bound, f32_Plane * f32_Plane);
+            p_Stack[i_Stack++] = c_High;
+            p_Stack[i_Stack++] = c_Low;
+        }
+        else
+        {
+            c_Low.f32_Bound = std::max(c_Range.f32_Bound, f32_Plane * f32_Plane);
+            p_Stack[i_Stack++] = c_Low;
+            p_Stack[i_Stack++] = c_High;
+        }
+    }
+    
+    Entry const& c_Entry = p_Entry[u32_Best];
+    const float* p_Found = p_Point[u32_Best].p_Axis;
+    
+    if (static_cast<MRH_Uint64>(c_Entry.u32_Name) + c_Entry.u8_NameSize > u32_NameSize)
+    {
+        return false;
+    }
+    
+    c_Place.p_Name = p_Name + c_Entry.u32_Name;
+    c_Place.u8_NameSize = c_Entry.u8_NameSize;
+    c_Place.p_Country[0] = c_Entry.p_Country[0];
+    c_Place.p_Country[1] = c_Entry.p_Country[1];
+    c_Place.u32_Population = c_Entry.u32_Population;
+    c_Place.f64_Latitude = std::asin(std::max(-1.0, std::min(1.0, static_cast<MRH_Sfloat64>(p_Found[2])))) / f64_Radians;
+    c_Place.f64_Longtitude = std::atan2(p_Found[1], p_Found[0]) / f64_Radians;
+    c_Place.f64_Distance = 2.0 * f64_EarthRadius * std::asin(std::min(1.0, std::sqrt(static_cast<MRH_Sfloat64>(f32_Best)) / 2.0));
+    
+    return true;
+}
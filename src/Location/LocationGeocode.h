@@ -0,0 +1,228 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationGeocode_h
+#define LocationGeocode_h
+
+// C / C++
+#include <string>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+
+
+class LocationGeocode
+{
+public:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Place_t
+    {
+        // Points into the mapped index, not terminated
+        const char* p_Name;
+        MRH_Uint8 u8_NameSize;
+        char p_Country[2];
+        MRH_Uint32 u32_Population;
+        
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Distance; // Meters from the looked up location
+        
+    }Place;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. An existing index is only mapped. The index 
+     *  is rebuilt from the place data on a background thread if it is 
+     *  missing or was built from different data. Lookups fail until an 
+     *  index is loaded.
+     *
+     *  \param s_DataPath The full path to the GeoNames place data, empty
+     *                    to use the index as is.
+     *  \param s_IndexPath The full path to the place index file.
+     */
+    
+    LocationGeocode(std::string const& s_DataPath, std::string const& s_IndexPath) noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationGeocode LocationGeocode class source.
+     */
+    
+    LocationGeocode(LocationGeocode const& c_LocationGeocode) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationGeocode() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the place closest to a location fix. The result is kept until
+     *  a different fix is looked up. This function is thread safe.
+     *
+     *  \param c_Fix The fix to look up.
+     *  \param c_Place The place to write to.
+     *
+     *  \return true if a place was found, false if not.
+     */
+    
+    bool Lookup(LocationSnapshot::Fix const& c_Fix, Place& c_Place) noexcept;
+    
+    /**
+     *  Get the place closest to a location. This function is thread safe.
+     *
+     *  \param f64_Latitude The location latitude.
+     *  \param f64_Longtitude The location longtitude.
+     *  \param c_Place The place to write to.
+     *
+     *  \return true if a place was found, false if not.
+     */
+    
+    bool Find(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, Place& c_Place) const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Header_t
+    {
+        MRH_Uint32 u32_Magic;
+        MRH_Uint32 u32_Version;
+        MRH_Uint32 u32_Count;
+        MRH_Uint32 u32_NameSize;
+        
+        // Place data the index was built from
+        MRH_Uint64 u64_DataSize;
+        MRH_Sint64 s64_DataTime;
+        
+    }Header;
+    
+    // Unit vector, places are stored as implicit k-d tree
+    typedef struct Point_t
+    {
+        float p_Axis[3];
+        
+    }Point;
+    
+    // Same order as the points
+    typedef struct Entry_t
+    {
+        MRH_Uint32 u32_Name;
+        MRH_Uint32 u32_Population;
+        char p_Country[2];
+        MRH_Uint8 u8_NameSize;
+        MRH_Uint8 u8_Reserved;
+        
+    }Entry;
+    
+    //*************************************************************************************
+    // Index
+    //*************************************************************************************
+    
+    /**
+     *  Map the index file.
+     *
+     *  \param s_IndexPath The full path to the place index file.
+     *  \param u64_DataSize The expected place data size, 0 to skip the check.
+     *  \param s64_DataTime The expected place data modification time.
+     *
+     *  \return true if the index was mapped, false if not.
+     */
+    
+    bool Map(std::string const& s_IndexPath, MRH_Uint64 u64_DataSize, MRH_Sint64 s64_DataTime) noexcept;
+    
+    /**
+     *  Build the index file from place data.
+     *
+     *  \param s_DataPath The full path to the GeoNames place data.
+     *  \param s_IndexPath The full path to the place index file.
+     *  \param u64_DataSize The place data size.
+     *  \param s64_DataTime The place data modification time.
+     *  \param b_Build The flag to stop building early if cleared.
+     *
+     *  \return true if the index was built, false if not.
+     */
+    
+    static bool Build(std::string const& s_DataPath, std::string const& s_IndexPath, MRH_Uint64 u64_DataSize, MRH_Sint64 s64_DataTime, std::atomic<bool> const& b_Build) noexcept;
+    
+    /**
+     *  Build the index file and map it once built.
+     *
+     *  \param p_Instance The class instance to map the index for.
+     *  \param s_DataPath The full path to the GeoNames place data.
+     *  \param s_IndexPath The full path to the place index file.
+     *  \param u64_DataSize The place data size.
+     *  \param s64_DataTime The place data modification time.
+     */
+    
+    static void BuildIndex(LocationGeocode* p_Instance, std::string s_DataPath, std::string s_IndexPath, MRH_Uint64 u64_DataSize, MRH_Sint64 s64_DataTime) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Mapped index, read only
+    void* p_Map;
+    size_t us_MapSize;
+    
+    MRH_Uint32 u32_Count;
+    const Point* p_Point;
+    const Entry* p_Entry;
+    const char* p_Name;
+    MRH_Uint32 u32_NameSize;
+    
+    // Set after the mapped index above, which is never changed again
+    std::atomic<bool> b_Mapped;
+    
+    // Builds a missing index without delaying startup
+    std::thread c_BuildThread;
+    std::atomic<bool> b_Build;
+    
+    // Last looked up fix
+    std::mutex c_Mutex;
+    bool b_Cached;
+    bool b_CachedFound;
+    MRH_Uint64 u64_CachedTimeMS;
+    MRH_Sfloat64 f64_CachedLatitude;
+    MRH_Sfloat64 f64_CachedLongtitude;
+    Place c_CachedPlace;
+    
+protected:
+    
+};
+
+#endif /* LocationGeocode_h */
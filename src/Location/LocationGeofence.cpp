@@ -0,0 +1,592 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+#include <libmrhpsb/MRH_Callback.h>
+
+// Project
+#include "./LocationGeofence.h"
+#include "../Callback/Service/CustomCommand.h"
+#include "../Callback/ResponseEvent.h"
+
+namespace
+{
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0; // Meters
+    constexpr MRH_Sfloat64 f64_Pi = 3.14159265358979323846;
+    constexpr MRH_Sfloat64 f64_MetersPerLatitude = f64_EarthRadius * f64_Pi / 180.0;
+    
+    constexpr MRH_Sfloat64 f64_CellSize = MRH_USER_LOCATION_GEOFENCE_CELL_MDEG / 1000.0; // Degrees
+    
+    // Configured ids stay below, added regions use ids above
+    constexpr MRH_Uint32 u32_AddedID = 0x80000000;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationGeofence::LocationGeofence(std::vector<Configuration::Geofence> const& v_Geofence) : u32_NextID(u32_AddedID)
+{
+    for (auto& Geofence : v_Geofence)
+    {
+        Region c_Region;
+        
+        if (Geofence.u32_ID == 0 || Geofence.u32_ID >= u32_AddedID)
+        {
+            throw Exception("Invalid geofence id " + std::to_string(Geofence.u32_ID) + "!");
+        }
+        else if (Geofence.v_Latitude.size() != Geofence.v_Longtitude.size() ||
+                 Create(c_Region, 
+                        Geofence.f64_Radius, 
+                        Geofence.v_Latitude.data(), 
+                        Geofence.v_Longtitude.data(), 
+                        static_cast<MRH_Uint32>(Geofence.v_Latitude.size())) == false)
+        {
+            throw Exception("Invalid geofence " + std::to_string(Geofence.u32_ID) + " region!");
+        }
+        
+        for (auto& Existing : v_Region)
+        {
+            if (Existing.u32_ID == Geofence.u32_ID)
+            {
+                throw Exception("Duplicate geofence id " + std::to_string(Geofence.u32_ID) + "!");
+            }
+        }
+        
+        c_Region.u32_ID = Geofence.u32_ID;
+        c_Region.u32_GroupID = 0;
+        c_Region.b_Shared = true;
+        
+        v_Region.emplace_back(std::move(c_Region));
+    }
+    
+    if (v_Region.size() > MRH_USER_LOCATION_GEOFENCE_MAX)
+    {
+        throw Exception("Too many geofences, " +
+                        std::to_string(MRH_USER_LOCATION_GEOFENCE_MAX) +
+                        " are supported!");
+    }
+    
+    Build();
+}
+
+LocationGeofence::~LocationGeofence() noexcept
+{}
+
+//*************************************************************************************
+// Regions
+//*************************************************************************************
+
+MRH_Uint32 LocationGeofence::Add(MRH_Uint32 u32_GroupID, MRH_Sfloat64 f64_Radius, const MRH_Sfloat64* p_Latitude, const MRH_Sfloat64* p_Longtitude, MRH_Uint32 u32_Count) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    if (v_Region.size() >= MRH_USER_LOCATION_GEOFENCE_MAX)
+    {
+        return 0;
+    }
+    
+    try
+    {
+        Region c_Region;
+        
+        if (Create(c_Region, f64_Radius, p_Latitude, p_Longtitude, u32_Count) == false)
+        {
+            return 0;
+        }
+        
+        // Skip ids still in use after wrapping around
+        do
+        {
+            c_Region.u32_ID = u32_NextID;
+            u32_NextID = (u32_NextID == 0xFFFFFFFF ? u32_AddedID : u32_NextID + 1);
+        }
+        while (p_Index->m_Region.count(c_Region.u32_ID) > 0);
+        
+        c_Region.u32_GroupID = u32_GroupID;
+        c_Region.b_Shared = false;
+        
+        v_Region.emplace_back(std::move(c_Region));
+        
+        try
+        {
+            Build();
+        }
+        catch (...)
+        {
+            v_Region.pop_back();
+            throw;
+        }
+        
+        return v_Region.back().u32_ID;
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to add geofence: " + std::string(e.what()),
+                                       "LocationGeofence.cpp", __LINE__);
+        return 0;
+    }
+}
+
+bool LocationGeofence::Remove(MRH_Uint32 u32_GroupID, MRH_Uint32 u32_RegionID) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    for (auto It = v_Region.begin(); It != v_Region.end(); ++It)
+    {
+        if (It->u32_ID != u32_RegionID)
+        {
+            continue;
+        }
+        else if (It->b_Shared == true || It->u32_GroupID != u32_GroupID)
+        {
+            return false;
+        }
+        
+        Region c_Region = std::move(*It);
+        v_Region.erase(It);
+        
+        try
+        {
+            Build();
+        }
+        catch (std::exception& e)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to remove geofence: " + std::string(e.what()),
+                                           "LocationGeofence.cpp", __LINE__);
+            v_Region.emplace_back(std::move(c_Region));
+            return false;
+        }
+        
+        return true;
+    }
+    
+    return false;
+}
+
+bool LocationGeofence::Subscribe(MRH_Uint32 u32_GroupID) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    if (std::find(v_Subscription.begin(), v_Subscription.end(), u32_GroupID) != v_Subscription.end())
+    {
+        return true;
+    }
+    else if (v_Subscription.size() >= MRH_USER_LOCATION_SUBSCRIPTION_MAX)
+    {
+        return false;
+    }
+    
+    try
+    {
+        v_Subscription.emplace_back(u32_GroupID);
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to add geofence subscription: " + std::string(e.what()),
+                                       "LocationGeofence.cpp", __LINE__);
+        return false;
+    }
+    
+    return true;
+}
+
+bool LocationGeofence::Unsubscribe(MRH_Uint32 u32_GroupID) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    auto It = std::find(v_Subscription.begin(), v_Subscription.end(), u32_GroupID);
+    
+    if (It == v_Subscription.end())
+    {
+        return false;
+    }
+    
+    v_Subscription.erase(It);
+    return true;
+}
+
+void LocationGeofence::Clear() noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    v_Subscription.clear();
+    v_Region.erase(std::remove_if(v_Region.begin(), 
+                                  v_Region.end(),
+                                  [](Region const& c_Region) { return c_Region.b_Shared == false; }),
+                   v_Region.end());
+    
+    try
+    {
+        Build();
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to clear geofences: " + std::string(e.what()),
+                                       "LocationGeofence.cpp", __LINE__);
+    }
+}
+
+bool LocationGeofence::Create(Region& c_Region, MRH_Sfloat64 f64_Radius, const MRH_Sfloat64* p_Latitude, const MRH_Sfloat64* p_Longtitude, MRH_Uint32 u32_Count) noexcept
+{
+    if (std::isfinite(f64_Radius) == false || f64_Radius < 0.0 ||
+        (f64_Radius > 0.0 && u32_Count != 1) ||
+        (f64_Radius == 0.0 && (u32_Count < 3 || u32_Count > MRH_USER_LOCATION_GEOFENCE_POINT_MAX)))
+    {
+        return false;
+    }
+    
+    c_Region.f64_MinLatitude = 90.0;
+    c_Region.f64_MaxLatitude = -90.0;
+    c_Region.f64_MinLongtitude = 180.0;
+    c_Region.f64_MaxLongtitude = -180.0;
+    
+    for (MRH_Uint32 i = 0; i < u32_Count; ++i)
+    {
+        if (std::fabs(p_Latitude[i]) > 90.0 || std::fabs(p_Longtitude[i]) > 180.0)
+        {
+            return false;
+        }
+        
+        c_Region.f64_MinLatitude = std::min(c_Region.f64_MinLatitude, p_Latitude[i]);
+        c_Region.f64_MaxLatitude = std::max(c_Region.f64_MaxLatitude, p_Latitude[i]);
+        c_Region.f64_MinLongtitude = std::min(c_Region.f64_MinLongtitude, p_Longtitude[i]);
+        c_Region.f64_MaxLongtitude = std::max(c_Region.f64_MaxLongtitude, p_Longtitude[i]);
+    }
+    
+    c_Region.f64_Radius = f64_Radius;
+    c_Region.f64_Latitude = p_Latitude[0];
+    c_Region.f64_Longtitude = p_Longtitude[0];
+    
+    if (f64_Radius > 0.0)
+    {
+        // Widen the bounds by the radius, never across the poles
+        MRH_Sfloat64 f64_Latitude = f64_Radius / f64_MetersPerLatitude;
+        
+        c_Region.f64_MinLatitude = std::max(c_Region.f64_MinLatitude - f64_Latitude, -90.0);
+        c_Region.f64_MaxLatitude = std::min(c_Region.f64_MaxLatitude + f64_Latitude, 90.0);
+        
+        MRH_Sfloat64 f64_Scale = std::cos(std::max(std::fabs(c_Region.f64_MinLatitude), 
+                                                   std::fabs(c_Region.f64_MaxLatitude)) * f64_Pi / 180.0);
+        MRH_Sfloat64 f64_Longtitude = (f64_Scale > 0.01 ? f64_Radius / (f64_MetersPerLatitude * f64_Scale) : 360.0);
+        
+        c_Region.f64_MinLongtitude = std::max(c_Region.f64_MinLongtitude - f64_Longtitude, -180.0);
+        c_Region.f64_MaxLongtitude = std::min(c_Region.f64_MaxLongtitude + f64_Longtitude, 180.0);
+        
+        return true;
+    }
+    
+    // Polygons may not cross the antimeridian
+    if (c_Region.f64_MaxLongtitude - c_Region.f64_MinLongtitude >= 180.0)
+    {
+        return false;
+    }
+    
+    try
+    {
+        c_Region.v_Y0.resize(u32_Count);
+        c_Region.v_Y1.resize(u32_Count);
+        c_Region.v_X0.resize(u32_Count);
+        c_Region.v_Slope.resize(u32_Count);
+    }
+    catch (...)
+    {
+        return false;
+    }
+    
+    for (MRH_Uint32 i = 0, j = u32_Count - 1; i < u32_Count; j = i++)
+    {
+        c_Region.v_Y0[i] = p_Latitude[j];
+        c_Region.v_Y1[i] = p_Latitude[i];
+        c_Region.v_X0[i] = p_Longtitude[j];
+        
+        // Horizontal edges are never crossed, slope unused
+        c_Region.v_Slope[i] = (p_Latitude[i] != p_Latitude[j] ? 
+                               (p_Longtitude[i] - p_Longtitude[j]) / (p_Latitude[i] - p_Latitude[j]) :
+                               0.0);
+    }
+    
+    return true;
+}
+
+void LocationGeofence::Build()
+{
+    std::shared_ptr<Index> p_Build(new Index());
+    
+    p_Build->v_Region = v_Region;
+    p_Build->m_Region.reserve(v_Region.size());
+    
+    for (MRH_Uint32 i = 0; i < p_Build->v_Region.size(); ++i)
+    {
+        Region const& c_Region = p_Build->v_Region[i];
+        p_Build->m_Region[c_Region.u32_ID] = i;
+        
+        // Add to each covered cell, large regions are always checked
+        MRH_Sint64 i64_MinLatitude = static_cast<MRH_Sint64>(std::floor(c_Region.f64_MinLatitude / f64_CellSize));
+        MRH_Sint64 i64_MaxLatitude = static_cast<MRH_Sint64>(std::floor(c_Region.f64_MaxLatitude / f64_CellSize));
+        MRH_Sint64 i64_MinLongtitude = static_cast<MRH_Sint64>(std::floor(c_Region.f64_MinLongtitude / f64_CellSize));
+        MRH_Sint64 i64_MaxLongtitude = static_cast<MRH_Sint64>(std::floor(c_Region.f64_MaxLongtitude / f64_CellSize));
+        
+        std::vector<Cell*> v_Cell;
+        
+        if ((i64_MaxLatitude - i64_MinLatitude + 1) * (i64_MaxLongtitude - i64_MinLongtitude + 1) > MRH_USER_LOCATION_GEOFENCE_CELL_MAX)
+        {
+            v_Cell.emplace_back(&(p_Build->c_Large));
+        }
+        else
+        {
+            for (MRH_Sint64 y = i64_MinLatitude; y <= i64_MaxLatitude; ++y)
+            {
+                for (MRH_Sint64 x = i64_MinLongtitude; x <= i64_MaxLongtitude; ++x)
+                {
+                    v_Cell.emplace_back(&(p_Build->m_Cell[GetKey(y, x)]));
+                }
+            }
+        }
+        
+        for (auto& It : v_Cell)
+        {
+            if (c_Region.f64_Radius > 0.0)
+            {
+                It->v_CircleLatitude.emplace_back(c_Region.f64_Latitude);
+                It->v_CircleLongtitude.emplace_back(c_Region.f64_Longtitude);
+                It->v_CircleRadius.emplace_back(c_Region.f64_Radius * c_Region.f64_Radius);
+                It->v_CircleRegion.emplace_back(i);
+            }
+            else
+            {
+                It->v_PolygonRegion.emplace_back(i);
+            }
+        }
+    }
+    
+    std::atomic_store(&p_Index, std::shared_ptr<const Index>(p_Build));
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationGeofence::Update(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    std::shared_ptr<const Index> p_Current = std::atomic_load(&p_Index);
+    
+    // Only the fix cell and large regions can contain the fix
+    MRH_Sfloat64 f64_MetersPerLongtitude = f64_MetersPerLatitude * std::cos(c_Fix.f64_Latitude * f64_Pi / 180.0);
+    auto Candidate = p_Current->m_Cell.find(GetKey(static_cast<MRH_Sint64>(std::floor(c_Fix.f64_Latitude / f64_CellSize)),
+                                                   static_cast<MRH_Sint64>(std::floor(c_Fix.f64_Longtitude / f64_CellSize))));
+    
+    v_Found.clear();
+    
+    try
+    {
+        if (Candidate != p_Current->m_Cell.end())
+        {
+            Test(*p_Current, Candidate->second, c_Fix.f64_Latitude, c_Fix.f64_Longtitude, f64_MetersPerLongtitude);
+        }
+        
+        Test(*p_Current, p_Current->c_Large, c_Fix.f64_Latitude, c_Fix.f64_Longtitude, f64_MetersPerLongtitude);
+        
+        std::sort(v_Found.begin(), v_Found.end());
+        v_Found.erase(std::unique(v_Found.begin(), v_Found.end()), v_Found.end());
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to test geofences: " + std::string(e.what()),
+                                       "LocationGeofence.cpp", __LINE__);
+        return;
+    }
+    
+    // Compare with the regions the last fix was inside, removed 
+    // regions are dropped without an event
+    auto Inside = v_Inside.begin();
+    auto Found = v_Found.begin();
+    
+    while (Inside != v_Inside.end() || Found != v_Found.end())
+    {
+        bool b_Entered;
+        MRH_Uint32 u32_ID;
+        
+        if (Found == v_Found.end() || (Inside != v_Inside.end() && *Inside < *Found))
+        {
+            b_Entered = false;
+            u32_ID = *(Inside++);
+        }
+        else if (Inside == v_Inside.end() || *Found < *Inside)
+        {
+            b_Entered = true;
+            u32_ID = *(Found++);
+        }
+        else
+        {
+            ++Inside;
+            ++Found;
+            continue;
+        }
+        
+        auto Entry = p_Current->m_Region.find(u32_ID);
+        
+        if (Entry != p_Current->m_Region.end())
+        {
+            Send(p_Current->v_Region[Entry->second], b_Entered, c_Fix);
+        }
+    }
+    
+    v_Inside.swap(v_Found);
+}
+
+void LocationGeofence::Test(Index const& c_Index, Cell const& c_Cell, MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, MRH_Sfloat64 f64_MetersPerLongtitude)
+{
+    // Circles, written without branches to allow vectorization
+    size_t us_Count = c_Cell.v_CircleRegion.size();
+    
+    if (us_Count > 0)
+    {
+        if (v_Margin.size() < us_Count)
+        {
+            v_Margin.resize(us_Count);
+        }
+        
+        const MRH_Sfloat64* p_CircleLatitude = c_Cell.v_CircleLatitude.data();
+        const MRH_Sfloat64* p_CircleLongtitude = c_Cell.v_CircleLongtitude.data();
+        const MRH_Sfloat64* p_CircleRadius = c_Cell.v_CircleRadius.data();
+        MRH_Sfloat64* p_Margin = v_Margin.data();
+        
+        for (size_t i = 0; i < us_Count; ++i)
+        {
+            MRH_Sfloat64 f64_North = (f64_Latitude - p_CircleLatitude[i]) * f64_MetersPerLatitude;
+            MRH_Sfloat64 f64_East = (f64_Longtitude - p_CircleLongtitude[i]) * f64_MetersPerLongtitude;
+            
+            p_Margin[i] = p_CircleRadius[i] - ((f64_North * f64_North) + (f64_East * f64_East));
+        }
+        
+        for (size_t i = 0; i < us_Count; ++i)
+        {
+            if (p_Margin[i] >= 0.0)
+            {
+                v_Found.emplace_back(c_Index.v_Region[c_Cell.v_CircleRegion[i]].u32_ID);
+            }
+        }
+    }
+    
+    // Polygons, counts edge crossings of a ray towards east
+    for (auto& It : c_Cell.v_PolygonRegion)
+    {
+        Region const& c_Region = c_Index.v_Region[It];
+        
+        if (f64_Latitude < c_Region.f64_MinLatitude || f64_Latitude > c_Region.f64_MaxLatitude ||
+            f64_Longtitude < c_Region.f64_MinLongtitude || f64_Longtitude > c_Region.f64_MaxLongtitude)
+        {
+            continue;
+        }
+        
+        const MRH_Sfloat64* p_Y0 = c_Region.v_Y0.data();
+        const MRH_Sfloat64* p_Y1 = c_Region.v_Y1.data();
+        const MRH_Sfloat64* p_X0 = c_Region.v_X0.data();
+        const MRH_Sfloat64* p_Slope = c_Region.v_Slope.data();
+        size_t us_Edges = c_Region.v_Y0.size();
+        MRH_Uint32 u32_Crossings = 0;
+        
+        for (size_t i = 0; i < us_Edges; ++i)
+        {
+            u32_Crossings += ((p_Y0[i] > f64_Latitude) != (p_Y1[i] > f64_Latitude)) &
+                             (f64_Longtitude < p_X0[i] + ((f64_Latitude - p_Y0[i]) * p_Slope[i]));
+        }
+        
+        if ((u32_Crossings & 1) != 0)
+        {
+            v_Found.emplace_back(c_Region.u32_ID);
+        }
+    }
+}
+
+void LocationGeofence::Send(Region const& c_Region, bool b_Entered, LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    CustomCommand::GeofenceEvent_S c_Data;
+    c_Data.c_Header.u32_Command = CustomCommand::GEOFENCE_EVENT;
+    c_Data.u32_RegionID = c_Region.u32_ID;
+    c_Data.u8_Entered = (b_Entered == true ? 1 : 0);
+    c_Data.u64_TimeMS = c_Fix.u64_TimeMS;
+    c_Data.f64_Latitude = c_Fix.f64_Latitude;
+    c_Data.f64_Longtitude = c_Fix.f64_Longtitude;
+    
+    // Configured regions go to all subscribers, added ones to the owner
+    // The list keeps its capacity, only growing subscriptions allocate
+    v_GroupID.clear();
+    
+    try
+    {
+        if (c_Region.b_Shared == true)
+        {
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            v_GroupID.assign(v_Subscription.begin(), v_Subscription.end());
+        }
+        else
+        {
+            v_GroupID.emplace_back(c_Region.u32_GroupID);
+        }
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, e.what(),
+                                       "LocationGeofence.cpp", __LINE__);
+        return;
+    }
+    
+    for (auto& GroupID : v_GroupID)
+    {
+        ResponseEvent::Send(MRH_EVENT_USER_CUSTOM_COMMAND_S, &c_Data, sizeof(c_Data), GroupID);
+    }
+}
+
+MRH_Uint64 LocationGeofence::GetKey(MRH_Sint64 i64_Latitude, MRH_Sint64 i64_Longtitude) noexcept
+{
+    return (static_cast<MRH_Uint64>(static_cast<MRH_Uint32>(i64_Latitude)) << 32) | static_cast<MRH_Uint32>(i64_Longtitude);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool LocationGeofence::GetSubscribed() noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    if (v_Subscription.empty() == false)
+    {
+        return true;
+    }
+    
+    // Added regions send to their owner
+    for (auto const& Region : v_Region)
+    {
+        if (Region.b_Shared == false)
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
@@ -0,0 +1,305 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationGeofence_h
+#define LocationGeofence_h
+
+// C / C++
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+#include "../Configuration.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_GEOFENCE_MAX
+    #define MRH_USER_LOCATION_GEOFENCE_MAX 16384
+#endif
+#ifndef MRH_USER_LOCATION_GEOFENCE_POINT_MAX
+    #define MRH_USER_LOCATION_GEOFENCE_POINT_MAX 64
+#endif
+#ifndef MRH_USER_LOCATION_GEOFENCE_CELL_MDEG
+    #define MRH_USER_LOCATION_GEOFENCE_CELL_MDEG 10
+#endif
+#ifndef MRH_USER_LOCATION_GEOFENCE_CELL_MAX
+    #define MRH_USER_LOCATION_GEOFENCE_CELL_MAX 256
+#endif
+#ifndef MRH_USER_LOCATION_SUBSCRIPTION_MAX
+    #define MRH_USER_LOCATION_SUBSCRIPTION_MAX 16
+#endif
+
+
+class LocationGeofence
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param v_Geofence The configured regions, shared by all subscribers.
+     */
+    
+    LocationGeofence(std::vector<Configuration::Geofence> const& v_Geofence);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationGeofence LocationGeofence class source.
+     */
+    
+    LocationGeofence(LocationGeofence const& c_LocationGeofence) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationGeofence() noexcept;
+    
+    //*************************************************************************************
+    // Regions
+    //*************************************************************************************
+    
+    /**
+     *  Add a region owned by a group id. The region is a circle if a 
+     *  radius is given, otherwise a polygon. This function is thread safe.
+     *
+     *  \param u32_GroupID The event group id to send region events to.
+     *  \param f64_Radius The circle radius in meters, 0 for a polygon.
+     *  \param p_Latitude The circle center or polygon point latitudes.
+     *  \param p_Longtitude The circle center or polygon point longtitudes.
+     *  \param u32_Count The number of points.
+     *
+     *  \return The region id on success, 0 on failure.
+     */
+    
+    MRH_Uint32 Add(MRH_Uint32 u32_GroupID, MRH_Sfloat64 f64_Radius, const MRH_Sfloat64* p_Latitude, const MRH_Sfloat64* p_Longtitude, MRH_Uint32 u32_Count) noexcept;
+    
+    /**
+     *  Remove a region owned by a group id. This function is thread safe.
+     *
+     *  \param u32_GroupID The event group id owning the region.
+     *  \param u32_RegionID The region to remove.
+     *
+     *  \return true if removed, false if not.
+     */
+    
+    bool Remove(MRH_Uint32 u32_GroupID, MRH_Uint32 u32_RegionID) noexcept;
+    
+    /**
+     *  Subscribe to events of the configured regions. This function is 
+     *  thread safe.
+     *
+     *  \param u32_GroupID The event group id to send region events to.
+     *
+     *  \return true if subscribed, false if no subscription is available.
+     */
+    
+    bool Subscribe(MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Remove the subscription for a group id. This function is thread safe.
+     *
+     *  \param u32_GroupID The event group id to unsubscribe.
+     *
+     *  \return true if a subscription was removed, false if not.
+     */
+    
+    bool Unsubscribe(MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Remove all added regions and subscriptions. This function is 
+     *  thread safe.
+     */
+    
+    void Clear() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Test a new location fix and send enter and leave events. Only a 
+     *  single thread may update.
+     *
+     *  \param c_Fix The new location fix.
+     */
+    
+    void Update(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Check if any event group id recieves region events, either by 
+     *  subscription or as the owner of an added region. This function 
+     *  is thread safe.
+     *
+     *  \return true if region events are sent, false if not.
+     */
+    
+    bool GetSubscribed() noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Region_t
+    {
+        MRH_Uint32 u32_ID;
+        MRH_Uint32 u32_GroupID;
+        bool b_Shared; // Configured, sent to subscribers
+        
+        // Circle
+        MRH_Sfloat64 f64_Radius;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+        // Polygon edges, y is latitude and x longtitude
+        std::vector<MRH_Sfloat64> v_Y0;
+        std::vector<MRH_Sfloat64> v_Y1;
+        std::vector<MRH_Sfloat64> v_X0;
+        std::vector<MRH_Sfloat64> v_Slope;
+        
+        // Bounds
+        MRH_Sfloat64 f64_MinLatitude;
+        MRH_Sfloat64 f64_MaxLatitude;
+        MRH_Sfloat64 f64_MinLongtitude;
+        MRH_Sfloat64 f64_MaxLongtitude;
+        
+    }Region;
+    
+    typedef struct Cell_t
+    {
+        // Circles, radius squared in meters
+        std::vector<MRH_Sfloat64> v_CircleLatitude;
+        std::vector<MRH_Sfloat64> v_CircleLongtitude;
+        std::vector<MRH_Sfloat64> v_CircleRadius;
+        std::vector<MRH_Uint32> v_CircleRegion;
+        
+        std::vector<MRH_Uint32> v_PolygonRegion;
+        
+    }Cell;
+    
+    typedef struct Index_t
+    {
+        std::vector<Region> v_Region;
+        std::unordered_map<MRH_Uint32, MRH_Uint32> m_Region; // ID to region
+        
+        std::unordered_map<MRH_Uint64, Cell> m_Cell;
+        Cell c_Large; // Checked for every fix
+        
+    }Index;
+    
+    //*************************************************************************************
+    // Regions
+    //*************************************************************************************
+    
+    /**
+     *  Create a region.
+     *
+     *  \param c_Region The region to set.
+     *  \param f64_Radius The circle radius in meters, 0 for a polygon.
+     *  \param p_Latitude The circle center or polygon point latitudes.
+     *  \param p_Longtitude The circle center or polygon point longtitudes.
+     *  \param u32_Count The number of points.
+     *
+     *  \return true if the region is valid, false if not.
+     */
+    
+    static bool Create(Region& c_Region, MRH_Sfloat64 f64_Radius, const MRH_Sfloat64* p_Latitude, const MRH_Sfloat64* p_Longtitude, MRH_Uint32 u32_Count) noexcept;
+    
+    /**
+     *  Build and publish the index for the current regions. The mutex 
+     *  has to be locked.
+     */
+    
+    void Build();
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Collect all regions of a cell containing a location.
+     *
+     *  \param c_Index The index containing the cell.
+     *  \param c_Cell The cell to test.
+     *  \param f64_Latitude The location latitude.
+     *  \param f64_Longtitude The location longtitude.
+     *  \param f64_MetersPerLongtitude The meters per degree longtitude at the location.
+     */
+    
+    void Test(Index const& c_Index, Cell const& c_Cell, MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, MRH_Sfloat64 f64_MetersPerLongtitude);
+    
+    /**
+     *  Send a region event.
+     *
+     *  \param c_Region The region entered or left.
+     *  \param b_Entered If the region was entered.
+     *  \param c_Fix The fix which entered or left.
+     */
+    
+    void Send(Region const& c_Region, bool b_Entered, LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Get the cell key for a cell position.
+     *
+     *  \param i64_Latitude The cell latitude.
+     *  \param i64_Longtitude The cell longtitude.
+     *
+     *  \return The cell key.
+     */
+    
+    static MRH_Uint64 GetKey(MRH_Sint64 i64_Latitude, MRH_Sint64 i64_Longtitude) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Changed by commands
+    std::mutex c_Mutex;
+    std::vector<Region> v_Region;
+    std::vector<MRH_Uint32> v_Subscription;
+    MRH_Uint32 u32_NextID;
+    
+    // Read by the update thread, replaced on change
+    std::shared_ptr<const Index> p_Index;
+    
+    // Update thread only
+    std::vector<MRH_Uint32> v_Inside; // Region ids, sorted
+    std::vector<MRH_Uint32> v_Found;
+    std::vector<MRH_Sfloat64> v_Margin; // Squared radius - squared distance
+    std::vector<MRH_Uint32> v_GroupID; // Event receivers
+    
+protected:
+    
+};
+
+#endif /* LocationGeofence_h */
@@ -0,0 +1,179 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <new>
+
+// External
+
+// Project
+#include "./LocationHistory.h"
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationHistory::LocationHistory(MRH_Uint32 u32_Capacity) : u64_Capacity(1),
+                                                            u64_Reserved(0),
+                                                            u64_Written(0),
+                                                            u64_LastTimeMS(0)
+{
+    if (u32_Capacity > MRH_USER_LOCATION_HISTORY_MAX)
+    {
+        u32_Capacity = MRH_USER_LOCATION_HISTORY_MAX;
+    }
+    
+    while (u64_Capacity < u32_Capacity)
+    {
+        u64_Capacity <<= 1;
+    }
+    
+    u64_Mask = u64_Capacity - 1;
+    
+    try
+    {
+        p_TimeMS.reset(new std::atomic<MRH_Uint64>[u64_Capacity]());
+        p_Latitude.reset(new std::atomic<MRH_Sfloat64>[u64_Capacity]());
+        p_Longtitude.reset(new std::atomic<MRH_Sfloat64>[u64_Capacity]());
+        p_Elevation.reset(new std::atomic<MRH_Sfloat64>[u64_Capacity]());
+        p_Facing.reset(new std::atomic<MRH_Sfloat64>[u64_Capacity]());
+    }
+    catch (std::bad_alloc& e)
+    {
+        throw Exception("Failed to allocate location history: " + std::string(e.what()));
+    }
+}
+
+LocationHistory::~LocationHistory() noexcept
+{}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationHistory::Add(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    // Single writer, no need to check the indices
+    MRH_Uint64 u64_Index = u64_Written.load(std::memory_order_relaxed);
+    MRH_Uint64 u64_Slot = u64_Index & u64_Mask;
+    
+    // Keep time ordered for searching, even if the clock went back
+    if (c_Fix.u64_TimeMS > u64_LastTimeMS)
+    {
+        u64_LastTimeMS = c_Fix.u64_TimeMS;
+    }
+    
+    u64_Reserved.store(u64_Index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    p_TimeMS[u64_Slot].store(u64_LastTimeMS, std::memory_order_relaxed);
+    p_Latitude[u64_Slot].store(c_Fix.f64_Latitude, std::memory_order_relaxed);
+    p_Longtitude[u64_Slot].store(c_Fix.f64_Longtitude, std::memory_order_relaxed);
+    p_Elevation[u64_Slot].store(c_Fix.f64_Elevation, std::memory_order_relaxed);
+    p_Facing[u64_Slot].store(c_Fix.f64_Facing, std::memory_order_relaxed);
+    
+    u64_Written.store(u64_Index + 1, std::memory_order_release);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint32 LocationHistory::Get(MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, LocationSnapshot::Fix* p_Fix, MRH_Uint32 u32_Count) const noexcept
+{
+    if (p_Fix == NULL || u32_Count == 0 || u64_StartMS > u64_EndMS)
+    {
+        return 0;
+    }
+    
+    MRH_Uint64 u64_First;
+    MRH_Uint64 u64_Last;
+    MRH_Uint64 u64_Min;
+    
+    do
+    {
+        MRH_Uint64 u64_End = u64_Written.load(std::memory_order_acquire);
+        MRH_Uint64 u64_Begin = (u64_End > u64_Capacity ? u64_End - u64_Capacity : 0);
+        
+        u64_Min = u64_End;
+        
+        // Fixes are time ordered, find [start, end] range
+        u64_First = (u64_StartMS > 0 ? Search(u64_StartMS - 1, u64_Begin, u64_End, u64_Min) : u64_Begin);
+        u64_Last = Search(u64_EndMS, u64_First, u64_End, u64_Min);
+        
+        // Newest fixes only
+        if (u64_Last - u64_First > u32_Count)
+        {
+            u64_First = u64_Last - u32_Count;
+        }
+        
+        for (MRH_Uint64 i = u64_First; i < u64_Last; ++i)
+        {
+            MRH_Uint64 u64_Slot = i & u64_Mask;
+            LocationSnapshot::Fix& c_Fix = p_Fix[i - u64_First];
+            
+            c_Fix.b_Recieved = true;
+            c_Fix.u64_TimeMS = p_TimeMS[u64_Slot].load(std::memory_order_relaxed);
+            c_Fix.f64_Latitude = p_Latitude[u64_Slot].load(std::memory_order_relaxed);
+            c_Fix.f64_Longtitude = p_Longtitude[u64_Slot].load(std::memory_order_relaxed);
+            c_Fix.f64_Elevation = p_Elevation[u64_Slot].load(std::memory_order_relaxed);
+            c_Fix.f64_Facing = p_Facing[u64_Slot].load(std::memory_order_relaxed);
+            c_Fix.f64_Speed = 0.f;
+            c_Fix.f64_Course = 0.f;
+        }
+        
+        if (u64_First < u64_Min)
+        {
+            u64_Min = u64_First;
+        }
+        
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    while (u64_Reserved.load(std::memory_order_relaxed) > u64_Min + u64_Capacity); // Read slot was replaced
+    
+    return static_cast<MRH_Uint32>(u64_Last - u64_First);
+}
+
+MRH_Uint64 LocationHistory::Search(MRH_Uint64 u64_TimeMS, MRH_Uint64 u64_Begin, MRH_Uint64 u64_End, MRH_Uint64& u64_Min) const noexcept
+{
+    while (u64_Begin < u64_End)
+    {
+        MRH_Uint64 u64_Middle = u64_Begin + (u64_End - u64_Begin) / 2;
+        
+        if (u64_Middle < u64_Min)
+        {
+            u64_Min = u64_Middle;
+        }
+        
+        if (p_TimeMS[u64_Middle & u64_Mask].load(std::memory_order_relaxed) > u64_TimeMS)
+        {
+            u64_End = u64_Middle;
+        }
+        else
+        {
+            u64_Begin = u64_Middle + 1;
+        }
+    }
+    
+    return u64_Begin;
+}
+
+MRH_Uint32 LocationHistory::GetCapacity() const noexcept
+{
+    return static_cast<MRH_Uint32>(u64_Capacity);
+}
@@ -0,0 +1,150 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationHistory_h
+#define LocationHistory_h
+
+// C / C++
+#include <atomic>
+#include <memory>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+#include "../Exception.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_HISTORY_MAX
+    #define MRH_USER_LOCATION_HISTORY_MAX (1 << 20)
+#endif
+
+
+class LocationHistory
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param u32_Capacity The number of fixes to keep. Rounded up to a power of two.
+     */
+    
+    LocationHistory(MRH_Uint32 u32_Capacity);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationHistory LocationHistory class source.
+     */
+    
+    LocationHistory(LocationHistory const& c_LocationHistory) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationHistory() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Add a location fix, replacing the oldest fix if full. Only a single 
+     *  thread may add, this function never waits.
+     *
+     *  \param c_Fix The location fix to add.
+     */
+    
+    void Add(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the newest fixes inside a time range, oldest first. Never blocks, 
+     *  the read is retried if fixes were replaced at the same time. This 
+     *  function is thread safe.
+     *
+     *  \param u64_StartMS The first fix time to include in milliseconds.
+     *  \param u64_EndMS The last fix time to include in milliseconds.
+     *  \param p_Fix The fix buffer to write to.
+     *  \param u32_Count The maximum number of fixes to write.
+     *
+     *  \return The number of fixes written.
+     */
+    
+    MRH_Uint32 Get(MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, LocationSnapshot::Fix* p_Fix, MRH_Uint32 u32_Count) const noexcept;
+    
+    /**
+     *  Get the number of fixes which can be kept.
+     *
+     *  \return The history capacity.
+     */
+    
+    MRH_Uint32 GetCapacity() const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Find the first fix index with a time after the given time.
+     *
+     *  \param u64_TimeMS The time to search for.
+     *  \param u64_Begin The first fix index to search.
+     *  \param u64_End The fix index after the last fix to search.
+     *  \param u64_Min The lowest fix index read, updated on read.
+     *
+     *  \return The first fix index with a greater time or u64_End.
+     */
+    
+    MRH_Uint64 Search(MRH_Uint64 u64_TimeMS, MRH_Uint64 u64_Begin, MRH_Uint64 u64_End, MRH_Uint64& u64_Min) const noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    MRH_Uint64 u64_Capacity;
+    MRH_Uint64 u64_Mask;
+    
+    // Fix indices keep counting up, the slot is index & mask
+    std::atomic<MRH_Uint64> u64_Reserved; // Written before the slot
+    std::atomic<MRH_Uint64> u64_Written; // Written after the slot
+    MRH_Uint64 u64_LastTimeMS;
+    
+    // Fix values, one array per value
+    std::unique_ptr<std::atomic<MRH_Uint64>[]> p_TimeMS;
+    std::unique_ptr<std::atomic<MRH_Sfloat64>[]> p_Latitude;
+    std::unique_ptr<std::atomic<MRH_Sfloat64>[]> p_Longtitude;
+    std::unique_ptr<std::atomic<MRH_Sfloat64>[]> p_Elevation;
+    std::unique_ptr<std::atomic<MRH_Sfloat64>[]> p_Facing;
+    
+protected:
+    
+};
+
+#endif /* LocationHistory_h */
@@ -0,0 +1,193 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <cerrno>
+#include <cstddef>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./LocationLastFix.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_FileMagic = 0x4C4C4631; // "LLF1"
+    constexpr MRH_Uint32 u32_FileVersion = 1;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationLastFix::LocationLastFix(std::string const& s_FilePath) noexcept : p_File(NULL),
+                                                                         u64_Sequence(0)
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    int i_FD = open(s_FilePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat c_Stat;
+    void* p_Map = MAP_FAILED;
+    
+    if (i_FD >= 0 && 
+        fstat(i_FD, &c_Stat) == 0 && 
+        (c_Stat.st_size == sizeof(File) || ftruncate(i_FD, sizeof(File)) == 0))
+    {
+        p_Map = mmap(NULL, sizeof(File), PROT_READ | PROT_WRITE, MAP_SHARED, i_FD, 0);
+    }
+    
+    if (p_Map == MAP_FAILED)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to open last location file " +
+                                           s_FilePath +
+                                           ": " +
+                                           std::string(std::strerror(errno)) +
+                                           " (" +
+                                           std::to_string(errno) +
+                                           ")!",
+                     "LocationLastFix.cpp", __LINE__);
+        
+        if (i_FD >= 0)
+        {
+            close(i_FD);
+        }
+        
+        return;
+    }
+    
+    close(i_FD);
+    p_File = static_cast<File*>(p_Map);
+    
+    // New or unknown file, start over
+    if (p_File->u32_Magic != u32_FileMagic || p_File->u32_Version != u32_FileVersion)
+    {
+        std::memset(p_File, 0, sizeof(File));
+        p_File->u32_Magic = u32_FileMagic;
+        p_File->u32_Version = u32_FileVersion;
+    }
+    
+    const Record* p_Record = GetRecord();
+    
+    if (p_Record != NULL)
+    {
+        u64_Sequence = p_Record->u64_Sequence;
+    }
+}
+
+LocationLastFix::~LocationLastFix() noexcept
+{
+    if (p_File != NULL)
+    {
+        msync(p_File, sizeof(File), MS_SYNC);
+        munmap(p_File, sizeof(File));
+    }
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationLastFix::Store(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    if (p_File == NULL)
+    {
+        return;
+    }
+    
+    // Overwrite the older record
+    Record& c_Record = p_File->p_Record[++u64_Sequence % 2];
+    
+    c_Record.u64_Checksum = 0;
+    c_Record.u64_Sequence = u64_Sequence;
+    c_Record.u64_TimeMS = c_Fix.u64_TimeMS;
+    c_Record.f64_Latitude = c_Fix.f64_Latitude;
+    c_Record.f64_Longtitude = c_Fix.f64_Longtitude;
+    c_Record.f64_Elevation = c_Fix.f64_Elevation;
+    c_Record.f64_Facing = c_Fix.f64_Facing;
+    c_Record.u64_Checksum = GetChecksum(c_Record);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool LocationLastFix::Load(LocationSnapshot::Fix& c_Fix) const noexcept
+{
+    const Record* p_Record = GetRecord();
+    
+    if (p_Record == NULL)
+    {
+        return false;
+    }
+    
+    c_Fix.b_Recieved = true;
+    c_Fix.u64_TimeMS = p_Record->u64_TimeMS;
+    c_Fix.f64_Latitude = p_Record->f64_Latitude;
+    c_Fix.f64_Longtitude = p_Record->f64_Longtitude;
+    c_Fix.f64_Elevation = p_Record->f64_Elevation;
+    c_Fix.f64_Facing = p_Record->f64_Facing;
+    c_Fix.f64_Speed = 0.f;
+    c_Fix.f64_Course = 0.f;
+    
+    return true;
+}
+
+const LocationLastFix::Record* LocationLastFix::GetRecord() const noexcept
+{
+    const Record* p_Newest = NULL;
+    
+    if (p_File == NULL)
+    {
+        return NULL;
+    }
+    
+    for (auto& Current : p_File->p_Record)
+    {
+        if (Current.u64_Sequence == 0 || Current.u64_Checksum != GetChecksum(Current))
+        {
+            continue;
+        }
+        else if (p_Newest == NULL || p_Newest->u64_Sequence < Current.u64_Sequence)
+        {
+            p_Newest = &Current;
+        }
+    }
+    
+    return p_Newest;
+}
+
+MRH_Uint64 LocationLastFix::GetChecksum(Record const& c_Record) noexcept
+{
+    // FNV-1a over everything before the checksum
+    const MRH_Uint8* p_Byte = reinterpret_cast<const MRH_Uint8*>(&c_Record);
+    MRH_Uint64 u64_Hash = 0xcbf29ce484222325ULL;
+    
+    for (size_t i = 0; i < offsetof(Record, u64_Checksum); ++i)
+    {
+        u64_Hash ^= p_Byte[i];
+        u64_Hash *= 0x100000001b3ULL;
+    }
+    
+    return u64_Hash;
+}
@@ -0,0 +1,148 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationLastFix_h
+#define LocationLastFix_h
+
+// C / C++
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+
+
+class LocationLastFix
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. The last fix is not kept if the file can not 
+     *  be opened.
+     *
+     *  \param s_FilePath The full path to the last fix file.
+     */
+    
+    LocationLastFix(std::string const& s_FilePath) noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationLastFix LocationLastFix class source.
+     */
+    
+    LocationLastFix(LocationLastFix const& c_LocationLastFix) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationLastFix() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Replace the last fix. Only a single thread may replace the fix.
+     *
+     *  \param c_Fix The location fix to keep.
+     */
+    
+    void Store(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the last kept fix.
+     *
+     *  \param c_Fix The fix to write to.
+     *
+     *  \return true if a valid fix was kept, false if not.
+     */
+    
+    bool Load(LocationSnapshot::Fix& c_Fix) const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Record_t
+    {
+        MRH_Uint64 u64_Sequence;
+        MRH_Uint64 u64_TimeMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Elevation;
+        MRH_Sfloat64 f64_Facing;
+        MRH_Uint64 u64_Checksum; // Written last
+        
+    }Record;
+    
+    // Records are written alternating, a torn write keeps the other
+    typedef struct File_t
+    {
+        MRH_Uint32 u32_Magic;
+        MRH_Uint32 u32_Version;
+        Record p_Record[2];
+        
+    }File;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the checksum for a record.
+     *
+     *  \param c_Record The record to check.
+     *
+     *  \return The record checksum.
+     */
+    
+    static MRH_Uint64 GetChecksum(Record const& c_Record) noexcept;
+    
+    /**
+     *  Get the newest valid record.
+     *
+     *  \return The newest valid record or NULL.
+     */
+    
+    const Record* GetRecord() const noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    File* p_File;
+    MRH_Uint64 u64_Sequence;
+    
+protected:
+    
+};
+
+#endif /* LocationLastFix_h */
@@ -0,0 +1,116 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <chrono>
+
+// External
+
+// Project
+#include "./LocationSnapshot.h"
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationSnapshot::LocationSnapshot() noexcept : u32_Sequence(0),
+                                                b_Recieved(false),
+                                                f64_Latitude(0.f),
+                                                f64_Longtitude(0.f),
+                                                f64_Elevation(0.f),
+                                                f64_Facing(0.f),
+                                                f64_Speed(0.f),
+                                                f64_Course(0.f),
+                                                u64_TimeMS(0)
+{}
+
+LocationSnapshot::~LocationSnapshot() noexcept
+{}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationSnapshot::Store(Fix const& c_Fix) noexcept
+{
+    // Single writer, no need to check the sequence
+    MRH_Uint32 u32_Current = u32_Sequence.load(std::memory_order_relaxed);
+    
+    u32_Sequence.store(u32_Current + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    b_Recieved.store(c_Fix.b_Recieved, std::memory_order_relaxed);
+    f64_Latitude.store(c_Fix.f64_Latitude, std::memory_order_relaxed);
+    f64_Longtitude.store(c_Fix.f64_Longtitude, std::memory_order_relaxed);
+    f64_Elevation.store(c_Fix.f64_Elevation, std::memory_order_relaxed);
+    f64_Facing.store(c_Fix.f64_Facing, std::memory_order_relaxed);
+    f64_Speed.store(c_Fix.f64_Speed, std::memory_order_relaxed);
+    f64_Course.store(c_Fix.f64_Course, std::memory_order_relaxed);
+    u64_TimeMS.store(c_Fix.u64_TimeMS, std::memory_order_relaxed);
+    
+    u32_Sequence.store(u32_Current + 2, std::memory_order_release);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+LocationSnapshot::Fix LocationSnapshot::Load() const noexcept
+{
+    Fix c_Fix;
+    MRH_Uint32 u32_Start;
+    
+    do
+    {
+        // Wait out a running write
+        while (((u32_Start = u32_Sequence.load(std::memory_order_acquire)) & 1) != 0)
+        {}
+        
+        c_Fix.b_Recieved = b_Recieved.load(std::memory_order_relaxed);
+        c_Fix.f64_Latitude = f64_Latitude.load(std::memory_order_relaxed);
+        c_Fix.f64_Longtitude = f64_Longtitude.load(std::memory_order_relaxed);
+        c_Fix.f64_Elevation = f64_Elevation.load(std::memory_order_relaxed);
+        c_Fix.f64_Facing = f64_Facing.load(std::memory_order_relaxed);
+        c_Fix.f64_Speed = f64_Speed.load(std::memory_order_relaxed);
+        c_Fix.f64_Course = f64_Course.load(std::memory_order_relaxed);
+        c_Fix.u64_TimeMS = u64_TimeMS.load(std::memory_order_relaxed);
+        
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    while (u32_Sequence.load(std::memory_order_relaxed) != u32_Start);
+    
+    return c_Fix;
+}
+
+MRH_Uint64 LocationSnapshot::GetTimeMS() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now()
+                                                                   .time_since_epoch()).count();
+}
+
+MRH_Uint64 LocationSnapshot::GetAgeMS(Fix const& c_Fix) noexcept
+{
+    MRH_Uint64 u64_TimeMS = GetTimeMS();
+    
+    return u64_TimeMS > c_Fix.u64_TimeMS ? u64_TimeMS - c_Fix.u64_TimeMS : 0;
+}
+
+bool LocationSnapshot::GetStale(Fix const& c_Fix) noexcept
+{
+    return c_Fix.b_Recieved == false || GetAgeMS(c_Fix) > MRH_USER_LOCATION_STALE_MS;
+}
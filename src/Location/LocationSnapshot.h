@@ -0,0 +1,161 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationSnapshot_h
+#define LocationSnapshot_h
+
+// C / C++
+#include <atomic>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_STALE_MS
+    #define MRH_USER_LOCATION_STALE_MS 10000
+#endif
+
+
+class LocationSnapshot
+{
+public:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Fix_t
+    {
+        bool b_Recieved;
+        
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Elevation;
+        MRH_Sfloat64 f64_Facing;
+        
+        // Derived by filtering, 0 if unknown
+        MRH_Sfloat64 f64_Speed; // Meters per second
+        MRH_Sfloat64 f64_Course; // Degrees from north
+        
+        MRH_Uint64 u64_TimeMS; // Unix time in milliseconds
+        
+    }Fix;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     */
+    
+    LocationSnapshot() noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param s_LocationSnapshot LocationSnapshot class source.
+     */
+    
+    LocationSnapshot(LocationSnapshot const& s_LocationSnapshot) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationSnapshot() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Publish a new location fix. Only a single thread may publish, 
+     *  this function never waits.
+     *
+     *  \param c_Fix The location fix to publish.
+     */
+    
+    void Store(Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the last published location fix. Never blocks, the read is 
+     *  retried if a fix was published at the same time. This function is 
+     *  thread safe.
+     *
+     *  \return The last published location fix.
+     */
+    
+    Fix Load() const noexcept;
+    
+    /**
+     *  Get the current time used for location fixes.
+     *
+     *  \return The current Unix time in milliseconds.
+     */
+    
+    static MRH_Uint64 GetTimeMS() noexcept;
+    
+    /**
+     *  Get the age of a location fix.
+     *
+     *  \param c_Fix The fix to check.
+     *
+     *  \return The fix age in milliseconds.
+     */
+    
+    static MRH_Uint64 GetAgeMS(Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Check if a location fix is too old to be current.
+     *
+     *  \param c_Fix The fix to check.
+     *
+     *  \return true if stale, false if not.
+     */
+    
+    static bool GetStale(Fix const& c_Fix) noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Odd while a fix is written
+    std::atomic<MRH_Uint32> u32_Sequence;
+    
+    std::atomic<bool> b_Recieved;
+    std::atomic<MRH_Sfloat64> f64_Latitude;
+    std::atomic<MRH_Sfloat64> f64_Longtitude;
+    std::atomic<MRH_Sfloat64> f64_Elevation;
+    std::atomic<MRH_Sfloat64> f64_Facing;
+    std::atomic<MRH_Sfloat64> f64_Speed;
+    std::atomic<MRH_Sfloat64> f64_Course;
+    std::atomic<MRH_Uint64> u64_TimeMS;
+    
+protected:
+    
+};
+
+#endif /* LocationSnapshot_h */
@@ -0,0 +1,184 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <chrono>
+#include <algorithm>
+
+// External
+
+// Project
+#include "./LocationSources.h"
+
+namespace
+{
+    // Shortest time without fixes before failing over
+    constexpr MRH_Uint64 u64_QuietMinMS = 250;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationSources::LocationSources(std::vector<Configuration::LocationSource> const& v_Source) : us_Count(v_Source.size()),
+                                                                                             us_Active(v_Source.size())
+{
+    if (us_Count == 0 || us_Count > MRH_USER_LOCATION_SOURCE_MAX)
+    {
+        throw Exception("Invalid location source count " +
+                        std::to_string(us_Count) +
+                        ", 1 to " +
+                        std::to_string(MRH_USER_LOCATION_SOURCE_MAX) +
+                        " sources are supported!");
+    }
+    
+    p_Source.reset(new Source[us_Count]);
+    
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        Source& c_Source = p_Source[i];
+        
+        c_Source.s_SocketPath = v_Source[i].s_SocketPath;
+        c_Source.u32_Priority = v_Source[i].u32_Priority;
+        c_Source.b_Connected = false;
+        c_Source.u64_LastFixMS = 0;
+        c_Source.u32_IntervalMS = 0;
+        c_Source.u64_Fixes = 0;
+        c_Source.u64_Selected = 0;
+        c_Source.u64_Connects = 0;
+        c_Source.u64_Errors = 0;
+    }
+}
+
+LocationSources::~LocationSources() noexcept
+{}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationSources::SetConnected(size_t us_Source, bool b_Connected) noexcept
+{
+    Source& c_Source = p_Source[us_Source];
+    
+    if (b_Connected == true && c_Source.b_Connected.load(std::memory_order_relaxed) == false)
+    {
+        c_Source.u64_Connects.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    c_Source.b_Connected.store(b_Connected, std::memory_order_relaxed);
+}
+
+void LocationSources::AddError(size_t us_Source) noexcept
+{
+    p_Source[us_Source].u64_Errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool LocationSources::AddFix(size_t us_Source) noexcept
+{
+    MRH_Uint64 u64_TimeMS = GetTimeMS();
+    Source& c_Source = p_Source[us_Source];
+    
+    // Average the fix interval, used to notice a quiet source
+    // Gaps after the source went quiet are outages, not intervals
+    MRH_Uint64 u64_LastFixMS = c_Source.u64_LastFixMS.load(std::memory_order_relaxed);
+    
+    if (GetFresh(c_Source, u64_TimeMS) == true)
+    {
+        MRH_Uint64 u64_IntervalMS = u64_TimeMS - u64_LastFixMS;
+        MRH_Uint32 u32_Average = c_Source.u32_IntervalMS.load(std::memory_order_relaxed);
+        
+        u32_Average = (u32_Average == 0 ? u64_IntervalMS : ((u32_Average * 7) + u64_IntervalMS) / 8);
+        c_Source.u32_IntervalMS.store(u32_Average, std::memory_order_relaxed);
+    }
+    
+    c_Source.u64_LastFixMS.store(u64_TimeMS, std::memory_order_relaxed);
+    c_Source.u64_Fixes.fetch_add(1, std::memory_order_relaxed);
+    
+    // Publish only if no fresh source has a better priority
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        if (i != us_Source && 
+            p_Source[i].u32_Priority < c_Source.u32_Priority && 
+            GetFresh(p_Source[i], u64_TimeMS) == true)
+        {
+            return false;
+        }
+    }
+    
+    c_Source.u64_Selected.fetch_add(1, std::memory_order_relaxed);
+    us_Active.store(us_Source, std::memory_order_relaxed);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+size_t LocationSources::GetCount() const noexcept
+{
+    return us_Count;
+}
+
+std::string const& LocationSources::GetSocketPath(size_t us_Source) const noexcept
+{
+    return p_Source[us_Source].s_SocketPath;
+}
+
+LocationSources::Stats LocationSources::GetStats(size_t us_Source) const noexcept
+{
+    MRH_Uint64 u64_TimeMS = GetTimeMS();
+    Source const& c_Source = p_Source[us_Source];
+    MRH_Uint64 u64_LastFixMS = c_Source.u64_LastFixMS.load(std::memory_order_relaxed);
+    Stats c_Stats;
+    
+    c_Stats.u32_Priority = c_Source.u32_Priority;
+    c_Stats.b_Connected = c_Source.b_Connected.load(std::memory_order_relaxed);
+    c_Stats.b_Active = (us_Active.load(std::memory_order_relaxed) == us_Source);
+    c_Stats.b_Fresh = GetFresh(c_Source, u64_TimeMS);
+    c_Stats.u32_IntervalMS = c_Source.u32_IntervalMS.load(std::memory_order_relaxed);
+    c_Stats.u64_AgeMS = (u64_LastFixMS > 0 && u64_TimeMS > u64_LastFixMS ? u64_TimeMS - u64_LastFixMS : 0);
+    c_Stats.u64_Fixes = c_Source.u64_Fixes.load(std::memory_order_relaxed);
+    c_Stats.u64_Selected = c_Source.u64_Selected.load(std::memory_order_relaxed);
+    c_Stats.u64_Connects = c_Source.u64_Connects.load(std::memory_order_relaxed);
+    c_Stats.u64_Errors = c_Source.u64_Errors.load(std::memory_order_relaxed);
+    
+    return c_Stats;
+}
+
+bool LocationSources::GetFresh(Source const& c_Source, MRH_Uint64 u64_TimeMS) noexcept
+{
+    MRH_Uint64 u64_LastFixMS = c_Source.u64_LastFixMS.load(std::memory_order_relaxed);
+    
+    if (c_Source.b_Connected.load(std::memory_order_relaxed) == false || u64_LastFixMS == 0)
+    {
+        return false;
+    }
+    
+    // Quiet after missing about 3 fixes
+    MRH_Uint64 u64_QuietMS = std::max(static_cast<MRH_Uint64>(c_Source.u32_IntervalMS.load(std::memory_order_relaxed)) * 3, u64_QuietMinMS);
+    
+    return u64_TimeMS - u64_LastFixMS <= std::min(u64_QuietMS, static_cast<MRH_Uint64>(MRH_USER_LOCATION_SOURCE_TIMEOUT_MS));
+}
+
+MRH_Uint64 LocationSources::GetTimeMS() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()
+                                                                   .time_since_epoch()).count();
+}
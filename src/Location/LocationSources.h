@@ -0,0 +1,217 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationSources_h
+#define LocationSources_h
+
+// C / C++
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "../Configuration.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_SOURCE_MAX
+    #define MRH_USER_LOCATION_SOURCE_MAX 8
+#endif
+#ifndef MRH_USER_LOCATION_SOURCE_TIMEOUT_MS
+    #define MRH_USER_LOCATION_SOURCE_TIMEOUT_MS 2000
+#endif
+
+
+class LocationSources
+{
+public:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Stats_t
+    {
+        MRH_Uint32 u32_Priority;
+        
+        bool b_Connected;
+        bool b_Active; // Source of the published fixes
+        bool b_Fresh;
+        
+        MRH_Uint32 u32_IntervalMS; // Average time between fixes
+        MRH_Uint64 u64_AgeMS; // Time since the last fix
+        
+        MRH_Uint64 u64_Fixes;
+        MRH_Uint64 u64_Selected;
+        MRH_Uint64 u64_Connects;
+        MRH_Uint64 u64_Errors;
+        
+    }Stats;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param v_Source The location sources to use.
+     */
+    
+    LocationSources(std::vector<Configuration::LocationSource> const& v_Source);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationSources LocationSources class source.
+     */
+    
+    LocationSources(LocationSources const& c_LocationSources) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationSources() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Set the connection state of a source. Only the stream thread may 
+     *  update sources.
+     *
+     *  \param us_Source The source index.
+     *  \param b_Connected If the source is connected.
+     */
+    
+    void SetConnected(size_t us_Source, bool b_Connected) noexcept;
+    
+    /**
+     *  Count a source read error. Only the stream thread may update sources.
+     *
+     *  \param us_Source The source index.
+     */
+    
+    void AddError(size_t us_Source) noexcept;
+    
+    /**
+     *  Add a recieved fix for a source. Only the stream thread may update 
+     *  sources.
+     *
+     *  \param us_Source The source index.
+     *
+     *  \return true if the fix should be published, false if a better source is fresh.
+     */
+    
+    bool AddFix(size_t us_Source) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the number of sources.
+     *
+     *  \return The source count.
+     */
+    
+    size_t GetCount() const noexcept;
+    
+    /**
+     *  Get the socket path of a source.
+     *
+     *  \param us_Source The source index.
+     *
+     *  \return The full socket path.
+     */
+    
+    std::string const& GetSocketPath(size_t us_Source) const noexcept;
+    
+    /**
+     *  Get the health of a source. This function is thread safe.
+     *
+     *  \param us_Source The source index.
+     *
+     *  \return The source stats.
+     */
+    
+    Stats GetStats(size_t us_Source) const noexcept;
+    
+    /**
+     *  Get the current steady time used for sources.
+     *
+     *  \return The steady time in milliseconds.
+     */
+    
+    static MRH_Uint64 GetTimeMS() noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Source_t
+    {
+        std::string s_SocketPath;
+        MRH_Uint32 u32_Priority;
+        
+        std::atomic<bool> b_Connected;
+        std::atomic<MRH_Uint64> u64_LastFixMS; // 0 if none
+        std::atomic<MRH_Uint32> u32_IntervalMS;
+        
+        std::atomic<MRH_Uint64> u64_Fixes;
+        std::atomic<MRH_Uint64> u64_Selected;
+        std::atomic<MRH_Uint64> u64_Connects;
+        std::atomic<MRH_Uint64> u64_Errors;
+        
+    }Source;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Check if a source recieved a fix recently enough.
+     *
+     *  \param c_Source The source to check.
+     *  \param u64_TimeMS The current steady time in milliseconds.
+     *
+     *  \return true if fresh, false if quiet.
+     */
+    
+    static bool GetFresh(Source const& c_Source, MRH_Uint64 u64_TimeMS) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    size_t us_Count;
+    std::unique_ptr<Source[]> p_Source;
+    
+    std::atomic<size_t> us_Active;
+    
+protected:
+    
+};
+
+#endif /* LocationSources_h */
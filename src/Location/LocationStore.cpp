@@ -0,0 +1,639 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./LocationStore.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_SegmentMagic = 0x4C534731; // "LSG1"
+    constexpr MRH_Uint32 u32_SegmentVersion = 1;
+    constexpr MRH_Uint32 u32_SegmentSizeMin = 64 * 1024;
+    constexpr MRH_Uint32 u32_IndexRatio = 512; // Segment bytes per index entry
+    
+    // Wait between failed segment creations, doubled per failure
+    constexpr MRH_Uint32 u32_RetryDelayMinMS = 1000;
+    constexpr MRH_Uint32 u32_RetryDelayMaxMS = 60 * 1000;
+    
+    // Time, latitude, longitude, elevation, facing
+    constexpr int i_ValueCount = 5;
+    constexpr MRH_Uint32 u32_RecordSizeMax = i_ValueCount * 10;
+    
+    // Stored precision
+    constexpr MRH_Sfloat64 f64_DegreeScale = 1e7; // ~1 cm
+    constexpr MRH_Sfloat64 f64_ElevationScale = 100.0; // 1 cm
+    constexpr MRH_Sfloat64 f64_FacingScale = 100.0; // 0.01 degrees
+    
+    inline MRH_Uint64 ZigZag(MRH_Sint64 s64_Value) noexcept
+    {
+        return (static_cast<MRH_Uint64>(s64_Value) << 1) ^ static_cast<MRH_Uint64>(s64_Value >> 63);
+    }
+    
+    inline MRH_Sint64 UnZigZag(MRH_Uint64 u64_Value) noexcept
+    {
+        return static_cast<MRH_Sint64>((u64_Value >> 1) ^ (~(u64_Value & 1) + 1));
+    }
+    
+    inline MRH_Uint32 WriteVarint(MRH_Uint8* p_Buffer, MRH_Uint64 u64_Value) noexcept
+    {
+        MRH_Uint32 u32_Size = 0;
+        
+        while (u64_Value >= 0x80)
+        {
+            p_Buffer[u32_Size++] = static_cast<MRH_Uint8>(u64_Value | 0x80);
+            u64_Value >>= 7;
+        }
+        
+        p_Buffer[u32_Size++] = static_cast<MRH_Uint8>(u64_Value);
+        return u32_Size;
+    }
+    
+    inline MRH_Uint32 ReadVarint(const MRH_Uint8* p_Buffer, MRH_Uint32 u32_Size, MRH_Uint64& u64_Value) noexcept
+    {
+        u64_Value = 0;
+        
+        for (MRH_Uint32 i = 0; i < u32_Size && i < 10; ++i)
+        {
+            u64_Value |= static_cast<MRH_Uint64>(p_Buffer[i] & 0x7F) << (7 * i);
+            
+            if ((p_Buffer[i] & 0x80) == 0)
+            {
+                return i + 1;
+            }
+        }
+        
+        return 0; // Truncated
+    }
+    
+    inline MRH_Sint64 Quantize(MRH_Sfloat64 f64_Value, MRH_Sfloat64 f64_Scale) noexcept
+    {
+        return std::isfinite(f64_Value) ? static_cast<MRH_Sint64>(std::llround(f64_Value * f64_Scale)) : 0;
+    }
+    
+    MRH_Uint64 GetTimeMS() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()
+                                                                       .time_since_epoch()).count();
+    }
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationStore::LocationStore(std::string const& s_DirPath, MRH_Uint32 u32_SegmentSize, MRH_Uint64 u64_SizeBudget) : i_DirFD(-1),
+                                                                                                                         u32_SegmentSize(std::max(u32_SegmentSize, u32_SegmentSizeMin)),
+                                                                                                                         u64_SizeBudget(u64_SizeBudget),
+                                                                                                                         p_SegmentList(std::make_shared<const SegmentList>()),
+                                                                                                                         u64_NextSequence(0),
+                                                                                                                         u32_BlockFixes(0),
+                                                                                                                         u64_LastTimeMS(0),
+                                                                                                                         b_Failed(false),
+                                                                                                                         u64_RetryMS(0),
+                                                                                                                         u32_RetryDelayMS(0),
+                                                                                                                         u64_Fixes(0),
+                                                                                                                         u64_Bytes(0)
+{
+    std::memset(p_Previous, 0, sizeof(p_Previous));
+    
+    if (u64_SizeBudget == 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Location store disabled.",
+                                       "LocationStore.cpp", __LINE__);
+        return;
+    }
+    
+    if (mkdir(s_DirPath.c_str(), 0755) < 0 && errno != EEXIST)
+    {
+        throw Exception("Failed to create location store directory " +
+                        s_DirPath +
+                        ": " +
+                        std::string(std::strerror(errno)) +
+                        " (" +
+                        std::to_string(errno) +
+                        ")!");
+    }
+    
+    if ((i_DirFD = open(s_DirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+    {
+        throw Exception("Failed to open location store directory " +
+                        s_DirPath +
+                        ": " +
+                        std::string(std::strerror(errno)) +
+                        " (" +
+                        std::to_string(errno) +
+                        ")!");
+    }
+    
+    try
+    {
+        Load();
+    }
+    catch (...)
+    {
+        close(i_DirFD);
+        throw;
+    }
+}
+
+LocationStore::~LocationStore() noexcept
+{
+    if (u64_Fixes > 0)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::INFO, "Stored " +
+                                                            std::to_string(u64_Fixes) +
+                                                            " location fixes with " +
+                                                            std::to_string(u64_Bytes / u64_Fixes) +
+                                                            " bytes per fix.",
+                                       "LocationStore.cpp", __LINE__);
+    }
+    
+    if (p_Active)
+    {
+        p_Active->p_Header->u32_Sealed = 1;
+        msync(p_Active->p_Map, p_Active->u32_Size, MS_SYNC);
+    }
+    
+    if (i_DirFD >= 0)
+    {
+        close(i_DirFD);
+    }
+}
+
+LocationStore::Segment::Segment(MRH_Uint64 u64_Sequence, MRH_Uint8* p_Map, MRH_Uint32 u32_Size) noexcept : u64_Sequence(u64_Sequence),
+                                                                                                          p_Map(p_Map),
+                                                                                                          u32_Size(u32_Size)
+{
+    p_Header = reinterpret_cast<SegmentHeader*>(p_Map);
+    p_Index = reinterpret_cast<IndexEntry*>(p_Map + sizeof(SegmentHeader));
+    p_Data = p_Map + sizeof(SegmentHeader) + (p_Header->u32_IndexCapacity * sizeof(IndexEntry));
+    u32_DataSize = u32_Size - static_cast<MRH_Uint32>(p_Data - p_Map);
+    
+    u32_Used = p_Header->u32_Used;
+    u32_IndexCount = p_Header->u32_IndexCount;
+    u64_FirstMS = p_Header->u64_FirstMS;
+    u64_LastMS = p_Header->u64_LastMS;
+}
+
+LocationStore::Segment::~Segment() noexcept
+{
+    munmap(p_Map, u32_Size);
+}
+
+//*************************************************************************************
+// Segments
+//*************************************************************************************
+
+void LocationStore::Load()
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    std::shared_ptr<SegmentList> p_List = std::make_shared<SegmentList>();
+    std::vector<MRH_Uint64> v_Sequence;
+    
+    // Collect segment files
+    int i_ReadFD = dup(i_DirFD);
+    DIR* p_Dir;
+    
+    if (i_ReadFD < 0 || (p_Dir = fdopendir(i_ReadFD)) == NULL)
+    {
+        int i_Error = errno;
+        
+        if (i_ReadFD >= 0)
+        {
+            close(i_ReadFD);
+        }
+        
+        throw Exception("Failed to read location store directory: " +
+                        std::string(std::strerror(i_Error)) +
+                        " (" +
+                        std::to_string(i_Error) +
+                        ")!");
+    }
+    
+    struct dirent* p_Entry;
+    
+    while ((p_Entry = readdir(p_Dir)) != NULL)
+    {
+        char* p_End;
+        MRH_Uint64 u64_Sequence = std::strtoull(p_Entry->d_name, &p_End, 16);
+        
+        if (p_End == p_Entry->d_name + 16 && std::strcmp(p_End, ".seg") == 0)
+        {
+            v_Sequence.emplace_back(u64_Sequence);
+        }
+    }
+    
+    closedir(p_Dir);
+    std::sort(v_Sequence.begin(), v_Sequence.end());
+    
+    // Map valid segments, all are read only now
+    // NOTE: Segments left unsealed by a crash are not written again either
+    for (auto& Sequence : v_Sequence)
+    {
+        std::string s_Name = GetSegmentName(Sequence);
+        int i_FD = openat(i_DirFD, s_Name.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat c_Stat;
+        void* p_Map = MAP_FAILED;
+        
+        if (i_FD >= 0 && fstat(i_FD, &c_Stat) == 0 && c_Stat.st_size >= static_cast<off_t>(sizeof(SegmentHeader)) && c_Stat.st_size <= UINT32_MAX)
+        {
+            p_Map = mmap(NULL, c_Stat.st_size, PROT_READ, MAP_SHARED, i_FD, 0);
+        }
+        
+        if (i_FD >= 0)
+        {
+            close(i_FD);
+        }
+        
+        if (p_Map != MAP_FAILED)
+        {
+            SegmentHeader* p_Header = static_cast<SegmentHeader*>(p_Map);
+            MRH_Uint64 u64_IndexEnd = sizeof(SegmentHeader) + (static_cast<MRH_Uint64>(p_Header->u32_IndexCapacity) * sizeof(IndexEntry));
+            
+            if (p_Header->u32_Magic == u32_SegmentMagic &&
+                p_Header->u32_Version == u32_SegmentVersion &&
+                p_Header->u32_Size == c_Stat.st_size &&
+                u64_IndexEnd <= p_Header->u32_Size &&
+                p_Header->u32_IndexCount <= p_Header->u32_IndexCapacity &&
+                p_Header->u32_Used <= p_Header->u32_Size - u64_IndexEnd)
+            {
+                p_List->emplace_back(std::make_shared<Segment>(Sequence, static_cast<MRH_Uint8*>(p_Map), p_Header->u32_Size));
+                u64_NextSequence = Sequence + 1;
+                continue;
+            }
+            
+            munmap(p_Map, c_Stat.st_size);
+        }
+        
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Removing invalid location store segment: " + s_Name,
+                     "LocationStore.cpp", __LINE__);
+        unlinkat(i_DirFD, s_Name.c_str(), 0);
+    }
+    
+    if (p_List->empty() == false)
+    {
+        u64_LastTimeMS = p_List->back()->u64_LastMS;
+    }
+    
+    c_Logger.Log(MRH_PSBLogger::INFO, "Loaded " + std::to_string(p_List->size()) + " location store segments.",
+                 "LocationStore.cpp", __LINE__);
+    
+    p_SegmentList = p_List;
+}
+
+bool LocationStore::Rotate() noexcept
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    
+    // Seal current, will not be written again
+    if (p_Active)
+    {
+        p_Active->p_Header->u32_Sealed = 1;
+        msync(p_Active->p_Map, p_Active->u32_Size, MS_ASYNC);
+        p_Active.reset();
+    }
+    
+    // Create the next segment file
+    std::string s_Name = GetSegmentName(u64_NextSequence);
+    int i_FD = openat(i_DirFD, s_Name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    void* p_Map = MAP_FAILED;
+    int i_Error = 0;
+    
+    if (i_FD < 0)
+    {
+        i_Error = errno;
+    }
+    else
+    {
+        // Allocate now, a full disk would fault on write otherwise
+        if ((i_Error = posix_fallocate(i_FD, 0, u32_SegmentSize)) == 0 &&
+            (p_Map = mmap(NULL, u32_SegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, i_FD, 0)) == MAP_FAILED)
+        {
+            i_Error = errno;
+        }
+        
+        close(i_FD);
+    }
+    
+    if (p_Map == MAP_FAILED)
+    {
+        if (b_Failed == false)
+        {
+            c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to create location store segment " +
+                                               s_Name +
+                                               ": " +
+                                               std::string(std::strerror(i_Error)) +
+                                               " (" +
+                                               std::to_string(i_Error) +
+                                               ")!",
+                         "LocationStore.cpp", __LINE__);
+            b_Failed = true;
+        }
+        
+        if (i_FD >= 0)
+        {
+            unlinkat(i_DirFD, s_Name.c_str(), 0);
+        }
+        
+        return false;
+    }
+    
+    SegmentHeader* p_Header = static_cast<SegmentHeader*>(p_Map);
+    std::memset(p_Header, 0, sizeof(SegmentHeader));
+    p_Header->u32_Magic = u32_SegmentMagic;
+    p_Header->u32_Version = u32_SegmentVersion;
+    p_Header->u32_Size = u32_SegmentSize;
+    p_Header->u32_IndexCapacity = u32_SegmentSize / u32_IndexRatio;
+    
+    // Publish the new list, dropping the oldest segments over budget
+    try
+    {
+        std::shared_ptr<const SegmentList> p_Current = std::atomic_load(&p_SegmentList);
+        std::shared_ptr<SegmentList> p_List = std::make_shared<SegmentList>(*p_Current);
+        MRH_Uint64 u64_Size = u32_SegmentSize;
+        size_t us_Remove = p_List->size();
+        
+        p_Active = std::make_shared<Segment>(u64_NextSequence, static_cast<MRH_Uint8*>(p_Map), u32_SegmentSize);
+        
+        while (us_Remove > 0 && u64_Size + (*p_List)[us_Remove - 1]->u32_Size <= u64_SizeBudget)
+        {
+            u64_Size += (*p_List)[--us_Remove]->u32_Size;
+        }
+        
+        for (size_t i = 0; i < us_Remove; ++i)
+        {
+            unlinkat(i_DirFD, GetSegmentName((*p_List)[i]->u64_Sequence).c_str(), 0);
+        }
+        
+        p_List->erase(p_List->begin(), p_List->begin() + us_Remove);
+        p_List->emplace_back(p_Active);
+        
+        std::atomic_store(&p_SegmentList, std::shared_ptr<const SegmentList>(p_List));
+    }
+    catch (std::exception& e)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to add location store segment: " + std::string(e.what()),
+                     "LocationStore.cpp", __LINE__);
+        
+        if (p_Active)
+        {
+            p_Active.reset();
+        }
+        else
+        {
+            munmap(p_Map, u32_SegmentSize);
+        }
+        
+        unlinkat(i_DirFD, s_Name.c_str(), 0);
+        return false;
+    }
+    
+    ++u64_NextSequence;
+    u32_BlockFixes = 0;
+    b_Failed = false;
+    
+    return true;
+}
+
+std::string LocationStore::GetSegmentName(MRH_Uint64 u64_Sequence) noexcept
+{
+    char p_Name[32];
+    std::snprintf(p_Name, sizeof(p_Name), "%016llx.seg", static_cast<unsigned long long>(u64_Sequence));
+    
+    return p_Name;
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationStore::Add(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    if (i_DirFD < 0)
+    {
+        return;
+    }
+    
+    // Keep time ordered for searching, even if the clock went back
+    if (c_Fix.u64_TimeMS > u64_LastTimeMS)
+    {
+        u64_LastTimeMS = c_Fix.u64_TimeMS;
+    }
+    
+    bool b_Key = (u32_BlockFixes == 0 || u32_BlockFixes >= MRH_USER_LOCATION_STORE_BLOCK_SIZE);
+    
+    if (!p_Active ||
+        p_Active->p_Header->u32_Used + u32_RecordSizeMax > p_Active->u32_DataSize ||
+        (b_Key == true && p_Active->p_Header->u32_IndexCount >= p_Active->p_Header->u32_IndexCapacity))
+    {
+        // Drop fixes until the next retry, a full disk fails every time
+        if (!p_Active && u32_RetryDelayMS > 0 && GetTimeMS() < u64_RetryMS)
+        {
+            return;
+        }
+        else if (Rotate() == false)
+        {
+            u32_RetryDelayMS = std::min(std::max(u32_RetryDelayMS * 2, u32_RetryDelayMinMS), u32_RetryDelayMaxMS);
+            u64_RetryMS = GetTimeMS() + u32_RetryDelayMS;
+            return;
+        }
+        
+        u32_RetryDelayMS = 0;
+        b_Key = true;
+    }
+    
+    Segment& c_Segment = *p_Active;
+    SegmentHeader* p_Header = c_Segment.p_Header;
+    
+    MRH_Sint64 p_Value[i_ValueCount] =
+    {
+        static_cast<MRH_Sint64>(u64_LastTimeMS),
+        Quantize(c_Fix.f64_Latitude, f64_DegreeScale),
+        Quantize(c_Fix.f64_Longtitude, f64_DegreeScale),
+        Quantize(c_Fix.f64_Elevation, f64_ElevationScale),
+        Quantize(c_Fix.f64_Facing, f64_FacingScale)
+    };
+    
+    // Blocks start without deltas so they decode on their own
+    if (b_Key == true)
+    {
+        std::memset(p_Previous, 0, sizeof(p_Previous));
+    }
+    
+    MRH_Uint8* p_Record = c_Segment.p_Data + p_Header->u32_Used;
+    MRH_Uint32 u32_Size = 0;
+    
+    for (int i = 0; i < i_ValueCount; ++i)
+    {
+        u32_Size += WriteVarint(p_Record + u32_Size, ZigZag(p_Value[i] - p_Previous[i]));
+        p_Previous[i] = p_Value[i];
+    }
+    
+    if (b_Key == true)
+    {
+        IndexEntry& c_Entry = c_Segment.p_Index[p_Header->u32_IndexCount];
+        c_Entry.u64_TimeMS = u64_LastTimeMS;
+        c_Entry.u32_Offset = p_Header->u32_Used;
+        c_Entry.u32_Reserved = 0;
+        
+        c_Segment.u32_IndexCount.store(++(p_Header->u32_IndexCount), std::memory_order_release);
+        u32_BlockFixes = 0;
+    }
+    
+    if (p_Header->u32_Count++ == 0)
+    {
+        p_Header->u64_FirstMS = u64_LastTimeMS;
+        c_Segment.u64_FirstMS.store(u64_LastTimeMS, std::memory_order_relaxed);
+    }
+    
+    p_Header->u64_LastMS = u64_LastTimeMS;
+    c_Segment.u64_LastMS.store(u64_LastTimeMS, std::memory_order_relaxed);
+    
+    p_Header->u32_Used += u32_Size;
+    c_Segment.u32_Used.store(p_Header->u32_Used, std::memory_order_release);
+    
+    ++u32_BlockFixes;
+    ++u64_Fixes;
+    u64_Bytes += u32_Size;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint32 LocationStore::Get(MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, LocationSnapshot::Fix* p_Fix, MRH_Uint32 u32_Count) const noexcept
+{
+    if (p_Fix == NULL || u32_Count == 0 || u64_StartMS > u64_EndMS)
+    {
+        return 0;
+    }
+    
+    // Segments stay mapped while the list copy is held
+    std::shared_ptr<const SegmentList> p_List = std::atomic_load(&p_SegmentList);
+    LocationSnapshot::Fix p_Block[MRH_USER_LOCATION_STORE_BLOCK_SIZE];
+    MRH_Uint32 u32_Found = 0;
+    
+    // Newest first, written in reverse and flipped at the end
+    for (auto It = p_List->rbegin(); It != p_List->rend() && u32_Found < u32_Count; ++It)
+    {
+        Segment const& c_Segment = **It;
+        MRH_Uint32 u32_Used = c_Segment.u32_Used.load(std::memory_order_acquire);
+        MRH_Uint32 u32_IndexCount = c_Segment.u32_IndexCount.load(std::memory_order_acquire);
+        
+        if (u32_IndexCount == 0 || c_Segment.u64_FirstMS.load(std::memory_order_relaxed) > u64_EndMS)
+        {
+            continue;
+        }
+        else if (c_Segment.u64_LastMS.load(std::memory_order_relaxed) < u64_StartMS)
+        {
+            break;
+        }
+        
+        for (MRH_Uint32 i = u32_IndexCount; i > 0 && u32_Found < u32_Count; --i)
+        {
+            IndexEntry const& c_Entry = c_Segment.p_Index[i - 1];
+            
+            if (c_Entry.u64_TimeMS > u64_EndMS || c_Entry.u32_Offset >= u32_Used)
+            {
+                continue;
+            }
+            
+            MRH_Uint32 u32_End = (i < u32_IndexCount ? std::min(c_Segment.p_Index[i].u32_Offset, u32_Used) : u32_Used);
+            MRH_Uint32 u32_Block = Decode(c_Segment, c_Entry.u32_Offset, u32_End, u64_StartMS, u64_EndMS, p_Block);
+            
+            while (u32_Block > 0 && u32_Found < u32_Count)
+            {
+                p_Fix[u32_Found++] = p_Block[--u32_Block];
+            }
+            
+            if (c_Entry.u64_TimeMS < u64_StartMS)
+            {
+                break;
+            }
+        }
+        
+        // Older segments end before this one starts
+        if (c_Segment.u64_FirstMS.load(std::memory_order_relaxed) < u64_StartMS)
+        {
+            break;
+        }
+    }
+    
+    std::reverse(p_Fix, p_Fix + u32_Found);
+    return u32_Found;
+}
+
+MRH_Uint32 LocationStore::Decode(Segment const& c_Segment, MRH_Uint32 u32_Begin, MRH_Uint32 u32_End, MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, LocationSnapshot::Fix* p_Fix) noexcept
+{
+    MRH_Sint64 p_Value[i_ValueCount] = { 0 };
+    MRH_Uint32 u32_Count = 0;
+    MRH_Uint32 u32_Read = 0;
+    
+    for (MRH_Uint32 u32_Record = 0; u32_Begin < u32_End && u32_Record < MRH_USER_LOCATION_STORE_BLOCK_SIZE; ++u32_Record)
+    {
+        for (int i = 0; i < i_ValueCount; ++i)
+        {
+            MRH_Uint64 u64_Delta;
+            
+            if ((u32_Read = ReadVarint(c_Segment.p_Data + u32_Begin, u32_End - u32_Begin, u64_Delta)) == 0)
+            {
+                return u32_Count;
+            }
+            
+            p_Value[i] += UnZigZag(u64_Delta);
+            u32_Begin += u32_Read;
+        }
+        
+        MRH_Uint64 u64_TimeMS = static_cast<MRH_Uint64>(p_Value[0]);
+        
+        if (u64_TimeMS < u64_StartMS || u64_TimeMS > u64_EndMS)
+        {
+            continue;
+        }
+        
+        LocationSnapshot::Fix& c_Fix = p_Fix[u32_Count++];
+        c_Fix.b_Recieved = true;
+        c_Fix.u64_TimeMS = u64_TimeMS;
+        c_Fix.f64_Latitude = p_Value[1] / f64_DegreeScale;
+        c_Fix.f64_Longtitude = p_Value[2] / f64_DegreeScale;
+        c_Fix.f64_Elevation = p_Value[3] / f64_ElevationScale;
+        c_Fix.f64_Facing = p_Value[4] / f64_FacingScale;
+        c_Fix.f64_Speed = 0.f;
+        c_Fix.f64_Course = 0.f;
+    }
+    
+    return u32_Count;
+}
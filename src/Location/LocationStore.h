@@ -0,0 +1,263 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationStore_h
+#define LocationStore_h
+
+// C / C++
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+#include "../Exception.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_STORE_BLOCK_SIZE
+    #define MRH_USER_LOCATION_STORE_BLOCK_SIZE 64
+#endif
+
+
+class LocationStore
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param s_DirPath The full path to the directory to store segments in.
+     *  \param u32_SegmentSize The size of a single segment file in bytes.
+     *  \param u64_SizeBudget The maximum size of all segment files in bytes. 0 disables the store.
+     */
+    
+    LocationStore(std::string const& s_DirPath, MRH_Uint32 u32_SegmentSize, MRH_Uint64 u64_SizeBudget);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationStore LocationStore class source.
+     */
+    
+    LocationStore(LocationStore const& c_LocationStore) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationStore() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Append a location fix. Only a single thread may append, readers are 
+     *  never waited for.
+     *
+     *  \param c_Fix The location fix to append.
+     */
+    
+    void Add(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the newest stored fixes inside a time range, oldest first. This 
+     *  function is thread safe.
+     *
+     *  \param u64_StartMS The first fix time to include in milliseconds.
+     *  \param u64_EndMS The last fix time to include in milliseconds.
+     *  \param p_Fix The fix buffer to write to.
+     *  \param u32_Count The maximum number of fixes to write.
+     *
+     *  \return The number of fixes written.
+     */
+    
+    MRH_Uint32 Get(MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, LocationSnapshot::Fix* p_Fix, MRH_Uint32 u32_Count) const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // Segment file layout: header, index, data
+    typedef struct SegmentHeader_t
+    {
+        MRH_Uint32 u32_Magic;
+        MRH_Uint32 u32_Version;
+        MRH_Uint32 u32_Size;
+        MRH_Uint32 u32_IndexCapacity;
+        MRH_Uint32 u32_IndexCount;
+        MRH_Uint32 u32_Used; // Data bytes
+        MRH_Uint64 u64_FirstMS;
+        MRH_Uint64 u64_LastMS;
+        MRH_Uint32 u32_Count;
+        MRH_Uint32 u32_Sealed;
+        
+    }SegmentHeader;
+    
+    // Index entries point to a block start, encoded without deltas
+    typedef struct IndexEntry_t
+    {
+        MRH_Uint64 u64_TimeMS;
+        MRH_Uint32 u32_Offset;
+        MRH_Uint32 u32_Reserved;
+        
+    }IndexEntry;
+    
+    class Segment
+    {
+    public:
+        
+        //*************************************************************************************
+        // Constructor / Destructor
+        //*************************************************************************************
+        
+        /**
+         *  Default constructor.
+         *
+         *  \param u64_Sequence The segment sequence number.
+         *  \param p_Map The mapped segment file.
+         *  \param u32_Size The mapped segment file size.
+         */
+        
+        Segment(MRH_Uint64 u64_Sequence, MRH_Uint8* p_Map, MRH_Uint32 u32_Size) noexcept;
+        
+        /**
+         *  Copy constructor. Disabled for this class.
+         *
+         *  \param c_Segment Segment class source.
+         */
+        
+        Segment(Segment const& c_Segment) = delete;
+        
+        /**
+         *  Default destructor.
+         */
+        
+        ~Segment() noexcept;
+        
+        //*************************************************************************************
+        // Data
+        //*************************************************************************************
+        
+        MRH_Uint64 u64_Sequence;
+        MRH_Uint8* p_Map; // Read only unless active
+        MRH_Uint32 u32_Size;
+        
+        SegmentHeader* p_Header;
+        IndexEntry* p_Index;
+        MRH_Uint8* p_Data;
+        MRH_Uint32 u32_DataSize;
+        
+        // Published to readers, the header is only written
+        std::atomic<MRH_Uint32> u32_Used;
+        std::atomic<MRH_Uint32> u32_IndexCount;
+        std::atomic<MRH_Uint64> u64_FirstMS;
+        std::atomic<MRH_Uint64> u64_LastMS;
+    };
+    
+    typedef std::vector<std::shared_ptr<Segment>> SegmentList;
+    
+    //*************************************************************************************
+    // Segments
+    //*************************************************************************************
+    
+    /**
+     *  Load all existing segments.
+     */
+    
+    void Load();
+    
+    /**
+     *  Seal the active segment and start a new one.
+     *
+     *  \return true if a new segment was started, false if not.
+     */
+    
+    bool Rotate() noexcept;
+    
+    /**
+     *  Get the file name for a segment.
+     *
+     *  \param u64_Sequence The segment sequence number.
+     *
+     *  \return The segment file name.
+     */
+    
+    static std::string GetSegmentName(MRH_Uint64 u64_Sequence) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Decode the fixes of a single block.
+     *
+     *  \param c_Segment The segment containing the block.
+     *  \param u32_Begin The block start data offset.
+     *  \param u32_End The block end data offset.
+     *  \param u64_StartMS The first fix time to include in milliseconds.
+     *  \param u64_EndMS The last fix time to include in milliseconds.
+     *  \param p_Fix The fix buffer to write to, MRH_USER_LOCATION_STORE_BLOCK_SIZE fixes.
+     *
+     *  \return The number of fixes written.
+     */
+    
+    static MRH_Uint32 Decode(Segment const& c_Segment, MRH_Uint32 u32_Begin, MRH_Uint32 u32_End, MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, LocationSnapshot::Fix* p_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    int i_DirFD;
+    MRH_Uint32 u32_SegmentSize;
+    MRH_Uint64 u64_SizeBudget;
+    
+    // Replaced by the writer, readers keep their copy
+    std::shared_ptr<const SegmentList> p_SegmentList;
+    
+    // Writer only
+    std::shared_ptr<Segment> p_Active;
+    MRH_Uint64 u64_NextSequence;
+    MRH_Uint32 u32_BlockFixes;
+    MRH_Sint64 p_Previous[5];
+    MRH_Uint64 u64_LastTimeMS;
+    bool b_Failed;
+    MRH_Uint64 u64_RetryMS;
+    MRH_Uint32 u32_RetryDelayMS;
+    
+    MRH_Uint64 u64_Fixes;
+    MRH_Uint64 u64_Bytes;
+    
+protected:
+    
+};
+
+#endif /* LocationStore_h */
@@ -0,0 +1,246 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <chrono>
+#include <cmath>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+#include <libmrhpsb/MRH_Callback.h>
+
+// Project
+#include "./LocationSubscription.h"
+#include "../Callback/ResponseEvent.h"
+
+namespace
+{
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0; // Meters
+    constexpr MRH_Sfloat64 f64_Pi = 3.14159265358979323846;
+    
+    MRH_Uint64 GetTimeMS() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()
+                                                                       .time_since_epoch()).count();
+    }
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationSubscription::LocationSubscription() noexcept
+{
+    c_Latest.b_Recieved = false;
+    c_Latest.f64_Latitude = 0.f;
+    c_Latest.f64_Longtitude = 0.f;
+    c_Latest.f64_Elevation = 0.f;
+    c_Latest.f64_Facing = 0.f;
+    c_Latest.u64_TimeMS = 0;
+}
+
+LocationSubscription::~LocationSubscription() noexcept
+{}
+
+//*************************************************************************************
+// Subscribe
+//*************************************************************************************
+
+bool LocationSubscription::Subscribe(MRH_Uint32 u32_GroupID, MRH_Uint32 u32_IntervalMS, MRH_Sfloat64 f64_Distance, MRH_Sfloat64 f64_Heading) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    Subscription c_Subscription;
+    c_Subscription.u32_GroupID = u32_GroupID;
+    c_Subscription.u64_IntervalMS = u32_IntervalMS;
+    c_Subscription.f64_Distance = (std::isfinite(f64_Distance) && f64_Distance > 0.f ? f64_Distance : 0.f);
+    c_Subscription.f64_Heading = (std::isfinite(f64_Heading) && f64_Heading > 0.f ? f64_Heading : 0.f);
+    c_Subscription.b_Sent = false;
+    c_Subscription.b_Pending = c_Latest.b_Recieved; // Send current fix first
+    c_Subscription.u64_SentMS = 0;
+    c_Subscription.f64_Latitude = 0.f;
+    c_Subscription.f64_Longtitude = 0.f;
+    c_Subscription.f64_Facing = 0.f;
+    
+    for (auto& Existing : v_Subscription)
+    {
+        if (Existing.u32_GroupID == u32_GroupID)
+        {
+            Existing = c_Subscription;
+            return true;
+        }
+    }
+    
+    if (v_Subscription.size() >= MRH_USER_LOCATION_SUBSCRIPTION_MAX)
+    {
+        return false;
+    }
+    
+    try
+    {
+        v_Subscription.emplace_back(c_Subscription);
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to add location subscription: " + std::string(e.what()),
+                                       "LocationSubscription.cpp", __LINE__);
+        return false;
+    }
+    
+    return true;
+}
+
+bool LocationSubscription::Unsubscribe(MRH_Uint32 u32_GroupID) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    for (auto It = v_Subscription.begin(); It != v_Subscription.end(); ++It)
+    {
+        if (It->u32_GroupID == u32_GroupID)
+        {
+            v_Subscription.erase(It);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void LocationSubscription::Clear() noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    v_Subscription.clear();
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationSubscription::Publish(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    c_Latest = c_Fix;
+    Notify(true);
+}
+
+void LocationSubscription::Flush() noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    if (v_Subscription.empty() == false)
+    {
+        Notify(false);
+    }
+}
+
+void LocationSubscription::Notify(bool b_NewFix) noexcept
+{
+    if (c_Latest.b_Recieved == false)
+    {
+        return;
+    }
+    
+    MRH_Uint64 u64_TimeMS = GetTimeMS();
+    
+    for (auto& Current : v_Subscription)
+    {
+        // Merge new fixes, only the latest is sent once due
+        if (b_NewFix == true && Current.b_Pending == false)
+        {
+            Current.b_Pending = Changed(Current, c_Latest);
+        }
+        
+        if (Current.b_Pending == false ||
+            (Current.b_Sent == true && u64_TimeMS - Current.u64_SentMS < Current.u64_IntervalMS))
+        {
+            continue;
+        }
+        
+        Send(Current.u32_GroupID, c_Latest);
+        
+        Current.b_Sent = true;
+        Current.b_Pending = false;
+        Current.u64_SentMS = u64_TimeMS;
+        Current.f64_Latitude = c_Latest.f64_Latitude;
+        Current.f64_Longtitude = c_Latest.f64_Longtitude;
+        Current.f64_Facing = c_Latest.f64_Facing;
+    }
+}
+
+bool LocationSubscription::Changed(Subscription const& c_Subscription, LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    if (c_Subscription.b_Sent == false)
+    {
+        return true;
+    }
+    else if (c_Subscription.f64_Distance <= 0.f && c_Subscription.f64_Heading <= 0.f)
+    {
+        return true;
+    }
+    
+    // Facing change, shortest way around
+    if (c_Subscription.f64_Heading > 0.f)
+    {
+        MRH_Sfloat64 f64_Change = std::fmod(std::fabs(c_Fix.f64_Facing - c_Subscription.f64_Facing), 360.0);
+        
+        if (std::fmin(f64_Change, 360.0 - f64_Change) >= c_Subscription.f64_Heading)
+        {
+            return true;
+        }
+    }
+    
+    // Distance change, haversine
+    if (c_Subscription.f64_Distance > 0.f)
+    {
+        MRH_Sfloat64 f64_LatA = c_Subscription.f64_Latitude * f64_Pi / 180.0;
+        MRH_Sfloat64 f64_LatB = c_Fix.f64_Latitude * f64_Pi / 180.0;
+        MRH_Sfloat64 f64_SinLat = std::sin((f64_LatB - f64_LatA) / 2.0);
+        MRH_Sfloat64 f64_SinLon = std::sin((c_Fix.f64_Longtitude - c_Subscription.f64_Longtitude) * f64_Pi / 360.0);
+        MRH_Sfloat64 f64_A = f64_SinLat * f64_SinLat + std::cos(f64_LatA) * std::cos(f64_LatB) * f64_SinLon * f64_SinLon;
+        
+        if (2.0 * f64_EarthRadius * std::asin(std::sqrt(std::fmin(f64_A, 1.0))) >= c_Subscription.f64_Distance)
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void LocationSubscription::Send(MRH_Uint32 u32_GroupID, LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    MRH_EvD_U_GetLocation_S c_Data;
+    c_Data.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    c_Data.f64_Latitude = c_Fix.f64_Latitude;
+    c_Data.f64_Longtitude = c_Fix.f64_Longtitude;
+    c_Data.f64_Elevation = c_Fix.f64_Elevation;
+    c_Data.f64_Facing = c_Fix.f64_Facing;
+    
+    ResponseEvent::Send(MRH_EVENT_USER_GET_LOCATION_S, c_Data, u32_GroupID);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool LocationSubscription::GetSubscribed() noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    return v_Subscription.empty() == false;
+}
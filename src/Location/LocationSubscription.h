@@ -0,0 +1,202 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationSubscription_h
+#define LocationSubscription_h
+
+// C / C++
+#include <mutex>
+#include <vector>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_SUBSCRIPTION_MAX
+    #define MRH_USER_LOCATION_SUBSCRIPTION_MAX 16
+#endif
+
+
+class LocationSubscription
+{
+public:
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     */
+    
+    LocationSubscription() noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationSubscription LocationSubscription class source.
+     */
+    
+    LocationSubscription(LocationSubscription const& c_LocationSubscription) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LocationSubscription() noexcept;
+    
+    //*************************************************************************************
+    // Subscribe
+    //*************************************************************************************
+    
+    /**
+     *  Subscribe to location updates. An existing subscription for the same 
+     *  group id is replaced. This function is thread safe.
+     *
+     *  \param u32_GroupID The event group id to send location updates to.
+     *  \param u32_IntervalMS The minimum time between updates in milliseconds.
+     *  \param f64_Distance The minimum distance change in meters.
+     *  \param f64_Heading The minimum facing change in degrees.
+     *
+     *  \return true if subscribed, false if no subscription is available.
+     */
+    
+    bool Subscribe(MRH_Uint32 u32_GroupID, MRH_Uint32 u32_IntervalMS, MRH_Sfloat64 f64_Distance, MRH_Sfloat64 f64_Heading) noexcept;
+    
+    /**
+     *  Remove the subscription for a group id. This function is thread safe.
+     *
+     *  \param u32_GroupID The event group id to unsubscribe.
+     *
+     *  \return true if a subscription was removed, false if not.
+     */
+    
+    bool Unsubscribe(MRH_Uint32 u32_GroupID) noexcept;
+    
+    /**
+     *  Remove all subscriptions. This function is thread safe.
+     */
+    
+    void Clear() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Add a new location fix and send updates to all subscriptions due. 
+     *  Fixes which are not yet due are merged into the next update.
+     *
+     *  \param c_Fix The new location fix.
+     */
+    
+    void Publish(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Send updates for merged fixes which became due.
+     */
+    
+    void Flush() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Check if any event group id is subscribed. This function is 
+     *  thread safe.
+     *
+     *  \return true if subscribed, false if not.
+     */
+    
+    bool GetSubscribed() noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Subscription_t
+    {
+        MRH_Uint32 u32_GroupID;
+        
+        // Thresholds
+        MRH_Uint64 u64_IntervalMS;
+        MRH_Sfloat64 f64_Distance;
+        MRH_Sfloat64 f64_Heading;
+        
+        // Last sent
+        bool b_Sent;
+        bool b_Pending;
+        MRH_Uint64 u64_SentMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_Facing;
+        
+    }Subscription;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Send the latest fix to all subscriptions due. The mutex has to be 
+     *  locked.
+     *
+     *  \param b_NewFix If the latest fix was just added.
+     */
+    
+    void Notify(bool b_NewFix) noexcept;
+    
+    /**
+     *  Check if a fix passes the change thresholds of a subscription.
+     *
+     *  \param c_Subscription The subscription to check.
+     *  \param c_Fix The fix to check.
+     *
+     *  \return true if the fix passes, false if not.
+     */
+    
+    static bool Changed(Subscription const& c_Subscription, LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Send a location update event.
+     *
+     *  \param u32_GroupID The event group id to send to.
+     *  \param c_Fix The fix to send.
+     */
+    
+    static void Send(MRH_Uint32 u32_GroupID, LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    std::mutex c_Mutex;
+    std::vector<Subscription> v_Subscription;
+    
+    LocationSnapshot::Fix c_Latest;
+    
+protected:
+    
+};
+
+#endif /* LocationSubscription_h */
@@ -0,0 +1,604 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// External
+#include <libmrhpsb/MRH_PSBLogger.h>
+
+// Project
+#include "./LocationVisits.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_FileMagic = 0x4C565331; // "LVS1"
+    constexpr MRH_Uint32 u32_FileVersion = 1;
+    
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0; // Meters
+    constexpr MRH_Sfloat64 f64_MetersPerLatitude = f64_EarthRadius * M_PI / 180.0;
+    
+    // Geohash precision 7, 18 longtitude and 17 latitude bits
+    constexpr int i_ColumnBits = 18;
+    constexpr int i_RowBits = 17;
+    constexpr MRH_Uint32 u32_Columns = 1 << i_ColumnBits;
+    constexpr MRH_Uint32 u32_Rows = 1 << i_RowBits;
+    constexpr MRH_Sfloat64 f64_CellMeters = f64_MetersPerLatitude * 180.0 / u32_Rows;
+    
+    typedef struct FileHeader_t
+    {
+        MRH_Uint32 u32_Magic;
+        MRH_Uint32 u32_Version;
+        
+    }FileHeader;
+    
+    inline MRH_Sfloat64 GetMetersPerLongtitude(MRH_Sfloat64 f64_Latitude) noexcept
+    {
+        return f64_MetersPerLatitude * std::max(std::cos(f64_Latitude * M_PI / 180.0), 0.01);
+    }
+    
+    inline MRH_Sfloat64 WrapLongtitude(MRH_Sfloat64 f64_Longtitude) noexcept
+    {
+        return std::remainder(f64_Longtitude, 360.0);
+    }
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LocationVisits::LocationVisits(std::string const& s_FilePath, MRH_Sfloat64 f64_Distance, MRH_Uint64 u64_DurationMS, MRH_Sfloat64 f64_PlaceDistance) noexcept : f64_Distance(f64_Distance),
+                                                                                                                                                                 u64_DurationMS(u64_DurationMS),
+                                                                                                                                                                 f64_PlaceDistance(f64_PlaceDistance),
+                                                                                                                                                                 s_FilePath(s_FilePath),
+                                                                                                                                                                 i_FD(-1),
+                                                                                                                                                                 u32_Records(0),
+                                                                                                                                                                 b_Current(false)
+{
+    std::memset(&c_Stay, 0, sizeof(c_Stay));
+    std::memset(&c_Leave, 0, sizeof(c_Leave));
+    std::memset(&c_Current, 0, sizeof(c_Current));
+    
+    Load(s_FilePath);
+}
+
+LocationVisits::~LocationVisits() noexcept
+{
+    // Keep the current visit, departed at the last fix
+    if (c_Stay.u32_Fixes > 0 && c_Stay.u64_LastMS - c_Stay.u64_FirstMS >= u64_DurationMS)
+    {
+        Record c_Record;
+        
+        c_Record.u64_ArrivalMS = c_Stay.u64_FirstMS;
+        c_Record.u64_DepartureMS = c_Stay.u64_LastMS;
+        GetCentroid(c_Stay, c_Record.f64_Latitude, c_Record.f64_Longtitude);
+        
+        Append(c_Record);
+    }
+    
+    if (i_FD >= 0)
+    {
+        close(i_FD);
+    }
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void LocationVisits::Update(LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    if (std::isfinite(c_Fix.f64_Latitude) == false || std::isfinite(c_Fix.f64_Longtitude) == false)
+    {
+        return;
+    }
+    else if (c_Stay.u32_Fixes == 0)
+    {
+        Add(c_Stay, c_Fix);
+        return;
+    }
+    
+    if (GetDistance(c_Stay, c_Fix) <= f64_Distance)
+    {
+        Add(c_Stay, c_Fix);
+        c_Leave.u32_Fixes = 0;
+    }
+    else
+    {
+        // A single stray fix does not end a stay
+        Add(c_Leave, c_Fix);
+        
+        if (c_Leave.u32_Fixes < MRH_USER_LOCATION_VISIT_LEAVE_COUNT)
+        {
+            return;
+        }
+        
+        if (c_Stay.u64_LastMS - c_Stay.u64_FirstMS >= u64_DurationMS)
+        {
+            Record c_Record;
+            
+            c_Record.u64_ArrivalMS = c_Stay.u64_FirstMS;
+            c_Record.u64_DepartureMS = c_Stay.u64_LastMS;
+            GetCentroid(c_Stay, c_Record.f64_Latitude, c_Record.f64_Longtitude);
+            
+            Append(c_Record);
+            
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            AddVisit(c_Record);
+            b_Current = false;
+        }
+        
+        // The fixes outside start the next stay
+        c_Stay = c_Leave;
+        c_Leave.u32_Fixes = 0;
+    }
+    
+    if (c_Stay.u64_LastMS - c_Stay.u64_FirstMS >= u64_DurationMS)
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        
+        c_Current.u64_ArrivalMS = c_Stay.u64_FirstMS;
+        c_Current.u64_DepartureMS = 0;
+        GetCentroid(c_Stay, c_Current.f64_Latitude, c_Current.f64_Longtitude);
+        c_Current.u32_PlaceID = 0;
+        b_Current = true;
+    }
+}
+
+//*************************************************************************************
+// Stay
+//*************************************************************************************
+
+void LocationVisits::Add(Stay& c_Stay, LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    if (c_Stay.u32_Fixes == 0)
+    {
+        c_Stay.u32_Fixes = 1;
+        c_Stay.u64_FirstMS = c_Fix.u64_TimeMS;
+        c_Stay.u64_LastMS = c_Fix.u64_TimeMS;
+        c_Stay.f64_Latitude = c_Fix.f64_Latitude;
+        c_Stay.f64_Longtitude = c_Fix.f64_Longtitude;
+        c_Stay.f64_North = 0.0;
+        c_Stay.f64_East = 0.0;
+        return;
+    }
+    
+    // Sums are kept relative to the first fix
+    c_Stay.f64_North += (c_Fix.f64_Latitude - c_Stay.f64_Latitude) * f64_MetersPerLatitude;
+    c_Stay.f64_East += WrapLongtitude(c_Fix.f64_Longtitude - c_Stay.f64_Longtitude) * GetMetersPerLongtitude(c_Stay.f64_Latitude);
+    c_Stay.u64_LastMS = std::max(c_Stay.u64_LastMS, c_Fix.u64_TimeMS);
+    ++(c_Stay.u32_Fixes);
+}
+
+MRH_Sfloat64 LocationVisits::GetDistance(Stay const& c_Stay, LocationSnapshot::Fix const& c_Fix) noexcept
+{
+    MRH_Sfloat64 f64_North = ((c_Fix.f64_Latitude - c_Stay.f64_Latitude) * f64_MetersPerLatitude) - (c_Stay.f64_North / c_Stay.u32_Fixes);
+    MRH_Sfloat64 f64_East = (WrapLongtitude(c_Fix.f64_Longtitude - c_Stay.f64_Longtitude) * GetMetersPerLongtitude(c_Stay.f64_Latitude)) - (c_Stay.f64_East / c_Stay.u32_Fixes);
+    
+    return std::sqrt((f64_North * f64_North) + (f64_East * f64_East));
+}
+
+void LocationVisits::GetCentroid(Stay const& c_Stay, MRH_Sfloat64& f64_Latitude, MRH_Sfloat64& f64_Longtitude) noexcept
+{
+    f64_Latitude = c_Stay.f64_Latitude + ((c_Stay.f64_North / c_Stay.u32_Fixes) / f64_MetersPerLatitude);
+    f64_Longtitude = WrapLongtitude(c_Stay.f64_Longtitude + ((c_Stay.f64_East / c_Stay.u32_Fixes) / GetMetersPerLongtitude(c_Stay.f64_Latitude)));
+}
+
+//*************************************************************************************
+// Visits
+//*************************************************************************************
+
+void LocationVisits::AddVisit(Record const& c_Record) noexcept
+{
+    Visit c_Visit;
+    
+    c_Visit.u64_ArrivalMS = c_Record.u64_ArrivalMS;
+    c_Visit.u64_DepartureMS = c_Record.u64_DepartureMS;
+    c_Visit.f64_Latitude = c_Record.f64_Latitude;
+    c_Visit.f64_Longtitude = c_Record.f64_Longtitude;
+    c_Visit.u32_PlaceID = AddPlace(c_Record);
+    
+    try
+    {
+        dq_Visit.emplace_back(c_Visit);
+        
+        if (dq_Visit.size() > MRH_USER_LOCATION_VISIT_MAX)
+        {
+            dq_Visit.pop_front();
+        }
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to add visit: " + std::string(e.what()),
+                                       "LocationVisits.cpp", __LINE__);
+    }
+}
+
+MRH_Uint32 LocationVisits::FindPlace(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude) const noexcept
+{
+    // Search all cells closer than the place distance
+    MRH_Uint32 u32_Row;
+    MRH_Uint32 u32_Column;
+    MRH_Sfloat64 f64_MetersPerLongtitude = GetMetersPerLongtitude(f64_Latitude);
+    MRH_Sint64 s64_Rows = static_cast<MRH_Sint64>(std::ceil(f64_PlaceDistance / f64_CellMeters));
+    MRH_Sint64 s64_Columns = std::min(static_cast<MRH_Sint64>(std::ceil(f64_PlaceDistance / (f64_CellMeters * (f64_MetersPerLongtitude / f64_MetersPerLatitude)))),
+                                      static_cast<MRH_Sint64>(u32_Columns / 2));
+    MRH_Sfloat64 f64_Best = f64_PlaceDistance;
+    MRH_Uint32 u32_Best = 0;
+    
+    GetCell(f64_Latitude, f64_Longtitude, u32_Row, u32_Column);
+    
+    for (MRH_Sint64 i = static_cast<MRH_Sint64>(u32_Row) - s64_Rows; i <= static_cast<MRH_Sint64>(u32_Row) + s64_Rows; ++i)
+    {
+        if (i < 0 || i >= u32_Rows)
+        {
+            continue;
+        }
+        
+        for (MRH_Sint64 j = static_cast<MRH_Sint64>(u32_Column) - s64_Columns; j <= static_cast<MRH_Sint64>(u32_Column) + s64_Columns; ++j)
+        {
+            // Columns wrap around at the 180th meridian
+            auto Cell = m_Cell.find(GetKey(static_cast<MRH_Uint32>(i), static_cast<MRH_Uint32>((j + u32_Columns) % u32_Columns)));
+            
+            if (Cell == m_Cell.end())
+            {
+                continue;
+            }
+            
+            for (auto& ID : Cell->second)
+            {
+                Place const& c_Place = v_Place[ID - 1];
+                MRH_Sfloat64 f64_North = (c_Place.f64_Latitude - f64_Latitude) * f64_MetersPerLatitude;
+                MRH_Sfloat64 f64_East = WrapLongtitude(c_Place.f64_Longtitude - f64_Longtitude) * f64_MetersPerLongtitude;
+                MRH_Sfloat64 f64_Distance = std::sqrt((f64_North * f64_North) + (f64_East * f64_East));
+                
+                if (f64_Distance <= f64_Best)
+                {
+                    f64_Best = f64_Distance;
+                    u32_Best = ID;
+                }
+            }
+        }
+    }
+    
+    return u32_Best;
+}
+
+MRH_Uint32 LocationVisits::AddPlace(Record const& c_Record) noexcept
+{
+    MRH_Uint32 u32_Best = FindPlace(c_Record.f64_Latitude, c_Record.f64_Longtitude);
+    MRH_Uint32 u32_Row;
+    MRH_Uint32 u32_Column;
+    
+    try
+    {
+        if (u32_Best == 0)
+        {
+            if (v_Place.size() >= MRH_USER_LOCATION_PLACE_MAX)
+            {
+                return 0;
+            }
+            
+            Place c_Place;
+            
+            c_Place.u32_PlaceID = static_cast<MRH_Uint32>(v_Place.size() + 1);
+            c_Place.f64_Latitude = c_Record.f64_Latitude;
+            c_Place.f64_Longtitude = c_Record.f64_Longtitude;
+            c_Place.u32_Visits = 1;
+            c_Place.u64_DurationMS = c_Record.u64_DepartureMS - c_Record.u64_ArrivalMS;
+            c_Place.u64_LastMS = c_Record.u64_DepartureMS;
+            
+            GetCell(c_Place.f64_Latitude, c_Place.f64_Longtitude, u32_Row, u32_Column);
+            
+            v_Place.emplace_back(c_Place);
+            m_Cell[GetKey(u32_Row, u32_Column)].emplace_back(c_Place.u32_PlaceID);
+            
+            return c_Place.u32_PlaceID;
+        }
+        
+        // Move the place centroid towards the visit
+        Place& c_Place = v_Place[u32_Best - 1];
+        MRH_Uint32 u32_OldRow;
+        MRH_Uint32 u32_OldColumn;
+        
+        GetCell(c_Place.f64_Latitude, c_Place.f64_Longtitude, u32_OldRow, u32_OldColumn);
+        
+        c_Place.f64_Latitude += (c_Record.f64_Latitude - c_Place.f64_Latitude) / (c_Place.u32_Visits + 1);
+        c_Place.f64_Longtitude = WrapLongtitude(c_Place.f64_Longtitude + (WrapLongtitude(c_Record.f64_Longtitude - c_Place.f64_Longtitude) / (c_Place.u32_Visits + 1)));
+        c_Place.u32_Visits += 1;
+        c_Place.u64_DurationMS += c_Record.u64_DepartureMS - c_Record.u64_ArrivalMS;
+        c_Place.u64_LastMS = std::max(c_Place.u64_LastMS, c_Record.u64_DepartureMS);
+        
+        GetCell(c_Place.f64_Latitude, c_Place.f64_Longtitude, u32_Row, u32_Column);
+        
+        if (u32_Row != u32_OldRow || u32_Column != u32_OldColumn)
+        {
+            std::vector<MRH_Uint32>& v_Old = m_Cell[GetKey(u32_OldRow, u32_OldColumn)];
+            
+            v_Old.erase(std::remove(v_Old.begin(), v_Old.end(), u32_Best), v_Old.end());
+            m_Cell[GetKey(u32_Row, u32_Column)].emplace_back(u32_Best);
+        }
+        
+        return u32_Best;
+    }
+    catch (std::exception& e)
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to add place: " + std::string(e.what()),
+                                       "LocationVisits.cpp", __LINE__);
+        return 0;
+    }
+}
+
+void LocationVisits::GetCell(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, MRH_Uint32& u32_Row, MRH_Uint32& u32_Column) noexcept
+{
+    MRH_Sfloat64 f64_Row = std::floor(((f64_Latitude + 90.0) / 180.0) * u32_Rows);
+    MRH_Sfloat64 f64_Column = std::floor(((WrapLongtitude(f64_Longtitude) + 180.0) / 360.0) * u32_Columns);
+    
+    u32_Row = static_cast<MRH_Uint32>(std::min(std::max(f64_Row, 0.0), static_cast<MRH_Sfloat64>(u32_Rows - 1)));
+    u32_Column = static_cast<MRH_Uint32>(std::min(std::max(f64_Column, 0.0), static_cast<MRH_Sfloat64>(u32_Columns - 1)));
+}
+
+MRH_Uint64 LocationVisits::GetKey(MRH_Uint32 u32_Row, MRH_Uint32 u32_Column) noexcept
+{
+    // Interleaved like geohash, longtitude bit first
+    MRH_Uint64 u64_Key = 0;
+    
+    for (int i = i_ColumnBits - 1; i >= 0; --i)
+    {
+        u64_Key = (u64_Key << 1) | ((u32_Column >> i) & 1);
+        
+        if (i > 0)
+        {
+            u64_Key = (u64_Key << 1) | ((u32_Row >> (i - 1)) & 1);
+        }
+    }
+    
+    return u64_Key;
+}
+
+//*************************************************************************************
+// File
+//*************************************************************************************
+
+void LocationVisits::Load(std::string const& s_FilePath) noexcept
+{
+    MRH_PSBLogger& c_Logger = MRH_PSBLogger::Singleton();
+    FileHeader c_Header;
+    
+    if ((i_FD = open(s_FilePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0)
+    {
+        c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to open visit file " +
+                                           s_FilePath +
+                                           ": " +
+                                           std::string(std::strerror(errno)) +
+                                           " (" +
+                                           std::to_string(errno) +
+                                           ")!",
+                     "LocationVisits.cpp", __LINE__);
+        return;
+    }
+    
+    // New or unknown file, start over
+    if (read(i_FD, &c_Header, sizeof(c_Header)) != sizeof(c_Header) ||
+        c_Header.u32_Magic != u32_FileMagic ||
+        c_Header.u32_Version != u32_FileVersion)
+    {
+        c_Header.u32_Magic = u32_FileMagic;
+        c_Header.u32_Version = u32_FileVersion;
+        
+        if (ftruncate(i_FD, 0) != 0 || pwrite(i_FD, &c_Header, sizeof(c_Header), 0) != sizeof(c_Header))
+        {
+            c_Logger.Log(MRH_PSBLogger::ERROR, "Failed to create visit file " + s_FilePath + "!",
+                         "LocationVisits.cpp", __LINE__);
+            close(i_FD);
+            i_FD = -1;
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        Record p_Record[64];
+        ssize_t ss_Read;
+        
+        while ((ss_Read = read(i_FD, p_Record, sizeof(p_Record))) >= static_cast<ssize_t>(sizeof(Record)))
+        {
+            for (ssize_t i = 0; i < ss_Read / static_cast<ssize_t>(sizeof(Record)); ++i)
+            {
+                AddVisit(p_Record[i]);
+                ++u32_Records;
+            }
+            
+            if (ss_Read % sizeof(Record) != 0)
+            {
+                break;
+            }
+        }
+    }
+    
+    // Drop a partly written visit
+    if (ftruncate(i_FD, sizeof(c_Header) + (static_cast<off_t>(u32_Records) * sizeof(Record))) != 0 ||
+        lseek(i_FD, 0, SEEK_END) < 0)
+    {
+        close(i_FD);
+        i_FD = -1;
+        return;
+    }
+    
+    c_Logger.Log(MRH_PSBLogger::INFO, "Loaded " +
+                                      std::to_string(u32_Records) +
+                                      " visits at " +
+                                      std::to_string(v_Place.size()) +
+                                      " places.",
+                 "LocationVisits.cpp", __LINE__);
+}
+
+void LocationVisits::Append(Record const& c_Record) noexcept
+{
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    // Rewrite with the kept visits once the file holds twice as many
+    if (u32_Records >= 2 * MRH_USER_LOCATION_VISIT_MAX)
+    {
+        std::string s_TempPath = s_FilePath + ".tmp";
+        int i_TempFD = open(s_TempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        FileHeader c_Header = { u32_FileMagic, u32_FileVersion };
+        bool b_Written = (i_TempFD >= 0 && write(i_TempFD, &c_Header, sizeof(c_Header)) == sizeof(c_Header));
+        MRH_Uint32 u32_Written = 0;
+        
+        {
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            
+            for (auto It = dq_Visit.begin(); It != dq_Visit.end() && b_Written == true; ++It)
+            {
+                Record c_Kept = { It->u64_ArrivalMS, It->u64_DepartureMS, It->f64_Latitude, It->f64_Longtitude };
+                
+                b_Written = (write(i_TempFD, &c_Kept, sizeof(c_Kept)) == sizeof(c_Kept));
+                ++u32_Written;
+            }
+        }
+        
+        if (i_TempFD >= 0 && (close(i_TempFD) != 0 || b_Written == false || rename(s_TempPath.c_str(), s_FilePath.c_str()) != 0))
+        {
+            b_Written = false;
+        }
+        
+        if (b_Written == false)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to compact visit file " + s_FilePath + "!",
+                                           "LocationVisits.cpp", __LINE__);
+            unlink(s_TempPath.c_str());
+        }
+        else
+        {
+            close(i_FD);
+            
+            if ((i_FD = open(s_FilePath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC)) < 0)
+            {
+                MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to open visit file " + s_FilePath + "!",
+                                               "LocationVisits.cpp", __LINE__);
+                return;
+            }
+            
+            u32_Records = u32_Written;
+        }
+    }
+    
+    if (write(i_FD, &c_Record, sizeof(c_Record)) != sizeof(c_Record))
+    {
+        MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Failed to write visit: " +
+                                                             std::string(std::strerror(errno)) +
+                                                             " (" +
+                                                             std::to_string(errno) +
+                                                             ")!",
+                                       "LocationVisits.cpp", __LINE__);
+        return;
+    }
+    
+    ++u32_Records;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint32 LocationVisits::GetVisits(MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, Visit* p_Visit, MRH_Uint32 u32_Count) const noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    MRH_Uint32 u32_Written = 0;
+    
+    if (u32_Count == 0 || u64_StartMS > u64_EndMS)
+    {
+        return 0;
+    }
+    
+    // Newest first, reversed below
+    if (b_Current == true && c_Current.u64_ArrivalMS <= u64_EndMS)
+    {
+        p_Visit[u32_Written] = c_Current;
+        p_Visit[u32_Written++].u32_PlaceID = FindPlace(c_Current.f64_Latitude, c_Current.f64_Longtitude);
+    }
+    
+    for (auto It = dq_Visit.rbegin(); It != dq_Visit.rend() && u32_Written < u32_Count; ++It)
+    {
+        if (It->u64_DepartureMS < u64_StartMS)
+        {
+            break;
+        }
+        else if (It->u64_ArrivalMS <= u64_EndMS)
+        {
+            p_Visit[u32_Written++] = *It;
+        }
+    }
+    
+    std::reverse(p_Visit, p_Visit + u32_Written);
+    return u32_Written;
+}
+
+MRH_Uint32 LocationVisits::GetPlaces(Place* p_Place, MRH_Uint32 u32_Count) const noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    std::vector<MRH_Uint32> v_Order;
+    
+    try
+    {
+        v_Order.reserve(v_Place.size());
+    }
+    catch (std::exception& e)
+    {
+        return 0;
+    }
+    
+    for (size_t i = 0; i < v_Place.size(); ++i)
+    {
+        v_Order.emplace_back(static_cast<MRH_Uint32>(i));
+    }
+    
+    u32_Count = std::min(u32_Count, static_cast<MRH_Uint32>(v_Order.size()));
+    
+    std::partial_sort(v_Order.begin(), v_Order.begin() + u32_Count, v_Order.end(), [this](MRH_Uint32 u32_A, MRH_Uint32 u32_B)
+    {
+        Place const& c_A = v_Place[u32_A];
+        Place const& c_B = v_Place[u32_B];
+        
+        if (c_A.u32_Visits != c_B.u32_Visits)
+        {
+            return c_A.u32_Visits > c_B.u32_Visits;
+        }
+        
+        return c_A.u64_DurationMS > c_B.u64_DurationMS;
+    });
+    
+    for (MRH_Uint32 i = 0; i < u32_Count; ++i)
+    {
+        p_Place[i] = v_Place[v_Order[i]];
+    }
+    
+    return u32_Count;
+}
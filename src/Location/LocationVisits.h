@@ -0,0 +1,328 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef LocationVisits_h
+#define LocationVisits_h
+
+// C / C++
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./LocationSnapshot.h"
+
+// Pre-defined
+#ifndef MRH_USER_LOCATION_VISIT_MAX
+    #define MRH_USER_LOCATION_VISIT_MAX 16384
+#endif
+#ifndef MRH_USER_LOCATION_VISIT_LEAVE_COUNT
+    #define MRH_USER_LOCATION_VISIT_LEAVE_COUNT 3
+#endif
+#ifndef MRH_USER_LOCATION_PLACE_MAX
+    #define MRH_USER_LOCATION_PLACE_MAX 4096
+#endif
+
+
+class LocationVisits
+{
+public:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef struct Visit_t
+    {
+        MRH_Uint64 u64_ArrivalMS; // Unix time in milliseconds
+        MRH_Uint64 u64_DepartureMS; // 0 if still staying
+        
+        // Centroid of all fixes during the visit
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+        MRH_Uint32 u32_PlaceID; // 0 if not assigned
+        
+    }Visit;
+    
+    typedef struct Place_t
+    {
+        MRH_Uint32 u32_PlaceID;
+        
+        // Centroid of all visits
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+        MRH_Uint32 u32_Visits;
+        MRH_Uint64 u64_DurationMS; // All visits
+        MRH_Uint64 u64_LastMS; // Last departure
+        
+    }Place;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. Stored visits are loaded and grouped into
+     *  places again. Visits are only kept in memory if the file can not
+     *  be opened.
+     *
+     *  \param s_FilePath The full path to the visit file.
+     *  \param f64_Distance The distance in meters a stay may spread.
+     *  \param u64_DurationMS The time in milliseconds a stay needs to be a visit.
+     *  \param f64_PlaceDistance The distance in meters between visits of the same place.
+     */
+    
+    LocationVisits(std::string const& s_FilePath, MRH_Sfloat64 f64_Distance, MRH_Uint64 u64_DurationMS, MRH_Sfloat64 f64_PlaceDistance) noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LocationVisits LocationVisits class source.
+     */
+    
+    LocationVisits(LocationVisits const& c_LocationVisits) = delete;
+    
+    /**
+     *  Default destructor. A current visit is stored as departed at the
+     *  last fix.
+     */
+    
+    ~LocationVisits() noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Add a location fix. Only a single thread may add fixes.
+     *
+     *  \param c_Fix The location fix to add.
+     */
+    
+    void Update(LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the newest visits overlapping a time range, oldest first. A
+     *  current visit is included. This function is thread safe.
+     *
+     *  \param u64_StartMS The range start in milliseconds.
+     *  \param u64_EndMS The range end in milliseconds.
+     *  \param p_Visit The visit buffer to write to.
+     *  \param u32_Count The maximum number of visits to write.
+     *
+     *  \return The number of visits written.
+     */
+    
+    MRH_Uint32 GetVisits(MRH_Uint64 u64_StartMS, MRH_Uint64 u64_EndMS, Visit* p_Visit, MRH_Uint32 u32_Count) const noexcept;
+    
+    /**
+     *  Get the most visited places, most visits first. This function is
+     *  thread safe.
+     *
+     *  \param p_Place The place buffer to write to.
+     *  \param u32_Count The maximum number of places to write.
+     *
+     *  \return The number of places written.
+     */
+    
+    MRH_Uint32 GetPlaces(Place* p_Place, MRH_Uint32 u32_Count) const noexcept;
+    
+private:
+    
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // Running centroid, offsets in meters from the first fix
+    typedef struct Stay_t
+    {
+        MRH_Uint32 u32_Fixes;
+        MRH_Uint64 u64_FirstMS;
+        MRH_Uint64 u64_LastMS;
+        
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        MRH_Sfloat64 f64_North;
+        MRH_Sfloat64 f64_East;
+        
+    }Stay;
+    
+    // Stored visit, appended once departed
+    typedef struct Record_t
+    {
+        MRH_Uint64 u64_ArrivalMS;
+        MRH_Uint64 u64_DepartureMS;
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+    }Record;
+    
+    //*************************************************************************************
+    // Stay
+    //*************************************************************************************
+    
+    /**
+     *  Add a fix to a stay.
+     *
+     *  \param c_Stay The stay to add to.
+     *  \param c_Fix The fix to add.
+     */
+    
+    static void Add(Stay& c_Stay, LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Get the distance from a stay centroid to a fix.
+     *
+     *  \param c_Stay The stay to measure from.
+     *  \param c_Fix The fix to measure to.
+     *
+     *  \return The distance in meters.
+     */
+    
+    static MRH_Sfloat64 GetDistance(Stay const& c_Stay, LocationSnapshot::Fix const& c_Fix) noexcept;
+    
+    /**
+     *  Get the centroid of a stay.
+     *
+     *  \param c_Stay The stay to use.
+     *  \param f64_Latitude The centroid latitude.
+     *  \param f64_Longtitude The centroid longtitude.
+     */
+    
+    static void GetCentroid(Stay const& c_Stay, MRH_Sfloat64& f64_Latitude, MRH_Sfloat64& f64_Longtitude) noexcept;
+    
+    //*************************************************************************************
+    // Visits
+    //*************************************************************************************
+    
+    /**
+     *  Add a departed visit and assign its place. The mutex has to be
+     *  locked.
+     *
+     *  \param c_Record The visit to add.
+     */
+    
+    void AddVisit(Record const& c_Record) noexcept;
+    
+    /**
+     *  Get the closest place within the place distance. The mutex has to 
+     *  be locked.
+     *
+     *  \param f64_Latitude The position latitude.
+     *  \param f64_Longtitude The position longtitude.
+     *
+     *  \return The place id or 0.
+     */
+    
+    MRH_Uint32 FindPlace(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude) const noexcept;
+    
+    /**
+     *  Get the place for a visit, creating a new place if none is close.
+     *  The mutex has to be locked.
+     *
+     *  \param c_Record The visit to find a place for.
+     *
+     *  \return The place id or 0.
+     */
+    
+    MRH_Uint32 AddPlace(Record const& c_Record) noexcept;
+    
+    /**
+     *  Get the geohash cell for a position.
+     *
+     *  \param f64_Latitude The position latitude.
+     *  \param f64_Longtitude The position longtitude.
+     *  \param u32_Row The cell row to write to.
+     *  \param u32_Column The cell column to write to.
+     */
+    
+    static void GetCell(MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude, MRH_Uint32& u32_Row, MRH_Uint32& u32_Column) noexcept;
+    
+    /**
+     *  Get the geohash key for a cell.
+     *
+     *  \param u32_Row The cell row.
+     *  \param u32_Column The cell column.
+     *
+     *  \return The geohash bits.
+     */
+    
+    static MRH_Uint64 GetKey(MRH_Uint32 u32_Row, MRH_Uint32 u32_Column) noexcept;
+    
+    //*************************************************************************************
+    // File
+    //*************************************************************************************
+    
+    /**
+     *  Load all stored visits.
+     *
+     *  \param s_FilePath The full path to the visit file.
+     */
+    
+    void Load(std::string const& s_FilePath) noexcept;
+    
+    /**
+     *  Append a visit to the visit file.
+     *
+     *  \param c_Record The visit to append.
+     */
+    
+    void Append(Record const& c_Record) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Settings
+    MRH_Sfloat64 f64_Distance;
+    MRH_Uint64 u64_DurationMS;
+    MRH_Sfloat64 f64_PlaceDistance;
+    
+    // Update thread only
+    Stay c_Stay;
+    Stay c_Leave; // Consecutive fixes outside the stay
+    
+    std::string s_FilePath;
+    int i_FD;
+    MRH_Uint32 u32_Records;
+    
+    // Departed visits and current stay, guarded by the mutex
+    mutable std::mutex c_Mutex;
+    std::deque<Visit> dq_Visit;
+    Visit c_Current;
+    bool b_Current;
+    
+    // Places with an index of geohash cell to place ids
+    std::vector<Place> v_Place;
+    std::unordered_map<MRH_Uint64, std::vector<MRH_Uint32>> m_Cell;
+    
+protected:
+    
+};
+
+#endif /* LocationVisits_h */
@@ -16,6 +16,11 @@
 
 // C / C++
 #include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <thread>
+#include <algorithm>
 
 // External
 #include <libmrhpsb.h>
@@ -28,14 +33,17 @@
 #include "./Callback/Content/CBAccessClear.h"
 #include "./Callback/Location/CBGetLocation.h"
 #include "./Content/Content.h"
+#include "./Location/LocationSnapshot.h"
+#include "./Location/LocationSubscription.h"
+#include "./Location/LocationHistory.h"
+#include "./Location/LocationStore.h"
+#include "./Location/LocationSources.h"
+#include "./Location/LocationGeofence.h"
+#include "./Location/LocationGeocode.h"
+#include "./Location/LocationVisits.h"
 #include "./Configuration.h"
 #include "./Revision.h"
 
-// Pre-defined
-#ifndef MRH_USER_SERVICE_THREAD_COUNT
-    #define MRH_USER_SERVICE_THREAD_COUNT 1
-#endif
-
 
 //*************************************************************************************
 // Exit
@@ -57,6 +65,56 @@ static int Exit(libmrhpsb* p_Context, const char* p_Exception, int i_Result)
     return i_Result;
 }
 
+//*************************************************************************************
+// Threads
+//*************************************************************************************
+
+static MRH_Uint32 GetCallbackThreadCount(int argc, const char* argv[], Configuration const& c_Configuration)
+{
+    // Command line overrides the configuration
+    MRH_Uint32 u32_Count = c_Configuration.GetCallbackThreadCount();
+    const char* p_Option = "--callback-threads=";
+    size_t us_OptionSize = std::strlen(p_Option);
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], p_Option, us_OptionSize) != 0)
+        {
+            continue;
+        }
+        
+        const char* p_Value = argv[i] + us_OptionSize;
+        char* p_End;
+        
+        errno = 0;
+        unsigned long ul_Count = std::strtoul(p_Value, &p_End, 10);
+        
+        // Digits only, strtoul would accept a sign and wrap negative values
+        if (*p_Value < '0' || *p_Value > '9' || *p_End != '\0' || errno == ERANGE || ul_Count > UINT32_MAX)
+        {
+            MRH_PSBLogger::Singleton().Log(MRH_PSBLogger::ERROR, "Invalid callback thread count " +
+                                                                 std::string(p_Value) +
+                                                                 ", using " +
+                                                                 std::to_string(c_Configuration.GetCallbackThreadCount()) +
+                                                                 " from the configuration.",
+                                           "Main.cpp", __LINE__);
+            u32_Count = c_Configuration.GetCallbackThreadCount();
+        }
+        else
+        {
+            u32_Count = static_cast<MRH_Uint32>(ul_Count);
+        }
+    }
+    
+    // One thread per core if not set
+    if (u32_Count == 0)
+    {
+        u32_Count = std::max(static_cast<MRH_Uint32>(std::thread::hardware_concurrency()), static_cast<MRH_Uint32>(1));
+    }
+    
+    return u32_Count;
+}
+
 //*************************************************************************************
 // Main
 //*************************************************************************************
@@ -69,41 +127,59 @@ int main(int argc, const char* argv[])
     
     try
     {
-        // Build library context first
+        // Load config first, it sets the callback thread count
+        Configuration c_Configuration;
+        
+        // Next, build library context
         p_Context = new libmrhpsb("mrhpsuser",
                                   argc,
                                   argv,
-                                  MRH_USER_SERVICE_THREAD_COUNT);
-        
-        // Next, load config for service data
-        Configuration c_Configuration;
+                                  GetCallbackThreadCount(argc, argv, c_Configuration));
         
         // Create the user content
         std::shared_ptr<Content> p_Content(new Content(c_Configuration));
         
+        // Create the shared location state
+        std::shared_ptr<LocationSnapshot> p_Snapshot(new LocationSnapshot());
+        std::shared_ptr<LocationSubscription> p_Subscription(new LocationSubscription());
+        std::shared_ptr<LocationHistory> p_History(new LocationHistory(c_Configuration.GetLocationHistoryCapacity()));
+        std::shared_ptr<LocationStore> p_Store(new LocationStore(c_Configuration.GetLocationStoreDirectoryPath(),
+                                                                 c_Configuration.GetLocationStoreSegmentSize(),
+                                                                 c_Configuration.GetLocationStoreSizeBudget()));
+        std::shared_ptr<LocationSources> p_Sources(new LocationSources(c_Configuration.GetLocationSources()));
+        std::shared_ptr<LocationGeofence> p_Geofence(new LocationGeofence(c_Configuration.GetGeofences()));
+        std::shared_ptr<LocationGeocode> p_Geocode(new LocationGeocode(c_Configuration.GetLocationGeocodeDataPath(),
+                                                                       c_Configuration.GetLocationGeocodeIndexPath()));
+        std::shared_ptr<LocationVisits> p_Visits(new LocationVisits(c_Configuration.GetLocationVisitFilePath(),
+                                                                    c_Configuration.GetLocationVisitDistance(),
+                                                                    static_cast<MRH_Uint64>(c_Configuration.GetLocationVisitDuration()) * 1000,
+                                                                    c_Configuration.GetLocationVisitPlaceDistance()));
+        
+        // Filesystem callbacks leave the callback threads
+        std::shared_ptr<CallbackLane> p_Lane(new CallbackLane(MRH_USER_CALLBACK_IO_THREAD_COUNT));
+        
         // Create callbacks
         std::shared_ptr<MRH_Callback> p_CBAvail(new CBAvail(p_Content));
-        std::shared_ptr<MRH_Callback> p_CBReset(new CBReset(p_Content));
-        std::shared_ptr<MRH_Callback> p_CBCustomCommand(new CBCustomCommand());
+        std::shared_ptr<MRH_Callback> p_CBReset(new CBReset(p_Content, p_Subscription, p_Geofence, p_Lane));
+        std::shared_ptr<MRH_Callback> p_CBCustomCommand(new CBCustomCommand(p_Content, p_Snapshot, p_Subscription, p_History, p_Store, p_Sources, p_Geofence, p_Geocode, p_Visits, p_Lane));
         
-        std::shared_ptr<MRH_Callback> p_CBAccessContent(new CBAccessContent(p_Content));
-        std::shared_ptr<MRH_Callback> p_CBAccessClear(new CBAccessClear(p_Content));
+        std::shared_ptr<MRH_Callback> p_CBAccessContent(new CBAccessContent(p_Content, c_Configuration, p_Lane));
+        std::shared_ptr<MRH_Callback> p_CBAccessClear(new CBAccessClear(p_Content, p_Lane));
         
-        std::shared_ptr<MRH_Callback> p_CBGetLocation(new CBGetLocation(c_Configuration));
+        std::shared_ptr<MRH_Callback> p_CBGetLocation(new CBGetLocation(c_Configuration, p_Snapshot, p_Subscription, p_History, p_Store, p_Sources, p_Geofence, p_Visits, p_Lane));
         
         // Add created callbacks
         p_Context->AddCallback(p_CBAvail, MRH_EVENT_USER_AVAIL_U);
         p_Context->AddCallback(p_CBReset, MRH_EVENT_PS_RESET_REQUEST_U);
         p_Context->AddCallback(p_CBCustomCommand, MRH_EVENT_USER_CUSTOM_COMMAND_U);
         
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_DOCUMENTS_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_PICTURES_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_MUSIC_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_VIDEOS_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_DOWNLOADS_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_CLIPBOARD_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_INFO_PERSON_U);
-        p_Context->AddCallback(p_CBAccessContent, MRH_EVENT_USER_ACCESS_INFO_RESIDENCE_U);
+        for (auto& ContentType : c_Configuration.GetContentTypes())
+        {
+            if (ContentType.u32_RequestEvent != MRH_EVENT_UNK)
+            {
+                p_Context->AddCallback(p_CBAccessContent, ContentType.u32_RequestEvent);
+            }
+        }
         p_Context->AddCallback(p_CBAccessClear, MRH_EVENT_USER_ACCESS_CLEAR_U);
         
         p_Context->AddCallback(p_CBGetLocation, MRH_EVENT_USER_GET_LOCATION_U);
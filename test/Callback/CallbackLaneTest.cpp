@@ -0,0 +1,435 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <stdexcept>
+
+// External
+
+// Project
+#include "../../src/Callback/CallbackLane.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_TaskCount = 10000;
+    constexpr MRH_Uint32 u32_SubmitterCount = 4;
+    constexpr MRH_Uint32 u32_ThreadCount = 4;
+    
+    // Event stream for one callback thread
+    constexpr MRH_Uint32 u32_EventCount = 2000;
+    constexpr MRH_Uint32 u32_EventGapUS = 200;
+    constexpr MRH_Uint32 u32_IOEvery = 50;
+    constexpr MRH_Uint32 u32_IOMS = 5;
+    
+    // Recieved events, waiting for the callback thread
+    class EventQueue
+    {
+    public:
+        
+        void Push(MRH_Uint32 u32_Event) noexcept
+        {
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            dq_Event.emplace_back(u32_Event, CallbackLane::GetTimeNS());
+            c_Condition.notify_one();
+        }
+        
+        std::pair<MRH_Uint32, MRH_Uint64> Pop() noexcept
+        {
+            std::unique_lock<std::mutex> c_Lock(c_Mutex);
+            c_Condition.wait(c_Lock, [this]() { return dq_Event.size() > 0; });
+            
+            std::pair<MRH_Uint32, MRH_Uint64> c_Event = dq_Event.front();
+            dq_Event.pop_front();
+            
+            return c_Event;
+        }
+        
+    private:
+        
+        std::mutex c_Mutex;
+        std::condition_variable c_Condition;
+        std::deque<std::pair<MRH_Uint32, MRH_Uint64>> dq_Event;
+    };
+    
+    // Every u32_IOEvery event touches the filesystem, the rest answer from 
+    // memory. Filesystem events are performed inline without a lane.
+    // Returns the p99 latency of memory events from being recieved to being 
+    // answered in microseconds.
+    MRH_Uint64 RunDispatch(CallbackLane* p_Lane, bool b_IOLoad)
+    {
+        EventQueue c_Queue;
+        std::vector<MRH_Uint64> v_LatencyUS;
+        
+        v_LatencyUS.reserve(u32_EventCount);
+        
+        std::thread c_Callback([&]()
+        {
+            for (MRH_Uint32 i = 0; i < u32_EventCount; ++i)
+            {
+                std::pair<MRH_Uint32, MRH_Uint64> c_Event = c_Queue.Pop();
+                
+                if (b_IOLoad == false || c_Event.first % u32_IOEvery != 0)
+                {
+                    v_LatencyUS.emplace_back((CallbackLane::GetTimeNS() - c_Event.second) / 1000);
+                }
+                else if (p_Lane == NULL)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(u32_IOMS));
+                }
+                else
+                {
+                    p_Lane->Submit((c_Event.first / u32_IOEvery) % u32_ThreadCount, []()
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(u32_IOMS));
+                    });
+                }
+            }
+        });
+        
+        for (MRH_Uint32 i = 0; i < u32_EventCount; ++i)
+        {
+            c_Queue.Push(i);
+            std::this_thread::sleep_for(std::chrono::microseconds(u32_EventGapUS));
+        }
+        
+        c_Callback.join();
+        
+        std::sort(v_LatencyUS.begin(), v_LatencyUS.end());
+        
+        return v_LatencyUS[(v_LatencyUS.size() * 99) / 100];
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestOrder()
+{
+    // Only the lane thread appends, read after the lane stopped
+    std::vector<MRH_Uint32> v_Performed;
+    
+    {
+        CallbackLane c_Lane(u32_ThreadCount);
+        
+        for (MRH_Uint32 i = 0; i < u32_TaskCount; ++i)
+        {
+            c_Lane.Submit(0, [&v_Performed, i]()
+            {
+                v_Performed.emplace_back(i);
+            });
+        }
+    }
+    
+    MRH_TEST_CHECK(v_Performed.size() == u32_TaskCount);
+    
+    for (MRH_Uint32 i = 0; i < u32_TaskCount; ++i)
+    {
+        MRH_TEST_CHECK(v_Performed[i] == i);
+    }
+    
+    return true;
+}
+
+static bool TestOrderPerSubmitter()
+{
+    // Each submitter keeps its order, like one group requesting access
+    std::vector<std::pair<MRH_Uint32, MRH_Uint32>> v_Performed;
+    std::mutex c_Mutex;
+    
+    {
+        CallbackLane c_Lane(u32_ThreadCount);
+        std::vector<std::thread> v_Submitter;
+        
+        for (MRH_Uint32 i = 0; i < u32_SubmitterCount; ++i)
+        {
+            v_Submitter.emplace_back([&c_Lane, &v_Performed, &c_Mutex, i]()
+            {
+                for (MRH_Uint32 j = 0; j < u32_TaskCount; ++j)
+                {
+                    c_Lane.Submit(i, [&v_Performed, &c_Mutex, i, j]()
+                    {
+                        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+                        v_Performed.emplace_back(i, j);
+                    });
+                }
+            });
+        }
+        
+        for (auto& Submitter : v_Submitter)
+        {
+            Submitter.join();
+        }
+    }
+    
+    std::vector<MRH_Uint32> v_Next(u32_SubmitterCount, 0);
+    
+    MRH_TEST_CHECK(v_Performed.size() == u32_SubmitterCount * u32_TaskCount);
+    
+    for (auto& Performed : v_Performed)
+    {
+        MRH_TEST_CHECK(Performed.second == v_Next[Performed.first]);
+        ++(v_Next[Performed.first]);
+    }
+    
+    return true;
+}
+
+static bool TestException()
+{
+    std::atomic<MRH_Uint32> u32_Performed(0);
+    
+    {
+        CallbackLane c_Lane(u32_ThreadCount);
+        
+        c_Lane.Submit(0, []()
+        {
+            throw std::runtime_error("Test task failure");
+        });
+        c_Lane.Submit(0, [&u32_Performed]()
+        {
+            ++u32_Performed;
+        });
+    }
+    
+    MRH_TEST_CHECK(u32_Performed == 1);
+    
+    return true;
+}
+
+static bool TestSubmitWhileBusy()
+{
+    // A slow filesystem task must not hold up the callback thread
+    CallbackLane c_Lane(u32_ThreadCount);
+    std::promise<void> c_Release;
+    std::shared_future<void> c_Released = c_Release.get_future().share();
+    std::atomic<MRH_Uint32> u32_Performed(0);
+    
+    c_Lane.Submit(0, [c_Released]()
+    {
+        c_Released.wait();
+    });
+    
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (MRH_Uint32 i = 0; i < 100; ++i)
+    {
+        c_Lane.Submit(0, [&u32_Performed]()
+        {
+            ++u32_Performed;
+        });
+    }
+    
+    auto c_Submitted = std::chrono::steady_clock::now() - c_Start;
+    bool b_Waited = (u32_Performed == 0);
+    
+    // Release first, the lane is joined on return
+    c_Release.set_value();
+    
+    MRH_TEST_CHECK(b_Waited == true);
+    MRH_TEST_CHECK(c_Submitted < std::chrono::milliseconds(100));
+    
+    return true;
+}
+
+static bool TestLatency()
+{
+    MRH_Uint64 p_Bucket[CallbackLane::us_BucketCount];
+    MRH_Uint64 u64_Total = 0;
+    MRH_Uint64 u64_Fast = 0;
+    
+    {
+        CallbackLane c_Lane(u32_ThreadCount);
+        
+        for (MRH_Uint32 i = 0; i < 100; ++i)
+        {
+            c_Lane.Submit(0, []() {});
+        }
+        
+        // Earlier tasks were counted before the lane takes the next one
+        c_Lane.Submit(0, [&c_Lane, &p_Bucket]()
+        {
+            c_Lane.GetLatency(CallbackLane::IO, p_Bucket);
+        });
+    }
+    
+    for (size_t i = 0; i < CallbackLane::us_BucketCount; ++i)
+    {
+        u64_Total += p_Bucket[i];
+    }
+    
+    MRH_TEST_CHECK(u64_Total == 100);
+    
+    // Inline callbacks are added by the caller
+    CallbackLane c_Lane(1);
+    
+    c_Lane.AddLatency(CallbackLane::FAST, CallbackLane::GetTimeNS());
+    c_Lane.GetLatency(CallbackLane::FAST, p_Bucket);
+    
+    for (size_t i = 0; i < CallbackLane::us_BucketCount; ++i)
+    {
+        u64_Fast += p_Bucket[i];
+    }
+    
+    MRH_TEST_CHECK(u64_Fast == 1);
+    
+    return true;
+}
+
+static bool TestParallel()
+{
+    // A slow group does not hold up other groups
+    CallbackLane c_Lane(u32_ThreadCount);
+    std::promise<void> c_Release;
+    std::shared_future<void> c_Released = c_Release.get_future().share();
+    std::promise<void> c_Other;
+    std::future<void> c_OtherDone = c_Other.get_future();
+    std::atomic<MRH_Uint32> u32_Next(0);
+    
+    c_Lane.Submit(1, [c_Released]()
+    {
+        c_Released.wait();
+    });
+    c_Lane.Submit(1, [&u32_Next]()
+    {
+        ++u32_Next;
+    });
+    c_Lane.Submit(2, [&c_Other]()
+    {
+        c_Other.set_value();
+    });
+    
+    bool b_Other = (c_OtherDone.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    bool b_Waited = (u32_Next == 0);
+    
+    // Release first, the lane is joined on return
+    c_Release.set_value();
+    
+    MRH_TEST_CHECK(b_Other == true);
+    MRH_TEST_CHECK(b_Waited == true);
+    
+    return true;
+}
+
+static bool TestBarrier()
+{
+    // A reset follows all earlier requests and precedes all later ones
+    std::atomic<MRH_Uint32> u32_Before(0);
+    std::atomic<MRH_Uint32> u32_After(0);
+    std::atomic<MRH_Uint32> u32_Early(0);
+    std::atomic<bool> b_Barrier(false);
+    bool b_Ordered = false;
+    
+    {
+        CallbackLane c_Lane(u32_ThreadCount);
+        
+        for (MRH_Uint32 i = 0; i < 100; ++i)
+        {
+            c_Lane.Submit(i % u32_ThreadCount, [&u32_Before]()
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                ++u32_Before;
+            });
+        }
+        
+        c_Lane.SubmitBarrier([&]()
+        {
+            b_Ordered = (u32_Before == 100 && u32_After == 0);
+            b_Barrier = true;
+        });
+        
+        for (MRH_Uint32 i = 0; i < 100; ++i)
+        {
+            c_Lane.Submit(i % u32_ThreadCount, [&]()
+            {
+                if (b_Barrier == false)
+                {
+                    ++u32_Early;
+                }
+                
+                ++u32_After;
+            });
+        }
+    }
+    
+    MRH_TEST_CHECK(b_Ordered == true);
+    MRH_TEST_CHECK(u32_After == 100);
+    MRH_TEST_CHECK(u32_Early == 0);
+    
+    return true;
+}
+
+static bool TestDispatch()
+{
+    // Measured from the event being recieved, not from the callback start
+    MRH_Uint64 u64_IdleUS;
+    MRH_Uint64 u64_InlineUS;
+    MRH_Uint64 u64_LaneUS;
+    
+    {
+        CallbackLane c_Lane(MRH_USER_CALLBACK_IO_THREAD_COUNT);
+        
+        u64_IdleUS = RunDispatch(&c_Lane, false);
+        u64_LaneUS = RunDispatch(&c_Lane, true);
+    }
+    
+    u64_InlineUS = RunDispatch(NULL, true);
+    
+    std::printf("p99 memory event latency: %llu us without filesystem events, "
+                "%llu us with filesystem events inline, %llu us with filesystem events on the IO lane.\n",
+                static_cast<unsigned long long>(u64_IdleUS),
+                static_cast<unsigned long long>(u64_InlineUS),
+                static_cast<unsigned long long>(u64_LaneUS));
+    
+    // Inline filesystem events delay every event recieved meanwhile
+    MRH_TEST_CHECK(u64_InlineUS >= u32_IOMS * 1000 / 2);
+    MRH_TEST_CHECK(u64_LaneUS * 4 < u64_InlineUS);
+    MRH_TEST_CHECK(u64_LaneUS < u64_IdleUS + u32_IOMS * 1000 / 4);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Order", TestOrder },
+        { "OrderPerSubmitter", TestOrderPerSubmitter },
+        { "Exception", TestException },
+        { "SubmitWhileBusy", TestSubmitWhileBusy },
+        { "Parallel", TestParallel },
+        { "Barrier", TestBarrier },
+        { "Latency", TestLatency },
+        { "Dispatch", TestDispatch }
+    };
+    
+    return Test::Run(p_Case);
+}
@@ -0,0 +1,243 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// External
+
+// Project
+#include "../../src/Callback/ResponseEvent.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_ResponseCount = 100000;
+    constexpr MRH_Uint32 u32_GroupID = 42;
+    
+    // Allocations made by the service itself
+    MRH_Uint64 u64_New = 0;
+    
+    // Events created, destroyed and added by the event libraries
+    MRH_Uint64 u64_Created = 0;
+    MRH_Uint64 u64_Destroyed = 0;
+    MRH_Uint64 u64_Added = 0;
+    
+    MRH_Uint32 u32_AddedType = 0;
+    MRH_Uint32 u32_AddedGroupID = 0;
+    
+    bool b_AddFails = false;
+    
+    MRH_Event* CreateEvent(MRH_Uint32 u32_Type, const void* p_Data, MRH_Uint32 u32_DataSize) noexcept
+    {
+        MRH_Event* p_Event = static_cast<MRH_Event*>(std::malloc(sizeof(MRH_Event)));
+        
+        if (p_Event == NULL)
+        {
+            return NULL;
+        }
+        
+        p_Event->u32_Type = u32_Type;
+        p_Event->u32_GroupID = 0;
+        p_Event->u32_DataSize = u32_DataSize;
+        p_Event->p_Data = static_cast<MRH_Uint8*>(std::malloc(u32_DataSize));
+        std::memcpy(p_Event->p_Data, p_Data, u32_DataSize);
+        
+        ++u64_Created;
+        return p_Event;
+    }
+}
+
+//*************************************************************************************
+// Allocation Count
+//*************************************************************************************
+
+void* operator new(std::size_t us_Size)
+{
+    ++u64_New;
+    
+    if (void* p_Memory = std::malloc(us_Size))
+    {
+        return p_Memory;
+    }
+    
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p_Memory) noexcept
+{
+    std::free(p_Memory);
+}
+
+void operator delete(void* p_Memory, std::size_t us_Size) noexcept
+{
+    std::free(p_Memory);
+}
+
+//*************************************************************************************
+// Event Libraries
+//*************************************************************************************
+
+// The event libraries are replaced to see what happens to every created event,
+// the creation calls allocate like the library ones do
+MRH_Event* MRH_EVD_CreateSetEvent(MRH_Uint32 u32_Type, const void* p_Data)
+{
+    switch (u32_Type)
+    {
+        case MRH_EVENT_USER_AVAIL_S:
+            return CreateEvent(u32_Type, p_Data, sizeof(MRH_EvD_U_ServiceAvail_S));
+        case MRH_EVENT_USER_GET_LOCATION_S:
+            return CreateEvent(u32_Type, p_Data, sizeof(MRH_EvD_U_GetLocation_S));
+        case MRH_EVENT_USER_ACCESS_CLEAR_S:
+            return CreateEvent(u32_Type, p_Data, sizeof(MRH_EvD_U_AccessClear_S));
+        case MRH_EVENT_NOT_IMPLEMENTED_S:
+            return CreateEvent(u32_Type, p_Data, sizeof(MRH_EvD_Sys_NotImplemented_S));
+        
+        default:
+            return NULL;
+    }
+}
+
+MRH_Event* MRH_EVD_CreateEvent(MRH_Uint32 u32_Type, const void* p_Data, MRH_Uint32 u32_DataSize)
+{
+    return CreateEvent(u32_Type, p_Data, u32_DataSize);
+}
+
+MRH_Event* MRH_EVD_DestroyEvent(MRH_Event* p_Event)
+{
+    if (p_Event != NULL)
+    {
+        std::free(p_Event->p_Data);
+        std::free(p_Event);
+        
+        ++u64_Destroyed;
+    }
+    
+    return NULL;
+}
+
+MRH_EventStorage& MRH_EventStorage::Singleton()
+{
+    static MRH_EventStorage c_Storage;
+    return c_Storage;
+}
+
+void MRH_EventStorage::Add(MRH_Event* p_Event)
+{
+    if (b_AddFails == true)
+    {
+        throw MRH_PSBException();
+    }
+    
+    u32_AddedType = p_Event->u32_Type;
+    u32_AddedGroupID = p_Event->u32_GroupID;
+    ++u64_Added;
+    
+    // Owned by the storage now, destroyed once sent
+    MRH_EVD_DestroyEvent(p_Event);
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestSend()
+{
+    MRH_EvD_U_AccessClear_S c_Clear;
+    c_Clear.u8_Result = MRH_EVD_BASE_RESULT_SUCCESS;
+    
+    MRH_EvD_U_GetLocation_S c_Location;
+    std::memset(&c_Location, 0, sizeof(c_Location));
+    
+    MRH_Uint8 p_Custom[64] = { 0 };
+    
+    // Predefined and raw event data
+    ResponseEvent::Send(MRH_EVENT_USER_ACCESS_CLEAR_S, c_Clear, u32_GroupID);
+    
+    MRH_TEST_CHECK(u64_Added == 1);
+    MRH_TEST_CHECK(u32_AddedType == MRH_EVENT_USER_ACCESS_CLEAR_S);
+    MRH_TEST_CHECK(u32_AddedGroupID == u32_GroupID);
+    
+    ResponseEvent::Send(MRH_EVENT_USER_CUSTOM_COMMAND_S, p_Custom, sizeof(p_Custom), u32_GroupID + 1);
+    
+    MRH_TEST_CHECK(u64_Added == 2);
+    MRH_TEST_CHECK(u32_AddedType == MRH_EVENT_USER_CUSTOM_COMMAND_S);
+    MRH_TEST_CHECK(u32_AddedGroupID == u32_GroupID + 1);
+    
+    // Events the storage refused are destroyed, failed creations are skipped
+    b_AddFails = true;
+    ResponseEvent::Send(MRH_EVENT_USER_GET_LOCATION_S, c_Location, u32_GroupID);
+    b_AddFails = false;
+    
+    ResponseEvent::Send(MRH_EVENT_UNK, c_Clear, u32_GroupID);
+    
+    MRH_TEST_CHECK(u64_Added == 2);
+    MRH_TEST_CHECK(u64_Created == 3);
+    MRH_TEST_CHECK(u64_Destroyed == u64_Created);
+    
+    return true;
+}
+
+static bool TestAllocations()
+{
+    MRH_EvD_U_ServiceAvail_S c_Avail;
+    std::memset(&c_Avail, 0, sizeof(c_Avail));
+    
+    MRH_EvD_U_GetLocation_S c_Location;
+    std::memset(&c_Location, 0, sizeof(c_Location));
+    
+    MRH_Uint8 p_Custom[64] = { 0 };
+    
+    MRH_Uint64 u64_StartNew = u64_New;
+    MRH_Uint64 u64_StartCreated = u64_Created;
+    
+    for (MRH_Uint32 i = 0; i < u32_ResponseCount; ++i)
+    {
+        ResponseEvent::Send(MRH_EVENT_USER_AVAIL_S, c_Avail, u32_GroupID);
+        ResponseEvent::Send(MRH_EVENT_USER_GET_LOCATION_S, c_Location, u32_GroupID);
+        ResponseEvent::Send(MRH_EVENT_USER_CUSTOM_COMMAND_S, p_Custom, sizeof(p_Custom), u32_GroupID);
+    }
+    
+    std::printf("Service allocations: %llu, event creations: %llu for %u responses.\n",
+                static_cast<unsigned long long>(u64_New - u64_StartNew),
+                static_cast<unsigned long long>(u64_Created - u64_StartCreated),
+                3 * u32_ResponseCount);
+    
+    // The only allocation left is the event the storage takes ownership of
+    MRH_TEST_CHECK(u64_New == u64_StartNew);
+    MRH_TEST_CHECK(u64_Created - u64_StartCreated == 3 * u32_ResponseCount);
+    MRH_TEST_CHECK(u64_Destroyed == u64_Created);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Send", TestSend },
+        { "Allocations", TestAllocations }
+    };
+    
+    return Test::Run(p_Case);
+}
@@ -0,0 +1,109 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+#include "../src/Configuration.h"
+#include "../src/Exception.h"
+#include "./Test.h"
+
+namespace
+{
+    // Configuration with a single added content type
+    bool WriteConfiguration(MRH_Uint32 u32_RequestEvent) noexcept
+    {
+        FILE* p_File = fopen(MRH_USER_CONFIGURATION_PATH, "w");
+        
+        if (p_File == NULL)
+        {
+            return false;
+        }
+        
+        std::fprintf(p_File, "<MRHBF_1>\n\n"
+                             "<UserContentType>{\n"
+                             "    <Path><Added>\n"
+                             "    <File><0>\n"
+                             "    <RequestEvent><%u>\n"
+                             "    <ResponseEvent><0>\n"
+                             "}\n",
+                     u32_RequestEvent);
+        
+        return fclose(p_File) == 0;
+    }
+    
+    bool GetAccepted(MRH_Uint32 u32_RequestEvent)
+    {
+        if (WriteConfiguration(u32_RequestEvent) == false)
+        {
+            throw Exception("Failed to write configuration!");
+        }
+        
+        try
+        {
+            Configuration c_Configuration;
+            
+            return c_Configuration.GetContentTypes().back().u32_RequestEvent == u32_RequestEvent;
+        }
+        catch (Exception& e)
+        {
+            return false;
+        }
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestRequestEvent()
+{
+    // Custom command only and unused events are fine
+    MRH_TEST_CHECK(GetAccepted(MRH_EVENT_UNK) == true);
+    MRH_TEST_CHECK(GetAccepted(0xFFFF0000) == true);
+    
+    // Events of other callbacks are refused
+    MRH_TEST_CHECK(GetAccepted(MRH_EVENT_USER_AVAIL_U) == false);
+    MRH_TEST_CHECK(GetAccepted(MRH_EVENT_PS_RESET_REQUEST_U) == false);
+    MRH_TEST_CHECK(GetAccepted(MRH_EVENT_USER_CUSTOM_COMMAND_U) == false);
+    MRH_TEST_CHECK(GetAccepted(MRH_EVENT_USER_ACCESS_CLEAR_U) == false);
+    MRH_TEST_CHECK(GetAccepted(MRH_EVENT_USER_GET_LOCATION_U) == false);
+    
+    unlink(MRH_USER_CONFIGURATION_PATH);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "RequestEvent", TestRequestEvent }
+    };
+    
+    return Test::Run(p_Case);
+}
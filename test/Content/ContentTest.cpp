@@ -0,0 +1,675 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <climits>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+
+// External
+
+// Project
+#include "../../src/Content/Content.h"
+#include "../Test.h"
+
+// Pre-defined
+#ifndef MRH_USER_TEST_DIR_PATH
+    #define MRH_USER_TEST_DIR_PATH "./ContentTestData/"
+#endif
+
+namespace
+{
+    constexpr MRH_Uint32 u32_RequesterCount = 8;
+    constexpr MRH_Uint32 u32_RequestCount = 500;
+    constexpr MRH_Uint32 u32_ResetCount = 200;
+    constexpr MRH_Uint32 u32_PackageCount = 8;
+    
+    const std::string s_SourceDirPath = MRH_USER_TEST_DIR_PATH "Source/";
+    const std::string s_PackagePath = MRH_USER_TEST_DIR_PATH "Package/";
+    const std::string s_UserDirLinkPath = s_PackagePath + "FSRoot/_User";
+    
+    // Default paths of the built-in types
+    const char* p_TypePath[Content::TYPE_COUNT] =
+    {
+        "Documents",
+        "Pictures",
+        "Music",
+        "Videos",
+        "Downloads",
+        "Clipboard.txt",
+        "UserPerson.conf",
+        "UserResidence.conf"
+    };
+    
+    // Counts completions, answered on any thread
+    class Result
+    {
+    public:
+        
+        Result(MRH_Uint32 u32_Expected) noexcept : u32_Expected(u32_Expected),
+                                                   u32_Finished(0),
+                                                   u32_Failed(0)
+        {}
+        
+        void Add(bool b_Result) noexcept
+        {
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            
+            ++u32_Finished;
+            
+            if (b_Result == false)
+            {
+                ++u32_Failed;
+            }
+            
+            c_Condition.notify_all();
+        }
+        
+        bool Wait() noexcept
+        {
+            std::unique_lock<std::mutex> c_Guard(c_Mutex);
+            
+            return c_Condition.wait_for(c_Guard, std::chrono::seconds(30), [this]()
+            {
+                return u32_Finished >= u32_Expected;
+            });
+        }
+        
+        MRH_Uint32 GetFinished() noexcept
+        {
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            return u32_Finished;
+        }
+        
+        MRH_Uint32 GetFailed() noexcept
+        {
+            std::lock_guard<std::mutex> c_Guard(c_Mutex);
+            return u32_Failed;
+        }
+        
+    private:
+        
+        std::mutex c_Mutex;
+        std::condition_variable c_Condition;
+        MRH_Uint32 u32_Expected;
+        MRH_Uint32 u32_Finished;
+        MRH_Uint32 u32_Failed;
+    };
+    
+    std::string GetLinkTarget(std::string const& s_LinkPath)
+    {
+        char p_Target[PATH_MAX];
+        ssize_t ss_Size = readlink(s_LinkPath.c_str(), p_Target, PATH_MAX - 1);
+        
+        if (ss_Size < 0)
+        {
+            return "";
+        }
+        
+        return std::string(p_Target, ss_Size);
+    }
+    
+    // Package links point to one of the session link dirs
+    bool GetSessionLink(std::string const& s_LinkPath)
+    {
+        std::string s_Prefix(s_SourceDirPath + "_User/Package");
+        
+        return GetLinkTarget(s_LinkPath).compare(0, s_Prefix.size(), s_Prefix) == 0;
+    }
+    
+    int RemoveEntry(const char* p_Path, const struct stat* p_Status, int i_Flag, struct FTW* p_FTW)
+    {
+        remove(p_Path);
+        return 0;
+    }
+    
+    // Start every run with a fresh source and package
+    void ResetDir()
+    {
+        nftw(MRH_USER_TEST_DIR_PATH, RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+        
+        mkdir(MRH_USER_TEST_DIR_PATH, 0755);
+        mkdir(s_PackagePath.c_str(), 0755);
+        mkdir((s_PackagePath + "FSRoot").c_str(), 0755);
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestAllowClear()
+{
+    ResetDir();
+    
+    Configuration c_Configuration;
+    Content c_Content(c_Configuration);
+    
+    c_Content.Reset(s_PackagePath);
+    
+    // The package link points to a session link dir
+    MRH_TEST_CHECK(GetSessionLink(s_UserDirLinkPath) == true);
+    
+    for (MRH_Uint32 i = 0; i < Content::TYPE_COUNT; ++i)
+    {
+        Result c_Result(1);
+        
+        c_Content.AllowAccess(i, [&c_Result](bool b_Result)
+        {
+            c_Result.Add(b_Result);
+        });
+        
+        MRH_TEST_CHECK(c_Result.Wait() == true);
+        MRH_TEST_CHECK(c_Result.GetFailed() == 0);
+        MRH_TEST_CHECK(GetLinkTarget(s_UserDirLinkPath + "/" + p_TypePath[i]) == s_SourceDirPath + p_TypePath[i]);
+    }
+    
+    Result c_Clear(1);
+    
+    c_Content.ClearAccess([&c_Clear](bool b_Result)
+    {
+        c_Clear.Add(b_Result);
+    });
+    
+    MRH_TEST_CHECK(c_Clear.Wait() == true);
+    MRH_TEST_CHECK(c_Clear.GetFailed() == 0);
+    
+    for (MRH_Uint32 i = 0; i < Content::TYPE_COUNT; ++i)
+    {
+        MRH_TEST_CHECK(access((s_UserDirLinkPath + "/" + p_TypePath[i]).c_str(), F_OK) != 0);
+    }
+    
+    // Grant and clear latency through the directory fds
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (MRH_Uint32 i = 0; i < u32_RequestCount; ++i)
+    {
+        Result c_Allow(1);
+        Result c_Cycle(1);
+        
+        c_Content.AllowAccess(Content::DOCUMENTS, [&c_Allow](bool b_Result)
+        {
+            c_Allow.Add(b_Result);
+        });
+        
+        MRH_TEST_CHECK(c_Allow.Wait() == true);
+        
+        c_Content.ClearAccess([&c_Cycle](bool b_Result)
+        {
+            c_Cycle.Add(b_Result);
+        });
+        
+        MRH_TEST_CHECK(c_Cycle.Wait() == true);
+        MRH_TEST_CHECK(c_Allow.GetFailed() + c_Cycle.GetFailed() == 0);
+    }
+    
+    auto c_Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    std::printf("Average grant and clear: %llu us.\n",
+                static_cast<unsigned long long>(c_Duration.count() / u32_RequestCount));
+    
+    return true;
+}
+
+static bool TestAllowCoalesce()
+{
+    ResetDir();
+    
+    Configuration c_Configuration;
+    Content c_Content(c_Configuration);
+    std::string s_LinkPath(s_UserDirLinkPath + "/Documents");
+    
+    c_Content.Reset(s_PackagePath);
+    
+    // Again after clearing, the link has to be created a second time
+    for (int i = 0; i < 2; ++i)
+    {
+        MRH_Uint32 u32_Total = u32_RequesterCount * u32_RequestCount;
+        MRH_Uint64 u64_Skipped = c_Content.GetSkippedOperations();
+        Result c_Result(u32_Total);
+        std::vector<std::thread> v_Requester;
+        
+        for (MRH_Uint32 j = 0; j < u32_RequesterCount; ++j)
+        {
+            v_Requester.emplace_back([&c_Content, &c_Result]()
+            {
+                for (MRH_Uint32 k = 0; k < u32_RequestCount; ++k)
+                {
+                    c_Content.AllowAccess(Content::DOCUMENTS, [&c_Result](bool b_Result)
+                    {
+                        c_Result.Add(b_Result);
+                    });
+                }
+            });
+        }
+        
+        for (auto& Requester : v_Requester)
+        {
+            Requester.join();
+        }
+        
+        MRH_TEST_CHECK(c_Result.Wait() == true);
+        
+        // Every request is answered, only one of them links
+        MRH_Uint64 u64_Performed = u32_Total - (c_Content.GetSkippedOperations() - u64_Skipped);
+        
+        std::printf("Answered %u requests with %llu link operations.\n",
+                    c_Result.GetFinished(),
+                    static_cast<unsigned long long>(u64_Performed));
+        
+        MRH_TEST_CHECK(c_Result.GetFinished() == u32_Total);
+        MRH_TEST_CHECK(c_Result.GetFailed() == 0);
+        MRH_TEST_CHECK(u64_Performed == 1);
+        MRH_TEST_CHECK(GetLinkTarget(s_LinkPath) == s_SourceDirPath + "Documents");
+        
+        Result c_Clear(1);
+        
+        c_Content.ClearAccess([&c_Clear](bool b_Result)
+        {
+            c_Clear.Add(b_Result);
+        });
+        
+        MRH_TEST_CHECK(c_Clear.Wait() == true);
+        MRH_TEST_CHECK(c_Clear.GetFailed() == 0);
+        MRH_TEST_CHECK(access(s_LinkPath.c_str(), F_OK) != 0);
+    }
+    
+    return true;
+}
+
+static bool TestAllowTypes()
+{
+    ResetDir();
+    
+    Configuration c_Configuration;
+    Content c_Content(c_Configuration);
+    MRH_Uint32 u32_Total = u32_RequesterCount * u32_RequestCount;
+    
+    c_Content.Reset(s_PackagePath);
+    
+    // Requesters start on different types, all types are granted at once
+    MRH_Uint64 u64_Skipped = c_Content.GetSkippedOperations();
+    Result c_Result(u32_Total);
+    std::vector<std::thread> v_Requester;
+    
+    for (MRH_Uint32 i = 0; i < u32_RequesterCount; ++i)
+    {
+        v_Requester.emplace_back([&c_Content, &c_Result, i]()
+        {
+            for (MRH_Uint32 j = 0; j < u32_RequestCount; ++j)
+            {
+                c_Content.AllowAccess((i + j) % Content::TYPE_COUNT, [&c_Result](bool b_Result)
+                {
+                    c_Result.Add(b_Result);
+                });
+            }
+        });
+    }
+    
+    for (auto& Requester : v_Requester)
+    {
+        Requester.join();
+    }
+    
+    MRH_TEST_CHECK(c_Result.Wait() == true);
+    MRH_TEST_CHECK(c_Result.GetFailed() == 0);
+    MRH_TEST_CHECK(u32_Total - (c_Content.GetSkippedOperations() - u64_Skipped) == Content::TYPE_COUNT);
+    
+    for (MRH_Uint32 i = 0; i < Content::TYPE_COUNT; ++i)
+    {
+        MRH_TEST_CHECK(GetLinkTarget(s_UserDirLinkPath + "/" + p_TypePath[i]) == s_SourceDirPath + p_TypePath[i]);
+    }
+    
+    // Linked types are answered inline, only the lookup remains
+    std::atomic<MRH_Uint32> u32_Failed(0);
+    
+    v_Requester.clear();
+    
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (MRH_Uint32 i = 0; i < u32_RequesterCount; ++i)
+    {
+        v_Requester.emplace_back([&c_Content, &u32_Failed, i]()
+        {
+            for (MRH_Uint32 j = 0; j < u32_RequestCount * 100; ++j)
+            {
+                c_Content.AllowAccess((i + j) % Content::TYPE_COUNT, [&u32_Failed](bool b_Result)
+                {
+                    if (b_Result == false)
+                    {
+                        ++u32_Failed;
+                    }
+                });
+            }
+        });
+    }
+    
+    for (auto& Requester : v_Requester)
+    {
+        Requester.join();
+    }
+    
+    auto c_Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    std::printf("Average linked request: %llu ns.\n",
+                static_cast<unsigned long long>(c_Duration.count() / (u32_Total * 100)));
+    
+    MRH_TEST_CHECK(u32_Failed == 0);
+    
+    // All types in one batch after clearing
+    Result c_Clear(1);
+    std::promise<MRH_Uint32> c_Mask;
+    std::future<MRH_Uint32> c_Failed = c_Mask.get_future();
+    
+    c_Content.ClearAccess([&c_Clear](bool b_Result)
+    {
+        c_Clear.Add(b_Result);
+    });
+    
+    MRH_TEST_CHECK(c_Clear.Wait() == true);
+    
+    c_Content.AllowAccessMask(c_Content.GetTypeMask(), [&c_Mask](MRH_Uint32 u32_FailedMask)
+    {
+        c_Mask.set_value(u32_FailedMask);
+    });
+    
+    MRH_TEST_CHECK(c_Failed.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+    MRH_TEST_CHECK(c_Failed.get() == 0);
+    
+    for (MRH_Uint32 i = 0; i < Content::TYPE_COUNT; ++i)
+    {
+        MRH_TEST_CHECK(GetLinkTarget(s_UserDirLinkPath + "/" + p_TypePath[i]) == s_SourceDirPath + p_TypePath[i]);
+    }
+    
+    return true;
+}
+
+static bool TestAllowMask()
+{
+    ResetDir();
+    
+    Configuration c_Configuration;
+    Content c_Content(c_Configuration);
+    MRH_Uint32 u32_Nested = Content::TypeMask(Content::TYPE_COUNT);
+    MRH_Uint32 u32_Mask = Content::TypeMask(Content::DOCUMENTS) | Content::TypeMask(Content::PICTURES);
+    std::string s_LinkPath(s_UserDirLinkPath + "/Documents");
+    
+    c_Content.Reset(s_PackagePath);
+    
+    MRH_TEST_CHECK((c_Content.GetTypeMask() & u32_Nested) != 0);
+    
+    // Single and mask requests for the same types share one operation per type
+    MRH_Uint32 u32_Total = u32_RequesterCount * u32_RequestCount;
+    MRH_Uint64 u64_Skipped = c_Content.GetSkippedOperations();
+    Result c_Result(u32_Total);
+    std::vector<std::thread> v_Requester;
+    
+    for (MRH_Uint32 i = 0; i < u32_RequesterCount; ++i)
+    {
+        v_Requester.emplace_back([&c_Content, &c_Result, u32_Mask, i]()
+        {
+            for (MRH_Uint32 j = 0; j < u32_RequestCount; ++j)
+            {
+                if ((i + j) % 2 == 0)
+                {
+                    c_Content.AllowAccess(Content::DOCUMENTS, [&c_Result](bool b_Result)
+                    {
+                        c_Result.Add(b_Result);
+                    });
+                }
+                else
+                {
+                    c_Content.AllowAccessMask(u32_Mask, [&c_Result](MRH_Uint32 u32_Failed)
+                    {
+                        c_Result.Add(u32_Failed == 0);
+                    });
+                }
+            }
+        });
+    }
+    
+    for (auto& Requester : v_Requester)
+    {
+        Requester.join();
+    }
+    
+    MRH_TEST_CHECK(c_Result.Wait() == true);
+    MRH_TEST_CHECK(c_Result.GetFailed() == 0);
+    
+    // Half the requests are masks with two types each
+    MRH_Uint64 u64_Performed = (u32_Total + u32_Total / 2) - (c_Content.GetSkippedOperations() - u64_Skipped);
+    
+    std::printf("Answered %u single and mask requests with %llu link operations.\n",
+                c_Result.GetFinished(),
+                static_cast<unsigned long long>(u64_Performed));
+    
+    MRH_TEST_CHECK(u64_Performed == 2);
+    MRH_TEST_CHECK(GetLinkTarget(s_LinkPath) == s_SourceDirPath + "Documents");
+    MRH_TEST_CHECK(GetLinkTarget(s_UserDirLinkPath + "/Pictures") == s_SourceDirPath + "Pictures");
+    
+    Result c_Clear(1);
+    
+    c_Content.ClearAccess([&c_Clear](bool b_Result)
+    {
+        c_Clear.Add(b_Result);
+    });
+    
+    MRH_TEST_CHECK(c_Clear.Wait() == true);
+    MRH_TEST_CHECK(c_Clear.GetFailed() == 0);
+    
+    // Nested links fail without their parent directory
+    std::string s_NestedDirPath(GetLinkTarget(s_UserDirLinkPath) + "/Nested");
+    
+    MRH_TEST_CHECK(rmdir(s_NestedDirPath.c_str()) == 0);
+    
+    for (MRH_Uint32 i = 0; i < u32_RequestCount; ++i)
+    {
+        std::promise<MRH_Uint32> c_Mask;
+        std::future<MRH_Uint32> c_Failed = c_Mask.get_future();
+        Result c_Single(1);
+        struct stat c_Status;
+        
+        c_Content.AllowAccessMask(u32_Mask | u32_Nested, [&c_Mask](MRH_Uint32 u32_Failed)
+        {
+            c_Mask.set_value(u32_Failed);
+        });
+        
+        // A single grant during the mask keeps its link, never rolled back
+        if (i % 2 == 0)
+        {
+            c_Content.AllowAccess(Content::DOCUMENTS, [&c_Single](bool b_Result)
+            {
+                c_Single.Add(b_Result);
+            });
+        }
+        else
+        {
+            c_Single.Add(true);
+        }
+        
+        MRH_TEST_CHECK(c_Failed.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+        MRH_TEST_CHECK(c_Single.Wait() == true);
+        
+        MRH_TEST_CHECK(c_Failed.get() == u32_Nested);
+        MRH_TEST_CHECK(c_Single.GetFailed() == 0);
+        MRH_TEST_CHECK(lstat((s_UserDirLinkPath + "/Pictures").c_str(), &c_Status) < 0);
+        
+        // Relinked if the single grant arrived during the removal
+        if (i % 2 == 0)
+        {
+            MRH_TEST_CHECK(GetLinkTarget(s_LinkPath) == s_SourceDirPath + "Documents");
+        }
+        else
+        {
+            MRH_TEST_CHECK(lstat(s_LinkPath.c_str(), &c_Status) < 0);
+        }
+        
+        Result c_Reset(1);
+        
+        c_Content.ClearAccess([&c_Reset](bool b_Result)
+        {
+            c_Reset.Add(b_Result);
+        });
+        
+        MRH_TEST_CHECK(c_Reset.Wait() == true);
+        MRH_TEST_CHECK(lstat(s_LinkPath.c_str(), &c_Status) < 0);
+    }
+    
+    // Everything is linked once the parent exists again
+    std::promise<MRH_Uint32> c_Mask;
+    std::future<MRH_Uint32> c_Failed = c_Mask.get_future();
+    
+    MRH_TEST_CHECK(mkdir(s_NestedDirPath.c_str(), 0755) == 0);
+    
+    c_Content.AllowAccessMask(u32_Mask | u32_Nested, [&c_Mask](MRH_Uint32 u32_Failed)
+    {
+        c_Mask.set_value(u32_Failed);
+    });
+    
+    MRH_TEST_CHECK(c_Failed.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+    MRH_TEST_CHECK(c_Failed.get() == 0);
+    MRH_TEST_CHECK(GetLinkTarget(s_UserDirLinkPath + "/Nested/Data") == s_SourceDirPath + "Nested/Data");
+    
+    return true;
+}
+
+static bool TestResetSwap()
+{
+    ResetDir();
+    
+    Configuration c_Configuration;
+    struct stat c_Status;
+    std::atomic<bool> b_Run(true);
+    std::atomic<MRH_Uint64> u64_Missing(0);
+    std::atomic<MRH_Uint64> u64_Checks(0);
+    
+    // Left behind by a crashed run
+    MRH_TEST_CHECK(symlink("/nonexistent", s_UserDirLinkPath.c_str()) == 0);
+    MRH_TEST_CHECK(symlink("/nonexistent", (s_PackagePath + "FSRoot/._User.new").c_str()) == 0);
+    
+    // The link is swapped, never removed and created again
+    std::thread c_Reader([&]()
+    {
+        struct stat c_Status;
+        
+        while (b_Run.load(std::memory_order_relaxed) == true)
+        {
+            if (lstat(s_UserDirLinkPath.c_str(), &c_Status) < 0 || S_ISLNK(c_Status.st_mode) == false)
+            {
+                ++u64_Missing;
+            }
+            
+            ++u64_Checks;
+        }
+    });
+    
+    // Every new service finds the link of the previous one
+    for (MRH_Uint32 i = 0; i < u32_ResetCount; ++i)
+    {
+        Content c_Content(c_Configuration);
+        
+        c_Content.Reset(s_PackagePath);
+    }
+    
+    b_Run = false;
+    c_Reader.join();
+    
+    std::printf("Checked the package link %llu times during %u resets.\n",
+                static_cast<unsigned long long>(u64_Checks.load()),
+                u32_ResetCount);
+    
+    MRH_TEST_CHECK(u64_Missing == 0);
+    MRH_TEST_CHECK(GetSessionLink(s_UserDirLinkPath) == true);
+    MRH_TEST_CHECK(lstat((s_PackagePath + "FSRoot/._User.new").c_str(), &c_Status) < 0);
+    
+    // More packages than sessions, back to back
+    Content c_Content(c_Configuration);
+    
+    for (MRH_Uint32 i = 0; i < u32_PackageCount; ++i)
+    {
+        std::string s_Path(MRH_USER_TEST_DIR_PATH "Package" + std::to_string(i) + "/");
+        
+        mkdir(s_Path.c_str(), 0755);
+        mkdir((s_Path + "FSRoot").c_str(), 0755);
+    }
+    
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (MRH_Uint32 i = 0; i < u32_ResetCount; ++i)
+    {
+        std::string s_Path(MRH_USER_TEST_DIR_PATH "Package" + std::to_string(i % u32_PackageCount) + "/");
+        
+        c_Content.Reset(s_Path);
+        
+        MRH_TEST_CHECK(GetSessionLink(s_Path + "FSRoot/_User") == true);
+    }
+    
+    auto c_Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    std::printf("Average reset: %llu us.\n",
+                static_cast<unsigned long long>(c_Duration.count() / u32_ResetCount));
+    
+    // Anything but a link is kept
+    std::string s_BlockedPath(MRH_USER_TEST_DIR_PATH "Blocked/");
+    bool b_Thrown = false;
+    
+    mkdir(s_BlockedPath.c_str(), 0755);
+    mkdir((s_BlockedPath + "FSRoot").c_str(), 0755);
+    mkdir((s_BlockedPath + "FSRoot/_User").c_str(), 0755);
+    
+    try
+    {
+        c_Content.Reset(s_BlockedPath);
+    }
+    catch (Exception& e)
+    {
+        b_Thrown = true;
+    }
+    
+    MRH_TEST_CHECK(b_Thrown == true);
+    MRH_TEST_CHECK(c_Content.GetReset() == false);
+    MRH_TEST_CHECK(lstat((s_BlockedPath + "FSRoot/_User").c_str(), &c_Status) == 0 && S_ISDIR(c_Status.st_mode));
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "AllowClear", TestAllowClear },
+        { "AllowCoalesce", TestAllowCoalesce },
+        { "AllowTypes", TestAllowTypes },
+        { "AllowMask", TestAllowMask },
+        { "ResetSwap", TestResetSwap }
+    };
+    
+    return Test::Run(p_Case);
+}
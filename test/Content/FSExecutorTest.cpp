@@ -0,0 +1,238 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <string>
+
+// External
+
+// Project
+#include "../../src/Content/FSExecutor.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_BatchCount = 8;
+    constexpr MRH_Uint32 u32_BlockMS = 100;
+    constexpr MRH_Uint32 u32_ChainSize = 4096;
+    constexpr MRH_Uint32 u32_ChainDepth = 4;
+    
+#if MRH_USER_CONTENT_IO_URING == 0
+    // Threads of this process, workers included
+    MRH_Uint32 GetThreadCount() noexcept
+    {
+        DIR* p_Dir = opendir("/proc/self/task");
+        MRH_Uint32 u32_Count = 0;
+        struct dirent* p_Entry;
+        
+        while (p_Dir != NULL && (p_Entry = readdir(p_Dir)) != NULL)
+        {
+            if (p_Entry->d_name[0] != '.')
+            {
+                ++u32_Count;
+            }
+        }
+        
+        if (p_Dir != NULL)
+        {
+            closedir(p_Dir);
+        }
+        
+        return u32_Count;
+    }
+    
+    // Slow completions keep a worker busy, like a slow grant
+    // Empty batches would complete on the caller
+    MRH_Uint64 RunBlocked(FSExecutor& c_Executor, MRH_Uint32& u32_Peak)
+    {
+        std::mutex c_Mutex;
+        std::condition_variable c_Condition;
+        MRH_Uint32 u32_Finished = 0;
+        
+        auto c_Start = std::chrono::steady_clock::now();
+        
+        for (MRH_Uint32 i = 0; i < u32_BatchCount; ++i)
+        {
+            c_Executor.Submit({ FSExecutor::Unlink(AT_FDCWD, "/nonexistent/mrhpsuser") }, [&](FSExecutor::Batch& c_Batch)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(u32_BlockMS));
+                
+                std::lock_guard<std::mutex> c_Guard(c_Mutex);
+                
+                u32_Peak = std::max(u32_Peak, GetThreadCount());
+                ++u32_Finished;
+                c_Condition.notify_all();
+            });
+        }
+        
+        std::unique_lock<std::mutex> c_Lock(c_Mutex);
+        c_Condition.wait(c_Lock, [&]() { return u32_Finished == u32_BatchCount; });
+        
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - c_Start).count();
+    }
+#endif
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+#if MRH_USER_CONTENT_IO_URING == 0
+static bool TestExecute()
+{
+    char p_DirPath[] = "/tmp/mrhpsuser_executor_XXXXXX";
+    
+    MRH_TEST_CHECK(mkdtemp(p_DirPath) != NULL);
+    
+    FSExecutor c_Executor(1, 1);
+    int i_DirFD = open(p_DirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    
+    MRH_TEST_CHECK(c_Executor.GetRingUsed() == false);
+    MRH_TEST_CHECK(i_DirFD >= 0);
+    
+    FSExecutor::Batch c_Batch =
+    {
+        FSExecutor::MkDir(i_DirFD, "Source", 0700),
+        FSExecutor::SymLink("Source", i_DirFD, "Link"),
+        FSExecutor::SymLink("Source", i_DirFD, "Link"),
+        FSExecutor::Unlink(i_DirFD, "Missing")
+    };
+    
+    // Operations run in order, failures only set their result
+    c_Executor.Execute(c_Batch);
+    
+    MRH_TEST_CHECK(c_Batch.size() == 4);
+    MRH_TEST_CHECK(c_Batch[0].i_Result == 0);
+    MRH_TEST_CHECK(c_Batch[1].i_Result == 0);
+    MRH_TEST_CHECK(c_Batch[2].i_Result == EEXIST);
+    MRH_TEST_CHECK(c_Batch[3].i_Result == ENOENT);
+    
+    unlinkat(i_DirFD, "Link", 0);
+    unlinkat(i_DirFD, "Source", AT_REMOVEDIR);
+    close(i_DirFD);
+    rmdir(p_DirPath);
+    
+    return true;
+}
+
+static bool TestScale()
+{
+    MRH_Uint32 u32_Threads = GetThreadCount();
+    MRH_Uint32 u32_FixedPeak = 0;
+    MRH_Uint32 u32_ScaledPeak = 0;
+    MRH_Uint64 u64_FixedMS;
+    MRH_Uint64 u64_ScaledMS;
+    
+    // One worker answers every batch after the other
+    {
+        FSExecutor c_Executor(1, 1);
+        u64_FixedMS = RunBlocked(c_Executor, u32_FixedPeak);
+    }
+    
+    // Workers are added while all are busy and stop once idle
+    FSExecutor c_Executor(1, 4);
+    u64_ScaledMS = RunBlocked(c_Executor, u32_ScaledPeak);
+    
+    std::printf("Blocked batches took %llu ms with 1 worker and %llu ms with up to 4 workers.\n",
+                static_cast<unsigned long long>(u64_FixedMS),
+                static_cast<unsigned long long>(u64_ScaledMS));
+    
+    MRH_TEST_CHECK(u32_FixedPeak == u32_Threads + 1);
+    MRH_TEST_CHECK(u64_FixedMS >= u32_BatchCount * u32_BlockMS);
+    MRH_TEST_CHECK(u32_ScaledPeak == u32_Threads + 4);
+    MRH_TEST_CHECK(u64_ScaledMS < u32_BatchCount * u32_BlockMS / 2);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(MRH_USER_CONTENT_THREAD_IDLE_MS * 3));
+    
+    MRH_TEST_CHECK(GetThreadCount() == u32_Threads + 1);
+    
+    return true;
+}
+#endif
+
+static bool TestChain()
+{
+    FSExecutor c_Executor(1, 1);
+    std::promise<void> c_Promise;
+    std::future<void> c_Future = c_Promise.get_future();
+    FSExecutor::Batch c_Chain(u32_ChainSize, FSExecutor::Unlink(AT_FDCWD, "/nonexistent/mrhpsuser"));
+    FSExecutor::Completion c_Next;
+    MRH_Uint32 u32_Depth = 0;
+    MRH_Uint32 u32_Missing = 0;
+    
+    // Completions submit more than the ring holds, never waiting for themselves
+    c_Next = [&](FSExecutor::Batch& c_Batch)
+    {
+        for (auto& Operation : c_Batch)
+        {
+            if (Operation.i_Result == ENOENT)
+            {
+                ++u32_Missing;
+            }
+        }
+        
+        if (++u32_Depth < u32_ChainDepth)
+        {
+            c_Executor.Submit(c_Chain, c_Next);
+        }
+        else
+        {
+            c_Promise.set_value();
+        }
+    };
+    
+    c_Executor.Submit(c_Chain, c_Next);
+    
+    MRH_TEST_CHECK(c_Future.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+    
+    std::printf("Chained %u batches of %u operations using %s.\n",
+                u32_Depth,
+                u32_ChainSize,
+                (c_Executor.GetRingUsed() == true ? "io_uring" : "worker threads"));
+    
+    MRH_TEST_CHECK(u32_Missing == u32_ChainSize * u32_ChainDepth);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+#if MRH_USER_CONTENT_IO_URING == 0
+        { "Execute", TestExecute },
+        { "Scale", TestScale },
+#endif
+        { "Chain", TestChain }
+    };
+    
+    return Test::Run(p_Case);
+}
@@ -0,0 +1,251 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <vector>
+
+// External
+
+// Project
+#include "../../src/Location/LocationFilter.h"
+#include "../Test.h"
+
+namespace
+{
+    // 5 m fixes once per second, driving east at 10 m/s
+    constexpr MRH_Sfloat64 f64_Accuracy = 5.0;
+    constexpr MRH_Sfloat64 f64_Acceleration = 2.0;
+    constexpr MRH_Sfloat64 f64_MaxSpeed = 50.0;
+    constexpr MRH_Sfloat64 f64_Speed = 10.0;
+    
+    constexpr MRH_Uint64 u64_StartMS = 1700000000000;
+    constexpr MRH_Uint64 u64_StepMS = 1000;
+    
+    constexpr MRH_Sfloat64 f64_Latitude = 48.1;
+    constexpr MRH_Sfloat64 f64_Longtitude = 11.5;
+    
+    constexpr MRH_Sfloat64 f64_MetersPerLatitude = 6371000.0 * M_PI / 180.0;
+    
+    LocationSnapshot::Fix GetFix(MRH_Sfloat64 f64_North, MRH_Sfloat64 f64_East, MRH_Uint64 u64_TimeMS) noexcept
+    {
+        MRH_Sfloat64 f64_MetersPerLongtitude = f64_MetersPerLatitude * std::cos(f64_Latitude * M_PI / 180.0);
+        
+        return { true, f64_Latitude + (f64_North / f64_MetersPerLatitude), f64_Longtitude + (f64_East / f64_MetersPerLongtitude), 520.0, 0.0, 0.0, 0.0, u64_TimeMS };
+    }
+    
+    MRH_Sfloat64 GetDistance(LocationSnapshot::Fix const& c_A, LocationSnapshot::Fix const& c_B) noexcept
+    {
+        MRH_Sfloat64 f64_North = (c_A.f64_Latitude - c_B.f64_Latitude) * f64_MetersPerLatitude;
+        MRH_Sfloat64 f64_East = (c_A.f64_Longtitude - c_B.f64_Longtitude) * f64_MetersPerLatitude * std::cos(c_A.f64_Latitude * M_PI / 180.0);
+        
+        return std::hypot(f64_North, f64_East);
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestOutliers()
+{
+    std::mt19937 c_Random(42);
+    std::normal_distribution<MRH_Sfloat64> c_Noise(0.0, f64_Accuracy / std::sqrt(2.0));
+    LocationFilter c_Filter(f64_Accuracy, f64_Acceleration, f64_MaxSpeed);
+    MRH_Uint32 u32_Rejected = 0;
+    
+    for (MRH_Uint32 i = 0; i < 200; ++i)
+    {
+        MRH_Uint64 u64_TimeMS = u64_StartMS + (i * u64_StepMS);
+        LocationSnapshot::Fix c_Truth = GetFix(0.0, i * f64_Speed, u64_TimeMS);
+        
+        // Every 20th fix is 500 m off to the north
+        bool b_Outlier = (i > 10 && (i % 20) == 0);
+        LocationSnapshot::Fix c_Fix = GetFix(c_Noise(c_Random) + (b_Outlier == true ? 500.0 : 0.0),
+                                             (i * f64_Speed) + c_Noise(c_Random),
+                                             u64_TimeMS);
+        
+        if (c_Filter.Process(c_Fix) == false)
+        {
+            MRH_TEST_CHECK(b_Outlier == true);
+            ++u32_Rejected;
+            continue;
+        }
+        
+        MRH_TEST_CHECK(b_Outlier == false);
+        
+        // Settled estimates follow the track, speed and course included
+        if (i >= 10)
+        {
+            MRH_TEST_CHECK(GetDistance(c_Fix, c_Truth) < 2.0 * f64_Accuracy);
+            MRH_TEST_CHECK(std::fabs(c_Fix.f64_Speed - f64_Speed) < 3.0);
+            MRH_TEST_CHECK(std::fabs(c_Fix.f64_Course - 90.0) < 25.0);
+        }
+    }
+    
+    MRH_TEST_CHECK(u32_Rejected == 9);
+    
+    return true;
+}
+
+static bool TestReset()
+{
+    LocationFilter c_Filter(f64_Accuracy, f64_Acceleration, f64_MaxSpeed);
+    MRH_Uint64 u64_TimeMS = u64_StartMS;
+    
+    for (MRH_Uint32 i = 0; i < 10; ++i, u64_TimeMS += u64_StepMS)
+    {
+        LocationSnapshot::Fix c_Fix = GetFix(0.0, 0.0, u64_TimeMS);
+        MRH_TEST_CHECK(c_Filter.Process(c_Fix) == true);
+    }
+    
+    // The source moved 5 km and stays there, trusted once the limit is reached
+    for (MRH_Uint32 i = 1; i < MRH_USER_LOCATION_FILTER_REJECT_MAX; ++i, u64_TimeMS += u64_StepMS)
+    {
+        LocationSnapshot::Fix c_Fix = GetFix(5000.0, 0.0, u64_TimeMS);
+        MRH_TEST_CHECK(c_Filter.Process(c_Fix) == false);
+    }
+    
+    LocationSnapshot::Fix c_Moved = GetFix(5000.0, 0.0, u64_TimeMS);
+    LocationSnapshot::Fix c_Fix = c_Moved;
+    
+    MRH_TEST_CHECK(c_Filter.Process(c_Fix) == true);
+    MRH_TEST_CHECK(GetDistance(c_Fix, c_Moved) < 0.01);
+    
+    // Filtering continues from there
+    u64_TimeMS += u64_StepMS;
+    c_Fix = GetFix(5001.0, 0.0, u64_TimeMS);
+    
+    MRH_TEST_CHECK(c_Filter.Process(c_Fix) == true);
+    MRH_TEST_CHECK(GetDistance(c_Fix, c_Moved) < 2.0);
+    
+    // A long gap also starts over
+    u64_TimeMS += MRH_USER_LOCATION_FILTER_RESET_MS + 1;
+    c_Moved = GetFix(0.0, 0.0, u64_TimeMS);
+    c_Fix = c_Moved;
+    
+    MRH_TEST_CHECK(c_Filter.Process(c_Fix) == true);
+    MRH_TEST_CHECK(GetDistance(c_Fix, c_Moved) < 0.01);
+    
+    // Disabled filters pass everything
+    LocationFilter c_Disabled(0.0, f64_Acceleration, f64_MaxSpeed);
+    c_Fix = GetFix(0.0, 0.0, u64_StartMS);
+    c_Moved = GetFix(100000.0, 0.0, u64_StartMS + 1);
+    
+    MRH_TEST_CHECK(c_Disabled.Process(c_Fix) == true);
+    MRH_TEST_CHECK(c_Disabled.Process(c_Moved) == true);
+    MRH_TEST_CHECK(c_Moved.f64_Latitude == GetFix(100000.0, 0.0, 0).f64_Latitude);
+    
+    return true;
+}
+
+static bool TestExtrapolate()
+{
+    LocationSnapshot::Fix c_Fix = GetFix(0.0, 0.0, u64_StartMS);
+    c_Fix.f64_Speed = f64_Speed;
+    c_Fix.f64_Course = 90.0;
+    
+    // Moved east, never further than the limit
+    LocationSnapshot::Fix c_Result = LocationFilter::Extrapolate(c_Fix, u64_StartMS + 1000);
+    
+    MRH_TEST_CHECK(c_Result.u64_TimeMS == u64_StartMS + 1000);
+    MRH_TEST_CHECK(std::fabs(GetDistance(c_Result, c_Fix) - f64_Speed) < 0.01);
+    MRH_TEST_CHECK(c_Result.f64_Longtitude > c_Fix.f64_Longtitude);
+    
+    c_Result = LocationFilter::Extrapolate(c_Fix, u64_StartMS + (10 * MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS));
+    
+    MRH_TEST_CHECK(c_Result.u64_TimeMS == u64_StartMS + MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS);
+    
+    // Heading over a pole stops at it, longtitude stays valid
+    for (MRH_Sfloat64 f64_Pole : { 90.0, -90.0 })
+    {
+        for (MRH_Sfloat64 f64_Course : { 0.0, 90.0, 180.0, 270.0 })
+        {
+            c_Fix.f64_Latitude = f64_Pole - (f64_Pole > 0.0 ? 1e-5 : -1e-5);
+            c_Fix.f64_Longtitude = 179.9;
+            c_Fix.f64_Speed = 100.0;
+            c_Fix.f64_Course = f64_Course;
+            
+            c_Result = LocationFilter::Extrapolate(c_Fix, u64_StartMS + MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS);
+            
+            MRH_TEST_CHECK(std::isfinite(c_Result.f64_Latitude) == true);
+            MRH_TEST_CHECK(std::isfinite(c_Result.f64_Longtitude) == true);
+            MRH_TEST_CHECK(std::fabs(c_Result.f64_Latitude) <= 90.0);
+            MRH_TEST_CHECK(std::fabs(c_Result.f64_Longtitude) <= 180.0);
+            
+            c_Fix.f64_Latitude = f64_Pole;
+            c_Result = LocationFilter::Extrapolate(c_Fix, u64_StartMS + MRH_USER_LOCATION_EXTRAPOLATE_MAX_MS);
+            
+            MRH_TEST_CHECK(std::fabs(c_Result.f64_Latitude) <= 90.0);
+            MRH_TEST_CHECK(std::isfinite(c_Result.f64_Longtitude) == true);
+            MRH_TEST_CHECK(std::fabs(c_Result.f64_Longtitude) <= 180.0);
+        }
+    }
+    
+    return true;
+}
+
+static bool TestCost()
+{
+    std::mt19937 c_Random(7);
+    std::normal_distribution<MRH_Sfloat64> c_Noise(0.0, f64_Accuracy / std::sqrt(2.0));
+    LocationFilter c_Filter(f64_Accuracy, f64_Acceleration, f64_MaxSpeed);
+    std::vector<LocationSnapshot::Fix> v_Fix;
+    
+    for (MRH_Uint32 i = 0; i < 100000; ++i)
+    {
+        v_Fix.emplace_back(GetFix(c_Noise(c_Random), (i * f64_Speed) + c_Noise(c_Random), u64_StartMS + (i * u64_StepMS)));
+    }
+    
+    MRH_Uint32 u32_Accepted = 0;
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (auto& Fix : v_Fix)
+    {
+        u32_Accepted += (c_Filter.Process(Fix) == true ? 1 : 0);
+    }
+    
+    auto c_Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    std::printf("Average filtered fix: %llu ns.\n",
+                static_cast<unsigned long long>(c_Duration.count() / v_Fix.size()));
+    
+    // Few noisy fixes fall outside the gate, rebasing keeps the 1000 km track accurate
+    MRH_TEST_CHECK(u32_Accepted > v_Fix.size() * 0.99);
+    MRH_TEST_CHECK(GetDistance(v_Fix.back(), GetFix(0.0, (v_Fix.size() - 1) * f64_Speed, 0)) < 2.0 * f64_Accuracy);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Outliers", TestOutliers },
+        { "Reset", TestReset },
+        { "Extrapolate", TestExtrapolate },
+        { "Cost", TestCost }
+    };
+    
+    return Test::Run(p_Case);
+}
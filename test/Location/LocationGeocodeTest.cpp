@@ -0,0 +1,336 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// External
+
+// Project
+#include "../../src/Location/LocationGeocode.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_PlaceCount = 20000;
+    constexpr MRH_Uint32 u32_LookupCount = 2000;
+    
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0;
+    constexpr MRH_Sfloat64 f64_Radians = M_PI / 180.0;
+    
+    typedef struct Place_t
+    {
+        MRH_Sfloat64 f64_Latitude;
+        MRH_Sfloat64 f64_Longtitude;
+        
+    }Place;
+    
+    MRH_Sfloat64 GetDistance(MRH_Sfloat64 f64_LatitudeA, MRH_Sfloat64 f64_LongtitudeA, MRH_Sfloat64 f64_LatitudeB, MRH_Sfloat64 f64_LongtitudeB) noexcept
+    {
+        MRH_Sfloat64 f64_Latitude = std::sin((f64_LatitudeB - f64_LatitudeA) * f64_Radians / 2.0);
+        MRH_Sfloat64 f64_Longtitude = std::sin((f64_LongtitudeB - f64_LongtitudeA) * f64_Radians / 2.0);
+        MRH_Sfloat64 f64_A = (f64_Latitude * f64_Latitude) +
+                             (std::cos(f64_LatitudeA * f64_Radians) * std::cos(f64_LatitudeB * f64_Radians) * f64_Longtitude * f64_Longtitude);
+        
+        return 2.0 * f64_EarthRadius * std::asin(std::min(1.0, std::sqrt(f64_A)));
+    }
+    
+    // GeoNames layout, every 10th line is not a populated place
+    std::vector<Place> WriteData(std::string const& s_FilePath, std::mt19937& c_Random)
+    {
+        std::uniform_real_distribution<MRH_Sfloat64> c_Latitude(-90.0, 90.0);
+        std::uniform_real_distribution<MRH_Sfloat64> c_Longtitude(-180.0, 180.0);
+        std::vector<Place> v_Place;
+        FILE* p_File = fopen(s_FilePath.c_str(), "w");
+        
+        if (p_File == NULL)
+        {
+            return v_Place;
+        }
+        
+        for (MRH_Uint32 i = 0; i < u32_PlaceCount; ++i)
+        {
+            Place c_Place = { c_Latitude(c_Random), c_Longtitude(c_Random) };
+            bool b_Populated = (i % 10) != 9;
+            
+            std::fprintf(p_File, "%u\tPlace%u\tPlace%u\t\t%.6f\t%.6f\t%c\tPPL\tDE\t\t\t\t\t\t%u\t\t500\tEurope/Berlin\t2022-01-01\n",
+                         i,
+                         static_cast<unsigned>(v_Place.size()),
+                         static_cast<unsigned>(v_Place.size()),
+                         c_Place.f64_Latitude,
+                         c_Place.f64_Longtitude,
+                         (b_Populated == true ? 'P' : 'T'),
+                         i * 10);
+            
+            if (b_Populated == true)
+            {
+                v_Place.emplace_back(c_Place);
+            }
+        }
+        
+        fclose(p_File);
+        
+        // Places are read back from the written text
+        for (auto& It : v_Place)
+        {
+            It.f64_Latitude = std::round(It.f64_Latitude * 1e6) / 1e6;
+            It.f64_Longtitude = std::round(It.f64_Longtitude * 1e6) / 1e6;
+        }
+        
+        return v_Place;
+    }
+    
+    bool WaitLoaded(LocationGeocode& c_Geocode) noexcept
+    {
+        LocationGeocode::Place c_Place;
+        
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (c_Geocode.Find(0.0, 0.0, c_Place) == true)
+            {
+                return true;
+            }
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        
+        return false;
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestFind()
+{
+    char p_DirPath[] = "/tmp/mrhpsuser_geocode_XXXXXX";
+    
+    MRH_TEST_CHECK(mkdtemp(p_DirPath) != NULL);
+    
+    std::string s_DataPath(std::string(p_DirPath) + "/Places.txt");
+    std::string s_IndexPath(std::string(p_DirPath) + "/Places.bin");
+    std::mt19937 c_Random(99);
+    std::vector<Place> v_Place = WriteData(s_DataPath, c_Random);
+    
+    MRH_TEST_CHECK(v_Place.size() > 0);
+    
+    {
+        // No index yet, built in the background
+        auto c_Start = std::chrono::steady_clock::now();
+        LocationGeocode c_Geocode(s_DataPath, s_IndexPath);
+        auto c_Create = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - c_Start);
+        
+        MRH_TEST_CHECK(WaitLoaded(c_Geocode) == true);
+        
+        auto c_Build = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - c_Start);
+        
+        std::printf("Startup without index: %llu us, index ready after %llu us.\n",
+                    static_cast<unsigned long long>(c_Create.count()),
+                    static_cast<unsigned long long>(c_Build.count()));
+        
+        // Nearest place matches testing every place
+        std::uniform_real_distribution<MRH_Sfloat64> c_Latitude(-90.0, 90.0);
+        std::uniform_real_distribution<MRH_Sfloat64> c_Longtitude(-180.0, 180.0);
+        
+        for (MRH_Uint32 i = 0; i < u32_LookupCount; ++i)
+        {
+            MRH_Sfloat64 f64_Latitude = c_Latitude(c_Random);
+            MRH_Sfloat64 f64_Longtitude = c_Longtitude(c_Random);
+            MRH_Sfloat64 f64_Best = 1e12;
+            
+            for (auto& It : v_Place)
+            {
+                f64_Best = std::min(f64_Best, GetDistance(f64_Latitude, f64_Longtitude, It.f64_Latitude, It.f64_Longtitude));
+            }
+            
+            LocationGeocode::Place c_Place;
+            
+            MRH_TEST_CHECK(c_Geocode.Find(f64_Latitude, f64_Longtitude, c_Place) == true);
+            
+            // The index stores float unit vectors, about a meter apart
+            std::string s_Name(c_Place.p_Name, c_Place.u8_NameSize);
+            size_t us_Place = std::stoul(s_Name.substr(5));
+            
+            MRH_TEST_CHECK(s_Name.compare(0, 5, "Place") == 0);
+            MRH_TEST_CHECK(us_Place < v_Place.size());
+            MRH_TEST_CHECK(GetDistance(f64_Latitude, f64_Longtitude, v_Place[us_Place].f64_Latitude, v_Place[us_Place].f64_Longtitude) < f64_Best + 5.0);
+            MRH_TEST_CHECK(std::fabs(c_Place.f64_Distance - f64_Best) < 5.0);
+            MRH_TEST_CHECK(c_Place.p_Country[0] == 'D' && c_Place.p_Country[1] == 'E');
+        }
+    }
+    
+    struct stat c_Built;
+    MRH_TEST_CHECK(stat(s_IndexPath.c_str(), &c_Built) == 0);
+    
+    {
+        // Unchanged data, the index is only mapped
+        auto c_Start = std::chrono::steady_clock::now();
+        LocationGeocode c_Geocode(s_DataPath, s_IndexPath);
+        auto c_Create = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - c_Start);
+        LocationGeocode::Place c_Place;
+        
+        std::printf("Startup with index: %llu us.\n",
+                    static_cast<unsigned long long>(c_Create.count()));
+        
+        MRH_TEST_CHECK(c_Geocode.Find(v_Place[0].f64_Latitude, v_Place[0].f64_Longtitude, c_Place) == true);
+        MRH_TEST_CHECK(std::string(c_Place.p_Name, c_Place.u8_NameSize) == "Place0");
+        MRH_TEST_CHECK(c_Place.f64_Distance < 5.0);
+        
+        struct stat c_Mapped;
+        MRH_TEST_CHECK(stat(s_IndexPath.c_str(), &c_Mapped) == 0);
+        MRH_TEST_CHECK(c_Mapped.st_ino == c_Built.st_ino);
+    }
+    
+    {
+        // Index only, no place data
+        LocationGeocode c_Geocode("", s_IndexPath);
+        LocationGeocode::Place c_Place;
+        
+        MRH_TEST_CHECK(c_Geocode.Find(v_Place[1].f64_Latitude, v_Place[1].f64_Longtitude, c_Place) == true);
+        MRH_TEST_CHECK(std::string(c_Place.p_Name, c_Place.u8_NameSize) == "Place1");
+    }
+    
+    {
+        // Nothing to load
+        LocationGeocode c_Geocode("", std::string(p_DirPath) + "/Missing.bin");
+        LocationGeocode::Place c_Place;
+        
+        MRH_TEST_CHECK(c_Geocode.Find(0.0, 0.0, c_Place) == false);
+    }
+    
+    unlink(s_DataPath.c_str());
+    unlink(s_IndexPath.c_str());
+    rmdir(p_DirPath);
+    
+    return true;
+}
+
+static bool TestLookup()
+{
+    char p_DirPath[] = "/tmp/mrhpsuser_geocode_XXXXXX";
+    
+    MRH_TEST_CHECK(mkdtemp(p_DirPath) != NULL);
+    
+    std::string s_DataPath(std::string(p_DirPath) + "/Places.txt");
+    std::string s_IndexPath(std::string(p_DirPath) + "/Places.bin");
+    std::mt19937 c_Random(123);
+    std::vector<Place> v_Place = WriteData(s_DataPath, c_Random);
+    
+    MRH_TEST_CHECK(v_Place.size() > 2);
+    
+    {
+        LocationGeocode c_Geocode(s_DataPath, s_IndexPath);
+        LocationSnapshot::Fix c_Fix = { true, v_Place[0].f64_Latitude, v_Place[0].f64_Longtitude, 0.0, 0.0, 0.0, 0.0, 1000 };
+        LocationGeocode::Place c_Place;
+        
+        MRH_TEST_CHECK(WaitLoaded(c_Geocode) == true);
+        
+        // Missing fixes have no place
+        c_Fix.b_Recieved = false;
+        MRH_TEST_CHECK(c_Geocode.Lookup(c_Fix, c_Place) == false);
+        c_Fix.b_Recieved = true;
+        
+        MRH_TEST_CHECK(c_Geocode.Lookup(c_Fix, c_Place) == true);
+        MRH_TEST_CHECK(std::string(c_Place.p_Name, c_Place.u8_NameSize) == "Place0");
+        
+        // Repeated lookups of the same fix reuse the result
+        auto c_Start = std::chrono::steady_clock::now();
+        
+        for (MRH_Uint32 i = 0; i < 100000; ++i)
+        {
+            MRH_TEST_CHECK(c_Geocode.Lookup(c_Fix, c_Place) == true);
+        }
+        
+        auto c_Cached = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+        
+        MRH_TEST_CHECK(std::string(c_Place.p_Name, c_Place.u8_NameSize) == "Place0");
+        
+        // A new fix is looked up again
+        c_Start = std::chrono::steady_clock::now();
+        
+        for (MRH_Uint32 i = 0; i < 100000; ++i)
+        {
+            c_Fix.u64_TimeMS = 2000 + i;
+            c_Fix.f64_Latitude = v_Place[1 + (i % 2)].f64_Latitude;
+            c_Fix.f64_Longtitude = v_Place[1 + (i % 2)].f64_Longtitude;
+            
+            MRH_TEST_CHECK(c_Geocode.Lookup(c_Fix, c_Place) == true);
+            MRH_TEST_CHECK(std::string(c_Place.p_Name, c_Place.u8_NameSize) == (i % 2 == 0 ? "Place1" : "Place2"));
+        }
+        
+        auto c_Uncached = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+        
+        std::printf("Average lookup: %llu ns cached, %llu ns searched.\n",
+                    static_cast<unsigned long long>(c_Cached.count() / 100000),
+                    static_cast<unsigned long long>(c_Uncached.count() / 100000));
+    }
+    
+    {
+        // Changed place data is built again, lookups before are not cached
+        LocationSnapshot::Fix c_Fix = { true, v_Place[0].f64_Latitude, v_Place[0].f64_Longtitude, 0.0, 0.0, 0.0, 0.0, 1000 };
+        LocationGeocode::Place c_Place;
+        
+        std::mt19937 c_Other(456);
+        v_Place = WriteData(s_DataPath, c_Other);
+        
+        // Written in the same second, make sure the time differs
+        struct timespec p_Time[2] = { { 0, UTIME_OMIT }, { 1000000000, 0 } };
+        MRH_TEST_CHECK(utimensat(AT_FDCWD, s_DataPath.c_str(), p_Time, 0) == 0);
+        c_Fix.f64_Latitude = v_Place[3].f64_Latitude;
+        c_Fix.f64_Longtitude = v_Place[3].f64_Longtitude;
+        
+        LocationGeocode c_Geocode(s_DataPath, s_IndexPath);
+        
+        c_Geocode.Lookup(c_Fix, c_Place);
+        
+        MRH_TEST_CHECK(WaitLoaded(c_Geocode) == true);
+        MRH_TEST_CHECK(c_Geocode.Lookup(c_Fix, c_Place) == true);
+        MRH_TEST_CHECK(std::string(c_Place.p_Name, c_Place.u8_NameSize) == "Place3");
+    }
+    
+    unlink(s_DataPath.c_str());
+    unlink(s_IndexPath.c_str());
+    rmdir(p_DirPath);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Find", TestFind },
+        { "Lookup", TestLookup }
+    };
+    
+    return Test::Run(p_Case);
+}
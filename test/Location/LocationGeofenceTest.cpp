@@ -0,0 +1,352 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+// External
+
+// Project
+#include "../../src/Location/LocationGeofence.h"
+#include "../../src/Callback/Service/CustomCommand.h"
+#include "../../src/Callback/ResponseEvent.h"
+#include "../Test.h"
+
+namespace
+{
+    // Same distance model as the geofence
+    constexpr MRH_Sfloat64 f64_EarthRadius = 6371000.0;
+    constexpr MRH_Sfloat64 f64_Pi = 3.14159265358979323846;
+    constexpr MRH_Sfloat64 f64_MetersPerLatitude = f64_EarthRadius * f64_Pi / 180.0;
+    
+    // Regions spread over about 110 x 75 km, a few span everything
+    constexpr MRH_Uint32 u32_RegionCount = 10000;
+    constexpr MRH_Uint32 u32_LargeCount = 4;
+    constexpr MRH_Sfloat64 f64_CenterLatitude = 48.1;
+    constexpr MRH_Sfloat64 f64_CenterLongtitude = 11.5;
+    constexpr MRH_Sfloat64 f64_Spread = 0.5; // Degrees
+    
+    constexpr MRH_Uint32 u32_FixCount = 2000;
+    constexpr MRH_Uint32 u32_GroupID = 7;
+    constexpr MRH_Uint32 u32_OwnerGroupID = 9;
+    
+    typedef struct Event_t
+    {
+        MRH_Uint32 u32_GroupID;
+        MRH_Uint32 u32_RegionID;
+        bool b_Entered;
+        
+    }Event;
+    
+    std::vector<Event> v_Event;
+    
+    // Reference containment, every region tested for every fix
+    bool GetInside(Configuration::Geofence const& c_Geofence, MRH_Sfloat64 f64_Latitude, MRH_Sfloat64 f64_Longtitude) noexcept
+    {
+        if (c_Geofence.f64_Radius > 0.0)
+        {
+            MRH_Sfloat64 f64_MetersPerLongtitude = f64_MetersPerLatitude * std::cos(f64_Latitude * f64_Pi / 180.0);
+            MRH_Sfloat64 f64_North = (f64_Latitude - c_Geofence.v_Latitude[0]) * f64_MetersPerLatitude;
+            MRH_Sfloat64 f64_East = (f64_Longtitude - c_Geofence.v_Longtitude[0]) * f64_MetersPerLongtitude;
+            
+            return (f64_North * f64_North) + (f64_East * f64_East) <= c_Geofence.f64_Radius * c_Geofence.f64_Radius;
+        }
+        
+        auto const& v_Y = c_Geofence.v_Latitude;
+        auto const& v_X = c_Geofence.v_Longtitude;
+        bool b_Inside = false;
+        
+        for (size_t i = 0, j = v_Y.size() - 1; i < v_Y.size(); j = i++)
+        {
+            if ((v_Y[i] > f64_Latitude) != (v_Y[j] > f64_Latitude) &&
+                f64_Longtitude < v_X[j] + ((f64_Latitude - v_Y[j]) * ((v_X[i] - v_X[j]) / (v_Y[i] - v_Y[j]))))
+            {
+                b_Inside = !b_Inside;
+            }
+        }
+        
+        return b_Inside;
+    }
+    
+    std::vector<Configuration::Geofence> GetGeofences(std::mt19937& c_Random)
+    {
+        std::uniform_real_distribution<MRH_Sfloat64> c_Offset(-f64_Spread, f64_Spread);
+        std::uniform_real_distribution<MRH_Sfloat64> c_Radius(50.0, 2000.0);
+        std::uniform_real_distribution<MRH_Sfloat64> c_Unit(0.0, 1.0);
+        std::uniform_int_distribution<MRH_Uint32> c_Points(3, 12);
+        std::vector<Configuration::Geofence> v_Geofence(u32_RegionCount);
+        
+        for (MRH_Uint32 i = 0; i < u32_RegionCount; ++i)
+        {
+            Configuration::Geofence& c_Geofence = v_Geofence[i];
+            MRH_Sfloat64 f64_Latitude = f64_CenterLatitude + c_Offset(c_Random);
+            MRH_Sfloat64 f64_Longtitude = f64_CenterLongtitude + c_Offset(c_Random);
+            
+            c_Geofence.u32_ID = i + 1;
+            
+            if (i < u32_LargeCount)
+            {
+                // Larger than the cell limit, checked for every fix
+                c_Geofence.f64_Radius = 40000.0 + (i * 10000.0);
+                c_Geofence.v_Latitude.emplace_back(f64_Latitude);
+                c_Geofence.v_Longtitude.emplace_back(f64_Longtitude);
+            }
+            else if ((i % 2) == 0)
+            {
+                c_Geofence.f64_Radius = c_Radius(c_Random);
+                c_Geofence.v_Latitude.emplace_back(f64_Latitude);
+                c_Geofence.v_Longtitude.emplace_back(f64_Longtitude);
+            }
+            else
+            {
+                // Star shaped polygons, not always convex
+                MRH_Uint32 u32_Points = c_Points(c_Random);
+                MRH_Sfloat64 f64_Size = c_Radius(c_Random) / f64_MetersPerLatitude;
+                
+                c_Geofence.f64_Radius = 0.0;
+                
+                for (MRH_Uint32 j = 0; j < u32_Points; ++j)
+                {
+                    MRH_Sfloat64 f64_Angle = (2.0 * f64_Pi * j) / u32_Points;
+                    MRH_Sfloat64 f64_Distance = f64_Size * (0.3 + (0.7 * c_Unit(c_Random)));
+                    
+                    c_Geofence.v_Latitude.emplace_back(f64_Latitude + (f64_Distance * std::sin(f64_Angle)));
+                    c_Geofence.v_Longtitude.emplace_back(f64_Longtitude + (f64_Distance * std::cos(f64_Angle) * 1.5));
+                }
+            }
+        }
+        
+        return v_Geofence;
+    }
+    
+    // Fixes walk in steps up to about 1 km and sometimes jump
+    std::vector<LocationSnapshot::Fix> GetFixes(std::mt19937& c_Random)
+    {
+        std::uniform_real_distribution<MRH_Sfloat64> c_Offset(-f64_Spread, f64_Spread);
+        std::uniform_real_distribution<MRH_Sfloat64> c_Step(-0.01, 0.01);
+        std::uniform_int_distribution<MRH_Uint32> c_Jump(0, 99);
+        std::vector<LocationSnapshot::Fix> v_Fix;
+        MRH_Sfloat64 f64_Latitude = f64_CenterLatitude;
+        MRH_Sfloat64 f64_Longtitude = f64_CenterLongtitude;
+        
+        for (MRH_Uint32 i = 0; i < u32_FixCount; ++i)
+        {
+            if (c_Jump(c_Random) == 0)
+            {
+                f64_Latitude = f64_CenterLatitude + c_Offset(c_Random);
+                f64_Longtitude = f64_CenterLongtitude + c_Offset(c_Random);
+            }
+            else
+            {
+                f64_Latitude += c_Step(c_Random);
+                f64_Longtitude += c_Step(c_Random);
+            }
+            
+            v_Fix.push_back({ true, f64_Latitude, f64_Longtitude, 520.0, 0.0, 0.0, 0.0, 1700000000000 + (i * 1000ULL) });
+        }
+        
+        return v_Fix;
+    }
+}
+
+//*************************************************************************************
+// Event Capture
+//*************************************************************************************
+
+void ResponseEvent::Send(MRH_Uint32 u32_Type, const void* p_Data, MRH_Uint32 u32_DataSize, MRH_Uint32 u32_GroupID) noexcept
+{
+    CustomCommand::GeofenceEvent_S c_Data;
+    
+    if (u32_Type != MRH_EVENT_USER_CUSTOM_COMMAND_S || u32_DataSize != sizeof(c_Data))
+    {
+        return;
+    }
+    
+    std::memcpy(&c_Data, p_Data, sizeof(c_Data));
+    v_Event.push_back({ u32_GroupID, c_Data.u32_RegionID, c_Data.u8_Entered != 0 });
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestEvents()
+{
+    std::mt19937 c_Random(1234);
+    std::vector<Configuration::Geofence> v_Geofence = GetGeofences(c_Random);
+    std::vector<LocationSnapshot::Fix> v_Fix = GetFixes(c_Random);
+    
+    LocationGeofence c_Geofence(v_Geofence);
+    MRH_TEST_CHECK(c_Geofence.GetSubscribed() == false);
+    MRH_TEST_CHECK(c_Geofence.Subscribe(u32_GroupID) == true);
+    MRH_TEST_CHECK(c_Geofence.GetSubscribed() == true);
+    
+    // Every change of the brute force result is one event in id order
+    std::vector<bool> v_Inside(u32_RegionCount, false);
+    MRH_Uint32 u32_Events = 0;
+    MRH_Uint32 u32_Entered = 0;
+    
+    for (auto& Fix : v_Fix)
+    {
+        v_Event.clear();
+        c_Geofence.Update(Fix);
+        
+        size_t us_Event = 0;
+        
+        for (MRH_Uint32 i = 0; i < u32_RegionCount; ++i)
+        {
+            bool b_Inside = GetInside(v_Geofence[i], Fix.f64_Latitude, Fix.f64_Longtitude);
+            
+            if (b_Inside == v_Inside[i])
+            {
+                continue;
+            }
+            
+            v_Inside[i] = b_Inside;
+            
+            MRH_TEST_CHECK(us_Event < v_Event.size());
+            MRH_TEST_CHECK(v_Event[us_Event].u32_GroupID == u32_GroupID);
+            MRH_TEST_CHECK(v_Event[us_Event].u32_RegionID == v_Geofence[i].u32_ID);
+            MRH_TEST_CHECK(v_Event[us_Event].b_Entered == b_Inside);
+            
+            ++us_Event;
+            u32_Entered += (b_Inside == true ? 1 : 0);
+        }
+        
+        MRH_TEST_CHECK(us_Event == v_Event.size());
+        u32_Events += us_Event;
+    }
+    
+    // The walk has to reach enough regions to mean anything
+    MRH_TEST_CHECK(u32_Entered > 1000);
+    MRH_TEST_CHECK(u32_Events > 2 * 1000);
+    
+    return true;
+}
+
+static bool TestAdded()
+{
+    std::vector<Configuration::Geofence> v_Geofence;
+    LocationGeofence c_Geofence(v_Geofence);
+    
+    MRH_Sfloat64 p_Latitude[4] = { 48.0, 48.0, 48.01, 48.01 };
+    MRH_Sfloat64 p_Longtitude[4] = { 11.0, 11.01, 11.01, 11.0 };
+    
+    // Invalid regions are refused
+    MRH_TEST_CHECK(c_Geofence.Add(u32_OwnerGroupID, 0.0, p_Latitude, p_Longtitude, 2) == 0);
+    MRH_TEST_CHECK(c_Geofence.Add(u32_OwnerGroupID, 100.0, p_Latitude, p_Longtitude, 4) == 0);
+    
+    MRH_Uint32 u32_Square = c_Geofence.Add(u32_OwnerGroupID, 0.0, p_Latitude, p_Longtitude, 4);
+    MRH_Uint32 u32_Circle = c_Geofence.Add(u32_OwnerGroupID, 500.0, p_Latitude, p_Longtitude, 1);
+    
+    MRH_TEST_CHECK(u32_Square != 0);
+    MRH_TEST_CHECK(u32_Circle != 0 && u32_Circle != u32_Square);
+    MRH_TEST_CHECK(c_Geofence.GetSubscribed() == true);
+    
+    // Added regions go to their owner only, subscribed or not
+    v_Event.clear();
+    c_Geofence.Update({ true, 48.0005, 11.0005, 520.0, 0.0, 0.0, 0.0, 1000 });
+    
+    MRH_TEST_CHECK(v_Event.size() == 2);
+    MRH_TEST_CHECK(v_Event[0].u32_GroupID == u32_OwnerGroupID && v_Event[1].u32_GroupID == u32_OwnerGroupID);
+    MRH_TEST_CHECK(v_Event[0].b_Entered == true && v_Event[1].b_Entered == true);
+    
+    // Leaving the circle only
+    v_Event.clear();
+    c_Geofence.Update({ true, 48.009, 11.009, 520.0, 0.0, 0.0, 0.0, 2000 });
+    
+    MRH_TEST_CHECK(v_Event.size() == 1);
+    MRH_TEST_CHECK(v_Event[0].u32_RegionID == u32_Circle && v_Event[0].b_Entered == false);
+    
+    // Only the owner removes, removed regions are dropped without events
+    MRH_TEST_CHECK(c_Geofence.Remove(u32_GroupID, u32_Square) == false);
+    MRH_TEST_CHECK(c_Geofence.Remove(u32_OwnerGroupID, u32_Square) == true);
+    
+    v_Event.clear();
+    c_Geofence.Update({ true, 47.0, 11.0, 520.0, 0.0, 0.0, 0.0, 3000 });
+    
+    MRH_TEST_CHECK(v_Event.empty() == true);
+    
+    c_Geofence.Clear();
+    MRH_TEST_CHECK(c_Geofence.GetSubscribed() == false);
+    
+    return true;
+}
+
+static bool TestCost()
+{
+    std::mt19937 c_Random(5678);
+    std::vector<Configuration::Geofence> v_Geofence = GetGeofences(c_Random);
+    std::vector<LocationSnapshot::Fix> v_Fix = GetFixes(c_Random);
+    
+    LocationGeofence c_Geofence(v_Geofence);
+    MRH_TEST_CHECK(c_Geofence.Subscribe(u32_GroupID) == true);
+    
+    // Compare the indexed update with testing every region
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (auto& Fix : v_Fix)
+    {
+        c_Geofence.Update(Fix);
+    }
+    
+    auto c_Index = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+    MRH_Uint32 u32_Inside = 0;
+    
+    c_Start = std::chrono::steady_clock::now();
+    
+    for (auto& Fix : v_Fix)
+    {
+        for (auto& Geofence : v_Geofence)
+        {
+            u32_Inside += (GetInside(Geofence, Fix.f64_Latitude, Fix.f64_Longtitude) == true ? 1 : 0);
+        }
+    }
+    
+    auto c_Brute = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    std::printf("Average update for %u regions: %llu ns indexed, %llu ns brute force (%u inside).\n",
+                u32_RegionCount,
+                static_cast<unsigned long long>(c_Index.count() / u32_FixCount),
+                static_cast<unsigned long long>(c_Brute.count() / u32_FixCount),
+                u32_Inside);
+    
+    MRH_TEST_CHECK(c_Index.count() < c_Brute.count());
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Events", TestEvents },
+        { "Added", TestAdded },
+        { "Cost", TestCost }
+    };
+    
+    return Test::Run(p_Case);
+}
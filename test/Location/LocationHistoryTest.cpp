@@ -0,0 +1,224 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+// External
+
+// Project
+#include "../../src/Location/LocationHistory.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint64 u64_StartMS = 1700000000000;
+    constexpr MRH_Uint64 u64_StepMS = 10;
+    
+    constexpr MRH_Uint32 u32_ReaderCount = 4;
+    constexpr MRH_Uint32 u32_AddCount = 2000000;
+    
+    // Every value is derived from the fix number, torn reads mix numbers
+    LocationSnapshot::Fix GetFix(MRH_Uint64 u64_Fix) noexcept
+    {
+        MRH_Sfloat64 f64_Fix = static_cast<MRH_Sfloat64>(u64_Fix);
+        
+        return { true, f64_Fix, -f64_Fix, f64_Fix * 2.0, f64_Fix * 3.0, 0.0, 0.0, u64_StartMS + (u64_Fix * u64_StepMS) };
+    }
+    
+    bool GetValid(LocationSnapshot::Fix const& c_Fix) noexcept
+    {
+        MRH_Sfloat64 f64_Fix = static_cast<MRH_Sfloat64>((c_Fix.u64_TimeMS - u64_StartMS) / u64_StepMS);
+        
+        return c_Fix.b_Recieved == true &&
+               c_Fix.u64_TimeMS >= u64_StartMS &&
+               (c_Fix.u64_TimeMS - u64_StartMS) % u64_StepMS == 0 &&
+               c_Fix.f64_Latitude == f64_Fix &&
+               c_Fix.f64_Longtitude == -f64_Fix &&
+               c_Fix.f64_Elevation == f64_Fix * 2.0 &&
+               c_Fix.f64_Facing == f64_Fix * 3.0;
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestRange()
+{
+    LocationHistory c_History(1000);
+    std::vector<LocationSnapshot::Fix> v_Fix(2048);
+    
+    MRH_TEST_CHECK(c_History.GetCapacity() == 1024);
+    MRH_TEST_CHECK(c_History.Get(0, UINT64_MAX, v_Fix.data(), 2048) == 0);
+    
+    for (MRH_Uint64 i = 0; i < 100; ++i)
+    {
+        c_History.Add(GetFix(i));
+    }
+    
+    // Start and end are included, oldest first
+    MRH_TEST_CHECK(c_History.Get(0, UINT64_MAX, v_Fix.data(), 2048) == 100);
+    MRH_TEST_CHECK(v_Fix[0].u64_TimeMS == u64_StartMS && v_Fix[99].u64_TimeMS == GetFix(99).u64_TimeMS);
+    MRH_TEST_CHECK(c_History.Get(GetFix(10).u64_TimeMS, GetFix(19).u64_TimeMS, v_Fix.data(), 2048) == 10);
+    MRH_TEST_CHECK(v_Fix[0].f64_Latitude == 10.0 && v_Fix[9].f64_Latitude == 19.0);
+    MRH_TEST_CHECK(c_History.Get(GetFix(10).u64_TimeMS + 1, GetFix(19).u64_TimeMS - 1, v_Fix.data(), 2048) == 8);
+    MRH_TEST_CHECK(v_Fix[0].f64_Latitude == 11.0);
+    
+    // Only the newest fit
+    MRH_TEST_CHECK(c_History.Get(0, UINT64_MAX, v_Fix.data(), 5) == 5);
+    MRH_TEST_CHECK(v_Fix[0].f64_Latitude == 95.0 && v_Fix[4].f64_Latitude == 99.0);
+    
+    // Nothing outside or for invalid ranges
+    MRH_TEST_CHECK(c_History.Get(GetFix(100).u64_TimeMS, UINT64_MAX, v_Fix.data(), 2048) == 0);
+    MRH_TEST_CHECK(c_History.Get(0, u64_StartMS - 1, v_Fix.data(), 2048) == 0);
+    MRH_TEST_CHECK(c_History.Get(GetFix(19).u64_TimeMS, GetFix(10).u64_TimeMS, v_Fix.data(), 2048) == 0);
+    MRH_TEST_CHECK(c_History.Get(0, UINT64_MAX, NULL, 2048) == 0);
+    
+    // Wrapped, the oldest fixes are replaced
+    for (MRH_Uint64 i = 100; i < 3000; ++i)
+    {
+        c_History.Add(GetFix(i));
+    }
+    
+    MRH_TEST_CHECK(c_History.Get(0, UINT64_MAX, v_Fix.data(), 2048) == 1024);
+    MRH_TEST_CHECK(v_Fix[0].f64_Latitude == 3000.0 - 1024.0 && v_Fix[1023].f64_Latitude == 2999.0);
+    
+    for (MRH_Uint32 i = 0; i < 1024; ++i)
+    {
+        MRH_TEST_CHECK(GetValid(v_Fix[i]) == true);
+    }
+    
+    // Time going back keeps the last time, searches stay ordered
+    LocationSnapshot::Fix c_Old = GetFix(5);
+    c_History.Add(c_Old);
+    
+    MRH_TEST_CHECK(c_History.Get(GetFix(2999).u64_TimeMS, UINT64_MAX, v_Fix.data(), 2048) == 2);
+    MRH_TEST_CHECK(v_Fix[1].u64_TimeMS == GetFix(2999).u64_TimeMS && v_Fix[1].f64_Latitude == 5.0);
+    
+    return true;
+}
+
+static bool TestConcurrent()
+{
+    // Small ring, readers are overtaken by the writer all the time
+    LocationHistory c_History(64);
+    
+    // Adding alone first, readers never slow down the writer
+    auto c_Start = std::chrono::steady_clock::now();
+    
+    for (MRH_Uint64 i = 0; i < u32_AddCount; ++i)
+    {
+        c_History.Add(GetFix(i));
+    }
+    
+    auto c_Alone = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    std::atomic<bool> b_Run(true);
+    std::atomic<MRH_Uint32> u32_Invalid(0);
+    std::atomic<MRH_Uint64> u64_Reads(0);
+    std::vector<std::thread> v_Reader;
+    
+    for (MRH_Uint32 i = 0; i < u32_ReaderCount; ++i)
+    {
+        v_Reader.emplace_back([&, i]()
+        {
+            std::mt19937 c_Random(i);
+            LocationSnapshot::Fix p_Fix[64];
+            MRH_Uint64 u64_Local = 0;
+            
+            while (b_Run == true)
+            {
+                // Random windows around the newest fixes
+                MRH_Uint32 u32_Count = 1 + (c_Random() % 64);
+                MRH_Uint32 u32_Read = c_History.Get(0, UINT64_MAX, p_Fix, u32_Count);
+                
+                for (MRH_Uint32 j = 0; j < u32_Read; ++j)
+                {
+                    // Consistent and without gaps
+                    if (GetValid(p_Fix[j]) == false ||
+                        (j > 0 && p_Fix[j].u64_TimeMS != p_Fix[j - 1].u64_TimeMS + u64_StepMS))
+                    {
+                        ++u32_Invalid;
+                        break;
+                    }
+                }
+                
+                if (u32_Read > u32_Count)
+                {
+                    ++u32_Invalid;
+                }
+                
+                ++u64_Local;
+            }
+            
+            u64_Reads += u64_Local;
+        });
+    }
+    
+    c_Start = std::chrono::steady_clock::now();
+    
+    for (MRH_Uint64 i = u32_AddCount; i < 2 * u32_AddCount; ++i)
+    {
+        c_History.Add(GetFix(i));
+        
+        // Let readers run on a single core too
+        if ((i % 1024) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    
+    auto c_Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c_Start);
+    
+    b_Run = false;
+    
+    for (auto& Reader : v_Reader)
+    {
+        Reader.join();
+    }
+    
+    std::printf("Average add: %llu ns alone, %llu ns with %u readers, %llu reads.\n",
+                static_cast<unsigned long long>(c_Alone.count() / u32_AddCount),
+                static_cast<unsigned long long>(c_Duration.count() / u32_AddCount),
+                u32_ReaderCount,
+                static_cast<unsigned long long>(u64_Reads.load()));
+    
+    MRH_TEST_CHECK(u32_Invalid == 0);
+    MRH_TEST_CHECK(u64_Reads > 0);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Range", TestRange },
+        { "Concurrent", TestConcurrent }
+    };
+    
+    return Test::Run(p_Case);
+}
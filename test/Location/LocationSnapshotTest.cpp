@@ -0,0 +1,171 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <thread>
+#include <atomic>
+#include <vector>
+
+// External
+
+// Project
+#include "../../src/Location/LocationSnapshot.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint64 u64_StoreCount = 2000000;
+    constexpr int i_ReaderCount = 3;
+    
+    // All values follow from the time, a torn read mixes two fixes
+    LocationSnapshot::Fix GetFix(MRH_Uint64 u64_TimeMS) noexcept
+    {
+        MRH_Sfloat64 f64_Value = static_cast<MRH_Sfloat64>(u64_TimeMS);
+        
+        return { true,
+                 f64_Value,
+                 f64_Value + 0.5,
+                 f64_Value * 2.0,
+                 f64_Value * 0.25,
+                 f64_Value * 3.0,
+                 f64_Value + 1.0,
+                 u64_TimeMS };
+    }
+    
+    bool GetValid(LocationSnapshot::Fix const& c_Fix) noexcept
+    {
+        LocationSnapshot::Fix c_Expected = GetFix(c_Fix.u64_TimeMS);
+        
+        return c_Fix.b_Recieved == c_Expected.b_Recieved &&
+               c_Fix.f64_Latitude == c_Expected.f64_Latitude &&
+               c_Fix.f64_Longtitude == c_Expected.f64_Longtitude &&
+               c_Fix.f64_Elevation == c_Expected.f64_Elevation &&
+               c_Fix.f64_Facing == c_Expected.f64_Facing &&
+               c_Fix.f64_Speed == c_Expected.f64_Speed &&
+               c_Fix.f64_Course == c_Expected.f64_Course;
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestEmpty()
+{
+    LocationSnapshot c_Snapshot;
+    LocationSnapshot::Fix c_Fix = c_Snapshot.Load();
+    
+    MRH_TEST_CHECK(c_Fix.b_Recieved == false);
+    MRH_TEST_CHECK(c_Fix.u64_TimeMS == 0);
+    MRH_TEST_CHECK(LocationSnapshot::GetStale(c_Fix) == true);
+    
+    return true;
+}
+
+static bool TestStoreLoad()
+{
+    LocationSnapshot c_Snapshot;
+    LocationSnapshot::Fix c_Fix = GetFix(LocationSnapshot::GetTimeMS());
+    
+    c_Snapshot.Store(c_Fix);
+    c_Fix = c_Snapshot.Load();
+    
+    MRH_TEST_CHECK(GetValid(c_Fix) == true);
+    MRH_TEST_CHECK(LocationSnapshot::GetStale(c_Fix) == false);
+    
+    return true;
+}
+
+static bool TestTorture()
+{
+    // One writer publishing as fast as possible, readers check every fix
+    LocationSnapshot c_Snapshot;
+    std::atomic<bool> b_Run(true);
+    std::atomic<MRH_Uint64> u64_Torn(0);
+    std::atomic<MRH_Uint64> u64_Backwards(0);
+    std::atomic<MRH_Uint64> u64_Reads(0);
+    std::vector<std::thread> v_Reader;
+    
+    c_Snapshot.Store(GetFix(1));
+    
+    for (int i = 0; i < i_ReaderCount; ++i)
+    {
+        v_Reader.emplace_back([&]()
+        {
+            MRH_Uint64 u64_Last = 0;
+            MRH_Uint64 u64_Count = 0;
+            
+            while (b_Run.load(std::memory_order_relaxed) == true)
+            {
+                LocationSnapshot::Fix c_Fix = c_Snapshot.Load();
+                
+                if (GetValid(c_Fix) == false)
+                {
+                    ++u64_Torn;
+                }
+                else if (c_Fix.u64_TimeMS < u64_Last)
+                {
+                    ++u64_Backwards;
+                }
+                
+                u64_Last = c_Fix.u64_TimeMS;
+                ++u64_Count;
+            }
+            
+            u64_Reads += u64_Count;
+        });
+    }
+    
+    for (MRH_Uint64 i = 2; i <= u64_StoreCount; ++i)
+    {
+        c_Snapshot.Store(GetFix(i));
+    }
+    
+    b_Run = false;
+    
+    for (auto& Reader : v_Reader)
+    {
+        Reader.join();
+    }
+    
+    std::printf("Read %llu fixes during %llu stores.\n",
+                static_cast<unsigned long long>(u64_Reads.load()),
+                static_cast<unsigned long long>(u64_StoreCount));
+    
+    MRH_TEST_CHECK(u64_Torn == 0);
+    MRH_TEST_CHECK(u64_Backwards == 0);
+    MRH_TEST_CHECK(u64_Reads > 0);
+    MRH_TEST_CHECK(c_Snapshot.Load().u64_TimeMS == u64_StoreCount);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Empty", TestEmpty },
+        { "StoreLoad", TestStoreLoad },
+        { "Torture", TestTorture }
+    };
+    
+    return Test::Run(p_Case);
+}
@@ -0,0 +1,181 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <thread>
+#include <chrono>
+#include <vector>
+
+// External
+
+// Project
+#include "../../src/Location/LocationSources.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_IntervalMS = 20;
+    constexpr MRH_Uint32 u32_FixCount = 10;
+    
+    // Sources become quiet after 250 ms with this interval
+    constexpr MRH_Uint64 u64_FailoverMinMS = 200;
+    constexpr MRH_Uint64 u64_FailoverMaxMS = 500;
+    
+    constexpr size_t us_Primary = 0;
+    constexpr size_t us_Secondary = 1;
+    
+    // A GNSS feed and a network fallback
+    const std::vector<Configuration::LocationSource> v_Source =
+    {
+        { "/tmp/mrhpsuser_test_gnss.sock", 0 },
+        { "/tmp/mrhpsuser_test_network.sock", 1 }
+    };
+    
+    void Wait() noexcept
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(u32_IntervalMS));
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestInvalid()
+{
+    std::vector<Configuration::LocationSource> v_None;
+    bool b_Thrown = false;
+    
+    try
+    {
+        LocationSources c_Sources(v_None);
+    }
+    catch (Exception& e)
+    {
+        b_Thrown = true;
+    }
+    
+    MRH_TEST_CHECK(b_Thrown == true);
+    
+    return true;
+}
+
+static bool TestPriority()
+{
+    LocationSources c_Sources(v_Source);
+    
+    MRH_TEST_CHECK(c_Sources.GetCount() == 2);
+    MRH_TEST_CHECK(c_Sources.GetSocketPath(us_Secondary) == v_Source[us_Secondary].s_SocketPath);
+    
+    c_Sources.SetConnected(us_Primary, true);
+    c_Sources.SetConnected(us_Secondary, true);
+    
+    // Both deliver, only the preferred source is published
+    for (MRH_Uint32 i = 0; i < u32_FixCount; ++i)
+    {
+        MRH_TEST_CHECK(c_Sources.AddFix(us_Primary) == true);
+        MRH_TEST_CHECK(c_Sources.AddFix(us_Secondary) == false);
+        
+        Wait();
+    }
+    
+    LocationSources::Stats c_Primary = c_Sources.GetStats(us_Primary);
+    LocationSources::Stats c_Secondary = c_Sources.GetStats(us_Secondary);
+    
+    MRH_TEST_CHECK(c_Primary.b_Active == true);
+    MRH_TEST_CHECK(c_Primary.b_Fresh == true);
+    MRH_TEST_CHECK(c_Primary.u64_Fixes == u32_FixCount);
+    MRH_TEST_CHECK(c_Primary.u64_Selected == u32_FixCount);
+    MRH_TEST_CHECK(c_Primary.u64_Connects == 1);
+    MRH_TEST_CHECK(c_Primary.u32_IntervalMS >= u32_IntervalMS);
+    MRH_TEST_CHECK(c_Secondary.b_Active == false);
+    MRH_TEST_CHECK(c_Secondary.u64_Fixes == u32_FixCount);
+    MRH_TEST_CHECK(c_Secondary.u64_Selected == 0);
+    
+    return true;
+}
+
+static bool TestFailover()
+{
+    LocationSources c_Sources(v_Source);
+    
+    c_Sources.SetConnected(us_Primary, true);
+    c_Sources.SetConnected(us_Secondary, true);
+    
+    for (MRH_Uint32 i = 0; i < u32_FixCount; ++i)
+    {
+        c_Sources.AddFix(us_Primary);
+        c_Sources.AddFix(us_Secondary);
+        
+        Wait();
+    }
+    
+    // Primary goes quiet, the fallback takes over once it is missed
+    MRH_Uint64 u64_QuietMS = LocationSources::GetTimeMS();
+    MRH_Uint64 u64_FailoverMS = 0;
+    
+    while (u64_FailoverMS == 0 && LocationSources::GetTimeMS() - u64_QuietMS < u64_FailoverMaxMS * 2)
+    {
+        if (c_Sources.AddFix(us_Secondary) == true)
+        {
+            u64_FailoverMS = LocationSources::GetTimeMS() - u64_QuietMS;
+        }
+        
+        Wait();
+    }
+    
+    std::printf("Failed over after %llu ms.\n", static_cast<unsigned long long>(u64_FailoverMS));
+    
+    MRH_TEST_CHECK(u64_FailoverMS >= u64_FailoverMinMS);
+    MRH_TEST_CHECK(u64_FailoverMS <= u64_FailoverMaxMS);
+    MRH_TEST_CHECK(c_Sources.GetStats(us_Secondary).b_Active == true);
+    MRH_TEST_CHECK(c_Sources.GetStats(us_Primary).b_Fresh == false);
+    
+    // Primary returns and is preferred again right away
+    MRH_TEST_CHECK(c_Sources.AddFix(us_Primary) == true);
+    MRH_TEST_CHECK(c_Sources.AddFix(us_Secondary) == false);
+    MRH_TEST_CHECK(c_Sources.GetStats(us_Primary).b_Active == true);
+    
+    // A closed source is not waited for
+    c_Sources.SetConnected(us_Primary, false);
+    
+    MRH_TEST_CHECK(c_Sources.AddFix(us_Secondary) == true);
+    
+    c_Sources.AddError(us_Primary);
+    c_Sources.SetConnected(us_Primary, true);
+    
+    MRH_TEST_CHECK(c_Sources.GetStats(us_Primary).u64_Errors == 1);
+    MRH_TEST_CHECK(c_Sources.GetStats(us_Primary).u64_Connects == 2);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Invalid", TestInvalid },
+        { "Priority", TestPriority },
+        { "Failover", TestFailover }
+    };
+    
+    return Test::Run(p_Case);
+}
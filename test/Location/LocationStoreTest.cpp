@@ -0,0 +1,303 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <cmath>
+#include <map>
+#include <string>
+#include <fstream>
+#include <iterator>
+
+// External
+
+// Project
+#include "../../src/Location/LocationStore.h"
+#include "../Test.h"
+
+namespace
+{
+    constexpr MRH_Uint32 u32_SegmentSize = 64 * 1024;
+    constexpr MRH_Uint64 u64_SizeBudget = 4 * u32_SegmentSize;
+    constexpr MRH_Uint64 u64_StartMS = 1700000000000;
+    constexpr MRH_Uint64 u64_StepMS = 1000;
+    
+    // Values change a little per fix, like a walk
+    LocationSnapshot::Fix GetFix(MRH_Uint64 u64_Fix) noexcept
+    {
+        return { true,
+                 48.1 + (u64_Fix * 1e-6),
+                 11.5 - (u64_Fix * 2e-6),
+                 520.0 + ((u64_Fix % 7) * 0.1),
+                 std::fmod(u64_Fix * 0.5, 360.0),
+                 0.0,
+                 0.0,
+                 u64_StartMS + (u64_Fix * u64_StepMS) };
+    }
+    
+    // Stored precision is 1e-7 degrees, 1 cm and 0.01 degrees
+    bool GetEqual(LocationSnapshot::Fix const& c_Fix, MRH_Uint64 u64_Fix) noexcept
+    {
+        LocationSnapshot::Fix c_Expected = GetFix(u64_Fix);
+        
+        return c_Fix.u64_TimeMS == c_Expected.u64_TimeMS &&
+               std::fabs(c_Fix.f64_Latitude - c_Expected.f64_Latitude) <= 1e-7 &&
+               std::fabs(c_Fix.f64_Longtitude - c_Expected.f64_Longtitude) <= 1e-7 &&
+               std::fabs(c_Fix.f64_Elevation - c_Expected.f64_Elevation) <= 0.01 &&
+               std::fabs(c_Fix.f64_Facing - c_Expected.f64_Facing) <= 0.01;
+    }
+    
+    MRH_Uint64 GetFixTime(MRH_Uint64 u64_Fix) noexcept
+    {
+        return u64_StartMS + (u64_Fix * u64_StepMS);
+    }
+    
+    // Segment files and their content by name
+    std::map<std::string, std::string> GetFiles(std::string const& s_DirPath)
+    {
+        std::map<std::string, std::string> m_File;
+        DIR* p_Dir = opendir(s_DirPath.c_str());
+        struct dirent* p_Entry;
+        
+        while (p_Dir != NULL && (p_Entry = readdir(p_Dir)) != NULL)
+        {
+            if (p_Entry->d_name[0] == '.')
+            {
+                continue;
+            }
+            
+            std::ifstream f_File(s_DirPath + "/" + p_Entry->d_name, std::ios::binary);
+            m_File[p_Entry->d_name] = std::string(std::istreambuf_iterator<char>(f_File), std::istreambuf_iterator<char>());
+        }
+        
+        if (p_Dir != NULL)
+        {
+            closedir(p_Dir);
+        }
+        
+        return m_File;
+    }
+    
+    std::string CreateDir()
+    {
+        char p_DirPath[] = "/tmp/mrhpsuser_store_XXXXXX";
+        
+        if (mkdtemp(p_DirPath) == NULL)
+        {
+            return "";
+        }
+        
+        return p_DirPath;
+    }
+    
+    void RemoveDir(std::string const& s_DirPath)
+    {
+        for (auto& File : GetFiles(s_DirPath))
+        {
+            unlink((s_DirPath + "/" + File.first).c_str());
+        }
+        
+        rmdir(s_DirPath.c_str());
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestDisabled()
+{
+    std::string s_DirPath = CreateDir() + "/Disabled";
+    LocationStore c_Store(s_DirPath, u32_SegmentSize, 0);
+    LocationSnapshot::Fix c_Fix;
+    
+    c_Store.Add(GetFix(1));
+    
+    MRH_TEST_CHECK(c_Store.Get(0, UINT64_MAX, &c_Fix, 1) == 0);
+    MRH_TEST_CHECK(access(s_DirPath.c_str(), F_OK) != 0);
+    
+    RemoveDir(s_DirPath.substr(0, s_DirPath.rfind('/')));
+    return true;
+}
+
+static bool TestRoundTrip()
+{
+    std::string s_DirPath = CreateDir();
+    LocationSnapshot::Fix p_Fix[MRH_USER_LOCATION_STORE_BLOCK_SIZE * 2];
+    MRH_Uint32 u32_Count;
+    bool b_Result = true;
+    
+    MRH_TEST_CHECK(s_DirPath.size() > 0);
+    
+    {
+        LocationStore c_Store(s_DirPath, u32_SegmentSize, u64_SizeBudget);
+        
+        MRH_TEST_CHECK(c_Store.Get(0, UINT64_MAX, p_Fix, 1) == 0);
+        
+        for (MRH_Uint64 i = 0; i < 1000; ++i)
+        {
+            c_Store.Add(GetFix(i));
+        }
+        
+        // Range crossing a block start, oldest first
+        u32_Count = c_Store.Get(GetFixTime(50), GetFixTime(149), p_Fix, 100);
+        
+        for (MRH_Uint32 i = 0; i < u32_Count; ++i)
+        {
+            b_Result = b_Result && GetEqual(p_Fix[i], 50 + i);
+        }
+        
+        MRH_TEST_CHECK(u32_Count == 100);
+        MRH_TEST_CHECK(b_Result == true);
+        
+        // Only the newest fixes if the buffer is too small
+        u32_Count = c_Store.Get(0, UINT64_MAX, p_Fix, 3);
+        
+        MRH_TEST_CHECK(u32_Count == 3);
+        MRH_TEST_CHECK(GetEqual(p_Fix[0], 997) == true);
+        MRH_TEST_CHECK(GetEqual(p_Fix[2], 999) == true);
+        
+        // Nothing before the first or after the last fix
+        MRH_TEST_CHECK(c_Store.Get(0, GetFixTime(0) - 1, p_Fix, 1) == 0);
+        MRH_TEST_CHECK(c_Store.Get(GetFixTime(1000), UINT64_MAX, p_Fix, 1) == 0);
+    }
+    
+    // Reloaded fixes decode the same
+    {
+        LocationStore c_Store(s_DirPath, u32_SegmentSize, u64_SizeBudget);
+        
+        u32_Count = c_Store.Get(GetFixTime(900), GetFixTime(999), p_Fix, 100);
+        
+        for (MRH_Uint32 i = 0; i < u32_Count; ++i)
+        {
+            b_Result = b_Result && GetEqual(p_Fix[i], 900 + i);
+        }
+        
+        MRH_TEST_CHECK(u32_Count == 100);
+        MRH_TEST_CHECK(b_Result == true);
+    }
+    
+    RemoveDir(s_DirPath);
+    return true;
+}
+
+static bool TestRotation()
+{
+    std::string s_DirPath = CreateDir();
+    LocationSnapshot::Fix c_Fix;
+    MRH_Uint64 u64_Count = 80000; // About 10 segments
+    
+    MRH_TEST_CHECK(s_DirPath.size() > 0);
+    
+    {
+        LocationStore c_Store(s_DirPath, u32_SegmentSize, u64_SizeBudget);
+        
+        for (MRH_Uint64 i = 0; i < u64_Count; ++i)
+        {
+            c_Store.Add(GetFix(i));
+        }
+        
+        // Oldest segments were removed, the newest fixes are kept
+        MRH_TEST_CHECK(c_Store.Get(0, GetFixTime(100), &c_Fix, 1) == 0);
+        MRH_TEST_CHECK(c_Store.Get(0, UINT64_MAX, &c_Fix, 1) == 1);
+        MRH_TEST_CHECK(GetEqual(c_Fix, u64_Count - 1) == true);
+    }
+    
+    std::map<std::string, std::string> m_File = GetFiles(s_DirPath);
+    MRH_Uint64 u64_Size = 0;
+    
+    for (auto& File : m_File)
+    {
+        u64_Size += File.second.size();
+    }
+    
+    MRH_TEST_CHECK(m_File.size() > 1);
+    MRH_TEST_CHECK(u64_Size <= u64_SizeBudget);
+    
+    RemoveDir(s_DirPath);
+    return true;
+}
+
+static bool TestReloadReadOnly()
+{
+    std::string s_DirPath = CreateDir();
+    LocationSnapshot::Fix p_Fix[2];
+    int i_Status;
+    
+    MRH_TEST_CHECK(s_DirPath.size() > 0);
+    
+    // Crash while writing, the segment is left unsealed
+    pid_t i_PID = fork();
+    
+    if (i_PID == 0)
+    {
+        LocationStore c_Store(s_DirPath, u32_SegmentSize, u64_SizeBudget);
+        
+        for (MRH_Uint64 i = 0; i < 100; ++i)
+        {
+            c_Store.Add(GetFix(i));
+        }
+        
+        _exit(EXIT_SUCCESS);
+    }
+    
+    MRH_TEST_CHECK(i_PID > 0);
+    MRH_TEST_CHECK(waitpid(i_PID, &i_Status, 0) == i_PID);
+    MRH_TEST_CHECK(WIFEXITED(i_Status) && WEXITSTATUS(i_Status) == EXIT_SUCCESS);
+    
+    // Loaded segments are never written, new fixes go to a new segment
+    std::map<std::string, std::string> m_Before = GetFiles(s_DirPath);
+    
+    {
+        LocationStore c_Store(s_DirPath, u32_SegmentSize, u64_SizeBudget);
+        
+        c_Store.Add(GetFix(100));
+        
+        MRH_TEST_CHECK(c_Store.Get(GetFixTime(99), UINT64_MAX, p_Fix, 2) == 2);
+        MRH_TEST_CHECK(GetEqual(p_Fix[0], 99) == true);
+        MRH_TEST_CHECK(GetEqual(p_Fix[1], 100) == true);
+    }
+    
+    std::map<std::string, std::string> m_After = GetFiles(s_DirPath);
+    
+    MRH_TEST_CHECK(m_Before.size() == 1);
+    MRH_TEST_CHECK(m_After.size() == 2);
+    MRH_TEST_CHECK(m_After[m_Before.begin()->first] == m_Before.begin()->second);
+    
+    RemoveDir(s_DirPath);
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Disabled", TestDisabled },
+        { "RoundTrip", TestRoundTrip },
+        { "Rotation", TestRotation },
+        { "ReloadReadOnly", TestReloadReadOnly }
+    };
+    
+    return Test::Run(p_Case);
+}
@@ -0,0 +1,226 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <cmath>
+#include <string>
+
+// External
+
+// Project
+#include "../../src/Location/LocationVisits.h"
+#include "../Test.h"
+
+namespace
+{
+    // Visits need 100 m and 5 minutes, places are 150 m wide
+    constexpr MRH_Sfloat64 f64_Distance = 100.0;
+    constexpr MRH_Uint64 u64_DurationMS = 300 * 1000;
+    constexpr MRH_Sfloat64 f64_PlaceDistance = 150.0;
+    
+    constexpr MRH_Uint64 u64_StartMS = 1700000000000;
+    constexpr MRH_Uint64 u64_StepMS = 10 * 1000;
+    constexpr MRH_Uint32 u32_StayCount = 61; // 10 minutes
+    constexpr MRH_Uint32 u32_StopCount = 15; // Below 5 minutes
+    constexpr MRH_Uint32 u32_TravelCount = 10;
+    
+    // About 1.1 km apart, a degree of latitude is about 111 km
+    constexpr MRH_Sfloat64 f64_HomeLatitude = 48.1000;
+    constexpr MRH_Sfloat64 f64_WorkLatitude = 48.1100;
+    constexpr MRH_Sfloat64 f64_StopLatitude = 48.1200;
+    constexpr MRH_Sfloat64 f64_Longtitude = 11.5000;
+    
+    constexpr MRH_Sfloat64 f64_MetersPerLatitude = 111195.0;
+    
+    // Feeds fixes in time order, one every 10 seconds
+    class Walk
+    {
+    public:
+        
+        Walk(LocationVisits& c_Visits) noexcept : c_Visits(c_Visits),
+                                                  u64_Fix(0),
+                                                  f64_Latitude(f64_HomeLatitude)
+        {}
+        
+        // Fixes jitter about 10 m around the place
+        void Stay(MRH_Sfloat64 f64_Latitude, MRH_Uint32 u32_Count) noexcept
+        {
+            for (MRH_Uint32 i = 0; i < u32_Count; ++i)
+            {
+                Add(f64_Latitude + ((static_cast<int>(i % 5) - 2) * 5e-5));
+            }
+            
+            this->f64_Latitude = f64_Latitude;
+        }
+        
+        void Travel(MRH_Sfloat64 f64_Latitude) noexcept
+        {
+            for (MRH_Uint32 i = 1; i <= u32_TravelCount; ++i)
+            {
+                Add(this->f64_Latitude + ((f64_Latitude - this->f64_Latitude) * i / (u32_TravelCount + 1)));
+            }
+        }
+        
+        MRH_Uint64 GetTimeMS() const noexcept
+        {
+            return u64_StartMS + (u64_Fix * u64_StepMS);
+        }
+        
+    private:
+        
+        void Add(MRH_Sfloat64 f64_FixLatitude) noexcept
+        {
+            c_Visits.Update({ true, f64_FixLatitude, f64_Longtitude, 520.0, 0.0, 0.0, 0.0, GetTimeMS() });
+            ++u64_Fix;
+        }
+        
+        LocationVisits& c_Visits;
+        MRH_Uint64 u64_Fix;
+        MRH_Sfloat64 f64_Latitude;
+    };
+    
+    bool GetNear(LocationVisits::Visit const& c_Visit, MRH_Sfloat64 f64_Latitude) noexcept
+    {
+        return std::fabs(c_Visit.f64_Latitude - f64_Latitude) * f64_MetersPerLatitude < 20.0 &&
+               std::fabs(c_Visit.f64_Longtitude - f64_Longtitude) < 1e-6;
+    }
+    
+    // Arrival may include the last travel fixes
+    bool GetTimes(LocationVisits::Visit const& c_Visit, MRH_Uint64 u64_ArrivalMS, MRH_Uint64 u64_DepartureMS) noexcept
+    {
+        return c_Visit.u64_ArrivalMS + (3 * u64_StepMS) >= u64_ArrivalMS &&
+               c_Visit.u64_ArrivalMS <= u64_ArrivalMS &&
+               c_Visit.u64_DepartureMS == u64_DepartureMS;
+    }
+}
+
+
+//*************************************************************************************
+// Tests
+//*************************************************************************************
+
+static bool TestVisits()
+{
+    char p_DirPath[] = "/tmp/mrhpsuser_visits_XXXXXX";
+    
+    MRH_TEST_CHECK(mkdtemp(p_DirPath) != NULL);
+    
+    std::string s_FilePath(std::string(p_DirPath) + "/Visits.bin");
+    LocationVisits::Visit p_Visit[8];
+    LocationVisits::Place p_Place[8];
+    MRH_Uint64 p_ArrivalMS[4];
+    MRH_Uint64 p_DepartureMS[4];
+    
+    {
+        LocationVisits c_Visits(s_FilePath, f64_Distance, u64_DurationMS, f64_PlaceDistance);
+        Walk c_Walk(c_Visits);
+        
+        // Home, work, a short stop and home again
+        p_ArrivalMS[0] = c_Walk.GetTimeMS();
+        c_Walk.Stay(f64_HomeLatitude, u32_StayCount);
+        p_DepartureMS[0] = c_Walk.GetTimeMS() - u64_StepMS;
+        c_Walk.Travel(f64_WorkLatitude);
+        
+        p_ArrivalMS[1] = c_Walk.GetTimeMS();
+        c_Walk.Stay(f64_WorkLatitude, u32_StayCount);
+        p_DepartureMS[1] = c_Walk.GetTimeMS() - u64_StepMS;
+        c_Walk.Travel(f64_StopLatitude);
+        
+        c_Walk.Stay(f64_StopLatitude, u32_StopCount);
+        c_Walk.Travel(f64_HomeLatitude);
+        
+        p_ArrivalMS[2] = c_Walk.GetTimeMS();
+        c_Walk.Stay(f64_HomeLatitude, u32_StayCount);
+        p_DepartureMS[2] = c_Walk.GetTimeMS() - u64_StepMS;
+        c_Walk.Travel(f64_StopLatitude);
+        
+        MRH_TEST_CHECK(c_Visits.GetVisits(0, UINT64_MAX, p_Visit, 8) == 3);
+        
+        for (int i = 0; i < 3; ++i)
+        {
+            MRH_TEST_CHECK(GetTimes(p_Visit[i], p_ArrivalMS[i], p_DepartureMS[i]) == true);
+        }
+        
+        MRH_TEST_CHECK(GetNear(p_Visit[0], f64_HomeLatitude) == true);
+        MRH_TEST_CHECK(GetNear(p_Visit[1], f64_WorkLatitude) == true);
+        MRH_TEST_CHECK(GetNear(p_Visit[2], f64_HomeLatitude) == true);
+        
+        // Both home visits are the same place
+        MRH_TEST_CHECK(p_Visit[0].u32_PlaceID != 0);
+        MRH_TEST_CHECK(p_Visit[0].u32_PlaceID == p_Visit[2].u32_PlaceID);
+        MRH_TEST_CHECK(p_Visit[1].u32_PlaceID != p_Visit[0].u32_PlaceID);
+        
+        // Only visits overlapping the range
+        MRH_TEST_CHECK(c_Visits.GetVisits(p_ArrivalMS[1], p_DepartureMS[1], p_Visit, 8) == 1);
+        MRH_TEST_CHECK(GetNear(p_Visit[0], f64_WorkLatitude) == true);
+        
+        // Most visited first
+        MRH_TEST_CHECK(c_Visits.GetPlaces(p_Place, 8) == 2);
+        MRH_TEST_CHECK(p_Place[0].u32_Visits == 2);
+        MRH_TEST_CHECK(p_Place[1].u32_Visits == 1);
+        MRH_TEST_CHECK(p_Place[0].u64_LastMS == p_DepartureMS[2]);
+        MRH_TEST_CHECK(p_Place[0].u64_DurationMS >= 2 * (u32_StayCount - 1) * u64_StepMS);
+        
+        // Staying at work again is the current visit
+        c_Walk.Travel(f64_WorkLatitude);
+        
+        p_ArrivalMS[3] = c_Walk.GetTimeMS();
+        c_Walk.Stay(f64_WorkLatitude, u32_StayCount);
+        p_DepartureMS[3] = c_Walk.GetTimeMS() - u64_StepMS;
+        
+        MRH_TEST_CHECK(c_Visits.GetVisits(0, UINT64_MAX, p_Visit, 8) == 4);
+        MRH_TEST_CHECK(p_Visit[3].u64_DepartureMS == 0);
+        MRH_TEST_CHECK(p_Visit[3].u32_PlaceID == p_Visit[1].u32_PlaceID);
+    }
+    
+    // Reloaded, the current visit departed at the last fix
+    {
+        LocationVisits c_Visits(s_FilePath, f64_Distance, u64_DurationMS, f64_PlaceDistance);
+        
+        MRH_TEST_CHECK(c_Visits.GetVisits(0, UINT64_MAX, p_Visit, 8) == 4);
+        
+        for (int i = 0; i < 4; ++i)
+        {
+            MRH_TEST_CHECK(GetTimes(p_Visit[i], p_ArrivalMS[i], p_DepartureMS[i]) == true);
+        }
+        
+        MRH_TEST_CHECK(p_Visit[0].u32_PlaceID == p_Visit[2].u32_PlaceID);
+        MRH_TEST_CHECK(p_Visit[1].u32_PlaceID == p_Visit[3].u32_PlaceID);
+        MRH_TEST_CHECK(c_Visits.GetPlaces(p_Place, 8) == 2);
+        MRH_TEST_CHECK(p_Place[0].u32_Visits == 2);
+        MRH_TEST_CHECK(p_Place[1].u32_Visits == 2);
+    }
+    
+    unlink(s_FilePath.c_str());
+    rmdir(p_DirPath);
+    
+    return true;
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    static const Test::Case p_Case[] =
+    {
+        { "Visits", TestVisits }
+    };
+    
+    return Test::Run(p_Case);
+}
@@ -0,0 +1,99 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef Test_h
+#define Test_h
+
+// C / C++
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+// External
+
+// Project
+
+
+//*************************************************************************************
+// Check
+//*************************************************************************************
+
+// Fail the running test case if the condition is false
+#define MRH_TEST_CHECK(Condition)                                               \
+    do                                                                          \
+    {                                                                           \
+        if (!(Condition))                                                       \
+        {                                                                       \
+            std::fprintf(stderr, "%s:%d: Check failed: %s\n",                   \
+                         __FILE__, __LINE__, #Condition);                       \
+            return false;                                                       \
+        }                                                                       \
+    }                                                                           \
+    while (false)
+
+//*************************************************************************************
+// Run
+//*************************************************************************************
+
+namespace Test
+{
+    typedef struct Case_t
+    {
+        const char* p_Name;
+        bool (*Run)();
+        
+    }Case;
+    
+    /**
+     *  Run all test cases. Exceptions fail the throwing test case.
+     *
+     *  \param p_Case The test cases to run.
+     *
+     *  \return EXIT_SUCCESS if all passed, EXIT_FAILURE if not.
+     */
+    
+    template<size_t Count>
+    int Run(const Case (&p_Case)[Count]) noexcept
+    {
+        int i_Result = EXIT_SUCCESS;
+        
+        for (size_t i = 0; i < Count; ++i)
+        {
+            bool b_Passed;
+            
+            try
+            {
+                b_Passed = p_Case[i].Run();
+            }
+            catch (std::exception& e)
+            {
+                std::fprintf(stderr, "%s: Exception: %s\n", p_Case[i].p_Name, e.what());
+                b_Passed = false;
+            }
+            
+            std::printf("%s %s\n", (b_Passed == true ? "PASS" : "FAIL"), p_Case[i].p_Name);
+            
+            if (b_Passed == false)
+            {
+                i_Result = EXIT_FAILURE;
+            }
+        }
+        
+        return i_Result;
+    }
+}
+
+#endif /* Test_h */